@@ -0,0 +1,241 @@
+/*
+  Author: Modulabs
+  File Name: balance_lookup_table.cpp
+*/
+
+/* Offline table of the explicit balance solution and its memory vs speed report
+ *
+ *   rosrun legged_robot_controller balance_lookup_table [--out=balance_lookup.txt] [--ticks=N] [--seed=S]
+ *
+ * Balance QPs of all stance masks are sampled along smooth random motions around the standing posture
+ * of HyQ: pose and velocity errors give the desired wrench, the feet move around their nominal stance
+ * and the previous forces are the last solution. The active sets of the QP solutions are collected into
+ * the table, which is written to --out and loaded by MainController from balance_controller/lookup_table.
+ *
+ * The report runs new motions with the table cut to K regions per mask (the table still learns, as at
+ * runtime) and prints memory, hit rate and the times of lookup, QP and BalanceController::update().
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "legged_robot_controller/balance_controller.h"
+#include "legged_robot_controller/quadruped_robot.h"
+
+#define N_EPISODE_TICKS 500     // ticks of one motion, 1 ms each
+
+using namespace quadruped_robot;
+
+
+static double uniform(double a, double b)
+{
+  return a + (b - a) * std::rand() / RAND_MAX;
+}
+
+static Vector3d uniform(const Vector3d& amplitude)
+{
+  return Vector3d(uniform(-1, 1), uniform(-1, 1), uniform(-1, 1)).cwiseProduct(amplitude);
+}
+
+// sinusoidal errors and foot motion of one stance mask
+struct Episode
+{
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  int mask;
+  double w;
+  Vector3d p_err, v_err, r_err, w_err, phase;
+  std::array<Vector3d, 4> p_foot;
+};
+
+static void randomEpisode(int mask, Episode& e)
+{
+  e.mask = mask;
+  e.w = uniform(2, 20);
+  e.p_err = uniform(Vector3d(0.05, 0.05, 0.03));
+  e.v_err = uniform(Vector3d(0.3, 0.3, 0.1));
+  e.r_err = uniform(Vector3d(0.1, 0.1, 0.1));
+  e.w_err = uniform(Vector3d(0.5, 0.5, 0.5));
+  e.phase = uniform(Vector3d(M_PI, M_PI, M_PI));
+
+  // lf, rf, lh, rh hips of HyQ
+  for (int i=0; i<4; i++)
+    e.p_foot[i] = Vector3d((i < 2) ? 0.37 : -0.37, (i % 2 == 0) ? 0.21 : -0.21, 0.0) + uniform(Vector3d(0.1, 0.05, 0.0));
+}
+
+static void initRobot(QuadrupedRobot& robot)
+{
+  robot._m_body = 83.282;
+  robot._mu_foot = 0.6;
+  robot._I_com_body = Eigen::Matrix3d::Zero();
+  robot._I_com_body.diagonal() << 1.5725937, 8.5015928, 9.1954911;
+  robot.setController(4, controllers::BalancingQP);
+
+  robot._pose_com_d._pos = Vector3d(0.0, 0.0, 0.6);
+  robot._pose_body_d._rot_quat.setIdentity();
+  robot._pose_vel_com_d._linear.setZero();
+  robot._pose_vel_body_d._angular.setZero();
+}
+
+static void updateRobot(QuadrupedRobot& robot, const Episode& e, int tick, const std::array<Vector3d, 4>& F_world)
+{
+  double t = 0.001*tick;
+  Vector3d s(std::sin(e.w*t + e.phase(0)), std::sin(e.w*t + e.phase(1)), std::sin(e.w*t + e.phase(2)));
+  Vector3d c(std::cos(e.w*t + e.phase(0)), std::cos(e.w*t + e.phase(1)), std::cos(e.w*t + e.phase(2)));
+
+  robot._pose_com._pos = robot._pose_com_d._pos + e.p_err.cwiseProduct(s);
+  robot._pose_vel_com._linear = e.v_err.cwiseProduct(c);
+  Vector3d r = e.r_err.cwiseProduct(s);
+  robot._pose_body._rot_quat = AngleAxisd(r.norm(), (r.norm() > 0) ? r.normalized() : Vector3d::UnitZ());
+  robot._pose_vel_body._angular = e.w_err.cwiseProduct(c);
+
+  for (int i=0; i<4; i++)
+  {
+    robot._p_world2leg[i] = e.p_foot[i] + 0.05*s(0)*Vector3d::UnitX();
+    robot._contact_states[i] = (e.mask >> i) & 1;
+    robot._F_world2leg_prev[i] = F_world[i];
+  }
+}
+
+static double elapsed(const std::chrono::steady_clock::time_point& t_start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+}
+
+struct Report
+{
+  Report() : ticks(0), hits(0), t_lookup_hit(0), t_lookup_miss(0), t_qp(0), t_update(0) {}
+
+  long ticks, hits;
+  double t_lookup_hit, t_lookup_miss, t_qp, t_update;   // sec, summed
+};
+
+// episodes of random stance masks through the controller
+static void run(BalanceController& controller, int n_ticks, unsigned int seed, Report& report)
+{
+  QuadrupedRobot robot;
+  initRobot(robot);
+
+  std::srand(seed);
+  std::array<Vector3d, 4> F_leg;
+  BalanceLookup::VectorF F;
+  Episode e;
+
+  for (int tick=0; tick<n_ticks; tick++)
+  {
+    if (tick % N_EPISODE_TICKS == 0)
+    {
+      randomEpisode(1 + std::rand() % 15, e);
+      for (int i=0; i<4; i++)
+        robot._F_world2leg[i] = Vector3d(0, 0, robot._m_body*GRAVITY_CONSTANT / 4);
+    }
+    updateRobot(robot, e, tick % N_EPISODE_TICKS, robot._F_world2leg);
+
+    // table as update() sees it, the lookup is timed again on it
+    BalanceLookup lookup = controller._lookup;
+    long hits = lookup.getStatistics().hits;
+
+    std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+    controller.update(robot, F_leg);
+    report.t_update += elapsed(t_start);
+    report.ticks++;
+
+    for (size_t l=0; l<controller._legs.size(); l++)
+      robot._F_world2leg[controller._legs[l]] = controller._F.segment<3>(3*l);
+
+    bool hit = controller._use_lookup && controller._lookup.getStatistics().hits > hits;
+    if (!hit)
+      report.t_qp += controller._qp_solver->getStatistics().solve_time;
+    if (!controller._use_lookup)
+      continue;
+
+    t_start = std::chrono::steady_clock::now();
+    lookup.solve(e.mask, controller._H, controller._g, controller._C_blocks,
+                 controller._lb, controller._ub, controller._ubC, F);
+    double t_lookup = elapsed(t_start);
+
+    if (hit)
+    {
+      report.hits++;
+      report.t_lookup_hit += t_lookup;
+    }
+    else
+    {
+      report.t_lookup_miss += t_lookup;
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  std::string out_file = "balance_lookup.txt";
+  int n_ticks = 100000;
+  unsigned int seed = 1;
+
+  for (int i=1; i<argc; i++)
+  {
+    if (std::strncmp(argv[i], "--out=", 6) == 0)
+      out_file = argv[i] + 6;
+    else if (std::strncmp(argv[i], "--ticks=", 8) == 0)
+      n_ticks = std::atoi(argv[i] + 8);
+    else if (std::strncmp(argv[i], "--seed=", 7) == 0)
+      seed = std::atoi(argv[i] + 7);
+    else
+    {
+      std::fprintf(stderr, "usage: %s [--out=balance_lookup.txt] [--ticks=N] [--seed=S]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  // table
+  BalanceController trainer;
+  trainer.init();
+  trainer._use_lookup = true;
+  trainer._lookup.setMaxRegions(32);
+  Report training;
+  run(trainer, n_ticks, seed, training);
+
+  if (!trainer._lookup.save(out_file))
+  {
+    std::fprintf(stderr, "Failed to write %s\n", out_file.c_str());
+    return 1;
+  }
+  std::printf("%d regions of %ld ticks written to %s, %.1f %% hits while learning\n\n",
+              trainer._lookup.size(), training.ticks, out_file.c_str(), 100.0*training.hits/training.ticks);
+
+  // online QP only
+  BalanceController online;
+  online.init();
+  Report qp;
+  run(online, n_ticks, seed + 1, qp);
+
+  std::printf("regions/mask  memory[B]  stored   hits[%%]  lookup hit[ns]  lookup miss[ns]  QP[us]  update[us]\n");
+  std::printf("%12s  %9d  %6d  %8s  %14s  %15s  %6.2f  %10.2f\n", "QP only", 0, 0, "-", "-", "-",
+              1e6*qp.t_qp/qp.ticks, 1e6*qp.t_update/qp.ticks);
+
+  const int max_regions[] = {1, 2, 4, 8, 16, 32};
+  for (size_t k=0; k<sizeof(max_regions)/sizeof(int); k++)
+  {
+    BalanceController controller;
+    controller.init();
+    controller._lookup.setMaxRegions(max_regions[k]);
+    if (!controller.loadLookupTable(out_file))
+      return 1;
+    int stored = controller._lookup.size();
+
+    Report r;
+    run(controller, n_ticks, seed + 1, r);
+    long misses = r.ticks - r.hits;
+
+    std::printf("%12d  %9zu  %6d  %8.1f  %14.0f  %15.0f  %6.2f  %10.2f\n",
+                max_regions[k], controller._lookup.memory(), stored, 100.0*r.hits/r.ticks,
+                r.hits ? 1e9*r.t_lookup_hit/r.hits : 0.0, misses ? 1e9*r.t_lookup_miss/misses : 0.0,
+                misses ? 1e6*r.t_qp/misses : 0.0, 1e6*r.t_update/r.ticks);
+  }
+
+  return 0;
+}
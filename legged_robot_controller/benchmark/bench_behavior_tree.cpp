@@ -0,0 +1,85 @@
+/*
+  Author: Modulabs
+  File Name: bench_behavior_tree.cpp
+*/
+
+#include <sstream>
+
+#include <benchmark/benchmark.h>
+
+#include "legged_robot_controller/behavior_tree.h"
+
+using namespace behavior_tree;
+
+
+// Selector of sequences, every sequence is a failing condition followed by actions,
+// so that the whole tree is visited on each tick (worst case).
+static std::string makeTree(int n_branch, int n_action)
+{
+  std::ostringstream text;
+
+  text << "selector\n";
+  for (int i=0; i<n_branch; i++)
+  {
+    text << "  sequence\n";
+    text << "    inverter\n";
+    text << "      condition is_false\n";
+    for (int j=0; j<n_action; j++)
+      text << "    action count\n";
+    text << "    condition is_false\n";
+  }
+
+  return text.str();
+}
+
+static void BM_BehaviorTreeTick(benchmark::State& state)
+{
+  int count = 0;
+  BehaviorTree tree;
+  tree.registerLeaf("is_false", []() { return Failure; });
+  tree.registerLeaf("count", [&count]() { count++; return Success; });
+
+  if (!tree.loadString(makeTree(state.range(0), 4)))
+  {
+    state.SkipWithError(tree.getError().c_str());
+    return;
+  }
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(tree.tick());
+  }
+
+  benchmark::DoNotOptimize(count);
+  state.counters["nodes"] = tree.size();
+  state.SetComplexityN(tree.size());
+}
+BENCHMARK(BM_BehaviorTreeTick)->RangeMultiplier(2)->Range(1, 16)->Arg(31)->Complexity(benchmark::oN);
+
+// Motion planner tree shipped in config/, standing branch
+static void BM_MotionPlannerTree(benchmark::State& state)
+{
+  BehaviorTree tree;
+  bool standing = true;
+  const char* names[] = {"is_falling", "is_moving", "is_gait_start"};
+  for (size_t i=0; i<3; i++)
+    tree.registerLeaf(names[i], []() { return Failure; });
+  tree.registerLeaf("is_standing", [&standing]() { return standing ? Success : Failure; });
+  const char* actions[] = {"update_falling", "start_standing", "update_standing", "start_moving", "update_moving"};
+  for (size_t i=0; i<5; i++)
+    tree.registerLeaf(actions[i], []() { return Success; });
+
+  if (!tree.loadFile(LEGGED_ROBOT_CONTROLLER_CONFIG "/motion_planner.tree"))
+  {
+    state.SkipWithError(tree.getError().c_str());
+    return;
+  }
+
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(tree.tick());
+  }
+}
+BENCHMARK(BM_MotionPlannerTree);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,267 @@
+/*
+  Author: Modulabs
+  File Name: legged_robot_benchmarks.cpp
+*/
+
+/* Benchmarks of the control stack on robot states
+ *
+ *   rosrun xacro xacro --inorder `rospack find legged_robot_description`/urdf/hyq/hyq.urdf.xacro > /tmp/hyq.urdf
+ *   rosrun legged_robot_controller legged_robot_benchmarks --urdf=/tmp/hyq.urdf [--states=states.txt]
+ *
+ * Result is printed as JSON unless --benchmark_format is given, --benchmark_out=<file> writes it to a file.
+ * Without --urdf, benchmarks of the robot model are skipped.
+ *
+ * State file is described in robot_states.h. Without --states, a trotting motion around the standing
+ * posture of HyQ is synthesized.
+*/
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "legged_robot_controller/balance_controller.h"
+#include "legged_robot_controller/mpc_controller.h"
+#include "legged_robot_controller/quadruped_robot.h"
+#include "legged_robot_math/bezier.h"
+#include "legged_robot_math/math_func.h"
+#include "legged_robot_math/min_jerk.h"
+#include "robot_states.h"
+
+static std::string urdf_file;
+static RobotStates states;
+
+
+// n_stance legs from lf are in contact
+static void updateRobot(quadruped_robot::QuadrupedRobot& robot, const RobotState& s, int n_stance)
+{
+  std::array<int, 4> contact_states;
+  for (int i=0; i<4; i++)
+    contact_states[i] = (i < n_stance) ? 1 : 0;
+
+  robot.updateSensorData(s._q_leg, s._qdot_leg, s._pose_body, s._pose_vel_body, contact_states);
+  robot.calKinematicsDynamics();
+  for (int i=0; i<4; i++)
+    robot._p_world2leg_d[i] = robot._p_world2leg[i];
+}
+
+static void BM_CalKinematicsDynamics(benchmark::State& state)
+{
+  quadruped_robot::QuadrupedRobot robot;
+  if (!initRobot(robot, urdf_file))
+  {
+    state.SkipWithError("robot model is not loaded, give --urdf");
+    return;
+  }
+
+  size_t k = 0;
+  for (auto _ : state)
+  {
+    const RobotState& s = states[k];
+    robot.updateSensorData(s._q_leg, s._qdot_leg, s._pose_body, s._pose_vel_body, s._contact_states);
+    robot.calKinematicsDynamics();
+    benchmark::DoNotOptimize(robot._p_world2leg);
+    k = (k + 1) % states.size();
+  }
+}
+BENCHMARK(BM_CalKinematicsDynamics);
+
+// args: number of stance legs, QP backend
+static void BM_BalanceController(benchmark::State& state)
+{
+  int n_stance = state.range(0);
+  qp_solver::backends::Backend backend = static_cast<qp_solver::backends::Backend>(state.range(1));
+  state.SetLabel(qp_solver::backends::BackendToString(backend));
+
+  quadruped_robot::QuadrupedRobot robot;
+  if (!initRobot(robot, urdf_file))
+  {
+    state.SkipWithError("robot model is not loaded, give --urdf");
+    return;
+  }
+  robot.setController(4, quadruped_robot::controllers::BalancingQP);
+
+  BalanceController balance_controller;
+  balance_controller.init(backend);
+  std::array<Vector3d, 4> F_leg;
+
+  size_t k = 0;
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    updateRobot(robot, states[k], n_stance);
+    k = (k + 1) % states.size();
+    state.ResumeTiming();
+
+    balance_controller.update(robot, F_leg);
+    benchmark::DoNotOptimize(F_leg);
+  }
+}
+static void BalanceArgs(benchmark::internal::Benchmark* b)
+{
+  for (int backend = qp_solver::backends::QPOASES; backend <= qp_solver::backends::ADMM_SINGLE; backend++)
+    for (int n_stance = 1; n_stance <= 4; n_stance++)
+      b->Args({n_stance, backend});
+}
+BENCHMARK(BM_BalanceController)->Apply(BalanceArgs)->Unit(benchmark::kMicrosecond);
+
+// args: horizon, number of stance legs, QP backend
+static void BM_MPCController(benchmark::State& state)
+{
+  int n_step = state.range(0);
+  int n_stance = state.range(1);
+  qp_solver::backends::Backend backend = static_cast<qp_solver::backends::Backend>(state.range(2));
+  state.SetLabel(qp_solver::backends::BackendToString(backend));
+
+  quadruped_robot::QuadrupedRobot robot;
+  if (!initRobot(robot, urdf_file))
+  {
+    state.SkipWithError("robot model is not loaded, give --urdf");
+    return;
+  }
+  robot.setController(4, quadruped_robot::controllers::BalancingMPC);
+
+  MPCController mpc_controller;
+  mpc_controller.init(backend);
+  mpc_controller._n_step = n_step;
+  std::array<Vector3d, 4> F_leg;
+
+  size_t k = 0;
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    updateRobot(robot, states[k], n_stance);
+    k = (k + 1) % states.size();
+    state.ResumeTiming();
+
+    mpc_controller.setControlData(robot);
+    mpc_controller.calControlInput();
+    mpc_controller.getControlInput(robot, F_leg);
+    benchmark::DoNotOptimize(F_leg);
+  }
+}
+static void MPCArgs(benchmark::internal::Benchmark* b)
+{
+  for (int backend = qp_solver::backends::QPOASES; backend <= qp_solver::backends::ADMM_SINGLE; backend++)
+  {
+    b->Args({1, 4, backend})->Args({3, 4, backend})->Args({6, 4, backend})->Args({10, 4, backend});
+    b->Args({3, 2, backend})->Args({6, 2, backend})->Args({10, 2, backend});
+  }
+}
+BENCHMARK(BM_MPCController)->Apply(MPCArgs)->Unit(benchmark::kMicrosecond);
+
+// swing trajectory of MainController, four legs
+static void BM_SwingBezier(benchmark::State& state)
+{
+  trajectory::Bezier<3, 4> swing_traj;
+  std::array<Vector3d, 4> pnts;
+  pnts[0] = Vector3d(-0.3, 0, -0.5);
+  pnts[1] = Vector3d(-0.3, 0, -0.3);
+  pnts[2] = Vector3d(0.3, 0, -0.3);
+  pnts[3] = Vector3d(0.3, 0, -0.5);
+  swing_traj.setPoints(pnts);
+
+  Eigen::Matrix<double, 1, 4> s(0.0, 0.25, 0.5, 0.75);
+  Eigen::Matrix<double, 3, 4> p, p_dot, p_ddot;
+  for (auto _ : state)
+  {
+    swing_traj.getPoints(s, p, p_dot, p_ddot);
+    benchmark::DoNotOptimize(p);
+    benchmark::DoNotOptimize(p_dot);
+    benchmark::DoNotOptimize(p_ddot);
+    s.array() += 1e-3;
+    s = s.unaryExpr([](double x) { return x < 1.0 ? x : x - 1.0; });
+  }
+}
+BENCHMARK(BM_SwingBezier);
+
+// all joints
+static void BM_MinJerkJoints(benchmark::State& state)
+{
+  typedef trajectory::MinJerkBatch<12>::VectorNd Vector12d;
+
+  trajectory::MinJerkBatch<12> traj;
+  Vector12d q_start, q_end;
+  for (int i=0; i<4; i++)
+  {
+    q_start.segment<3>(3*i) = states[0]._q_leg[i];
+    q_end.segment<3>(3*i) = states[states.size()/2]._q_leg[i];
+  }
+  traj.setTrajInput(0.0, q_start, q_end, 2.0);
+
+  Vector12d q, q_dot, q_ddot;
+  double t = 0;
+  for (auto _ : state)
+  {
+    traj.getTrajOutput(t, q, q_dot, q_ddot);
+    benchmark::DoNotOptimize(q);
+    benchmark::DoNotOptimize(q_dot);
+    benchmark::DoNotOptimize(q_ddot);
+    t = (t < 2.0) ? t + 1e-3 : 0.0;
+  }
+}
+BENCHMARK(BM_MinJerkJoints);
+
+// orientation error of recorded states to upright
+static void BM_LogR(benchmark::State& state)
+{
+  size_t k = 0;
+  for (auto _ : state)
+  {
+    const Matrix3d R = states[k]._pose_body._rot_quat.toRotationMatrix();
+    benchmark::DoNotOptimize(logR(R.transpose()));
+    k = (k + 1) % states.size();
+  }
+}
+BENCHMARK(BM_LogR);
+
+
+int main(int argc, char** argv)
+{
+  // our arguments are removed before benchmark reads the rest
+  std::string states_file;
+  std::vector<char*> args;
+  bool has_format = false;
+  for (int i=0; i<argc; i++)
+  {
+    if (std::strncmp(argv[i], "--urdf=", 7) == 0)
+      urdf_file = argv[i] + 7;
+    else if (std::strncmp(argv[i], "--states=", 9) == 0)
+      states_file = argv[i] + 9;
+    else
+    {
+      if (std::strncmp(argv[i], "--benchmark_format=", 19) == 0)
+        has_format = true;
+      args.push_back(argv[i]);
+    }
+  }
+
+  char json_format[] = "--benchmark_format=json";
+  if (!has_format)
+    args.push_back(json_format);
+
+  if (!states_file.empty())
+  {
+    if (!loadStates(states_file, states))
+    {
+      std::fprintf(stderr, "Failed to load states from %s\n", states_file.c_str());
+      return 1;
+    }
+  }
+  else
+  {
+    synthesizeStates(N_SYNTHESIZED_STATE, states);
+  }
+
+  int n_arg = args.size();
+  benchmark::Initialize(&n_arg, args.data());
+  if (benchmark::ReportUnrecognizedArguments(n_arg, args.data()))
+    return 1;
+
+  benchmark::RunSpecifiedBenchmarks();
+
+  return 0;
+}
@@ -0,0 +1,249 @@
+/*
+  Author: Modulabs
+  File Name: mpc_blocking_bench.cpp
+*/
+
+/* Tracking and time of the MPC over input parameterisations (mpc_inputs)
+ *
+ *   rosrun legged_robot_controller mpc_blocking_bench [--horizon=30] [--duration=5] [--backend=ADMM] [--trot]
+ *
+ * The MPC runs in closed loop on a single rigid body with the mass and inertia of HyQ, standing on four
+ * feet (or on diagonal pairs switched every 0.3 s with --trot) and following a CoM sway of 5 cm and 3 cm
+ * in height at 0.5 Hz from 3 cm below it. The body is integrated at 1 ms, the MPC runs every sampling
+ * time of its model. Per scheme the RMS position and orientation errors and the mean and maximum time of
+ * setControlData() and calControlInput() are printed. Schemes are the default horizon and, over --horizon
+ * steps, an input per step, move blocks of equal and of doubling length and linear interpolation.
+ *
+ * The MPC keeps the contacts of the current tick over the horizon, with --trot the prediction is wrong
+ * after the next switch. The backend is ADMM by default, the cold starts of qpOASES on these problems
+ * often need more than QPOASES_MAX_NWSR working set changes and the failed QPs are counted.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "legged_robot_controller/mpc_controller.h"
+#include "legged_robot_controller/quadruped_robot.h"
+#include "legged_robot_math/so3.h"
+
+#define SIM_DT 0.001
+#define TROT_PERIOD 0.3
+
+using namespace quadruped_robot;
+
+
+struct Scheme
+{
+  std::string name;
+  int n_step;
+  mpc_inputs::Parameterisation parameterisation;
+  int n_input;
+  std::vector<int> move_blocks;
+};
+
+struct Result
+{
+  int n_variables;
+  int n_failed;         // QPs not solved
+  double rms_position, rms_orientation;
+  double t_mean, t_max;
+};
+
+static double elapsed(const std::chrono::steady_clock::time_point& t_start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+}
+
+static void initBody(QuadrupedRobot& robot)
+{
+  robot._m_body = 83.282;
+  robot._mu_foot = 0.6;
+  robot._I_com_body = Eigen::Matrix3d::Zero();
+  robot._I_com_body.diagonal() << 1.5725937, 8.5015928, 9.1954911;
+  robot.setController(4, controllers::BalancingMPC);
+
+  const double x[4] = { 0.37, 0.37, -0.37, -0.37 };
+  const double y[4] = { 0.33, -0.33, 0.33, -0.33 };
+  for (int i=0; i<4; i++)
+  {
+    robot._p_world2leg[i] = Vector3d(x[i], y[i], 0.0);
+    robot._p_world2leg_d[i] = robot._p_world2leg[i];
+  }
+
+  robot._pose_com._pos = Vector3d(0.0, 0.0, 0.52);
+  robot._pose_vel_com._linear.setZero();
+  robot._pose_body._rot_quat.setIdentity();
+  robot._pose_vel_body._angular.setZero();
+  robot._pose_body_d._rot_quat.setIdentity();
+  robot._pose_vel_body_d._angular.setZero();
+}
+
+static void setReference(QuadrupedRobot& robot, double t)
+{
+  const double w = 2 * M_PI * 0.5;
+  robot._pose_com_d._pos = Vector3d(0.05 * std::sin(w * t), 0.05 * std::cos(w * t) - 0.05, 0.55 + 0.03 * std::sin(w * t));
+  robot._pose_vel_com_d._linear = Vector3d(0.05 * w * std::cos(w * t), -0.05 * w * std::sin(w * t), 0.03 * w * std::cos(w * t));
+}
+
+static void setContacts(QuadrupedRobot& robot, double t, bool trot)
+{
+  int pair = (int)(t / TROT_PERIOD) % 2;
+  for (int i=0; i<4; i++)
+    robot._contact_states[i] = (!trot || (i == 0 || i == 3) == (pair == 0)) ? 1 : 0;
+}
+
+// rigid body under the contact forces F (world frame, on the body) and gravity
+static void integrate(QuadrupedRobot& robot, const std::array<Vector3d, 4>& F, double dt)
+{
+  Vector3d force(0.0, 0.0, -robot._m_body * Gravity), torque = Vector3d::Zero();
+  for (int i=0; i<4; i++)
+  {
+    if (robot._contact_states[i] == 0)
+      continue;
+    force += F[i];
+    torque += (robot._p_world2leg[i] - robot._pose_com._pos).cross(F[i]);
+  }
+
+  const Eigen::Matrix3d R = robot._pose_body._rot_quat.toRotationMatrix();
+  const Eigen::Matrix3d I_world = R * robot._I_com_body * R.transpose();
+  Vector3d& w = robot._pose_vel_body._angular;
+  Vector3d w_dot = I_world.inverse() * (torque - w.cross(I_world * w));
+
+  robot._pose_vel_com._linear += force / robot._m_body * dt;
+  robot._pose_com._pos += robot._pose_vel_com._linear * dt;
+  w += w_dot * dt;
+  robot._pose_body._rot_quat = (so3::expQ(w * dt) * robot._pose_body._rot_quat).normalized();
+}
+
+static Result run(const Scheme& scheme, qp_solver::backends::Backend backend, double duration, bool trot)
+{
+  QuadrupedRobot robot;
+  initBody(robot);
+
+  MPCController mpc;
+  mpc.init(backend);
+  mpc._n_step = scheme.n_step;
+  mpc.setInputParameterisation(scheme.parameterisation, scheme.n_input, scheme.move_blocks);
+
+  Result result = { 0, 0, 0.0, 0.0, 0.0, 0.0 };
+  std::array<Vector3d, 4> F;
+  F.fill(Vector3d::Zero());
+
+  const int n_sim = (int)std::lround(duration / SIM_DT);
+  const int control_interval = (int)std::lround(SamplingTime / SIM_DT);
+  int n_control = 0;
+
+  for (int k=0; k<n_sim; k++)
+  {
+    double t = k * SIM_DT;
+    setReference(robot, t);
+
+    if (k % control_interval == 0)
+    {
+      setContacts(robot, t, trot);
+
+      std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+      mpc.setControlData(robot);
+      mpc.calControlInput();
+      double t_control = elapsed(t_start);
+
+      result.t_mean += t_control;
+      result.t_max = std::max(result.t_max, t_control);
+      result.n_variables = mpc._qp.n;
+      result.n_failed += !mpc._qp_solver->getStatistics().solved;
+      n_control++;
+
+      for (int i=0; i<4; i++)
+        F[i] = mpc._F[i];
+    }
+
+    integrate(robot, F, SIM_DT);
+
+    result.rms_position += (robot._pose_com_d._pos - robot._pose_com._pos).squaredNorm();
+    result.rms_orientation += so3::logError(robot._pose_body_d._rot_quat, robot._pose_body._rot_quat).squaredNorm();
+  }
+
+  result.rms_position = std::sqrt(result.rms_position / n_sim);
+  result.rms_orientation = std::sqrt(result.rms_orientation / n_sim);
+  result.t_mean /= n_control;
+
+  return result;
+}
+
+int main(int argc, char** argv)
+{
+  int horizon = 30;
+  double duration = 5.0;
+  bool trot = false;
+  qp_solver::backends::Backend backend = qp_solver::backends::ADMM;
+
+  for (int i=1; i<argc; i++)
+  {
+    if (std::strncmp(argv[i], "--horizon=", 10) == 0)
+      horizon = std::max(std::atoi(argv[i] + 10), 2);
+    else if (std::strncmp(argv[i], "--duration=", 11) == 0)
+      duration = std::max(std::atof(argv[i] + 11), 0.1);
+    else if (std::strncmp(argv[i], "--backend=", 10) == 0 && qp_solver::backends::BackendFromString(argv[i] + 10, backend))
+      continue;
+    else if (std::strcmp(argv[i], "--trot") == 0)
+      trot = true;
+    else
+    {
+      std::fprintf(stderr, "usage: %s [--horizon=N] [--duration=s] [--backend=qpOASES|ADMM|ADMM_single] [--trot]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  // 1, 2, 4, .. steps per block, the last one takes the rest
+  std::vector<int> doubling;
+  for (int steps = 1, n = 0; n < horizon; steps *= 2)
+  {
+    doubling.push_back(std::min(steps, horizon - n));
+    n += doubling.back();
+  }
+  if (doubling.size() > 1 && doubling.back() < doubling[doubling.size() - 2])
+  {
+    doubling[doubling.size() - 2] += doubling.back();
+    doubling.pop_back();
+  }
+
+  char name[64];
+  std::vector<Scheme> schemes;
+  std::snprintf(name, sizeof(name), "full %d", MPC_Step);
+  schemes.push_back(Scheme{ name, MPC_Step, mpc_inputs::FULL, MPC_Step, std::vector<int>() });
+  std::snprintf(name, sizeof(name), "full %d", horizon);
+  schemes.push_back(Scheme{ name, horizon, mpc_inputs::FULL, horizon, std::vector<int>() });
+  for (int n_input = 2; n_input <= 4; n_input += 2)
+  {
+    std::snprintf(name, sizeof(name), "blocking %d x %d", n_input, horizon / n_input);
+    schemes.push_back(Scheme{ name, horizon, mpc_inputs::BLOCKING, n_input, std::vector<int>() });
+  }
+  std::snprintf(name, sizeof(name), "blocking doubling (%d)", (int)doubling.size());
+  schemes.push_back(Scheme{ name, horizon, mpc_inputs::BLOCKING, (int)doubling.size(), doubling });
+  for (int n_input = 2; n_input <= 4; n_input += 2)
+  {
+    std::snprintf(name, sizeof(name), "linear %d knots", n_input);
+    schemes.push_back(Scheme{ name, horizon, mpc_inputs::LINEAR, n_input, std::vector<int>() });
+  }
+
+  std::printf("%s, %s, %.1f s, horizon %d steps of %.3f s\n", qp_solver::backends::BackendToString(backend),
+              trot ? "trot" : "stand", duration, horizon, SamplingTime);
+  std::printf("%-24s %6s %6s %14s %18s %10s %10s %7s\n", "scheme", "steps", "vars", "position [mm]",
+              "orientation [mrad]", "mean [us]", "max [us]", "failed");
+
+  for (size_t s=0; s<schemes.size(); s++)
+  {
+    Result result = run(schemes[s], backend, duration, trot);
+    std::printf("%-24s %6d %6d %14.2f %18.2f %10.1f %10.1f %7d\n", schemes[s].name.c_str(), schemes[s].n_step,
+                result.n_variables, 1e3 * result.rms_position, 1e3 * result.rms_orientation,
+                1e6 * result.t_mean, 1e6 * result.t_max, result.n_failed);
+  }
+
+  return 0;
+}
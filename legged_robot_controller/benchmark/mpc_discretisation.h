@@ -0,0 +1,117 @@
+/*
+  Author: Modulabs
+  File Name: mpc_discretisation.h
+*/
+
+#pragma once
+
+/* Reference discretisation of the MPC model, for mpc_discretisation_check and test_mpc_discretisation
+ *
+ * Random models are drawn with std::rand, seed it for reproducible cases. The reference is the zero-order
+ * hold of the continuous model integrated by RK4 over the sampling time.
+*/
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+
+#include "legged_robot_controller/mpc_controller.h"
+#include "legged_robot_math/so3.h"
+
+#define RK4_STEPS 100
+#define DISCRETISATION_ERROR_MAX 1e-12
+
+
+struct Model
+{
+  Eigen::Matrix3d Rz, I_hat;
+  double m;
+  LegContactState contacts;
+  std::array<Eigen::Vector3d, 4> r;    // p_leg - p_com
+  std::array<Eigen::Matrix3d, 4> R_leg;
+};
+
+inline double uniform(double min, double max)
+{
+  return min + (max - min) * std::rand() / RAND_MAX;
+}
+
+inline void randomModel(Model& model)
+{
+  model.Rz = Eigen::AngleAxisd(uniform(-M_PI, M_PI), Eigen::Vector3d::UnitZ()).toRotationMatrix();
+
+  Eigen::Matrix3d R = so3::exp(Eigen::Vector3d(uniform(-1, 1), uniform(-1, 1), uniform(-1, 1)));
+  Eigen::Vector3d I_diag(uniform(0.5, 5.0), uniform(0.5, 5.0), uniform(0.5, 5.0));
+  model.I_hat = R * I_diag.asDiagonal() * R.transpose();
+  model.m = uniform(20.0, 100.0);
+
+  do
+  {
+    model.contacts.ContactTotalNum = 0;
+    for (int i=0; i<4; i++)
+    {
+      model.contacts.LegState[i] = std::rand() % 4 != 0;
+      model.contacts.ContactTotalNum += model.contacts.LegState[i];
+    }
+  } while (model.contacts.ContactTotalNum == 0);
+
+  const Eigen::Matrix3d I_hat_inv = model.I_hat.inverse();
+  for (int i=0; i<4; i++)
+  {
+    model.r[i] = Eigen::Vector3d(uniform(-0.5, 0.5), uniform(-0.4, 0.4), uniform(-0.7, -0.3));
+    model.R_leg[i] = so3::mulHat(I_hat_inv, model.r[i]);
+  }
+}
+
+// x_dot = A_c x + B_c u integrated over the sampling time, X_dot = [A_c B_c; 0 0] X from X(0) = I
+inline void reference(const Model& model, Eigen::MatrixXd& A_d, Eigen::MatrixXd& B_d)
+{
+  int n_u = 3 * model.contacts.ContactTotalNum;
+  Eigen::MatrixXd M = Eigen::MatrixXd::Zero(15 + n_u, 15 + n_u);
+  M.block<3, 3>(0, 6) = model.Rz;
+  M.block<3, 3>(3, 9).setIdentity();
+  M.block<3, 3>(9, 12) = -Eigen::Matrix3d::Identity();
+
+  int num = 0;
+  for (int i=0; i<4; i++)
+  {
+    if (!model.contacts.LegState[i])
+      continue;
+    M.block<3, 3>(6, 15 + num) = model.I_hat.inverse() * so3::hat(model.r[i]);
+    M.block<3, 3>(9, 15 + num) = Eigen::Matrix3d::Identity() / model.m;
+    num += 3;
+  }
+
+  double h = SamplingTime / RK4_STEPS;
+  Eigen::MatrixXd X = Eigen::MatrixXd::Identity(15 + n_u, 15 + n_u);
+  for (int k=0; k<RK4_STEPS; k++)
+  {
+    Eigen::MatrixXd k1 = M * X;
+    Eigen::MatrixXd k2 = M * (X + 0.5*h*k1);
+    Eigen::MatrixXd k3 = M * (X + 0.5*h*k2);
+    Eigen::MatrixXd k4 = M * (X + h*k3);
+    X += h/6.0 * (k1 + 2*k2 + 2*k3 + k4);
+  }
+
+  A_d = X.block(0, 0, 15, 15);
+  B_d = X.block(0, 15, 15, n_u);
+}
+
+inline void setModel(MPCController& mpc, const Model& model)
+{
+  mpc._m_body = model.m;
+  mpc._LegContactState = model.contacts;
+  mpc._Rz = model.Rz;
+  mpc._Rz_d = model.Rz;
+  mpc._R_leg = model.R_leg;
+  mpc._R_leg_d = model.R_leg;
+  mpc._A_d = Eigen::MatrixXd::Zero(15, 15);
+  mpc._B_d = Eigen::MatrixXd::Zero(15, 3 * model.contacts.ContactTotalNum);
+  mpc._B_d_d = Eigen::MatrixXd::Zero(15, 3 * model.contacts.ContactTotalNum);
+}
+
+// largest entry of the difference relative to the largest entry of the reference
+inline double relativeError(const Eigen::MatrixXd& A, const Eigen::MatrixXd& A_ref)
+{
+  return (A - A_ref).cwiseAbs().maxCoeff() / A_ref.cwiseAbs().maxCoeff();
+}
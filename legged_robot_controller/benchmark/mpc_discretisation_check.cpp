@@ -0,0 +1,180 @@
+/*
+  Author: Modulabs
+  File Name: mpc_discretisation_check.cpp
+*/
+
+/* Discretisation of the MPC model against a reference, and its time
+ *
+ *   rosrun legged_robot_controller mpc_discretisation_check [--cases=1000] [--runs=100000] [--seed=1]
+ *
+ * A_d and B_d of MPCController (cal_A_d, cal_B_d) are compared with the zero-order hold of the continuous
+ * model integrated by RK4 (mpc_discretisation.h), on random yaw, inertia, mass, leg positions and contact
+ * sets. The error is the largest entry of the difference relative to the largest entry of the reference,
+ * the tool fails above 1e-12 as test_mpc_discretisation does. The previous kernel, Euler rows with the
+ * 1/2 T^2 terms lost to integer division, is printed for comparison.
+ *
+ * Times are per tick with four stance legs, A_d and both B_d and B_d_d, minimum of 10 rounds of --runs.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "mpc_discretisation.h"
+
+
+// kernel before the exact hold, dynamic size members as in MPCController
+struct PreviousKernel
+{
+  Eigen::MatrixXd Rz, I3x3;
+  std::array<Eigen::MatrixXd, 4> R_leg;
+  double m;
+  LegContactState contacts;
+
+  void set(const Model& model)
+  {
+    Rz = model.Rz;
+    I3x3 = Eigen::MatrixXd::Identity(3, 3);
+    for (int i=0; i<4; i++)
+      R_leg[i] = model.R_leg[i];
+    m = model.m;
+    contacts = model.contacts;
+  }
+
+  void cal_A_d(Eigen::MatrixXd& A_d) const
+  {
+    const double T = SamplingTime;
+    A_d = Eigen::MatrixXd::Identity(15, 15);
+    A_d.block<3, 3>(0, 6) = Rz * T;
+    A_d.block<3, 3>(3, 9) = I3x3 * T;
+    A_d.block<3, 3>(3, 12) = I3x3 * (-1 / 2 * T * T);
+    A_d.block<3, 3>(9, 12) = I3x3 * (-T);
+  }
+
+  void cal_B_d(Eigen::MatrixXd& B_d) const
+  {
+    const double T = SamplingTime;
+    int num = 0;
+    for (int i=0; i<4; i++)
+    {
+      if (!contacts.LegState[i])
+        continue;
+
+      const Eigen::MatrixXd& R = R_leg[i];
+      for (int r=0; r<3; r++)
+        for (int c=0; c<3; c++)
+          B_d(r, num + c) = 1 / 2 * (R(0, c) * T * T * Rz(r, 0) + R(1, c) * T * T * Rz(r, 1) + R(2, c) * T * T * Rz(r, 2));
+
+      B_d.block<3, 3>(3, num) = I3x3 * (T * T / (2 * m));
+      B_d.block<3, 3>(6, num) = R * T;
+      B_d.block<3, 3>(9, num) = I3x3 * (T / m);
+      num += 3;
+    }
+  }
+};
+
+static double elapsed(const std::chrono::steady_clock::time_point& t_start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+}
+
+int main(int argc, char** argv)
+{
+  int n_cases = 1000;
+  int n_runs = 100000;
+  unsigned int seed = 1;
+
+  for (int i=1; i<argc; i++)
+  {
+    if (std::strncmp(argv[i], "--cases=", 8) == 0)
+      n_cases = std::max(std::atoi(argv[i] + 8), 1);
+    else if (std::strncmp(argv[i], "--runs=", 7) == 0)
+      n_runs = std::max(std::atoi(argv[i] + 7), 1);
+    else if (std::strncmp(argv[i], "--seed=", 7) == 0)
+      seed = std::atoi(argv[i] + 7);
+    else
+    {
+      std::fprintf(stderr, "usage: %s [--cases=N] [--runs=N] [--seed=N]\n", argv[0]);
+      return 1;
+    }
+  }
+  std::srand(seed);
+
+  MPCController mpc;
+  mpc.init();
+  PreviousKernel previous;
+
+  // accuracy
+  double error_A = 0.0, error_B = 0.0, error_B_d = 0.0;
+  double error_A_previous = 0.0, error_B_previous = 0.0;
+  Model model;
+  Eigen::MatrixXd A_ref, B_ref, A_previous, B_previous;
+
+  for (int k=0; k<n_cases; k++)
+  {
+    randomModel(model);
+    reference(model, A_ref, B_ref);
+
+    setModel(mpc, model);
+    mpc.cal_A_d();
+    mpc.cal_B_d(model.Rz, model.R_leg, mpc._B_d);
+    mpc.cal_B_d(mpc._Rz_d, mpc._R_leg_d, mpc._B_d_d);
+
+    previous.set(model);
+    B_previous = Eigen::MatrixXd::Zero(15, B_ref.cols());
+    previous.cal_A_d(A_previous);
+    previous.cal_B_d(B_previous);
+
+    error_A = std::max(error_A, relativeError(mpc._A_d, A_ref));
+    error_B = std::max(error_B, relativeError(mpc._B_d, B_ref));
+    error_B_d = std::max(error_B_d, relativeError(mpc._B_d_d, B_ref));
+    error_A_previous = std::max(error_A_previous, relativeError(A_previous, A_ref));
+    error_B_previous = std::max(error_B_previous, relativeError(B_previous, B_ref));
+  }
+
+  std::printf("%d cases, relative error to RK4 reference\n", n_cases);
+  std::printf("  A_d %9.2e  B_d %9.2e  B_d_d %9.2e\n", error_A, error_B, error_B_d);
+  std::printf("  previous kernel: A_d %9.2e  B_d %9.2e\n", error_A_previous, error_B_previous);
+
+  // time, four stance legs
+  randomModel(model);
+  model.contacts.ContactTotalNum = 4;
+  for (int i=0; i<4; i++)
+    model.contacts.LegState[i] = true;
+  setModel(mpc, model);
+  previous.set(model);
+  B_previous = Eigen::MatrixXd::Zero(15, 12);
+  Eigen::MatrixXd B_d_previous = B_previous;
+
+  double t_kernel = 1e9, t_previous = 1e9;
+  for (int round=0; round<10; round++)
+  {
+    std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+    for (int k=0; k<n_runs; k++)
+    {
+      mpc.cal_A_d();
+      mpc.cal_B_d(model.Rz, mpc._R_leg, mpc._B_d);
+      mpc.cal_B_d(model.Rz, mpc._R_leg_d, mpc._B_d_d);
+    }
+    t_kernel = std::min(t_kernel, elapsed(t_start));
+
+    t_start = std::chrono::steady_clock::now();
+    for (int k=0; k<n_runs; k++)
+    {
+      previous.cal_A_d(A_previous);
+      previous.cal_B_d(B_previous);
+      previous.cal_B_d(B_d_previous);
+    }
+    t_previous = std::min(t_previous, elapsed(t_start));
+  }
+  std::printf("time per tick: %.1f ns, previous kernel %.1f ns (%.2fx)\n",
+              1e9 * t_kernel / n_runs, 1e9 * t_previous / n_runs, t_previous / t_kernel);
+
+  bool ok = error_A < DISCRETISATION_ERROR_MAX && error_B < DISCRETISATION_ERROR_MAX && error_B_d < DISCRETISATION_ERROR_MAX;
+  std::printf("%s\n", ok ? "PASSED" : "FAILED");
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,277 @@
+/*
+  Author: Modulabs
+  File Name: precision_check.cpp
+*/
+
+/* Accuracy of a QP backend against a reference on robot states
+ *
+ *   rosrun legged_robot_controller precision_check --urdf=/tmp/hyq.urdf [--states=states.txt] [--backend=ADMM_single]
+ *          [--save=forces.txt | --reference=forces.txt | --reference_backend=ADMM]
+ *
+ * Balance and MPC controller run on every state with the state's contacts, leg forces and joint torques
+ * tau = Jv'F are compared with the reference. The reference is another backend of this build or a file
+ * saved by a double build, e.g. for qpOASES built with QPOASES_SINGLE_PRECISION:
+ *
+ *   precision_check --urdf=/tmp/hyq.urdf --save=forces_double.txt                 (double build)
+ *   precision_check --urdf=/tmp/hyq.urdf --reference=forces_double.txt            (single build)
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "legged_robot_controller/balance_controller.h"
+#include "legged_robot_controller/mpc_controller.h"
+#include "legged_robot_controller/quadruped_robot.h"
+#include "robot_states.h"
+
+#define N_OUTPUT 48     // per tick: F and tau of balance, F and tau of MPC, 4 legs each
+
+using namespace quadruped_robot;
+
+typedef std::vector<double> Output;
+
+
+// balance and MPC controller with their own robot on one backend
+struct ControlPath
+{
+  ControlPath() : ok(false) {}
+
+  bool init(const std::string& urdf_file, qp_solver::backends::Backend backend)
+  {
+    ok = initRobot(robot_balance, urdf_file) && initRobot(robot_mpc, urdf_file);
+    robot_balance.setController(4, controllers::BalancingQP);
+    robot_mpc.setController(4, controllers::BalancingMPC);
+    balance_controller.init(backend);
+    mpc_controller.init(backend);
+    return ok;
+  }
+
+  void update(const RobotState& s, Output& out)
+  {
+    out.assign(N_OUTPUT, 0.0);
+
+    update(robot_balance, s);
+    F_leg.fill(Vector3d::Zero());
+    balance_controller.update(robot_balance, F_leg);
+    write(robot_balance, &out[0]);
+
+    update(robot_mpc, s);
+    F_leg.fill(Vector3d::Zero());
+    mpc_controller.setControlData(robot_mpc);
+    mpc_controller.calControlInput();
+    mpc_controller.getControlInput(robot_mpc, F_leg);
+    write(robot_mpc, &out[24]);
+  }
+
+  void update(QuadrupedRobot& robot, const RobotState& s)
+  {
+    robot.updateSensorData(s._q_leg, s._qdot_leg, s._pose_body, s._pose_vel_body, s._contact_states);
+    robot.calKinematicsDynamics();
+    for (int i=0; i<4; i++)
+      robot._p_world2leg_d[i] = robot._p_world2leg[i];
+  }
+
+  void write(const QuadrupedRobot& robot, double* out)
+  {
+    for (int i=0; i<4; i++)
+    {
+      Vector3d tau = robot._Jv_leg[i].transpose() * F_leg[i];
+      for (int j=0; j<3; j++)
+      {
+        out[3*i + j] = F_leg[i](j);
+        out[12 + 3*i + j] = tau(j);
+      }
+    }
+  }
+
+  bool ok;
+  QuadrupedRobot robot_balance, robot_mpc;
+  BalanceController balance_controller;
+  MPCController mpc_controller;
+  std::array<Vector3d, 4> F_leg;
+};
+
+// deviation of 12 values (4 legs x 3)
+struct Deviation
+{
+  Deviation() : max_abs(0), sum_sq(0), max_ref(0), n(0) {}
+
+  void add(const double* x, const double* ref)
+  {
+    for (int i=0; i<12; i++)
+    {
+      double d = std::abs(x[i] - ref[i]);
+      max_abs = std::max(max_abs, d);
+      max_ref = std::max(max_ref, std::abs(ref[i]));
+      sum_sq += d*d;
+      n++;
+    }
+  }
+
+  void print(const char* name) const
+  {
+    std::printf("%-16s  %12.3e  %12.3e  %12.3e  %12.3e\n", name, max_abs, n ? std::sqrt(sum_sq/n) : 0.0,
+                max_ref, max_ref > 0 ? max_abs/max_ref : 0.0);
+  }
+
+  double max_abs, sum_sq, max_ref;
+  long n;
+};
+
+
+int main(int argc, char** argv)
+{
+  std::string urdf_file, states_file, save_file, reference_file;
+  std::string backend_name = "qpOASES", reference_backend_name;
+
+  for (int i=1; i<argc; i++)
+  {
+    if (std::strncmp(argv[i], "--urdf=", 7) == 0)
+      urdf_file = argv[i] + 7;
+    else if (std::strncmp(argv[i], "--states=", 9) == 0)
+      states_file = argv[i] + 9;
+    else if (std::strncmp(argv[i], "--backend=", 10) == 0)
+      backend_name = argv[i] + 10;
+    else if (std::strncmp(argv[i], "--save=", 7) == 0)
+      save_file = argv[i] + 7;
+    else if (std::strncmp(argv[i], "--reference=", 12) == 0)
+      reference_file = argv[i] + 12;
+    else if (std::strncmp(argv[i], "--reference_backend=", 20) == 0)
+      reference_backend_name = argv[i] + 20;
+    else
+    {
+      std::fprintf(stderr, "usage: %s --urdf=<file> [--states=<file>] [--backend=<name>] "
+                   "[--save=<file> | --reference=<file> | --reference_backend=<name>]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  if (save_file.empty() && reference_file.empty() && reference_backend_name.empty())
+  {
+    std::fprintf(stderr, "Give --save, --reference or --reference_backend\n");
+    return 1;
+  }
+
+  qp_solver::backends::Backend backend, reference_backend;
+  if (!qp_solver::backends::BackendFromString(backend_name, backend) ||
+      (!reference_backend_name.empty() && !qp_solver::backends::BackendFromString(reference_backend_name, reference_backend)))
+  {
+    std::fprintf(stderr, "Unknown QP backend\n");
+    return 1;
+  }
+
+  RobotStates states;
+  if (!states_file.empty())
+  {
+    if (!loadStates(states_file, states))
+    {
+      std::fprintf(stderr, "Failed to load states from %s\n", states_file.c_str());
+      return 1;
+    }
+  }
+  else
+  {
+    synthesizeStates(N_SYNTHESIZED_STATE, states);
+  }
+
+  ControlPath path, reference_path;
+  if (!path.init(urdf_file, backend) ||
+      (!reference_backend_name.empty() && !reference_path.init(urdf_file, reference_backend)))
+  {
+    std::fprintf(stderr, "Robot model is not loaded, give --urdf\n");
+    return 1;
+  }
+
+  std::ofstream save;
+  std::ifstream reference;
+  if (!save_file.empty())
+  {
+    save.open(save_file.c_str());
+    save << "# precision_check, " << backend_name << ", sizeof(qpOASES::real_t) " << sizeof(qpOASES::real_t) << std::endl;
+    save << "# balance F[12] tau[12], mpc F[12] tau[12]" << std::endl;
+    save.precision(17);
+  }
+  if (!reference_file.empty())
+  {
+    reference.open(reference_file.c_str());
+    if (!reference.is_open())
+    {
+      std::fprintf(stderr, "Failed to open %s\n", reference_file.c_str());
+      return 1;
+    }
+  }
+
+  Output out, ref;
+  Deviation F_balance, tau_balance, F_mpc, tau_mpc;
+
+  for (size_t k=0; k<states.size(); k++)
+  {
+    path.update(states[k], out);
+
+    if (save.is_open())
+    {
+      for (int i=0; i<N_OUTPUT; i++)
+        save << out[i] << ((i+1 < N_OUTPUT) ? " " : "\n");
+      continue;
+    }
+
+    if (reference.is_open())
+    {
+      std::string line;
+      do
+      {
+        if (!std::getline(reference, line))
+        {
+          std::fprintf(stderr, "%s has less ticks than the states\n", reference_file.c_str());
+          return 1;
+        }
+        line = line.substr(0, line.find('#'));
+      } while (line.find_first_not_of(" \t\r") == std::string::npos);
+
+      std::istringstream values(line);
+      ref.resize(N_OUTPUT);
+      for (int i=0; i<N_OUTPUT; i++)
+        values >> ref[i];
+      if (values.fail())
+      {
+        std::fprintf(stderr, "Bad line in %s\n", reference_file.c_str());
+        return 1;
+      }
+    }
+    else if (reference_path.ok)
+    {
+      reference_path.update(states[k], ref);
+    }
+    else
+    {
+      continue;
+    }
+
+    F_balance.add(&out[0], &ref[0]);
+    tau_balance.add(&out[12], &ref[12]);
+    F_mpc.add(&out[24], &ref[24]);
+    tau_mpc.add(&out[36], &ref[36]);
+  }
+
+  if (save.is_open())
+  {
+    std::printf("%zu ticks of %s written to %s\n", states.size(), backend_name.c_str(), save_file.c_str());
+    return save.good() ? 0 : 1;
+  }
+
+  std::printf("%zu ticks, %s (sizeof(qpOASES::real_t) %zu) against %s\n", states.size(), backend_name.c_str(),
+              sizeof(qpOASES::real_t), reference_file.empty() ? reference_backend_name.c_str() : reference_file.c_str());
+  std::printf("%-16s  %12s  %12s  %12s  %12s\n", "", "max dev", "rms dev", "max ref", "max rel dev");
+  F_balance.print("balance F [N]");
+  tau_balance.print("balance tau [Nm]");
+  F_mpc.print("mpc F [N]");
+  tau_mpc.print("mpc tau [Nm]");
+
+  return 0;
+}
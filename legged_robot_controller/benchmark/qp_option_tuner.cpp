@@ -0,0 +1,451 @@
+/*
+  Author: Modulabs
+  File Name: qp_option_tuner.cpp
+*/
+
+/* Offline search of the qpOASES options for the balance and MPC QPs
+ *
+ *   rosrun legged_robot_controller qp_option_tuner --urdf=/tmp/hyq.urdf [--states=states.txt] [--kkt_tol=1e-6]
+ *          [--repeat=3] [--balance_out=balance_qp_options.txt] [--mpc_out=mpc_qp_options.txt]
+ *
+ * The controllers run on the states with qpOASES and their QPs are recorded. Each controller's corpus is
+ * replayed in order, warm started as at runtime, with the qpOASES presets and then coordinate steps over
+ * single options from the best one. A candidate is accepted if all QPs are solved with a KKT violation
+ * (SolutionAnalysis::getKktViolation) below --kkt_tol, the accepted one with the lowest p99 solve time
+ * is written as the profile that MainController loads from balance_controller/qp_options and
+ * mpc_controller/qp_options. Times are the minimum of --repeat replays of each QP, a step has to beat the
+ * best by TUNER_MIN_GAIN in TUNER_ROUNDS paired timings.
+ *
+ * The KKT violation is absolute, on these QPs the float build of qpOASES reaches about 1e-2 to 1e-1.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "legged_robot_controller/balance_controller.h"
+#include "legged_robot_controller/mpc_controller.h"
+#include "legged_robot_controller/quadruped_robot.h"
+#include "robot_states.h"
+
+#define TUNER_MAX_PASSES 3      // coordinate passes over all options
+#define TUNER_MIN_GAIN 0.03     // relative p99 gain a step needs, below it is timing noise
+#define TUNER_ROUNDS 3          // paired timings of the best and a candidate
+
+using namespace quadruped_robot;
+
+
+// owned copy of a qp_solver::Problem
+struct StoredProblem
+{
+  void store(const qp_solver::Problem& qp)
+  {
+    int n_C = qp.numConstraints();
+
+    n = qp.n;
+    n_blocks = qp.n_blocks;
+    block_rows = qp.block_rows;
+    block_cols = qp.block_cols;
+
+    H.assign(qp.H, qp.H + n*n);
+    g.assign(qp.g, qp.g + n);
+    copy(qp.lb, n, lb);
+    copy(qp.ub, n, ub);
+    copy(qp.C_blocks, n_C*block_cols, C_blocks);
+    copy(qp.lbC, n_C, lbC);
+    copy(qp.ubC, n_C, ubC);
+  }
+
+  static void copy(const double* v, int size, std::vector<double>& buffer)
+  {
+    if (v)
+      buffer.assign(v, v + size);
+    else
+      buffer.clear();
+  }
+
+  static const double* data(const std::vector<double>& buffer)
+  {
+    return buffer.empty() ? NULL : buffer.data();
+  }
+
+  // H is copied to H_work, qpOASES may regularize it in place
+  void problem(std::vector<double>& H_work, qp_solver::Problem& qp) const
+  {
+    H_work = H;
+
+    qp.n = n;
+    qp.H = H_work.data();
+    qp.g = g.data();
+    qp.lb = data(lb);
+    qp.ub = data(ub);
+    qp.n_blocks = n_blocks;
+    qp.block_rows = block_rows;
+    qp.block_cols = block_cols;
+    qp.C_blocks = data(C_blocks);
+    qp.lbC = data(lbC);
+    qp.ubC = data(ubC);
+  }
+
+  int n, n_blocks, block_rows, block_cols;
+  std::vector<double> H, g, lb, ub, C_blocks, lbC, ubC;
+};
+
+typedef std::vector<StoredProblem> Corpus;
+
+// qpOASES with default options, recording each problem it solves
+class RecordingSolver : public qp_solver::Solver
+{
+public:
+  RecordingSolver(Corpus& corpus) : _corpus(corpus) {}
+
+  qp_solver::backends::Backend getBackend() const { return qp_solver::backends::QPOASES; }
+
+  bool solve(const qp_solver::Problem& qp)
+  {
+    _corpus.push_back(StoredProblem());
+    _corpus.back().store(qp);
+
+    bool solved = _solver.solve(qp);
+    _x = _solver.getSolution();
+    _statistics = _solver.getStatistics();
+    return solved;
+  }
+
+  void reset() { _solver.reset(); }
+
+private:
+  Corpus& _corpus;
+  qp_solver::QPOASESSolver _solver;
+};
+
+static void updateRobot(QuadrupedRobot& robot, const RobotState& s)
+{
+  robot.updateSensorData(s._q_leg, s._qdot_leg, s._pose_body, s._pose_vel_body, s._contact_states);
+  robot.calKinematicsDynamics();
+  for (int i=0; i<4; i++)
+    robot._p_world2leg_d[i] = robot._p_world2leg[i];
+}
+
+static bool record(const std::string& urdf_file, const RobotStates& states, Corpus& balance_corpus, Corpus& mpc_corpus)
+{
+  QuadrupedRobot robot_balance, robot_mpc;
+  if (!initRobot(robot_balance, urdf_file) || !initRobot(robot_mpc, urdf_file))
+    return false;
+  robot_balance.setController(4, controllers::BalancingQP);
+  robot_mpc.setController(4, controllers::BalancingMPC);
+
+  BalanceController balance_controller;
+  MPCController mpc_controller;
+  balance_controller.init();
+  mpc_controller.init();
+  balance_controller._qp_solver.reset(new RecordingSolver(balance_corpus));
+  mpc_controller._qp_solver.reset(new RecordingSolver(mpc_corpus));
+
+  std::array<Vector3d, 4> F_leg;
+  for (size_t k=0; k<states.size(); k++)
+  {
+    updateRobot(robot_balance, states[k]);
+    balance_controller.update(robot_balance, F_leg);
+
+    updateRobot(robot_mpc, states[k]);
+    mpc_controller.setControlData(robot_mpc);
+    mpc_controller.calControlInput();
+    mpc_controller.getControlInput(robot_mpc, F_leg);
+  }
+
+  return true;
+}
+
+
+struct Result
+{
+  Result() : p50(0), p99(0), max_kkt(0), failed(0) {}
+
+  double p50, p99;        // sec
+  double max_kkt;
+  int failed;
+};
+
+static double percentile(std::vector<double> t, double p)
+{
+  if (t.empty())
+    return 0.0;
+  std::sort(t.begin(), t.end());
+  size_t k = (size_t)std::ceil(p * t.size());
+  return t[std::min(std::max(k, (size_t)1), t.size()) - 1];
+}
+
+static Result evaluate(const Corpus& corpus, const qpOASES::Options& options, int repeat)
+{
+  std::vector<double> t(corpus.size(), 1e30);
+  std::vector<double> H_work;
+  qp_solver::Problem qp;
+  Result r;
+
+  for (int k=0; k<repeat; k++)
+  {
+    qp_solver::QPOASESSolver solver;
+    solver.setOptions(options);
+    solver.setKktCheck(true);
+
+    for (size_t i=0; i<corpus.size(); i++)
+    {
+      corpus[i].problem(H_work, qp);
+      bool solved = solver.solve(qp);
+      const qp_solver::Statistics& statistics = solver.getStatistics();
+
+      t[i] = std::min(t[i], statistics.solve_time);
+      if (k > 0)
+        continue;
+
+      if (!solved)
+        r.failed++;
+      else if (!(statistics.kkt_violation <= r.max_kkt))
+        r.max_kkt = statistics.kkt_violation;
+    }
+  }
+
+  r.p50 = percentile(t, 0.5);
+  r.p99 = percentile(t, 0.99);
+  return r;
+}
+
+// one option and the values it is tried with
+struct Dimension
+{
+  std::string name;
+  std::vector<double> values;
+  std::function<double(const qpOASES::Options&)> get;
+  std::function<void(qpOASES::Options&, double)> set;
+};
+
+static std::vector<Dimension> dimensions()
+{
+  using qpOASES::Options;
+  using qpOASES::EPS;
+
+  std::vector<Dimension> d;
+
+  const char* bools[] = {"enableRamping", "enableFarBounds", "enableFlippingBounds", "enableRegularisation",
+                         "enableFullLITests", "enableNZCTests"};
+  qpOASES::BooleanType Options::* bool_fields[] = {&Options::enableRamping, &Options::enableFarBounds,
+                                                   &Options::enableFlippingBounds, &Options::enableRegularisation,
+                                                   &Options::enableFullLITests, &Options::enableNZCTests};
+  for (int i=0; i<6; i++)
+  {
+    qpOASES::BooleanType Options::* field = bool_fields[i];
+    d.push_back(Dimension{bools[i], {0, 1},
+                          [field](const Options& o) { return (o.*field == qpOASES::BT_TRUE) ? 1.0 : 0.0; },
+                          [field](Options& o, double v) { o.*field = v ? qpOASES::BT_TRUE : qpOASES::BT_FALSE; }});
+  }
+
+  d.push_back(Dimension{"enableDriftCorrection", {0, 1},
+                        [](const Options& o) { return (double)o.enableDriftCorrection; },
+                        [](Options& o, double v) { o.enableDriftCorrection = (int)v; }});
+  d.push_back(Dimension{"enableCholeskyRefactorisation", {0, 1},
+                        [](const Options& o) { return (double)o.enableCholeskyRefactorisation; },
+                        [](Options& o, double v) { o.enableCholeskyRefactorisation = (int)v; }});
+  d.push_back(Dimension{"numRefinementSteps", {0, 1, 2},
+                        [](const Options& o) { return (double)o.numRefinementSteps; },
+                        [](Options& o, double v) { o.numRefinementSteps = (int)v; }});
+  d.push_back(Dimension{"numRegularisationSteps", {0, 1, 2},
+                        [](const Options& o) { return (double)o.numRegularisationSteps; },
+                        [](Options& o, double v) { o.numRegularisationSteps = (int)v; }});
+  d.push_back(Dimension{"initialStatusBounds", {qpOASES::ST_LOWER, qpOASES::ST_INACTIVE},
+                        [](const Options& o) { return (double)o.initialStatusBounds; },
+                        [](Options& o, double v) { o.initialStatusBounds = (qpOASES::SubjectToStatus)(int)v; }});
+
+  // tolerances in multiples of the machine precision, the same grid serves both precisions
+  d.push_back(Dimension{"terminationTolerance", {1e3*EPS, 1e4*EPS, 1e5*EPS, 5e6*EPS, 1e7*EPS},
+                        [](const Options& o) { return (double)o.terminationTolerance; },
+                        [](Options& o, double v) { o.terminationTolerance = v; }});
+  d.push_back(Dimension{"boundTolerance", {1e4*EPS, 1e6*EPS, 1e8*EPS},
+                        [](const Options& o) { return (double)o.boundTolerance; },
+                        [](Options& o, double v) { o.boundTolerance = v; }});
+
+  return d;
+}
+
+static bool accepted(const Result& r, double kkt_tol)
+{
+  return r.failed == 0 && r.max_kkt <= kkt_tol;
+}
+
+static void print(const std::string& candidate, const Result& r, double kkt_tol)
+{
+  std::printf("  %-40s  %8.2f  %8.2f  %10.2e  %6d  %s\n", candidate.c_str(), 1e6*r.p50, 1e6*r.p99, r.max_kkt, r.failed,
+              accepted(r, kkt_tol) ? "" : "rejected");
+}
+
+static bool tune(const std::string& name, const Corpus& corpus, double kkt_tol, int repeat, const std::string& out_file)
+{
+  std::printf("%s: %zu QPs\n", name.c_str(), corpus.size());
+  std::printf("  %-40s  %8s  %8s  %10s  %6s\n", "candidate", "p50[us]", "p99[us]", "max KKT", "failed");
+
+  // presets
+  const char* presets[] = {"default", "reliable", "MPC", "fast"};
+  qpOASES::Options best;
+  Result best_result;
+  std::string best_name;
+  bool found = false;
+
+  for (int i=0; i<4; i++)
+  {
+    qpOASES::Options options;
+    if (i == 1)
+      options.setToReliable();
+    else if (i == 2)
+      options.setToMPC();
+    else if (i == 3)
+      options.setToFast();
+
+    Result r = evaluate(corpus, options, repeat);
+    print(std::string("preset ") + presets[i], r, kkt_tol);
+
+    if (accepted(r, kkt_tol) && (!found || r.p99 < best_result.p99))
+    {
+      best = options;
+      best_result = r;
+      best_name = std::string("preset ") + presets[i];
+      found = true;
+    }
+  }
+
+  if (!found)
+  {
+    std::printf("  no preset meets the KKT tolerance %.1e, %s is not written\n\n", kkt_tol, out_file.c_str());
+    return false;
+  }
+
+  // coordinate steps from the best preset
+  std::vector<Dimension> dims = dimensions();
+  std::vector<std::string> steps;
+
+  for (int pass=0; pass<TUNER_MAX_PASSES; pass++)
+  {
+    bool improved = false;
+
+    for (size_t i=0; i<dims.size(); i++)
+    {
+      for (size_t j=0; j<dims[i].values.size(); j++)
+      {
+        if (dims[i].get(best) == (double)(qpOASES::real_t)dims[i].values[j])
+          continue;
+
+        qpOASES::Options options = best;
+        dims[i].set(options, dims[i].values[j]);
+        options.ensureConsistency();
+
+        std::ostringstream candidate;
+        candidate << dims[i].name << " " << dims[i].values[j];
+
+        // the best is timed again next to the candidate as the machine drifts over the search,
+        // a gain has to show up in all rounds
+        Result r;
+        bool faster = true;
+        for (int k=0; k<TUNER_ROUNDS && faster; k++)
+        {
+          Result r_best = evaluate(corpus, best, repeat);
+          r = evaluate(corpus, options, repeat);
+          if (k == 0)
+            print(candidate.str(), r, kkt_tol);
+          faster = accepted(r, kkt_tol) && r.p99 < (1.0 - TUNER_MIN_GAIN) * r_best.p99;
+        }
+
+        if (faster)
+        {
+          best = options;
+          best_result = r;
+          steps.push_back(candidate.str());
+          improved = true;
+        }
+      }
+    }
+
+    if (!improved)
+      break;
+  }
+
+  std::ostringstream comment;
+  comment << name << ", " << best_name;
+  for (size_t i=0; i<steps.size(); i++)
+    comment << ", " << steps[i];
+  comment << "; p99 " << 1e6*best_result.p99 << " us, max KKT violation " << best_result.max_kkt
+          << " over " << corpus.size() << " QPs";
+
+  std::printf("  best: %s\n", comment.str().c_str());
+  if (!qp_solver::saveOptions(out_file, best, comment.str()))
+  {
+    std::fprintf(stderr, "Failed to write %s\n", out_file.c_str());
+    return false;
+  }
+  std::printf("  written to %s\n\n", out_file.c_str());
+
+  return true;
+}
+
+
+int main(int argc, char** argv)
+{
+  std::string urdf_file, states_file;
+  std::string balance_out = "balance_qp_options.txt", mpc_out = "mpc_qp_options.txt";
+  double kkt_tol = 1e-6;
+  int repeat = 3;
+
+  for (int i=1; i<argc; i++)
+  {
+    if (std::strncmp(argv[i], "--urdf=", 7) == 0)
+      urdf_file = argv[i] + 7;
+    else if (std::strncmp(argv[i], "--states=", 9) == 0)
+      states_file = argv[i] + 9;
+    else if (std::strncmp(argv[i], "--kkt_tol=", 10) == 0)
+      kkt_tol = std::atof(argv[i] + 10);
+    else if (std::strncmp(argv[i], "--repeat=", 9) == 0)
+      repeat = std::max(std::atoi(argv[i] + 9), 1);
+    else if (std::strncmp(argv[i], "--balance_out=", 14) == 0)
+      balance_out = argv[i] + 14;
+    else if (std::strncmp(argv[i], "--mpc_out=", 10) == 0)
+      mpc_out = argv[i] + 10;
+    else
+    {
+      std::fprintf(stderr, "usage: %s --urdf=<file> [--states=<file>] [--kkt_tol=1e-6] [--repeat=3] "
+                   "[--balance_out=<file>] [--mpc_out=<file>]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  RobotStates states;
+  if (!states_file.empty())
+  {
+    if (!loadStates(states_file, states))
+    {
+      std::fprintf(stderr, "Failed to load states from %s\n", states_file.c_str());
+      return 1;
+    }
+  }
+  else
+  {
+    synthesizeStates(N_SYNTHESIZED_STATE, states);
+  }
+
+  Corpus balance_corpus, mpc_corpus;
+  if (!record(urdf_file, states, balance_corpus, mpc_corpus))
+  {
+    std::fprintf(stderr, "Robot model is not loaded, give --urdf\n");
+    return 1;
+  }
+
+  std::printf("%zu ticks, sizeof(qpOASES::real_t) %zu, KKT tolerance %.1e\n\n", states.size(), sizeof(qpOASES::real_t), kkt_tol);
+
+  bool ok = tune("balance", balance_corpus, kkt_tol, repeat, balance_out);
+  ok = tune("mpc", mpc_corpus, kkt_tol, repeat, mpc_out) && ok;
+
+  return ok ? 0 : 1;
+}
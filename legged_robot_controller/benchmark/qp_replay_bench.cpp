@@ -0,0 +1,365 @@
+/*
+  Author: Modulabs
+  File Name: qp_replay_bench.cpp
+*/
+
+/* Replay of QPs dumped by the controllers (qp_dumper.h)
+ *
+ *   rosrun legged_robot_controller qp_replay_bench --dir=/tmp/qp_dump/mpc [--options=mpc_qp_options.txt]
+ *          [--nwsr=100] [--repeat=3] [--equilibrate] [--summary]
+ *
+ * Each OQP problem of the directory is solved cold by QProblem::init() and hot started by an SQProblem
+ * kept over the problems in dump order, a new size starts it cold again. Per problem the working set
+ * changes and times are printed, at the end their distributions. Cold times are the minimum of --repeat
+ * solves. Dumped every n-th tick, consecutive problems are n ticks apart and the hot start is that much
+ * worse than at runtime.
+ *
+ * Options are those of QPOASESSolver, a profile of qp_option_tuner is given by --options.
+ *
+ * --equilibrate solves the problems scaled by qp_solver::Equilibration, the scaling time is added to the
+ * solve times. The dump has no contact sets, the scaling is kept while the problem size stays. The cold
+ * solutions are compared with those of the unscaled problems.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <string>
+#include <vector>
+
+#include "legged_robot_controller/qp_solver.h"
+
+USING_NAMESPACE_QPOASES
+
+
+// one OQP problem, arrays allocated by readOQPdata
+struct OQPProblem
+{
+  OQPProblem() : nV(0), nC(0), H(NULL), g(NULL), A(NULL), lb(NULL), ub(NULL), lbA(NULL), ubA(NULL) {}
+  ~OQPProblem() { clear(); }
+
+  bool load(const std::string& path)
+  {
+    clear();
+    int nQP, nEC;
+    return readOQPdata(path.c_str(), nQP, nV, nC, nEC, &H, &g, &A, &lb, &ub, &lbA, &ubA, NULL, NULL, NULL)
+           == SUCCESSFUL_RETURN;
+  }
+
+  void clear()
+  {
+    delete[] H; delete[] g; delete[] A; delete[] lb; delete[] ub; delete[] lbA; delete[] ubA;
+    H = g = A = lb = ub = lbA = ubA = NULL;
+  }
+
+  int nV, nC;
+  real_t *H, *g, *A, *lb, *ub, *lbA, *ubA;
+
+private:
+  OQPProblem(const OQPProblem&);
+  OQPProblem& operator=(const OQPProblem&);
+};
+
+struct Solve
+{
+  Solve() : solved(false), nWSR(0), time(0) {}
+
+  bool solved;
+  int nWSR;
+  double time;    // sec
+};
+
+static double elapsed(const std::chrono::steady_clock::time_point& t_start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+}
+
+// problem directories of the dump in order
+static bool listProblems(const std::string& directory, std::vector<std::string>& paths)
+{
+  DIR* dir = opendir(directory.c_str());
+  if (!dir)
+    return false;
+
+  for (struct dirent* entry = readdir(dir); entry; entry = readdir(dir))
+  {
+    if (entry->d_name[0] == '.')
+      continue;
+
+    std::string path = directory + "/" + entry->d_name + "/";
+    std::FILE* dims = std::fopen((path + "dims.oqp").c_str(), "r");
+    if (dims)
+    {
+      std::fclose(dims);
+      paths.push_back(path);
+    }
+  }
+  closedir(dir);
+
+  std::sort(paths.begin(), paths.end());
+  return true;
+}
+
+// primal solution into x if given
+static Solve solveCold(const OQPProblem& p, const Options& options, int max_nWSR, std::vector<real_t>& H,
+                       real_t* x = NULL)
+{
+  Solve s;
+
+  // H may be regularized in place
+  H.assign(p.H, p.H + p.nV*p.nV);
+
+  std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+  QProblem qp(p.nV, p.nC);
+  qp.setOptions(options);
+  s.nWSR = max_nWSR;
+  s.solved = (qp.init(H.data(), p.g, p.A, p.lb, p.ub, p.lbA, p.ubA, s.nWSR) == SUCCESSFUL_RETURN);
+  s.time = elapsed(t_start);
+
+  if (x)
+    qp.getPrimalSolution(x);
+
+  return s;
+}
+
+// the OQP problem in double as a qp_solver::Problem, C is one dense block
+struct ProblemData
+{
+  void set(const OQPProblem& p)
+  {
+    H.assign(p.H, p.H + p.nV*p.nV);
+    g.assign(p.g, p.g + p.nV);
+    lb.assign(p.lb, p.lb + p.nV);
+    ub.assign(p.ub, p.ub + p.nV);
+    C.assign(p.A, p.A + p.nC*p.nV);
+    lbC.assign(p.lbA, p.lbA + p.nC);
+    ubC.assign(p.ubA, p.ubA + p.nC);
+
+    qp.n = p.nV;
+    qp.H = H.data();
+    qp.g = g.data();
+    qp.lb = lb.data();
+    qp.ub = ub.data();
+    qp.n_blocks = (p.nC > 0) ? 1 : 0;
+    qp.block_rows = p.nC;
+    qp.block_cols = p.nV;
+    qp.C_blocks = C.data();
+    qp.lbC = lbC.data();
+    qp.ubC = ubC.data();
+  }
+
+  std::vector<double> H, g, lb, ub, C, lbC, ubC;
+  qp_solver::Problem qp;
+};
+
+// problem replaced by its equilibration, returns the time of the scaling
+static double equilibrateProblem(OQPProblem& p, qp_solver::Equilibration& equilibration, ProblemData& data)
+{
+  data.set(p);
+  qp_solver::Problem scaled;
+
+  std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+  equilibration.scale(data.qp, scaled);
+  double t = elapsed(t_start);
+
+  std::copy(scaled.H, scaled.H + p.nV*p.nV, p.H);
+  std::copy(scaled.g, scaled.g + p.nV, p.g);
+  std::copy(scaled.lb, scaled.lb + p.nV, p.lb);
+  std::copy(scaled.ub, scaled.ub + p.nV, p.ub);
+  if (p.nC > 0)
+  {
+    std::copy(scaled.C_blocks, scaled.C_blocks + p.nC*p.nV, p.A);
+    std::copy(scaled.lbC, scaled.lbC + p.nC, p.lbA);
+    std::copy(scaled.ubC, scaled.ubC + p.nC, p.ubA);
+  }
+
+  return t;
+}
+
+struct Distribution
+{
+  Distribution() : failed(0) {}
+
+  void add(const Solve& s)
+  {
+    if (!s.solved)
+    {
+      failed++;
+      return;
+    }
+    nWSR.push_back(s.nWSR);
+    time.push_back(s.time);
+  }
+
+  static double percentile(std::vector<double> v, double p)
+  {
+    if (v.empty())
+      return 0.0;
+    std::sort(v.begin(), v.end());
+    size_t k = (size_t)std::ceil(p * v.size());
+    return v[std::min(std::max(k, (size_t)1), v.size()) - 1];
+  }
+
+  void print(const char* name) const
+  {
+    std::printf("%-6s %7zu %7d   %6.0f %6.0f %6.0f %6.0f   %8.2f %8.2f %8.2f %8.2f\n", name, time.size(), failed,
+                percentile(nWSR, 0.5), percentile(nWSR, 0.9), percentile(nWSR, 0.99), percentile(nWSR, 1.0),
+                1e6*percentile(time, 0.5), 1e6*percentile(time, 0.9), 1e6*percentile(time, 0.99), 1e6*percentile(time, 1.0));
+  }
+
+  std::vector<double> nWSR, time;
+  int failed;
+};
+
+
+int main(int argc, char** argv)
+{
+  std::string directory, options_file;
+  int max_nWSR = QPOASES_MAX_NWSR;
+  int repeat = 3;
+  bool summary = false;
+  bool equilibrate = false;
+
+  for (int i=1; i<argc; i++)
+  {
+    if (std::strncmp(argv[i], "--dir=", 6) == 0)
+      directory = argv[i] + 6;
+    else if (std::strncmp(argv[i], "--options=", 10) == 0)
+      options_file = argv[i] + 10;
+    else if (std::strncmp(argv[i], "--nwsr=", 7) == 0)
+      max_nWSR = std::atoi(argv[i] + 7);
+    else if (std::strncmp(argv[i], "--repeat=", 9) == 0)
+      repeat = std::max(std::atoi(argv[i] + 9), 1);
+    else if (std::strcmp(argv[i], "--summary") == 0)
+      summary = true;
+    else if (std::strcmp(argv[i], "--equilibrate") == 0)
+      equilibrate = true;
+    else
+    {
+      std::fprintf(stderr, "usage: %s --dir=<dump directory> [--options=<file>] [--nwsr=N] [--repeat=N] [--equilibrate] [--summary]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  std::vector<std::string> paths;
+  if (directory.empty() || !listProblems(directory, paths) || paths.empty())
+  {
+    std::fprintf(stderr, "No OQP problems in '%s', give --dir\n", directory.c_str());
+    return 1;
+  }
+
+  Options options = qp_solver::QPOASESSolver().getOptions();
+  if (!options_file.empty() && !qp_solver::loadOptions(options_file, options))
+  {
+    std::fprintf(stderr, "Failed to load options from %s\n", options_file.c_str());
+    return 1;
+  }
+  options.printLevel = PL_NONE;
+
+  // the hot solver refers to the arrays of the last problem, they are swapped in turn
+  OQPProblem problems[2];
+  std::vector<real_t> H_cold, H_hot[2];
+  SQProblem* hot = NULL;
+  Distribution cold_all, hot_all;
+
+  qp_solver::Equilibration equilibration;
+  ProblemData data;
+  std::vector<real_t> x_ref, x_scaled;
+  Eigen::VectorXd x, x_unscaled;
+  double t_scale_sum = 0.0, max_deviation = 0.0;
+
+  if (!summary)
+    std::printf("%-40s %4s %4s  %9s %9s  %9s %9s\n", "problem", "nV", "nC", "cold nWSR", "cold[us]", "hot nWSR", "hot[us]");
+
+  for (size_t k=0; k<paths.size(); k++)
+  {
+    OQPProblem& p = problems[k % 2];
+    if (!p.load(paths[k]))
+    {
+      std::fprintf(stderr, "Failed to read %s\n", paths[k].c_str());
+      delete hot;
+      return 1;
+    }
+
+    // reference solution before the scaling
+    double t_scale = 0.0;
+    if (equilibrate)
+    {
+      x_ref.resize(p.nV);
+      x_scaled.resize(p.nV);
+      bool solved = solveCold(p, options, max_nWSR, H_cold, x_ref.data()).solved;
+
+      t_scale = equilibrateProblem(p, equilibration, data);
+      t_scale_sum += t_scale;
+
+      if (solved && solveCold(p, options, max_nWSR, H_cold, x_scaled.data()).solved)
+      {
+        x = Eigen::Map<const Eigen::Matrix<real_t, Eigen::Dynamic, 1> >(x_scaled.data(), p.nV).cast<double>();
+        equilibration.unscale(x, x_unscaled);
+        for (int i=0; i<p.nV; i++)
+          max_deviation = std::max(max_deviation, std::abs(x_unscaled(i) - x_ref[i]));
+      }
+    }
+
+    // cold, best of repeat
+    Solve cold;
+    for (int r=0; r<repeat; r++)
+    {
+      Solve s = solveCold(p, options, max_nWSR, H_cold);
+      if (r == 0 || s.time < cold.time)
+        cold = s;
+    }
+    cold.time += t_scale;
+    cold_all.add(cold);
+
+    // hot start from the previous problem of the same size
+    std::vector<real_t>& H = H_hot[k % 2];
+    H.assign(p.H, p.H + p.nV*p.nV);
+    Solve warm;
+    bool started = (hot && hot->getNV() == p.nV && hot->getNC() == p.nC && hot->isSolved());
+
+    std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+    if (!started)
+    {
+      delete hot;
+      hot = new SQProblem(p.nV, p.nC);
+      hot->setOptions(options);
+    }
+    warm.nWSR = max_nWSR;
+    if (started)
+      warm.solved = (hot->hotstart(H.data(), p.g, p.A, p.lb, p.ub, p.lbA, p.ubA, warm.nWSR) == SUCCESSFUL_RETURN);
+    else
+      warm.solved = (hot->init(H.data(), p.g, p.A, p.lb, p.ub, p.lbA, p.ubA, warm.nWSR) == SUCCESSFUL_RETURN);
+    warm.time = elapsed(t_start) + t_scale;
+
+    if (started)
+      hot_all.add(warm);
+
+    if (!summary)
+    {
+      std::printf("%-40s %4d %4d  %9d %9.2f  ", paths[k].c_str(), p.nV, p.nC, cold.solved ? cold.nWSR : -1, 1e6*cold.time);
+      if (started)
+        std::printf("%9d %9.2f\n", warm.solved ? warm.nWSR : -1, 1e6*warm.time);
+      else
+        std::printf("%9s %9s\n", "-", "-");
+    }
+  }
+  delete hot;
+
+  std::printf("\n%zu problems of %s, failed solves have nWSR -1\n", paths.size(), directory.c_str());
+  std::printf("%-6s %7s %7s   %6s %6s %6s %6s   %8s %8s %8s %8s\n", "", "solved", "failed",
+              "nWSR50", "nWSR90", "nWSR99", "max", "p50[us]", "p90[us]", "p99[us]", "max[us]");
+  cold_all.print("cold");
+  hot_all.print("hot");
+
+  if (equilibrate)
+    std::printf("\nequilibrated, %d scalings computed, %.2f us per problem to scale, "
+                "max deviation from the unscaled solution %.3e\n",
+                equilibration.getComputations(), 1e6*t_scale_sum/paths.size(), max_deviation);
+
+  return 0;
+}
@@ -0,0 +1,129 @@
+/*
+  Author: Modulabs
+  File Name: robot_states.h
+*/
+
+#pragma once
+
+/* Robot states of the benchmarks and the model they run on
+ *
+ * State file has one tick per line, '#' starts a comment, leg order is lf, rf, lh, rh
+ *   q[12] qdot[12] p_body[3] quat_body(w x y z)[4] v_body[3] w_body[3] contact[4]
+ * Without a file, a trotting motion around the standing posture of HyQ is synthesized.
+*/
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <kdl_parser/kdl_parser.hpp>
+
+#include "legged_robot_controller/quadruped_robot.h"
+#include "legged_robot_math/math_func.h"
+
+#define N_SYNTHESIZED_STATE 1000
+
+struct RobotState
+{
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  std::array<Eigen::Vector3d, 4> _q_leg, _qdot_leg;
+  Pose _pose_body;
+  PoseVel _pose_vel_body;
+  std::array<int, 4> _contact_states;
+};
+
+typedef std::vector<RobotState, Eigen::aligned_allocator<RobotState> > RobotStates;
+
+inline bool loadStates(const std::string& file_name, RobotStates& states)
+{
+  std::ifstream file(file_name.c_str());
+  if (!file.is_open())
+    return false;
+
+  std::string line;
+  while (std::getline(file, line))
+  {
+    line = line.substr(0, line.find('#'));
+    if (line.find_first_not_of(" \t\r") == std::string::npos)
+      continue;
+
+    std::istringstream values(line);
+    RobotState s;
+    double qw, qx, qy, qz;
+
+    for (int i=0; i<4; i++)
+      values >> s._q_leg[i](0) >> s._q_leg[i](1) >> s._q_leg[i](2);
+    for (int i=0; i<4; i++)
+      values >> s._qdot_leg[i](0) >> s._qdot_leg[i](1) >> s._qdot_leg[i](2);
+    values >> s._pose_body._pos(0) >> s._pose_body._pos(1) >> s._pose_body._pos(2);
+    values >> qw >> qx >> qy >> qz;
+    values >> s._pose_vel_body._linear(0) >> s._pose_vel_body._linear(1) >> s._pose_vel_body._linear(2);
+    values >> s._pose_vel_body._angular(0) >> s._pose_vel_body._angular(1) >> s._pose_vel_body._angular(2);
+    for (int i=0; i<4; i++)
+      values >> s._contact_states[i];
+
+    if (values.fail())
+      return false;
+
+    s._pose_body._rot_quat = Quaterniond(qw, qx, qy, qz).normalized();
+    states.push_back(s);
+  }
+
+  return !states.empty();
+}
+
+// trotting at 1/0.6 Hz around the standing posture, 1 ms per state
+inline void synthesizeStates(int n_state, RobotStates& states)
+{
+  const double T = 0.6, w = 2*M_PI/T;
+  const double phase[4] = {0, M_PI, M_PI, 0};
+
+  for (int k=0; k<n_state; k++)
+  {
+    double t = 0.001*k;
+    RobotState s;
+
+    for (int i=0; i<4; i++)
+    {
+      double sign = (i < 2) ? 1.0 : -1.0;   // front legs bend forward
+      double c = std::cos(w*t + phase[i]), d = std::sin(w*t + phase[i]);
+
+      s._q_leg[i] = Vector3d(0.05*d, sign*(0.75 + 0.1*d), -sign*(1.5 + 0.2*d));
+      s._qdot_leg[i] = w * Vector3d(0.05*c, sign*0.1*c, -sign*0.2*c);
+      s._contact_states[i] = (d < 0) ? 1 : 0;
+    }
+
+    s._pose_body._pos = Vector3d(0.3*t, 0.0, 0.6 + 0.01*std::sin(2*w*t));
+    s._pose_body._rot_quat = AngleAxisd(0.02*std::sin(w*t), Vector3d::UnitX()) * AngleAxisd(0.01*std::cos(w*t), Vector3d::UnitY());
+    s._pose_vel_body._linear = Vector3d(0.3, 0.0, 0.02*w*std::cos(2*w*t));
+    s._pose_vel_body._angular = Vector3d(0.02*w*std::cos(w*t), -0.01*w*std::sin(w*t), 0.0);
+
+    states.push_back(s);
+  }
+}
+
+// same model parameters as MainController
+inline bool initRobot(quadruped_robot::QuadrupedRobot& robot, const std::string& urdf_file)
+{
+  if (urdf_file.empty() || !kdl_parser::treeFromFile(urdf_file, robot._kdl_tree))
+    return false;
+
+  if (robot.init() < 0)
+    return false;
+
+  robot._m_body = 83.282;
+  robot._mu_foot = 0.6;
+  robot._I_com_body = Eigen::Matrix3d::Zero();
+  robot._I_com_body.diagonal() << 1.5725937, 8.5015928, 9.1954911;
+  robot._p_body2com = Eigen::Vector3d(0.056, 0.0215, 0.00358);
+
+  robot._pose_body_d._pos = Vector3d(0.0, 0.0, 0.6);
+  robot._pose_body_d._rot_quat.setIdentity();
+  robot._pose_vel_body_d._linear.setZero();
+  robot._pose_vel_body_d._angular.setZero();
+
+  return true;
+}
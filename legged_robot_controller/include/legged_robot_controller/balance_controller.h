@@ -13,9 +13,12 @@
 #include <kdl/chain.hpp>
 #include <kdl/chaindynparam.hpp>
 #include <kdl_parser/kdl_parser.hpp>
-#include <qpOASES/qpOASES.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <ros/console.h>
 
+#include "legged_robot_controller/balance_lookup.h"
+#include "legged_robot_controller/qp_dumper.h"
+#include "legged_robot_controller/qp_solver.h"
 #include "legged_robot_controller/quadruped_robot.h"
 #include "legged_robot_math/math_func.h"
 
@@ -33,9 +36,19 @@ using Eigen::NoChange;
 class BalanceController
 {
 public:
-  BalanceController() {}
+  BalanceController() : _use_lookup(false) {}
 
-  void init();
+  // equilibrate scales the QP of each contact set (qp_solver::Equilibration)
+  void init(qp_solver::backends::Backend backend = qp_solver::backends::QPOASES, bool equilibrate = false);
+
+  // active sets of the explicit solution, enables the lookup before the QP
+  bool loadLookupTable(const std::string& file_name);
+
+  // options profile of the QP backend (qp_option_tuner)
+  bool loadQPOptions(const std::string& file_name) { return _qp_solver->loadOptions(file_name); }
+
+  // every sample_interval-th QP to directory in OQP format (qp_dumper.h)
+  bool dumpQPs(const std::string& directory, int sample_interval) { return _qp_dumper.open(directory, sample_interval); }
 
   // void setControlInput(const Eigen::Vector3d& p_body_d,
   //         const Eigen::Vector3d& p_body_dot_d,
@@ -71,8 +84,17 @@ public:
   Matrix<double, Dynamic, Dynamic, ColMajor, 12, 12> _Beta;
   Matrix<double, Dynamic, 1, ColMajor, 12, 1> _g;
 
-  // Inequality constraint
-  Matrix<double, Dynamic, Dynamic, RowMajor, 16, 12> _C;
+  // Inequality constraint, 4x3 friction cone block of each leg stacked
+  Matrix<double, Dynamic, 3, RowMajor, 16, 3> _C_blocks;
   Matrix<double, 1, Dynamic, RowMajor, 1, 12> _lb, _ub;
   Matrix<double, 1, Dynamic, RowMajor, 1, 16> _ubC;
+
+  // QP solver and the problem pointing to the matrices above
+  boost::scoped_ptr<qp_solver::Solver> _qp_solver;
+  qp_solver::Problem _qp;
+  QPDumper _qp_dumper;
+
+  // explicit solution, learns the active sets of the QP solutions it misses
+  bool _use_lookup;
+  BalanceLookup _lookup;
 };
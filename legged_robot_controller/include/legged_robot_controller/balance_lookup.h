@@ -0,0 +1,98 @@
+/*
+  Author: Modulabs
+  File Name: balance_lookup.h
+*/
+
+#pragma once
+
+#include <array>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+/* Explicit solution of the balance QP
+ *
+ *   min 1/2 F'HF + g'F   s.t.  lb <= F <= ub,  C F <= ubC     (3 forces, 4 cone rows per stance leg)
+ *
+ * For a fixed active set W the solution is affine in the parameters (critical region of W),
+ *   F = H^-1 (A_W' lambda - g),   A_W H^-1 A_W' lambda = b_W + A_W H^-1 g
+ * and W is optimal while F satisfies the inactive constraints and the multipliers have the right sign.
+ * H depends on the foot positions, so the regions are not stored as polytopes but by their active
+ * sets, one table per stance mask, and checked exactly at runtime. A failed lookup falls back to the QP.
+ *
+ * Active set bits of stance leg i (i-th set bit of the mask):
+ *   3i+j lower bound of F_j,  12+3i+j upper bound of F_j,  24+4i+r cone row r
+*/
+
+#define LOOKUP_MAX_REGIONS 8      // active sets kept per stance mask, a miss checks all of them
+#define LOOKUP_ACTIVE_TOL 1e-6    // constraint is active within this (relative) distance
+#define LOOKUP_FEAS_TOL 1e-6      // violation of inactive constraints and multiplier signs accepted
+
+class BalanceLookup
+{
+public:
+  typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor, 12, 12> MatrixH;
+  typedef Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor, 16, 3> MatrixC;
+  typedef Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, 12, 1> VectorF;
+  typedef Eigen::Matrix<double, 1, Eigen::Dynamic, Eigen::RowMajor, 1, 12> RowVectorB;
+  typedef Eigen::Matrix<double, 1, Eigen::Dynamic, Eigen::RowMajor, 1, 16> RowVectorC;
+
+  struct Statistics
+  {
+    Statistics() : hits(0), misses(0), candidates(0) {}
+
+    long hits;            // lookups answered from the table
+    long misses;          // lookups left to the QP
+    long candidates;      // active sets checked
+  };
+
+  BalanceLookup();
+
+  // max_regions active sets are kept per stance mask, the least recently hit is dropped first
+  void setMaxRegions(int max_regions);
+  int getMaxRegions() const { return _max_regions; }
+
+  void clear();
+
+  // F of the first stored active set of the mask that is optimal, false if there is none
+  bool solve(int mask, const MatrixH& H, const VectorF& g, const MatrixC& C_blocks,
+             const RowVectorB& lb, const RowVectorB& ub, const RowVectorC& ubC, VectorF& F);
+
+  // active set of a solution of the QP, as given by the online solver
+  static uint64_t activeSet(const VectorF& F, const MatrixC& C_blocks,
+                            const RowVectorB& lb, const RowVectorB& ub, const RowVectorC& ubC);
+
+  // adds the active set in front of the mask's table
+  void insert(int mask, uint64_t active_set);
+
+  // one line per region "mask active_set" in hex, most recently hit first
+  bool save(const std::string& file_name) const;
+  bool load(const std::string& file_name);
+
+  int size() const;
+  int size(int mask) const { return _regions[mask & 15].size(); }
+  size_t memory() const { return 16 * _max_regions * sizeof(uint64_t); }
+
+  const Statistics& getStatistics() const { return _statistics; }
+  void resetStatistics() { _statistics = Statistics(); }
+
+private:
+  bool solveActiveSet(uint64_t active_set, const MatrixC& C_blocks,
+                      const RowVectorB& lb, const RowVectorB& ub, const RowVectorC& ubC, VectorF& F);
+
+  int _max_regions;
+  std::array<std::vector<uint64_t>, 16> _regions;   // storage is reserved once, no allocation at runtime
+  Statistics _statistics;
+
+  // factorization of H and L^-1 g of the current lookup
+  int _n;
+  Eigen::LLT<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, 12, 12> > _llt_H;
+  VectorF _h;
+
+  // active constraints a_k'F = b_k, M = L^-1 A_W', S = M'M
+  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, 12, 12> _At, _M;
+  Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::ColMajor, 12, 1> _b, _sign, _lambda;
+  Eigen::LLT<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, 12, 12> > _llt_S;
+};
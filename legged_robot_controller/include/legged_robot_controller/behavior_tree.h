@@ -0,0 +1,83 @@
+/*
+  Author: Modulabs
+  File Name: behavior_tree.h
+*/
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#define BT_MAX_NODES 256
+#define BT_MAX_DEPTH 16
+
+namespace behavior_tree
+{
+  enum Status
+  {
+    Failure,
+    Success,
+    Running
+  };
+
+  enum NodeType
+  {
+    Sequence,   // ticks children until one does not succeed
+    Selector,   // ticks children until one does not fail
+    Inverter,   // swaps success and failure of its only child
+    Condition,  // leaf, returns success or failure
+    Action      // leaf
+  };
+
+  typedef std::function<Status()> LeafFunction;
+
+  /* Node
+   * children of a node are stored next to each other in the arena, [_first_child, _first_child + _n_child)
+  */
+  struct Node
+  {
+    NodeType _type;
+    int _first_child;
+    int _n_child;
+    int _leaf;        // index of leaf function, -1 for composite node
+  };
+
+/* Behavior tree
+ * Nodes live in an arena allocated in the constructor and are laid out breadth first when a tree is loaded.
+ * Leaf functions are registered by name before loading. tick() visits each node at most once and never allocates,
+ * so it can run inside the realtime loop.
+ *
+ * Tree file is indented by two spaces per level, one node per line, '#' starts a comment.
+ *   selector
+ *     sequence
+ *       condition is_falling
+ *       action update_falling
+*/
+class BehaviorTree
+{
+public:
+  BehaviorTree();
+
+  // startup
+  void registerLeaf(const std::string& name, const LeafFunction& function);
+  bool loadFile(const std::string& file_name);
+  bool loadString(const std::string& text);
+  void clear();
+
+  // realtime
+  Status tick();
+
+  bool isLoaded() const { return !_nodes.empty(); }
+  size_t size() const { return _nodes.size(); }
+  const std::string& getError() const { return _error; }
+
+private:
+  Status tickNode(int i);
+
+  std::vector<Node> _nodes;   // arena, _nodes[0] is root
+  std::vector<std::string> _leaf_names;
+  std::vector<LeafFunction> _leaf_functions;
+  std::string _error;
+};
+}
@@ -0,0 +1,60 @@
+/*
+  Author: Modulabs
+  File Name: gait_scheduler.h
+*/
+
+#pragma once
+
+#include <array>
+#include <cmath>
+
+#include "legged_robot_controller/quadruped_robot.h"
+
+#define GAIT_PATTERN_NUM (quadruped_robot::gait_patterns::Pronking + 1)
+
+/* Gait table
+ * one stride of a gait, stance first then swing: phase in [0, duty) is stance, [duty, 1) is swing
+ * leg order is lf, rf, lh, rh
+*/
+struct GaitTable
+{
+  double _T_stride;               // stride period (sec)
+  double _duty;                   // stance duty factor, T_stance / T_stride
+  std::array<double, 4> _offset;  // phase offset of each leg, 1 - phase lag
+
+  // precomputed from above
+  double _inv_T_stride, _inv_duty, _inv_swing;
+  double _T_stance, _T_swing;
+};
+
+class GaitScheduler
+{
+public:
+  GaitScheduler();
+
+  void init();
+
+  // tables are built once in init(), use this only when gait parameter is changed
+  void setGaitTable(quadruped_robot::gait_patterns::GaitPattern gait_pattern,
+                    double T_stride, double duty, const std::array<double, 4>& phase_lag);
+  const GaitTable& getGaitTable(quadruped_robot::gait_patterns::GaitPattern gait_pattern) const { return _table[gait_pattern]; }
+
+  // phase of all legs is zero at t_start
+  void start(quadruped_robot::gait_patterns::GaitPattern gait_pattern, double t_start);
+
+  // per tick, writes _t_leg, _T_stance, _T_swing, _S_stance, _S_swing, _contact_states_d
+  void update(double t, quadruped_robot::QuadrupedRobot& robot);
+
+  // contact of each leg at t (bit i is leg i)
+  int getContactMask(double t) const;
+
+  // contact of each leg from t to t + (n_step-1)*dt, for predictive controllers
+  void getContactLookahead(double t, double dt, int n_step, std::array<int, 4>* contacts) const;
+
+public:
+  std::array<GaitTable, GAIT_PATTERN_NUM> _table;
+
+  const GaitTable* _gait;
+  double _t_start;
+  std::array<double, 4> _phase;
+};
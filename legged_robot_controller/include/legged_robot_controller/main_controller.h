@@ -37,6 +37,7 @@
 #include "legged_robot_controller/swing_controller.h"
 #include "legged_robot_controller/virtual_spring_damper_controller.h"
 #include "legged_robot_math/bezier.h"
+#include "legged_robot_math/trajectory_table.h"
 #include "legged_robot_msgs/ControllerJointState.h"
 #include "legged_robot_msgs/MoveBody.h"
 #include "legged_robot_msgs/UICommand.h"
@@ -122,8 +123,10 @@ private:
   MotionPlanner _motion_planner;
 
   // trajectory
-  trajectory::Bezier _swing_traj;
-  trajectory::Bezier _stance_traj;
+  trajectory::Bezier<3, 4> _swing_traj;
+  trajectory::Bezier<3, 2> _stance_traj;
+  trajectory::TrajectoryTable<3> _swing_table, _stance_table;
+  std::array<trajectory::TrajectoryTable<3>::Correction, 4> _swing_correction;
   
   // 
   BalanceController _balance_controller;
@@ -2,21 +2,29 @@
 #define MOTION_PLANNER_H
 
 #include "legged_robot_controller/quadruped_robot.h"
+#include "legged_robot_controller/behavior_tree.h"
+#include "legged_robot_controller/gait_scheduler.h"
 
 class MotionPlanner
 {
 public:
-  void init(quadruped_robot::QuadrupedRobot* robot) {_robot = robot;}
+  void init(quadruped_robot::QuadrupedRobot* robot) {_robot = robot; _t = 0; _gait_scheduler.init();}
+
+  bool loadBehaviorTree(const std::string& file_name);
 
   void setGaitPattern(quadruped_robot::gait_patterns::GaitPattern gait_pattern, int int_param=0);
 
-  void update();
+  void update(double t);
   void updateFalling();
   void startStanding();
   void updateStanding();
+  void startMoving();
   void updateMoving();
 
   quadruped_robot::QuadrupedRobot* _robot;
+  behavior_tree::BehaviorTree _behavior_tree;
+  GaitScheduler _gait_scheduler;
+  double _t;
 };
 
 
@@ -8,15 +8,18 @@
 #include <array>
 #include <fstream>
 #include <iostream>
+#include <vector>
 
 #include <kdl/tree.hpp>
 #include <kdl/kdl.hpp>
 #include <kdl/chain.hpp>
 #include <kdl/chaindynparam.hpp>
 #include <kdl_parser/kdl_parser.hpp>
-#include <qpOASES/qpOASES.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include "legged_robot_math/math_func.h"
+#include "legged_robot_controller/qp_dumper.h"
+#include "legged_robot_controller/qp_solver.h"
 #include "legged_robot_controller/quadruped_robot.h"
 
 #undef MPC_Debugging
@@ -47,6 +50,54 @@
 using namespace std;
 
 
+// forces over the horizon, the QP has a force per stance leg and input
+namespace mpc_inputs
+{
+  enum Parameterisation
+  {
+    FULL,       // an input per step
+    BLOCKING,   // inputs held over blocks of steps (move blocking)
+    LINEAR      // forces linear between inputs at knots spread over the horizon
+  };
+
+  inline const char* ParameterisationToString(Parameterisation parameterisation)
+  {
+    switch (parameterisation)
+    {
+        case FULL:     return "full";
+        case BLOCKING: return "blocking";
+        case LINEAR:   return "linear";
+        default:       return "---";
+    }
+  }
+
+  inline bool ParameterisationFromString(const std::string& name, Parameterisation& parameterisation)
+  {
+    if (name == "full")
+      parameterisation = FULL;
+    else if (name == "blocking")
+      parameterisation = BLOCKING;
+    else if (name == "linear")
+      parameterisation = LINEAR;
+    else
+      return false;
+    return true;
+  }
+
+  // move blocks of at least one step each, summing to the horizon
+  inline bool MoveBlocksValid(const std::vector<int>& move_blocks, int n_step)
+  {
+    int n_block_steps = 0;
+    for (size_t j=0; j<move_blocks.size(); j++)
+    {
+      if (move_blocks[j] < 1)
+        return false;
+      n_block_steps += move_blocks[j];
+    }
+    return n_block_steps == n_step;
+  }
+}
+
 struct LegContactState
 {
   int ContactTotalNum;
@@ -56,20 +107,41 @@ struct LegContactState
 class MPCController
 {
 public:
-  MPCController() {}
+  MPCController() : _n_step(MPC_Step), _input_parameterisation(mpc_inputs::FULL), _n_input(MPC_Step) {}
+
+  // equilibrate scales the QP of each contact set (qp_solver::Equilibration)
+  void init(qp_solver::backends::Backend backend = qp_solver::backends::QPOASES, bool equilibrate = false);
+
+  // options profile of the QP backend (qp_option_tuner)
+  bool loadQPOptions(const std::string& file_name) { return _qp_solver->loadOptions(file_name); }
 
-  void init();
+  // every sample_interval-th QP to directory in OQP format (qp_dumper.h)
+  bool dumpQPs(const std::string& directory, int sample_interval) { return _qp_dumper.open(directory, sample_interval); }
+
+  // n_input blocks or knots over the horizon (FULL has one per step), move_blocks gives the steps of each
+  // block instead if they add up to the horizon
+  void setInputParameterisation(mpc_inputs::Parameterisation parameterisation, int n_input,
+                                const std::vector<int>& move_blocks = std::vector<int>());
 
   void setControlData(quadruped_robot::QuadrupedRobot &robot);
   void calControlInput();
   void getControlInput(quadruped_robot::QuadrupedRobot &robot, std::array<Eigen::Vector3d, 4> &F_leg);
+
+  // exact zero-order hold of the continuous dynamics, x[k+1] = A_d x[k] + B_d u[k]
+  void cal_ZOH();
+  void cal_W_input();
   void cal_A_d();
-  void cal_B_d_and_B_d_d();
+  void cal_B_d(const Eigen::Matrix3d& Rz, const std::array<Eigen::Matrix3d, 4>& R_leg, Eigen::MatrixXd& B_d) const;
   
 public:
   bool _start;
   volatile bool _update;
   int _step;
+  int _n_step;    // prediction horizon, MPC_Step by default
+
+  mpc_inputs::Parameterisation _input_parameterisation;
+  int _n_input;
+  std::vector<int> _move_blocks;
       
   // parameter
   double _m_body;
@@ -93,19 +165,27 @@ public:
   // Define Parameter For MPC Controller
   Eigen::MatrixXd _A_d, _B_d, _B_d_d;
   Eigen::MatrixXd _Rz, _Rz_d;
-  Eigen::MatrixXd _R1, _R2, _R3, _R4;
-  Eigen::MatrixXd _R1_d, _R2_d, _R3_d, _R4_d;
+  std::array<Eigen::Matrix3d, 4> _R_leg, _R_leg_d;    // I^-1 [p_leg - p_com], force to angular acceleration
+  // exp(A_c T) at zero yaw and its integral on the angular and linear acceleration rows,
+  // unaligned as MainController holds the controller by value
+  Eigen::Matrix<double, 15, 15, Eigen::DontAlign> _A_d_0;
+  Eigen::Matrix<double, 15, 6, Eigen::DontAlign> _B_d_0;
+  std::array<bool, 5> _A_d_0_row, _A_d_0_col, _B_d_0_w;   // nonzero 3x3 blocks the yaw and legs act on
   Eigen::MatrixXd _I3x3, _I15x15;
   Eigen::MatrixXd _I_hat, _I_hat_d;
-  Eigen::MatrixXd _p_leg_1_skew, _p_leg_2_skew, _p_leg_3_skew, _p_leg_4_skew;
-  Eigen::MatrixXd _p_leg_1_skew_d, _p_leg_2_skew_d, _p_leg_3_skew_d, _p_leg_4_skew_d;
   Eigen::MatrixXd _A_qp, _B_qp, _Temp;
   Eigen::MatrixXd _L_d, _K_d;
-  Eigen::MatrixXd _H_qp, _L_qp, _K_qp;
+  Eigen::MatrixXd _W_input;   // forces of step k are sum_j W(k,j) V_j of the inputs V
+  Eigen::MatrixXd _H_qp, _LB_qp, _K_qp;
   Eigen::MatrixXd _g_qp, _x0, _xref, _xref_qp;
 
-  Eigen::MatrixXd _C_1leg, _C_totalleg, _C_qp;
-  Eigen::MatrixXd _lbC_1leg, _lbC_totalleg, _lbC_qp;
+  Eigen::MatrixXd _C_1leg, _lbC_1leg, _lbC_qp;
+  Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> _C_blocks;   // blocks of the block diagonal friction cone
   Eigen::MatrixXd _ub_1leg, _ub_totalleg, _ub_qp;
   Eigen::MatrixXd _lb_1leg, _lb_totalleg, _lb_qp;
+
+  // QP solver and the problem pointing to the matrices above
+  boost::scoped_ptr<qp_solver::Solver> _qp_solver;
+  qp_solver::Problem _qp;
+  QPDumper _qp_dumper;
 };
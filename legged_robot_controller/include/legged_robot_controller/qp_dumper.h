@@ -0,0 +1,72 @@
+/*
+  Author: Modulabs
+  File Name: qp_dumper.h
+*/
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "legged_robot_controller/qp_solver.h"
+
+/* QPs of a controller to disk in the OQP format of qpOASES (extras/OQPinterface)
+ *
+ * Every sample_interval-th problem given to sample() is copied into a queue, a writer thread takes it
+ * from there and writes it as a collection of one QP, directory/000000/, directory/000001/, ...
+ * with dims.oqp, H.oqp, g.oqp, lb.oqp, ub.oqp and, with constraints, A.oqp, lbA.oqp, ubA.oqp.
+ * C is written dense, missing bounds as +-QP_DUMP_INFTY. qp_replay_bench solves them again.
+ *
+ * sample() takes no lock and allocates only while a queue slot grows to the largest problem,
+ * a full queue drops the problem.
+*/
+
+#define QP_DUMP_QUEUE 64          // problems waiting for the writer
+#define QP_DUMP_INTERVAL 100      // default sampling, every 100th problem
+#define QP_DUMP_IDLE_MS 10        // writer sleep while the queue is empty
+#define QP_DUMP_INFTY 1e20        // INFTY of qpOASES
+
+class QPDumper
+{
+public:
+  QPDumper();
+  ~QPDumper();
+
+  // creates the directory and starts the writer
+  bool open(const std::string& directory, int sample_interval = QP_DUMP_INTERVAL);
+
+  // writes the queued problems and stops the writer
+  void close();
+
+  bool isOpen() const { return _running; }
+
+  // realtime side, problem data has to be valid during the call only
+  void sample(const qp_solver::Problem& qp);
+
+  long getWritten() const { return _written; }
+  long getDropped() const { return _dropped; }
+
+private:
+  struct Slot
+  {
+    int n, n_blocks, block_rows, block_cols;
+    std::vector<double> H, g, lb, ub, C_blocks, lbC, ubC;    // empty if not given
+  };
+
+  void run();
+  bool write(const Slot& slot, long index) const;
+
+  std::string _directory;
+  int _sample_interval;
+  long _samples;
+
+  // single producer, single consumer ring, _head is written by sample(), _tail by the writer
+  std::vector<Slot> _queue;
+  std::atomic<long> _head, _tail;
+
+  std::atomic<bool> _running;
+  std::atomic<long> _written, _dropped;
+  std::thread _writer;
+};
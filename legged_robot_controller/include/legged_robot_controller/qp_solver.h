@@ -0,0 +1,304 @@
+/*
+  Author: Modulabs
+  File Name: qp_solver.h
+*/
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <qpOASES/qpOASES.hpp>
+
+/* QP backends shared by the balance and mpc controller
+ *
+ *   min 1/2 x'Hx + g'x   s.t.  lb <= x <= ub,  lbC <= Cx <= ubC
+ *
+ * C is block diagonal, block_rows x block_cols blocks stacked row-major (friction cone of each leg),
+ * a single block gives a dense C. NULL bounds are unbounded.
+ *
+ * Problems are given in double. qpOASES built with QPOASES_SINGLE_PRECISION and ADMM_SINGLE solve in float,
+ * twice the SIMD width for the products of the solver, the problem is converted once per solve.
+ *
+ * Badly scaled problems (forces of hundreds of N next to tiny regularization weights) can be equilibrated
+ * in front of any backend, see Equilibration.
+ *
+ * qpOASES options can be given by a profile, one "name value" per line, '#' starts a comment.
+ * An optional "preset default|reliable|MPC|fast" comes first, the other names are the fields of
+ * qpOASES::Options (booleans and initialStatusBounds as integers). qp_option_tuner writes these profiles.
+*/
+
+// ADMM defaults
+#define ADMM_RHO 0.1
+#define ADMM_SIGMA 1e-6
+#define ADMM_ALPHA 1.6
+#define ADMM_EPS_ABS 1e-4
+#define ADMM_EPS_REL 1e-4
+#define ADMM_MAX_ITER 4000
+#define ADMM_CHECK_INTERVAL 5
+#define ADMM_RHO_MIN 1e-6
+#define ADMM_RHO_MAX 1e6
+#define ADMM_RHO_ADAPT 5.0        // rho is changed when it is off by this factor
+#define ADMM_RHO_INTERVAL 25
+
+#define QPOASES_MAX_NWSR 100
+
+// Ruiz equilibration
+#define EQUILIBRATION_ITER 10
+#define EQUILIBRATION_MIN 1e-4      // bounds of the scale factors
+#define EQUILIBRATION_MAX 1e4
+#define EQUILIBRATION_INFTY 1e20    // bounds beyond this are infinite and kept
+#define EQUILIBRATION_CACHE 16      // contact sets, 4 legs
+
+namespace qp_solver
+{
+  namespace backends
+  {
+    enum Backend
+    {
+      QPOASES,
+      ADMM,
+      ADMM_SINGLE
+    };
+
+    inline const char* BackendToString(Backend backend)
+    {
+      switch (backend)
+      {
+          case QPOASES:     return "qpOASES";
+          case ADMM:        return "ADMM";
+          case ADMM_SINGLE: return "ADMM_single";
+          default:          return "---";
+      }
+    }
+
+    inline bool BackendFromString(const std::string& name, Backend& backend)
+    {
+      if (name == "qpOASES")
+        backend = QPOASES;
+      else if (name == "ADMM")
+        backend = ADMM;
+      else if (name == "ADMM_single")
+        backend = ADMM_SINGLE;
+      else
+        return false;
+      return true;
+    }
+  }
+
+  // all data stays with the caller and has to be valid during solve()
+  struct Problem
+  {
+    Problem() : n(0), H(NULL), g(NULL), lb(NULL), ub(NULL),
+                n_blocks(0), block_rows(0), block_cols(0), C_blocks(NULL), lbC(NULL), ubC(NULL), contact_set(-1) {}
+
+    int numConstraints() const { return n_blocks*block_rows; }
+
+    int n;                // number of variables
+    double* H;            // n x n, symmetric, qpOASES may regularize it in place
+    const double* g;
+    const double* lb;
+    const double* ub;
+
+    int n_blocks, block_rows, block_cols;   // n_blocks*block_cols == n
+    const double* C_blocks;
+    const double* lbC;
+    const double* ubC;
+
+    int contact_set;      // mask of the legs in contact, -1 if unknown. problems of a contact set share the scaling
+  };
+
+  struct Statistics
+  {
+    Statistics() : solved(false), warm_started(false), iterations(0), factorizations(0), solve_time(0.0),
+                   kkt_violation(0.0) {}
+
+    bool solved;
+    bool warm_started;    // started from the solution of the last problem
+    int iterations;       // working set changes or ADMM iterations
+    int factorizations;   // since construction
+    double solve_time;    // sec
+    double kkt_violation; // max KKT residual, by a QPOASESSolver with setKktCheck(true) only
+  };
+
+  class Solver
+  {
+  public:
+    virtual ~Solver() {}
+
+    virtual backends::Backend getBackend() const = 0;
+
+    // warm starts from the last solution when the problem has the same size
+    virtual bool solve(const Problem& qp) = 0;
+
+    // next solve starts cold
+    virtual void reset() = 0;
+
+    // options profile of the backend, false if it has none or the file is bad
+    virtual bool loadOptions(const std::string& file_name) { return false; }
+
+    const Eigen::VectorXd& getSolution() const { return _x; }
+    const Statistics& getStatistics() const { return _statistics; }
+
+  protected:
+    Eigen::VectorXd _x;
+    Statistics _statistics;
+  };
+
+  // caller owns the solver, equilibrate puts an EquilibratedSolver in front of the backend
+  Solver* createSolver(backends::Backend backend, bool equilibrate = false);
+
+  // qpOASES options profile, fields not in the file keep their value
+  bool loadOptions(const std::string& file_name, qpOASES::Options& options);
+  bool saveOptions(const std::string& file_name, const qpOASES::Options& options, const std::string& comment = "");
+
+
+  // active set, one QProblem per solve() on a reused workspace, in the precision qpOASES is built with
+  class QPOASESSolver : public Solver
+  {
+  public:
+    QPOASESSolver();
+
+    backends::Backend getBackend() const { return backends::QPOASES; }
+    bool solve(const Problem& qp);
+    void reset() { _n_C = -1; }
+    bool loadOptions(const std::string& file_name);
+
+    void setOptions(const qpOASES::Options& options) { _options = options; reset(); }
+    const qpOASES::Options& getOptions() const { return _options; }
+
+    // KKT violation of each solution into the statistics, not included in solve_time. allocates, offline only
+    void setKktCheck(bool check) { _check_kkt = check; }
+
+  private:
+    typedef Eigen::Matrix<qpOASES::real_t, Eigen::Dynamic, 1> VectorReal;
+
+    // KKT violation into the statistics, returns the time it took
+    template <typename QProblemType>
+    double checkKkt(QProblemType* qp_problem);
+
+    qpOASES::Options _options;
+    bool _check_kkt;
+    int _n_C;             // constraints of the last solution, -1 if there is none
+    VectorReal _x_real;
+    VectorReal _y;        // dual solution, bounds then constraints
+    qpOASES::Workspace _workspace;
+
+    // problem in single precision, unused by a double build
+    std::vector<qpOASES::real_t> _H, _g, _lb, _ub, _C_blocks, _lbC, _ubC;
+  };
+
+
+  // operator splitting (OSQP iteration) on the stacked constraints A = [I; C], z = Ax, iterated in Scalar
+  // the factorization of H + sigma*I + rho*A'A is kept while H, C and rho stay,
+  // x, z, y and rho are kept while the contact set stays
+  template <typename Scalar>
+  class ADMMSolverT : public Solver
+  {
+  public:
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatrixS;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1> VectorS;
+
+    ADMMSolverT();
+
+    backends::Backend getBackend() const;
+    bool solve(const Problem& qp);
+    void reset() { _warm = false; _factorized = false; _rho = ADMM_RHO; }
+
+  public:
+    Scalar _rho, _sigma, _alpha;
+    Scalar _eps_abs, _eps_rel;
+    int _max_iter;
+
+  private:
+    void setProblem(const Problem& qp);
+    void factorize();
+    bool needFactorization() const;
+
+    // A x and A'z
+    void multiplyA(const VectorS& x, VectorS& z) const;
+    void multiplyAt(const VectorS& z, VectorS& x) const;
+
+    bool _warm, _factorized;
+    int _n, _m;
+    int _n_blocks, _block_rows, _block_cols;
+
+    // problem in Scalar, C blocks stacked
+    MatrixS _H, _C;
+    VectorS _g, _l, _u;
+
+    // factorization and the data it was built from
+    MatrixS _K, _H_factorized, _C_factorized;
+    Eigen::LLT<MatrixS> _llt;
+
+    // iterates and work vectors, sized once per problem size
+    VectorS _x_iter, _z, _y, _x_tilde, _z_tilde, _rhs, _res, _Ax, _Aty, _Hx;
+  };
+
+  typedef ADMMSolverT<double> ADMMSolver;
+  typedef ADMMSolverT<float> ADMMSolverSingle;
+
+
+  // Ruiz equilibration of H and C, the backend solves
+  //   min 1/2 x~'(cDHD)x~ + (cDg)'x~   s.t.  D^-1 lb <= x~ <= D^-1 ub,  E lbC <= ECD x~ <= E ubC,   x = D x~
+  // D and E are from the first problem of a contact set and kept for it, scale() and unscale()
+  // do not allocate while the contact set stays
+  class Equilibration
+  {
+  public:
+    Equilibration() : _computations(0), _current(NULL) {}
+
+    // scaled problem in buffers of this, valid until the next scale()
+    void scale(const Problem& qp, Problem& scaled);
+    void unscale(const Eigen::VectorXd& x_scaled, Eigen::VectorXd& x) const;
+
+    void clear();
+    int getComputations() const { return _computations; }
+
+  private:
+    struct Scaling
+    {
+      Scaling() : valid(false), n(0), n_blocks(0), block_rows(0), block_cols(0), c(1.0) {}
+
+      bool valid;
+      int n, n_blocks, block_rows, block_cols;
+      double c;                   // cost
+      Eigen::VectorXd D, E;       // variables, constraints
+    };
+
+    void compute(const Problem& qp, Scaling& s);
+
+    int _computations;
+    std::array<Scaling, EQUILIBRATION_CACHE + 1> _cache;    // last one for unknown contact sets
+    const Scaling* _current;
+
+    std::vector<double> _H, _g, _lb, _ub, _C_blocks, _lbC, _ubC;
+  };
+
+  // equilibrated problem through another backend, the solution is unscaled
+  class EquilibratedSolver : public Solver
+  {
+  public:
+    // takes ownership of the backend
+    EquilibratedSolver(Solver* solver) : _solver(solver) {}
+    ~EquilibratedSolver() { delete _solver; }
+
+    backends::Backend getBackend() const { return _solver->getBackend(); }
+    bool solve(const Problem& qp);
+    void reset() { _solver->reset(); }
+    bool loadOptions(const std::string& file_name) { return _solver->loadOptions(file_name); }
+
+    Solver* getSolver() { return _solver; }
+    const Equilibration& getEquilibration() const { return _equilibration; }
+
+  private:
+    EquilibratedSolver(const EquilibratedSolver&);
+    EquilibratedSolver& operator=(const EquilibratedSolver&);
+
+    Solver* _solver;
+    Equilibration _equilibration;
+    Problem _scaled;
+  };
+}
@@ -39,6 +39,11 @@ namespace quadruped_robot
       Galloping,
       Pronking
     };
+
+    inline bool isMoving(GaitPattern gait_pattern)
+    {
+      return gait_pattern >= Walking;
+    }
   }
 
   namespace controllers
@@ -128,6 +133,7 @@ public:
   std::array<double, 4> _S_swing;
   std::array<double, 4> _t_leg;
   std::array<int, 4> _contact_states;
+  std::array<int, 4> _contact_states_d;   // planned by gait scheduler
 
   // body
   Pose  _pose_body, _pose_body_d;           // world to body
@@ -6,9 +6,16 @@
 #include "legged_robot_controller/balance_controller.h"
 
 
-void BalanceController::init()
+void BalanceController::init(qp_solver::backends::Backend backend, bool equilibrate)
 {
   _legs.reserve(4);
+  _qp_solver.reset(qp_solver::createSolver(backend, equilibrate));
+}
+
+bool BalanceController::loadLookupTable(const std::string& file_name)
+{
+  _use_lookup = _lookup.load(file_name);
+  return _use_lookup;
 }
 
 void BalanceController::update(quadruped_robot::QuadrupedRobot& robot, std::array<Vector3d, 4>& F_leg)
@@ -21,8 +28,9 @@ void BalanceController::update(quadruped_robot::QuadrupedRobot& robot, std::arra
   const Vector3d& p_com = robot._pose_com._pos;
   const Vector3d& v_com_d = robot._pose_vel_com_d._linear;
   const Vector3d& v_com = robot._pose_vel_com._linear;
-  const Matrix3d R_d = robot._pose_body_d._rot_quat.toRotationMatrix();
-  const Matrix3d R = robot._pose_body._rot_quat.toRotationMatrix();
+  const Quaterniond& q_d = robot._pose_body_d._rot_quat;
+  const Quaterniond& q = robot._pose_body._rot_quat;
+  const Matrix3d R = q.toRotationMatrix();
   const Vector3d& w_d = robot._pose_vel_body_d._angular;
   const Vector3d& w = robot._pose_vel_body._angular;
   const std::array<Vector3d, 4>& p_leg = robot._p_world2leg;
@@ -31,10 +39,14 @@ void BalanceController::update(quadruped_robot::QuadrupedRobot& robot, std::arra
 
   // contact number
   _legs.clear();
+  int stance_mask = 0;
   for (size_t i=0; i<4; i++)
   {
     if (robot.getController(i) == quadruped_robot::controllers::BalancingQP && contact_states[i] == 1)
+    {
       _legs.push_back(i);
+      stance_mask |= 1 << i;
+    }
   }
 
   if (_legs.size() < 1)
@@ -72,14 +84,13 @@ void BalanceController::update(quadruped_robot::QuadrupedRobot& robot, std::arra
   _Alpha.resize(opt_size, opt_size);
   _Beta.resize(opt_size, opt_size);
   _g.resize(opt_size);
-  _C.resize(inequality_constraint_size, opt_size);
+  _C_blocks.resize(inequality_constraint_size, NoChange);
   _lb.resize(opt_size);
   _ub.resizeLike(_lb);
   _ubC.resize(inequality_constraint_size);
 
   //
   _H.setZero();
-  _C.setZero();
   _ubC.setZero();
 
   // gains
@@ -100,7 +111,7 @@ void BalanceController::update(quadruped_robot::QuadrupedRobot& robot, std::arra
 
   // Desired acceleration
   _bd.head(3) = m * ( _kp_p.cwiseProduct(p_com_d - p_com) + _kd_p.cwiseProduct(v_com_d - v_com) + Vector3d(0,0,GRAVITY_CONSTANT) );
-  _bd.tail(3) = R*I_com*R.transpose() * ( _kp_w.cwiseProduct(logR(R_d*R.transpose())) + _kd_w.cwiseProduct(w_d - w) );
+  _bd.tail(3) = R*I_com*R.transpose() * ( _kp_w.cwiseProduct(so3::logError(q_d, q)) + _kd_w.cwiseProduct(w_d - w) );
 
   // Stacking matrix with contact foot variable
   for (int l=0, i=0; l < _legs.size(); l++, i++)
@@ -109,13 +120,13 @@ void BalanceController::update(quadruped_robot::QuadrupedRobot& robot, std::arra
 
     // Dynamics
     _A.block<3,3>(0,3*i) = Matrix3d::Identity();
-    _A.block<3,3>(3,3*i) = skew(p_leg[_legs[l]] - p_com);
+    so3::hat(p_leg[_legs[l]] - p_com, _A.block<3,3>(3,3*i));
 
-    // Inequality constraint matrix from friction cone
-    _C.block<4,3>(4*i,3*i) << 1, 0, -mu,
-                            -1, 0, -mu,
-                             0, 1, -mu,
-                            0, -1, -mu;
+    // Inequality constraint matrix from friction cone, one block per leg
+    _C_blocks.block<4,3>(4*i,0) <<  1,  0, -mu,
+                                   -1,  0, -mu,
+                                    0,  1, -mu,
+                                    0, -1, -mu;
     _lb.segment<3>(3*i) << -mu*fz_max, -mu*fz_max, 10;
     _ub.segment<3>(3*i) << mu*fz_max, mu*fz_max, fz_max;
   }
@@ -124,34 +135,28 @@ void BalanceController::update(quadruped_robot::QuadrupedRobot& robot, std::arra
   _H = _A.transpose()*_S*_A + _Alpha + _Beta;   // Hessian
   _g = -_A.transpose()*_S*_bd - beta*_F_prev;  // Gradient
 
-  // Optimization
-  USING_NAMESPACE_QPOASES
-
-//  real_t lb[12] = {-mu*fz_max, -mu*fz_max, 10,
-//                  -mu*fz_max, -mu*fz_max, 10,
-//                  -mu*fz_max, -mu*fz_max, 10,
-//                  -mu*fz_max, -mu*fz_max, 10};
-//  real_t ub[12] = {mu*fz_max, mu*fz_max, fz_max,
-//                  mu*fz_max, mu*fz_max, fz_max,
-//                  mu*fz_max, mu*fz_max,fz_max,
-//                  mu*fz_max, mu*fz_max, fz_max};
-//  real_t ubA[16] = {0.0,};
-
-  QProblem qp_problem( opt_size, inequality_constraint_size);
-
-  Options options;
-  qp_problem.setOptions( options );
-
-  int nWSR = 100;
-  qp_problem.init(_H.data(), _g.data(), _C.data(), _lb.data(), _ub.data(), NULL, _ubC.data(), nWSR);
-
-  real_t xOpt[12];
-//  real_t yOpt[12+1];
-  qp_problem.getPrimalSolution( xOpt );
-
-  for (int i=0; i<opt_size; i++)
+  // Optimization, friction cone is block diagonal, only its blocks are stored and multiplied
+  _qp.n = opt_size;
+  _qp.H = _H.data();
+  _qp.g = _g.data();
+  _qp.lb = _lb.data();
+  _qp.ub = _ub.data();
+  _qp.n_blocks = _legs.size();
+  _qp.block_rows = 4;
+  _qp.block_cols = 3;
+  _qp.C_blocks = _C_blocks.data();
+  _qp.ubC = _ubC.data();
+  _qp.contact_set = stance_mask;
+  _qp_dumper.sample(_qp);
+
+  // explicit solution first, the QP only outside of the stored regions
+  if (!_use_lookup || !_lookup.solve(stance_mask, _H, _g, _C_blocks, _lb, _ub, _ubC, _F))
   {
-    _F(i) = xOpt[i];
+    bool solved = _qp_solver->solve(_qp);
+    _F = _qp_solver->getSolution();
+
+    if (_use_lookup && solved)
+      _lookup.insert(stance_mask, BalanceLookup::activeSet(_F, _C_blocks, _lb, _ub, _ubC));
   }
 
   for (int l=0, i=0; l<_legs.size(); l++, i++)
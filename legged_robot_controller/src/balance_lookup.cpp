@@ -0,0 +1,291 @@
+/*
+  Author: Modulabs
+  File Name: balance_lookup.cpp
+*/
+
+#include "legged_robot_controller/balance_lookup.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+
+static int countBits(uint64_t bits)
+{
+  int n = 0;
+  for (; bits; bits &= bits - 1)
+    n++;
+  return n;
+}
+
+BalanceLookup::BalanceLookup()
+  : _n(0)
+{
+  setMaxRegions(LOOKUP_MAX_REGIONS);
+}
+
+void BalanceLookup::setMaxRegions(int max_regions)
+{
+  _max_regions = std::max(max_regions, 0);
+  for (size_t mask=0; mask<_regions.size(); mask++)
+  {
+    if (_regions[mask].size() > (size_t)_max_regions)
+      _regions[mask].resize(_max_regions);
+    _regions[mask].reserve(_max_regions);
+  }
+}
+
+void BalanceLookup::clear()
+{
+  for (size_t mask=0; mask<_regions.size(); mask++)
+    _regions[mask].clear();
+}
+
+int BalanceLookup::size() const
+{
+  int n = 0;
+  for (size_t mask=0; mask<_regions.size(); mask++)
+    n += _regions[mask].size();
+  return n;
+}
+
+bool BalanceLookup::solve(int mask, const MatrixH& H, const VectorF& g, const MatrixC& C_blocks,
+                          const RowVectorB& lb, const RowVectorB& ub, const RowVectorC& ubC, VectorF& F)
+{
+  std::vector<uint64_t>& regions = _regions[mask & 15];
+
+  if (regions.empty())
+  {
+    _statistics.misses++;
+    return false;
+  }
+
+  // H = LL' is shared by all regions of the mask
+  _n = H.rows();
+  _llt_H.compute(H);
+  if (_llt_H.info() != Eigen::Success)
+  {
+    _statistics.misses++;
+    return false;
+  }
+  _h = g;
+  _llt_H.matrixL().solveInPlace(_h);
+
+  for (size_t k=0; k<regions.size(); k++)
+  {
+    _statistics.candidates++;
+    if (solveActiveSet(regions[k], C_blocks, lb, ub, ubC, F))
+    {
+      // move to front, the next tick is likely in the same region
+      std::rotate(regions.begin(), regions.begin() + k, regions.begin() + k + 1);
+      _statistics.hits++;
+      return true;
+    }
+  }
+
+  _statistics.misses++;
+  return false;
+}
+
+bool BalanceLookup::solveActiveSet(uint64_t active_set, const MatrixC& C_blocks,
+                                   const RowVectorB& lb, const RowVectorB& ub, const RowVectorC& ubC, VectorF& F)
+{
+  int n = _n;
+  int n_active = countBits(active_set);
+  if (n_active > n)
+    return false;
+
+  // rows a_k' of A_W with a_k'F = b_k, sign of the multiplier for an optimal W
+  _At.setZero(n, n_active);
+  _b.resize(n_active);
+  _sign.resize(n_active);
+
+  int k = 0;
+  for (int bit=0; bit<40; bit++)
+  {
+    if (!(active_set & ((uint64_t)1 << bit)))
+      continue;
+
+    if (bit < 24)
+    {
+      int i = bit % 12;
+      if (i >= n)
+        return false;
+      _At(i, k) = 1.0;
+      _b(k) = (bit < 12) ? lb(i) : ub(i);
+      _sign(k) = (bit < 12) ? 1.0 : -1.0;
+    }
+    else
+    {
+      int r = bit - 24;
+      if (3*(r/4) >= n)
+        return false;
+      _At.block<3,1>(3*(r/4), k) = C_blocks.row(r).transpose();
+      _b(k) = ubC(r);
+      _sign(k) = -1.0;
+    }
+    k++;
+  }
+
+  // lambda from the Schur complement S = A_W H^-1 A_W' = M'M
+  _M = _At;
+  _llt_H.matrixL().solveInPlace(_M);
+
+  if (n_active > 0)
+  {
+    _llt_S.compute(_M.transpose() * _M);
+    if (_llt_S.info() != Eigen::Success)
+      return false;
+
+    // linearly dependent active constraints
+    if (_llt_S.matrixLLT().diagonal().minCoeff() <= 1e-6 * _llt_S.matrixLLT().diagonal().maxCoeff())
+      return false;
+
+    _lambda = _b + _M.transpose() * _h;
+    _llt_S.solveInPlace(_lambda);
+  }
+  else
+  {
+    _lambda.resize(0);
+  }
+
+  // F = H^-1 (A_W' lambda - g) = L'^-1 (M lambda - h)
+  F = _M * _lambda - _h;
+  _llt_H.matrixU().solveInPlace(F);
+
+  if (!F.allFinite())
+    return false;
+
+  // dual feasibility
+  double lambda_max = (n_active > 0) ? _lambda.cwiseAbs().maxCoeff() : 0.0;
+  for (k=0; k<n_active; k++)
+  {
+    if (_sign(k) * _lambda(k) < -LOOKUP_FEAS_TOL * (1.0 + lambda_max))
+      return false;
+  }
+
+  // primal feasibility
+  for (int i=0; i<n; i++)
+  {
+    if (F(i) < lb(i) - LOOKUP_FEAS_TOL * (1.0 + std::abs(lb(i))) ||
+        F(i) > ub(i) + LOOKUP_FEAS_TOL * (1.0 + std::abs(ub(i))))
+      return false;
+  }
+  for (int r=0; r<4*(n/3); r++)
+  {
+    const Eigen::Vector3d& F_leg = F.segment<3>(3*(r/4));
+    if (C_blocks.row(r).dot(F_leg) > ubC(r) + LOOKUP_FEAS_TOL * (1.0 + F_leg.cwiseAbs().maxCoeff()))
+      return false;
+  }
+
+  return true;
+}
+
+uint64_t BalanceLookup::activeSet(const VectorF& F, const MatrixC& C_blocks,
+                                  const RowVectorB& lb, const RowVectorB& ub, const RowVectorC& ubC)
+{
+  int n = F.size();
+  uint64_t active_set = 0;
+
+  for (int i=0; i<n; i++)
+  {
+    if (F(i) - lb(i) <= LOOKUP_ACTIVE_TOL * (1.0 + std::abs(lb(i))))
+      active_set |= (uint64_t)1 << i;
+    else if (ub(i) - F(i) <= LOOKUP_ACTIVE_TOL * (1.0 + std::abs(ub(i))))
+      active_set |= (uint64_t)1 << (12 + i);
+  }
+  for (int r=0; r<4*(n/3); r++)
+  {
+    const Eigen::Vector3d& F_leg = F.segment<3>(3*(r/4));
+    if (ubC(r) - C_blocks.row(r).dot(F_leg) <= LOOKUP_ACTIVE_TOL * (1.0 + F_leg.cwiseAbs().maxCoeff()))
+      active_set |= (uint64_t)1 << (24 + r);
+  }
+
+  // at fz = fz_max the tangential bounds +-mu*fz_max meet the cone, which then is active with them.
+  // the bounds are dependent on the cone rows and fz bound there and are left out
+  for (int l=0; l<n/3; l++)
+  {
+    for (int j=0; j<2; j++)
+    {
+      uint64_t cone_upper = (uint64_t)1 << (24 + 4*l + 2*j);
+      uint64_t cone_lower = (uint64_t)1 << (24 + 4*l + 2*j + 1);
+      if (active_set & cone_upper)
+        active_set &= ~((uint64_t)1 << (12 + 3*l + j));
+      if (active_set & cone_lower)
+        active_set &= ~((uint64_t)1 << (3*l + j));
+    }
+  }
+
+  return active_set;
+}
+
+void BalanceLookup::insert(int mask, uint64_t active_set)
+{
+  std::vector<uint64_t>& regions = _regions[mask & 15];
+
+  // more active constraints than forces can not be a region
+  int n = 0;
+  for (int i=0; i<4; i++)
+    n += (mask >> i) & 1;
+  if (countBits(active_set) > 3*n || _max_regions == 0)
+    return;
+
+  std::vector<uint64_t>::iterator it = std::find(regions.begin(), regions.end(), active_set);
+  if (it == regions.end())
+  {
+    if (regions.size() == (size_t)_max_regions)
+      regions.pop_back();
+    regions.insert(regions.begin(), active_set);
+  }
+  else
+  {
+    std::rotate(regions.begin(), it, it + 1);
+  }
+}
+
+bool BalanceLookup::save(const std::string& file_name) const
+{
+  std::ofstream file(file_name.c_str());
+  if (!file.is_open())
+    return false;
+
+  file << "# stance mask, active set (balance_lookup.h)" << std::endl;
+  for (size_t mask=0; mask<_regions.size(); mask++)
+  {
+    for (size_t k=0; k<_regions[mask].size(); k++)
+      file << std::hex << mask << " " << _regions[mask][k] << std::endl;
+  }
+
+  return file.good();
+}
+
+bool BalanceLookup::load(const std::string& file_name)
+{
+  std::ifstream file(file_name.c_str());
+  if (!file.is_open())
+    return false;
+
+  clear();
+
+  std::string line;
+  while (std::getline(file, line))
+  {
+    line = line.substr(0, line.find('#'));
+    if (line.find_first_not_of(" \t\r") == std::string::npos)
+      continue;
+
+    std::istringstream values(line);
+    int mask;
+    uint64_t active_set;
+    values >> std::hex >> mask >> active_set;
+    if (values.fail() || mask < 0 || mask > 15)
+      return false;
+
+    // file is ordered by recency like the table
+    if (_regions[mask].size() < (size_t)_max_regions)
+      _regions[mask].push_back(active_set);
+  }
+
+  return true;
+}
@@ -0,0 +1,236 @@
+/*
+  Author: Modulabs
+  File Name: behavior_tree.cpp
+*/
+
+#include "legged_robot_controller/behavior_tree.h"
+
+#include <fstream>
+#include <sstream>
+
+
+namespace behavior_tree
+{
+namespace
+{
+  struct ParsedNode
+  {
+    int _depth;
+    NodeType _type;
+    int _leaf;
+    std::vector<int> _children;
+  };
+
+  bool toNodeType(const std::string& name, NodeType& type)
+  {
+    if (name == "sequence")       type = Sequence;
+    else if (name == "selector")  type = Selector;
+    else if (name == "inverter")  type = Inverter;
+    else if (name == "condition") type = Condition;
+    else if (name == "action")    type = Action;
+    else return false;
+
+    return true;
+  }
+}
+
+BehaviorTree::BehaviorTree()
+{
+  _nodes.reserve(BT_MAX_NODES);
+}
+
+void BehaviorTree::registerLeaf(const std::string& name, const LeafFunction& function)
+{
+  for (size_t i=0; i<_leaf_names.size(); i++)
+  {
+    if (_leaf_names[i] == name)
+    {
+      _leaf_functions[i] = function;
+      return;
+    }
+  }
+
+  _leaf_names.push_back(name);
+  _leaf_functions.push_back(function);
+}
+
+bool BehaviorTree::loadFile(const std::string& file_name)
+{
+  std::ifstream file(file_name.c_str());
+  if (!file.is_open())
+  {
+    _error = "cannot open " + file_name;
+    return false;
+  }
+
+  std::stringstream text;
+  text << file.rdbuf();
+
+  return loadString(text.str());
+}
+
+bool BehaviorTree::loadString(const std::string& text)
+{
+  clear();
+
+  // parse lines
+  std::vector<ParsedNode> parsed;
+  std::vector<int> stack;   // last node of each depth
+  std::istringstream lines(text);
+  std::string line;
+
+  for (int line_num=1; std::getline(lines, line); line_num++)
+  {
+    std::ostringstream where;
+    where << "line " << line_num << ": ";
+
+    line = line.substr(0, line.find('#'));
+    size_t indent = line.find_first_not_of(' ');
+    if (indent == std::string::npos)
+      continue;
+
+    std::istringstream tokens(line);
+    std::string type_name, leaf_name;
+    tokens >> type_name >> leaf_name;
+
+    ParsedNode node;
+    node._depth = indent / 2;
+    node._leaf = -1;
+
+    if (indent % 2 != 0 || node._depth > (int)stack.size() || (parsed.size() > 0 && node._depth == 0))
+    {
+      _error = where.str() + "wrong indentation";
+      return false;
+    }
+    if (node._depth >= BT_MAX_DEPTH || parsed.size() >= BT_MAX_NODES)
+    {
+      _error = where.str() + "tree is too large";
+      return false;
+    }
+    if (!toNodeType(type_name, node._type))
+    {
+      _error = where.str() + "unknown node type " + type_name;
+      return false;
+    }
+
+    if (node._type == Condition || node._type == Action)
+    {
+      for (size_t i=0; i<_leaf_names.size(); i++)
+      {
+        if (_leaf_names[i] == leaf_name)
+          node._leaf = i;
+      }
+
+      if (node._leaf < 0)
+      {
+        _error = where.str() + "unknown leaf " + leaf_name;
+        return false;
+      }
+    }
+
+    if (node._depth > 0)
+    {
+      ParsedNode& parent = parsed[stack[node._depth - 1]];
+      if (parent._type == Condition || parent._type == Action || (parent._type == Inverter && parent._children.size() > 0))
+      {
+        _error = where.str() + "too many children";
+        return false;
+      }
+      parent._children.push_back(parsed.size());
+    }
+
+    stack.resize(node._depth);
+    stack.push_back(parsed.size());
+    parsed.push_back(node);
+  }
+
+  if (parsed.empty())
+  {
+    _error = "empty tree";
+    return false;
+  }
+
+  for (size_t i=0; i<parsed.size(); i++)
+  {
+    if (parsed[i]._leaf < 0 && parsed[i]._children.empty())
+    {
+      _error = "composite node without children";
+      return false;
+    }
+  }
+
+  // breadth first layout in the arena, so that children are contiguous
+  std::vector<int> order(1, 0);
+  for (size_t k=0; k<order.size(); k++)
+  {
+    const ParsedNode& p = parsed[order[k]];
+
+    Node node;
+    node._type = p._type;
+    node._first_child = order.size();
+    node._n_child = p._children.size();
+    node._leaf = p._leaf;
+    _nodes.push_back(node);
+
+    order.insert(order.end(), p._children.begin(), p._children.end());
+  }
+
+  return true;
+}
+
+void BehaviorTree::clear()
+{
+  _nodes.clear();   // keeps capacity of the arena
+  _error.clear();
+}
+
+Status BehaviorTree::tick()
+{
+  if (_nodes.empty())
+    return Failure;
+
+  return tickNode(0);
+}
+
+Status BehaviorTree::tickNode(int i)
+{
+  const Node& node = _nodes[i];
+  Status status;
+
+  switch (node._type)
+  {
+  case Sequence:
+    for (int c=node._first_child; c<node._first_child + node._n_child; c++)
+    {
+      status = tickNode(c);
+      if (status != Success)
+        return status;
+    }
+    return Success;
+
+  case Selector:
+    for (int c=node._first_child; c<node._first_child + node._n_child; c++)
+    {
+      status = tickNode(c);
+      if (status != Failure)
+        return status;
+    }
+    return Failure;
+
+  case Inverter:
+    status = tickNode(node._first_child);
+    if (status == Success)
+      return Failure;
+    else if (status == Failure)
+      return Success;
+    return status;
+
+  case Condition:
+  case Action:
+    return _leaf_functions[node._leaf]();
+
+  default:
+    return Failure;
+  }
+}
+}
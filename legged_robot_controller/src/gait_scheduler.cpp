@@ -0,0 +1,123 @@
+/*
+  Author: Modulabs
+  File Name: gait_scheduler.cpp
+*/
+
+#include "legged_robot_controller/gait_scheduler.h"
+
+using namespace quadruped_robot;
+
+
+GaitScheduler::GaitScheduler()
+{
+  _gait = &_table[gait_patterns::Standing];
+  _t_start = 0;
+  _phase.fill(0);
+}
+
+void GaitScheduler::init()
+{
+  // non-moving patterns keep all legs on the ground
+  std::array<double, 4> zero_lag = {0, 0, 0, 0};
+  setGaitTable(gait_patterns::Falling, 1.0, 1.0, zero_lag);
+  setGaitTable(gait_patterns::Standing, 1.0, 1.0, zero_lag);
+  setGaitTable(gait_patterns::Manipulation, 1.0, 1.0, zero_lag);
+
+  // phase lag of lf, rf, lh, rh
+  std::array<double, 4> walk_lag = {0, 0.5, 0.75, 0.25};   // lh -> lf -> rh -> rf
+  std::array<double, 4> pace_lag = {0, 0.5, 0, 0.5};       // left pair, right pair
+  std::array<double, 4> trot_lag = {0, 0.5, 0.5, 0};       // diagonal pairs
+  std::array<double, 4> bound_lag = {0, 0, 0.5, 0.5};      // front pair, hind pair
+  std::array<double, 4> gallop_lag = {0, 0.2, 0.55, 0.75};
+  std::array<double, 4> pronk_lag = {0, 0, 0, 0};
+
+  setGaitTable(gait_patterns::Walking, 1.25, 0.8, walk_lag);
+  setGaitTable(gait_patterns::Pacing, 0.6, 0.6, pace_lag);
+  setGaitTable(gait_patterns::Trotting, 0.6, 0.6, trot_lag);
+  setGaitTable(gait_patterns::Bounding, 0.4, 0.4, bound_lag);
+  setGaitTable(gait_patterns::Galloping, 0.4, 0.3, gallop_lag);
+  setGaitTable(gait_patterns::Pronking, 0.4, 0.4, pronk_lag);
+}
+
+void GaitScheduler::setGaitTable(gait_patterns::GaitPattern gait_pattern,
+                                 double T_stride, double duty, const std::array<double, 4>& phase_lag)
+{
+  GaitTable& table = _table[gait_pattern];
+
+  table._T_stride = T_stride;
+  table._duty = duty;
+
+  // phase = base phase - lag, add 1 so that the phase stays positive before wrapping
+  for (size_t i=0; i<4; i++)
+    table._offset[i] = 1.0 - phase_lag[i];
+
+  table._inv_T_stride = 1.0 / T_stride;
+  table._inv_duty = 1.0 / duty;
+  table._inv_swing = (duty < 1.0) ? 1.0 / (1.0 - duty) : 0.0;
+  table._T_stance = duty * T_stride;
+  table._T_swing = (1.0 - duty) * T_stride;
+}
+
+void GaitScheduler::start(gait_patterns::GaitPattern gait_pattern, double t_start)
+{
+  _gait = &_table[gait_pattern];
+  _t_start = t_start;
+}
+
+void GaitScheduler::update(double t, QuadrupedRobot& robot)
+{
+  const GaitTable& g = *_gait;
+  double s = (t - _t_start) * g._inv_T_stride;
+
+  for (size_t i=0; i<4; i++)
+  {
+    double phase = s + g._offset[i];
+    phase -= std::floor(phase);
+
+    // no branch: contact is 0 or 1 and selects between stance and swing values
+    int contact = phase < g._duty;
+    double S_stance = phase * g._inv_duty;
+    double S_swing = (phase - g._duty) * g._inv_swing;
+
+    _phase[i] = phase;
+    robot._t_leg[i] = phase * g._T_stride;
+    robot._T_stance[i] = g._T_stance;
+    robot._T_swing[i] = g._T_swing;
+    robot._S_stance[i] = contact * S_stance + (1 - contact);
+    robot._S_swing[i] = (1 - contact) * S_swing;
+    robot._contact_states_d[i] = contact;
+  }
+}
+
+int GaitScheduler::getContactMask(double t) const
+{
+  const GaitTable& g = *_gait;
+  double s = (t - _t_start) * g._inv_T_stride;
+  int mask = 0;
+
+  for (size_t i=0; i<4; i++)
+  {
+    double phase = s + g._offset[i];
+    phase -= std::floor(phase);
+    mask |= (phase < g._duty) << i;
+  }
+
+  return mask;
+}
+
+void GaitScheduler::getContactLookahead(double t, double dt, int n_step, std::array<int, 4>* contacts) const
+{
+  const GaitTable& g = *_gait;
+  double s = (t - _t_start) * g._inv_T_stride;
+  double ds = dt * g._inv_T_stride;
+
+  for (int k=0; k<n_step; k++, s+=ds)
+  {
+    for (size_t i=0; i<4; i++)
+    {
+      double phase = s + g._offset[i];
+      phase -= std::floor(phase);
+      contacts[k][i] = phase < g._duty;
+    }
+  }
+}
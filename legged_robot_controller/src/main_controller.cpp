@@ -151,32 +151,95 @@ bool MainController::init(hardware_interface::EffortJointInterface *hw, ros::Nod
   _robot._I_com_body.diagonal() << 1.5725937, 8.5015928, 9.1954911;
   _robot._p_body2com = Eigen::Vector3d(0.056, 0.0215, 0.00358);
 
-  // Controllers
+  // Controllers, QP backend of each is qpOASES unless given
+  qp_solver::backends::Backend balance_backend = qp_solver::backends::QPOASES;
+  qp_solver::backends::Backend mpc_backend = qp_solver::backends::QPOASES;
+  std::string backend_name;
+  if (n.getParam("balance_controller/qp_backend", backend_name) && !qp_solver::backends::BackendFromString(backend_name, balance_backend))
+    ROS_WARN("Unknown QP backend %s, using qpOASES", backend_name.c_str());
+  if (n.getParam("mpc_controller/qp_backend", backend_name) && !qp_solver::backends::BackendFromString(backend_name, mpc_backend))
+    ROS_WARN("Unknown QP backend %s, using qpOASES", backend_name.c_str());
+
+  bool balance_equilibration, mpc_equilibration;
+  n.param("balance_controller/qp_equilibration", balance_equilibration, false);
+  n.param("mpc_controller/qp_equilibration", mpc_equilibration, false);
+
   _virtual_spring_damper_controller.init();
-  _balance_controller.init();
-  _mpc_controller.init();
+  _balance_controller.init(balance_backend, balance_equilibration);
+  std::string lookup_table_file;
+  if (n.getParam("balance_controller/lookup_table", lookup_table_file) && !_balance_controller.loadLookupTable(lookup_table_file))
+    ROS_WARN("Failed to load balance lookup table %s", lookup_table_file.c_str());
+  _mpc_controller.init(mpc_backend, mpc_equilibration);
   _mpc_controller._step = 0;
 
+  // horizon of the mpc controller and its inputs over it, an input per step unless given
+  std::string input_parameterisation_name;
+  mpc_inputs::Parameterisation input_parameterisation = mpc_inputs::FULL;
+  int n_input;
+  std::vector<int> move_blocks;
+  n.param("mpc_controller/horizon", _mpc_controller._n_step, MPC_Step);
+  if (_mpc_controller._n_step < 1)
+  {
+    ROS_ERROR("MPC horizon of %d steps is not positive, using %d", _mpc_controller._n_step, MPC_Step);
+    _mpc_controller._n_step = MPC_Step;
+  }
+  n.param("mpc_controller/inputs", n_input, _mpc_controller._n_step);
+  if (n.getParam("mpc_controller/move_blocks", move_blocks) && !mpc_inputs::MoveBlocksValid(move_blocks, _mpc_controller._n_step))
+  {
+    ROS_WARN("MPC move blocks do not split the horizon of %d steps, using blocks of equal length", _mpc_controller._n_step);
+    move_blocks.clear();
+  }
+  if (n.getParam("mpc_controller/input_parameterisation", input_parameterisation_name) &&
+      !mpc_inputs::ParameterisationFromString(input_parameterisation_name, input_parameterisation))
+    ROS_WARN("Unknown MPC input parameterisation %s, using full", input_parameterisation_name.c_str());
+  _mpc_controller.setInputParameterisation(input_parameterisation, n_input, move_blocks);
+
+  std::string qp_options_file;
+  if (n.getParam("balance_controller/qp_options", qp_options_file) && !_balance_controller.loadQPOptions(qp_options_file))
+    ROS_WARN("Failed to load QP options %s for the balance controller", qp_options_file.c_str());
+  if (n.getParam("mpc_controller/qp_options", qp_options_file) && !_mpc_controller.loadQPOptions(qp_options_file))
+    ROS_WARN("Failed to load QP options %s for the mpc controller", qp_options_file.c_str());
+
+  // QP instances to disk for qp_replay_bench, off unless a directory is given
+  std::string qp_dump_directory;
+  int qp_dump_interval;
+  n.param("balance_controller/qp_dump_interval", qp_dump_interval, QP_DUMP_INTERVAL);
+  if (n.getParam("balance_controller/qp_dump", qp_dump_directory) && !_balance_controller.dumpQPs(qp_dump_directory, qp_dump_interval))
+    ROS_WARN("Failed to open QP dump directory %s", qp_dump_directory.c_str());
+  n.param("mpc_controller/qp_dump_interval", qp_dump_interval, QP_DUMP_INTERVAL);
+  if (n.getParam("mpc_controller/qp_dump", qp_dump_directory) && !_mpc_controller.dumpQPs(qp_dump_directory, qp_dump_interval))
+    ROS_WARN("Failed to open QP dump directory %s", qp_dump_directory.c_str());
+
   // First Motion Plan
   _motion_planner.init(&_robot);
+
+  std::string behavior_tree_file;
+  if (n.getParam("motion_planner/behavior_tree", behavior_tree_file))
+    _motion_planner.loadBehaviorTree(behavior_tree_file);
   _robot._gait_pattern = quadruped_robot::gait_patterns::Falling;
-  _motion_planner.update();
+  _motion_planner.update(0.0);
 //  _robot.setController(4, quadruped_robot::controllers::VirtualSpringDamper);
 //  for (size_t i = 0; i < 4; i++)
 //    _robot._p_body2leg_d[i] = Vector3d(0, 0, -0.4);
 
-  // trajectory control points
-  std::vector<Vector2d> pnts(4);
-  pnts[0](0) = -0.3; pnts[0](1) = -0.5;
-  pnts[1](0) = -0.3; pnts[1](1) = -0.3;
-  pnts[2](0) = 0.3; pnts[2](1) = -0.3;
-  pnts[3](0) = 0.3; pnts[3](1) = -0.5;
-  _swing_traj.setPoints(pnts);
-
-  pnts.resize(2);
-  pnts[0](0) = 0.3; pnts[0](1) = -0.5;
-  pnts[1](0) = -0.3; pnts[1](1) = -0.5;
-  _stance_traj.setPoints(pnts);
+  // trajectory control points, x and z of leg in body frame
+  std::array<Vector3d, 4> swing_pnts;
+  swing_pnts[0] = Vector3d(-0.3, 0, -0.5);
+  swing_pnts[1] = Vector3d(-0.3, 0, -0.3);
+  swing_pnts[2] = Vector3d(0.3, 0, -0.3);
+  swing_pnts[3] = Vector3d(0.3, 0, -0.5);
+  _swing_traj.setPoints(swing_pnts);
+
+  std::array<Vector3d, 2> stance_pnts;
+  stance_pnts[0] = Vector3d(0.3, 0, -0.5);
+  stance_pnts[1] = Vector3d(-0.3, 0, -0.5);
+  _stance_traj.setPoints(stance_pnts);
+
+  // sample trajectories once, evaluated by interpolation in update()
+  int traj_resolution;
+  n.param("trajectory/resolution", traj_resolution, 50);
+  _swing_table.build(_swing_traj, traj_resolution);
+  _stance_table.build(_stance_traj, traj_resolution);
   
   return true;
 }
@@ -348,6 +411,8 @@ bool MainController::srvUICommand(legged_robot_msgs::UICommand::Request &request
       _motion_planner.setGaitPattern(quadruped_robot::gait_patterns::Bounding);
     else if (subCommand == "galloping")
       _motion_planner.setGaitPattern(quadruped_robot::gait_patterns::Galloping);
+    else if (subCommand == "pronking")
+      _motion_planner.setGaitPattern(quadruped_robot::gait_patterns::Pronking);
 
     response.result = true;
     return true;
@@ -483,12 +548,37 @@ void MainController::update(const ros::Time &time, const ros::Duration &period)
   //  _state_estimation.update(_robot);
 
   // Motion Planner
-  _motion_planner.update();
+  _motion_planner.update(_t);
 
   // @TODO: Trajectory Generation, update trajectory - get from this initial state(temporary)
 
   // _trajectory_generator.update(_robot);
 
+  // swing legs of moving gait
+  if (quadruped_robot::gait_patterns::isMoving(_robot._gait_pattern))
+  {
+    for (size_t i = 0; i < 4; i++)
+    {
+      if (_robot._contact_states_d[i] == 0)
+      {
+        // footstep half a stance ahead along the desired body velocity (Raibert), follows the command while swinging
+        Vector3d v_body_d = _robot._pose_body_d._rot_quat.conjugate() * _robot._pose_vel_body_d._linear;
+        Vector3d p_footstep = _swing_table.getEndPoint();
+        p_footstep(0) += 0.5 * _robot._T_stance[i] * v_body_d(0);
+        _swing_table.retarget(_robot._S_swing[i], p_footstep, _swing_correction[i]);
+
+        Vector3d p_swing, v_swing, a_swing;
+        _swing_table.getPoint(_robot._S_swing[i], _swing_correction[i], p_swing, v_swing, a_swing);
+        _robot._p_body2leg_d[i](0) = p_swing(0);
+        _robot._p_body2leg_d[i](2) = p_swing(2);
+      }
+      else
+      {
+        _swing_correction[i].reset();   // footstep is re-targeted for each swing
+      }
+    }
+  }
+
 
 #undef SWING_CONTROL_TEST
 #ifdef SWING_CONTROL_TEST
@@ -548,16 +638,14 @@ void MainController::update(const ros::Time &time, const ros::Duration &period)
         _robot._S_swing[i] = 1;
       }
 
+      Vector3d p_traj, v_traj, a_traj;
       if (_robot._contact_states[i] == 0)
-      {
-        _robot._p_body2leg_d[i](0) = _swing_traj.getPoint(_robot._S_swing[i])(0);
-        _robot._p_body2leg_d[i](2) = _swing_traj.getPoint(_robot._S_swing[i])(1);
-      }
+        _swing_table.getPoint(_robot._S_swing[i], p_traj, v_traj, a_traj);
       else
-      {
-        _robot._p_body2leg_d[i](0) = _stance_traj.getPoint(_robot._S_stance[i])(0);
-        _robot._p_body2leg_d[i](2) = _stance_traj.getPoint(_robot._S_stance[i])(1);
-      }
+        _stance_table.getPoint(_robot._S_stance[i], p_traj, v_traj, a_traj);
+
+      _robot._p_body2leg_d[i](0) = p_traj(0);
+      _robot._p_body2leg_d[i](2) = p_traj(2);
     }
 
     _robot.setController(4, quadruped_robot::controllers::VirtualSpringDamper);
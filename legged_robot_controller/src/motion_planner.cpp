@@ -1,5 +1,42 @@
 #include "legged_robot_controller/motion_planner.h"
 
+using namespace behavior_tree;
+
+bool MotionPlanner::loadBehaviorTree(const std::string& file_name)
+{
+  // conditions
+  _behavior_tree.registerLeaf("is_falling", [this]() {
+    return _robot->_gait_pattern == quadruped_robot::gait_patterns::Falling ? Success : Failure; });
+  _behavior_tree.registerLeaf("is_standing", [this]() {
+    return _robot->_gait_pattern == quadruped_robot::gait_patterns::Standing ? Success : Failure; });
+  _behavior_tree.registerLeaf("is_manipulation", [this]() {
+    return _robot->_gait_pattern == quadruped_robot::gait_patterns::Manipulation ? Success : Failure; });
+  _behavior_tree.registerLeaf("is_moving", [this]() {
+    return quadruped_robot::gait_patterns::isMoving(_robot->_gait_pattern) ? Success : Failure; });
+  _behavior_tree.registerLeaf("is_gait_start", [this]() {
+    return _robot->_gait_pattern_start ? Success : Failure; });
+
+  // actions
+  _behavior_tree.registerLeaf("update_falling", [this]() {
+    updateFalling(); return Success; });
+  _behavior_tree.registerLeaf("start_standing", [this]() {
+    startStanding(); _robot->_gait_pattern_start = false; return Success; });
+  _behavior_tree.registerLeaf("update_standing", [this]() {
+    updateStanding(); return Success; });
+  _behavior_tree.registerLeaf("start_moving", [this]() {
+    startMoving(); _robot->_gait_pattern_start = false; return Success; });
+  _behavior_tree.registerLeaf("update_moving", [this]() {
+    updateMoving(); return Success; });
+
+  if (!_behavior_tree.loadFile(file_name))
+  {
+    ROS_ERROR("[Motion Planner] Failed to load behavior tree, %s", _behavior_tree.getError().c_str());
+    return false;
+  }
+
+  ROS_INFO("[Motion Planner] Load behavior tree %s (%zu nodes)", file_name.c_str(), _behavior_tree.size());
+  return true;
+}
 
 void MotionPlanner::setGaitPattern(quadruped_robot::gait_patterns::GaitPattern gait_pattern, int int_param)
 {
@@ -8,9 +45,17 @@ void MotionPlanner::setGaitPattern(quadruped_robot::gait_patterns::GaitPattern g
   _robot->_gait_pattern_start = true;
 }
 
-void MotionPlanner::update()
+void MotionPlanner::update(double t)
 {
-  // to do: make below structure to behavior tree
+  _t = t;
+
+  if (_behavior_tree.isLoaded())
+  {
+    _behavior_tree.tick();
+    return;
+  }
+
+  // without behavior tree
   switch(_robot->_gait_pattern)
   {
   case quadruped_robot::gait_patterns::Falling:
@@ -33,6 +78,11 @@ void MotionPlanner::update()
   case quadruped_robot::gait_patterns::Bounding:
   case quadruped_robot::gait_patterns::Galloping:
   case quadruped_robot::gait_patterns::Pronking:
+    if (_robot->_gait_pattern_start)
+    {
+      startMoving();
+      _robot->_gait_pattern_start = false;
+    }
     updateMoving();
     break;
   default:
@@ -69,7 +119,24 @@ void MotionPlanner::updateStanding()
 
 }
 
+void MotionPlanner::startMoving()
+{
+  ROS_INFO("[Motion Planner] Start Moving");
+
+  _gait_scheduler.start(_robot->_gait_pattern, _t);
+}
+
 void MotionPlanner::updateMoving()
 {
   // gait pattern modulator
+  _gait_scheduler.update(_t, *_robot);
+
+  // stance legs balance the body, swing legs follow the swing trajectory
+  for (size_t i=0; i<4; i++)
+  {
+    if (_robot->_contact_states_d[i] == 1)
+      _robot->setController(i, quadruped_robot::controllers::BalancingQP);
+    else
+      _robot->setController(i, quadruped_robot::controllers::VirtualSpringDamper);
+  }
 }
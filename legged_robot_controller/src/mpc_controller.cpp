@@ -5,8 +5,75 @@
 
 #include "legged_robot_controller/mpc_controller.h"
 
+#include <algorithm>
+#include <cmath>
 
-void MPCController::init() {}
+
+void MPCController::init(qp_solver::backends::Backend backend, bool equilibrate)
+{
+    _qp_solver.reset(qp_solver::createSolver(backend, equilibrate));
+    cal_ZOH();
+}
+
+void MPCController::setInputParameterisation(mpc_inputs::Parameterisation parameterisation, int n_input,
+                                             const std::vector<int>& move_blocks)
+{
+    _input_parameterisation = parameterisation;
+    _n_input = n_input;
+    _move_blocks = move_blocks;
+}
+
+void MPCController::cal_W_input()
+{
+    const int n_input = std::max(1, std::min(_n_input, _n_step));
+
+    switch (_input_parameterisation)
+    {
+    case mpc_inputs::BLOCKING:
+    {
+        // given steps per block, or blocks of equal length with the longer ones at the end
+        std::vector<int> blocks = _move_blocks;
+        if (!mpc_inputs::MoveBlocksValid(blocks, _n_step))
+        {
+            blocks.assign(n_input, _n_step / n_input);
+            for (int j = 0; j < _n_step % n_input; j++)
+                blocks[n_input - 1 - j]++;
+        }
+
+        _W_input = Eigen::MatrixXd::Zero(_n_step, blocks.size());
+        int k = 0;
+        for (size_t j = 0; j < blocks.size(); j++)
+            for (int l = 0; l < blocks[j]; l++)
+                _W_input(k++, j) = 1.0;
+        break;
+    }
+
+    case mpc_inputs::LINEAR:
+    {
+        // knots spread evenly from the first to the last step, hat functions between them
+        _W_input = Eigen::MatrixXd::Zero(_n_step, n_input);
+        if (n_input == 1)
+        {
+            _W_input.setOnes();
+            break;
+        }
+
+        const double spacing = (double)(_n_step - 1) / (n_input - 1);
+        for (int k = 0; k < _n_step; k++)
+        {
+            const double t = k / spacing;
+            const int j = std::min((int)t, n_input - 2);
+            _W_input(k, j) = (j + 1) - t;
+            _W_input(k, j + 1) = t - j;
+        }
+        break;
+    }
+
+    default:
+        _W_input = Eigen::MatrixXd::Identity(_n_step, _n_step);
+        break;
+    }
+}
 
 void MPCController::setControlData(quadruped_robot::QuadrupedRobot &robot)
 {
@@ -44,12 +111,11 @@ void MPCController::setControlData(quadruped_robot::QuadrupedRobot &robot)
     if (_LegContactState.ContactTotalNum < 1)
         return;
 
-    // Matrix Resize according to LegContactState
-    _R1 = Eigen::MatrixXd::Zero(3, 3);
-    _R2 = Eigen::MatrixXd::Zero(3, 3);
-    _R3 = Eigen::MatrixXd::Zero(3, 3);
-    _R4 = Eigen::MatrixXd::Zero(3, 3);
+    // Inputs of the QP over the horizon
+    cal_W_input();
+    int n_input = _W_input.cols();
 
+    // Matrix Resize according to LegContactState
     _A_d = Eigen::MatrixXd::Zero(15, 15);    
     _B_d = Eigen::MatrixXd::Zero(15, 3*_LegContactState.ContactTotalNum);
     _B_d_d = Eigen::MatrixXd::Zero(15, 3*_LegContactState.ContactTotalNum);
@@ -63,48 +129,36 @@ void MPCController::setControlData(quadruped_robot::QuadrupedRobot &robot)
     _I_hat = Eigen::MatrixXd::Zero(3, 3);
     _I_hat_d = Eigen::MatrixXd::Zero(3, 3);
 
-    _p_leg_1_skew = Eigen::MatrixXd::Zero(3, 3);
-    _p_leg_2_skew = Eigen::MatrixXd::Zero(3, 3);
-    _p_leg_3_skew = Eigen::MatrixXd::Zero(3, 3);
-    _p_leg_4_skew = Eigen::MatrixXd::Zero(3, 3);
-
-    _p_leg_1_skew_d = Eigen::MatrixXd::Zero(3, 3);
-    _p_leg_2_skew_d = Eigen::MatrixXd::Zero(3, 3);
-    _p_leg_3_skew_d = Eigen::MatrixXd::Zero(3, 3);
-    _p_leg_4_skew_d = Eigen::MatrixXd::Zero(3, 3); 
-
-    _A_qp = Eigen::MatrixXd::Zero(15 * (MPC_Step + 1), 15);
+    _A_qp = Eigen::MatrixXd::Zero(15 * (_n_step + 1), 15);
     _Temp = Eigen::MatrixXd::Zero(15, 15);
 
-    _B_qp = Eigen::MatrixXd::Zero(15 * (MPC_Step + 1), 3*_LegContactState.ContactTotalNum*MPC_Step);
+    _B_qp = Eigen::MatrixXd::Zero(15 * (_n_step + 1), 3*_LegContactState.ContactTotalNum*n_input);
+    _LB_qp = Eigen::MatrixXd::Zero(15 * (_n_step + 1), 3*_LegContactState.ContactTotalNum*n_input);
 
     _L_d = Eigen::MatrixXd::Identity(15, 15);
     _K_d = Eigen::MatrixXd::Identity(3*_LegContactState.ContactTotalNum, 3*_LegContactState.ContactTotalNum);
 
-    _H_qp = Eigen::MatrixXd::Zero(3*_LegContactState.ContactTotalNum * MPC_Step, 3*_LegContactState.ContactTotalNum * MPC_Step);
-    _L_qp = Eigen::MatrixXd::Zero(15 * (MPC_Step + 1), 15 * (MPC_Step + 1));
-    _K_qp = Eigen::MatrixXd::Zero(3*_LegContactState.ContactTotalNum * MPC_Step, 3*_LegContactState.ContactTotalNum * MPC_Step);   
+    _H_qp = Eigen::MatrixXd::Zero(3*_LegContactState.ContactTotalNum * n_input, 3*_LegContactState.ContactTotalNum * n_input);
+    _K_qp = Eigen::MatrixXd::Zero(3*_LegContactState.ContactTotalNum * n_input, 3*_LegContactState.ContactTotalNum * n_input);   
 
-    _g_qp = Eigen::MatrixXd::Zero(3*_LegContactState.ContactTotalNum*MPC_Step, 1);
+    _g_qp = Eigen::MatrixXd::Zero(3*_LegContactState.ContactTotalNum*n_input, 1);
     _x0 = Eigen::MatrixXd::Zero(15, 1);
     _xref = Eigen::MatrixXd::Zero(15, 1);
-    _xref_qp = Eigen::MatrixXd::Zero(15 * (MPC_Step + 1), 1);    
+    _xref_qp = Eigen::MatrixXd::Zero(15 * (_n_step + 1), 1);    
 
     _C_1leg = Eigen::MatrixXd::Zero(4, 3);
-    _C_totalleg = Eigen::MatrixXd::Zero(4 * _LegContactState.ContactTotalNum, 3);
-    _C_qp = Eigen::MatrixXd::Zero(4 * _LegContactState.ContactTotalNum * MPC_Step, 3 * MPC_Step);
+    _C_blocks = Eigen::MatrixXd::Zero(4 * _LegContactState.ContactTotalNum * n_input, 3);
 
     _lbC_1leg = Eigen::MatrixXd::Zero(4, 1);
-    _lbC_totalleg = Eigen::MatrixXd::Zero(4 * _LegContactState.ContactTotalNum, 1);
-    _lbC_qp = Eigen::MatrixXd::Zero(4 * _LegContactState.ContactTotalNum * MPC_Step, 1);
+    _lbC_qp = Eigen::MatrixXd::Zero(4 * _LegContactState.ContactTotalNum * n_input, 1);
 
     _ub_1leg = Eigen::MatrixXd::Zero(3, 1);
     _ub_totalleg = Eigen::MatrixXd::Zero(3 * _LegContactState.ContactTotalNum, 1);
-    _ub_qp = Eigen::MatrixXd::Zero(3 * _LegContactState.ContactTotalNum * MPC_Step, 1);
+    _ub_qp = Eigen::MatrixXd::Zero(3 * _LegContactState.ContactTotalNum * n_input, 1);
 
     _lb_1leg = Eigen::MatrixXd::Zero(3, 1);
     _lb_totalleg = Eigen::MatrixXd::Zero(3 * _LegContactState.ContactTotalNum, 1);
-    _lb_qp = Eigen::MatrixXd::Zero(3 * _LegContactState.ContactTotalNum * MPC_Step, 1);
+    _lb_qp = Eigen::MatrixXd::Zero(3 * _LegContactState.ContactTotalNum * n_input, 1);
 }
 
 void MPCController::calControlInput()
@@ -129,30 +183,21 @@ void MPCController::calControlInput()
     _I_hat = _Rz * _I_hat * _Rz.transpose();
     _I_hat_d = _Rz_d * _I_hat * _Rz_d.transpose();
 
-    _p_leg_1_skew = skew(_p_leg[0] - _p_com);
-    _p_leg_2_skew = skew(_p_leg[1] - _p_com);
-    _p_leg_3_skew = skew(_p_leg[2] - _p_com);
-    _p_leg_4_skew = skew(_p_leg[3] - _p_com);
-
-    _R1 = _I_hat.inverse() * _p_leg_1_skew;
-    _R2 = _I_hat.inverse() * _p_leg_2_skew;
-    _R3 = _I_hat.inverse() * _p_leg_3_skew;
-    _R4 = _I_hat.inverse() * _p_leg_4_skew;
+    // I^-1 [p_leg - p_com], inverse once and without forming skew matrices
+    const Eigen::Matrix3d I_hat_inv = Eigen::Matrix3d(_I_hat).inverse();
+    const Eigen::Matrix3d I_hat_d_inv = Eigen::Matrix3d(_I_hat_d).inverse();
 
-    _p_leg_1_skew_d = skew(_p_leg_d[0] - _p_com_d);
-    _p_leg_2_skew_d = skew(_p_leg_d[1] - _p_com_d);
-    _p_leg_3_skew_d = skew(_p_leg_d[2] - _p_com_d);
-    _p_leg_4_skew_d = skew(_p_leg_d[3] - _p_com_d);
-
-    _R1_d = _I_hat_d.inverse() * _p_leg_1_skew_d;
-    _R2_d = _I_hat_d.inverse() * _p_leg_2_skew_d;
-    _R3_d = _I_hat_d.inverse() * _p_leg_3_skew_d;
-    _R4_d = _I_hat_d.inverse() * _p_leg_4_skew_d;
+    for (int i = 0; i < 4; i++)
+    {
+        _R_leg[i] = so3::mulHat(I_hat_inv, _p_leg[i] - _p_com);
+        _R_leg_d[i] = so3::mulHat(I_hat_d_inv, _p_leg_d[i] - _p_com_d);
+    }
 
-    // Discrete Simplified Robot Dynamics x[k+1] = A_c*x[k] + B_c*u[k]
+    // Discrete Simplified Robot Dynamics x[k+1] = A_d*x[k] + B_d*u[k]
 
     cal_A_d();
-    cal_B_d_and_B_d_d();
+    cal_B_d(_Rz, _R_leg, _B_d);
+    cal_B_d(_Rz_d, _R_leg_d, _B_d_d);
 
     // Condensed QP formulation X = Aqp*x0 + Bqp*U
 
@@ -160,38 +205,38 @@ void MPCController::calControlInput()
 
     _Temp = _A_d;
 
-    for (int i = 1; i <= MPC_Step; i++)
+    for (int i = 1; i <= _n_step; i++)
     {
         _A_qp.block<15, 15>(15 * i, 0) = _Temp;
         _Temp = _Temp * _A_d;
     }
 
-    for (int i = 0; i < MPC_Step; i++)
+    // Forces of step k are sum_j W(k,j) V_j, the columns of input j gather the steps it acts on
+
+    const int n_u = 3 * _LegContactState.ContactTotalNum;
+    const int n_input = _W_input.cols();
+
+    for (int k = 0; k < _n_step; k++)
     {
         _Temp = _B_d_d;
 
-        for (int j = (i + 1); j <= MPC_Step; j++)
+        for (int i = (k + 1); i <= _n_step; i++)
         {
-            for(int k=0; k<15; k++)
+            for (int j = 0; j < n_input; j++)
             {
-                for(int l=0; l<3 * _LegContactState.ContactTotalNum; l++)
-                {
-                    _B_qp(15*j+k,3 * _LegContactState.ContactTotalNum * i+l) = _Temp(k,l);    
-                }
+                if (_W_input(k, j) == 0.0)
+                    continue;
+
+                if (k == 0 && i == 1)
+                    _B_qp.block(15 * i, n_u * j, 15, n_u) += _W_input(k, j) * _B_d;
+                else
+                    _B_qp.block(15 * i, n_u * j, 15, n_u) += _W_input(k, j) * _Temp;
             }
 
             _Temp = _A_d * _Temp;
         }
     }
 
-    for (int k = 0; k < 15; k++)
-    {
-        for (int l = 0; l < 3 * _LegContactState.ContactTotalNum; l++)
-        {
-            _B_qp(15 * 1+k, 3 * _LegContactState.ContactTotalNum * 0+l) = _B_d(k,l);
-        }
-    }
-
     _L_d.block<3, 3>(0, 0) = L_00_gain * _I3x3;
 
     Eigen::Matrix3d L_11_gain_xyz;
@@ -219,22 +264,20 @@ void MPCController::calControlInput()
 
     _K_d = K_gain*_K_d;
 
-    for (int i = 0; i < (MPC_Step + 1); i++)
-        _L_qp.block<15, 15>(15 * i, 15 * i) = _L_d;
+    // sum_k W(k,j) W(k,l) K_d, forces of every step are weighted
+    const Eigen::MatrixXd W_W = _W_input.transpose() * _W_input;
 
-    for (int i = 0; i < MPC_Step; i++)
-    {
-        for(int k = 0; k < 3*_LegContactState.ContactTotalNum; k++)
-        {
-            for(int l = 0; l < 3*_LegContactState.ContactTotalNum; l++)
-            {
-                _K_qp(3*_LegContactState.ContactTotalNum * i+k, 3*_LegContactState.ContactTotalNum * i+l) = _K_d(k,l);
-            }
-        }
+    for (int j = 0; j < n_input; j++)
+        for (int l = 0; l < n_input; l++)
+            _K_qp.block(n_u * j, n_u * l, n_u, n_u) = W_W(j, l) * _K_d;
 
-    }
+    // L is block diagonal and symmetric, L*Bqp per step
+    for (int i = 0; i < (_n_step + 1); i++)
+        _LB_qp.middleRows<15>(15 * i).noalias() = _L_d * _B_qp.middleRows<15>(15 * i);
+
+    _H_qp.noalias() = 2 * _B_qp.transpose() * _LB_qp;
+    _H_qp += 2 * _K_qp;
 
-    _H_qp = 2 * (_B_qp.transpose() * _L_qp * _B_qp + _K_qp);
 
     _x0(0) = 0.0;
     _x0(1) = 0.0;
@@ -268,12 +311,12 @@ void MPCController::calControlInput()
     _xref(13) = 0.0;
     _xref(14) = Gravity;
 
-    for (int i = 0; i < (MPC_Step + 1); i++)
+    for (int i = 0; i < (_n_step + 1); i++)
     {
         _xref_qp.block<15, 1>(15 * i, 0) = _xref;
     }
 
-    _g_qp = 2 * _B_qp.transpose() * _L_qp * (_A_qp * _x0 - _xref_qp);
+    _g_qp = 2 * _LB_qp.transpose() * (_A_qp * _x0 - _xref_qp);
 
     // Inequality constraint
 
@@ -292,55 +335,18 @@ void MPCController::calControlInput()
         e3(0), e3(1), e3(2),
         e4(0), e4(1), e4(2);
 
-    for (int i = 0; i < _LegContactState.ContactTotalNum; i++)
-    {
-        for(int k = 0; k < _LegContactState.ContactTotalNum; k++)
-        {
-            for(int l = 0; l < 3; l++)
-            {
-                _C_totalleg(_LegContactState.ContactTotalNum * i+k, 0+l) = _C_1leg(k,l);
-            }
-        }
-    }
-        
-
-    for (int i = 0; i < MPC_Step; i++)
-    {
-        for(int k = 0; k < 4 * _LegContactState.ContactTotalNum; k++)
-        {
-            for(int l = 0; l < 3; l++)
-            {
-                _C_qp(4 * _LegContactState.ContactTotalNum * i+k, 3 * i+l) = _C_totalleg(k,l);
-            }
-        }
-    }
-        
     _lbC_1leg << 0,
         0,
         0,
         0;
 
-    for (int i = 0; i < _LegContactState.ContactTotalNum; i++)
+    // one friction pyramid block per contact leg and input, the constraint matrix is block diagonal
+    // in the forces. Forces of a step are those of one input or a convex combination of two,
+    // the pyramid and bounds hold on every step if they hold on the inputs.
+    for (int i = 0; i < _LegContactState.ContactTotalNum * n_input; i++)
     {
-        for(int k = 0; k < _LegContactState.ContactTotalNum; k++)
-        {
-            for(int l = 0; l < 1; l++)
-            {
-                _lbC_totalleg(_LegContactState.ContactTotalNum * i+k, 0+l) = _lbC_1leg(k,l);
-            }
-        }
-    }
-
-    for (int i = 0; i < MPC_Step; i++)
-    {
-        for(int k = 0; k < 4*_LegContactState.ContactTotalNum; k++)
-        {
-            for(int l =0; l < 1; l++)
-            {
-                _lbC_qp(4 * _LegContactState.ContactTotalNum * i+k, 0+l) = _lbC_totalleg(k,l);
-            }
-        }
-
+        _C_blocks.block<4, 3>(4 * i, 0) = _C_1leg;
+        _lbC_qp.block<4, 1>(4 * i, 0) = _lbC_1leg;
     }
         
     _ub_1leg << _mu * Force_max, _mu * Force_max, Force_max;
@@ -356,7 +362,7 @@ void MPCController::calControlInput()
         }
     }
 
-    for (int i = 0; i < MPC_Step; i++)
+    for (int i = 0; i < n_input; i++)
     {
         for(int k = 0; k < 3 * _LegContactState.ContactTotalNum; k++)
         {
@@ -381,7 +387,7 @@ void MPCController::calControlInput()
     }
         
 
-    for (int i = 0; i < MPC_Step; i++)
+    for (int i = 0; i < n_input; i++)
     {
         for(int k = 0; k < 3 * _LegContactState.ContactTotalNum; k++)
         {
@@ -394,59 +400,28 @@ void MPCController::calControlInput()
 
     // Optimization(QP Solver)
 
-    USING_NAMESPACE_QPOASES
-    real_t H_qp_qpoases[(3 * _LegContactState.ContactTotalNum * MPC_Step) * (3 * _LegContactState.ContactTotalNum * MPC_Step)] = {
-        0,
-    };
-    real_t g_qp_qpoases[(3 * _LegContactState.ContactTotalNum * MPC_Step) * (1)] = {
-        0,
-    };
-
-    real_t C_qp_qpoases[(4 * 3 * _LegContactState.ContactTotalNum * MPC_Step) * (3 * MPC_Step)] = {
-        0,
-    };
-    real_t lbC_qp_qpoases[4 * 3 * _LegContactState.ContactTotalNum * MPC_Step] = {
-        0,
-    };
-    real_t ub_qp_qpoases[3 * 3 * _LegContactState.ContactTotalNum * MPC_Step] = {
-        0,
-    };
-    real_t lb_qp_qpoases[3 * 3 * _LegContactState.ContactTotalNum * MPC_Step] = {
-        0,
-    };
-
-    for (int i = 0; i < (3 * _LegContactState.ContactTotalNum * MPC_Step); i++)
-        for (int j = 0; j < (3 * _LegContactState.ContactTotalNum * MPC_Step); j++)
-            H_qp_qpoases[i * (3 * _LegContactState.ContactTotalNum * MPC_Step) + j] = _H_qp(i, j);
-
-    for (int i = 0; i < (3 * _LegContactState.ContactTotalNum * MPC_Step); i++)
-        for (int j = 0; j < (1); j++)
-            g_qp_qpoases[i * (1) + j] = _g_qp(i, j);
-
-    for (int i = 0; i < (4 * _LegContactState.ContactTotalNum * MPC_Step); i++)
-        for (int j = 0; j < (3 * MPC_Step); j++)
-            C_qp_qpoases[i * (3 * MPC_Step) + j] = _C_qp(i, j);
-
-    for (int i = 0; i < (4 * _LegContactState.ContactTotalNum * MPC_Step); i++)
-        lbC_qp_qpoases[i] = _lbC_qp(i, 0);
-
-    for (int i = 0; i < (3 * _LegContactState.ContactTotalNum * MPC_Step); i++)
-        ub_qp_qpoases[i] = _ub_qp(i, 0);
-
-    for (int i = 0; i < (3 * _LegContactState.ContactTotalNum * MPC_Step); i++)
-        lb_qp_qpoases[i] = _lb_qp(i, 0);
-
-    QProblem qp_problem(3 * _LegContactState.ContactTotalNum * MPC_Step, _LegContactState.ContactTotalNum * MPC_Step);
-
-    Options options;
-    qp_problem.setOptions(options);
-
-    int nWSR = 100;
+    // _H_qp is symmetric, so its column-major storage is handed over as is.
+    // Its nonzeros fill the whole matrix (every force acts on all later states),
+    // a sparse Hessian only pays off for banded Hessians of long horizons.
+    _qp.n = 3 * _LegContactState.ContactTotalNum * n_input;
+    _qp.H = _H_qp.data();
+    _qp.g = _g_qp.data();
+    _qp.lb = _lb_qp.data();
+    _qp.ub = _ub_qp.data();
+    _qp.n_blocks = _LegContactState.ContactTotalNum * n_input;
+    _qp.block_rows = 4;
+    _qp.block_cols = 3;
+    _qp.C_blocks = _C_blocks.data();
+    _qp.lbC = _lbC_qp.data();
+    _qp.contact_set = 0;
+    for (int i = 0; i < 4; i++)
+        _qp.contact_set |= _LegContactState.LegState[i] << i;
+    _qp_dumper.sample(_qp);
 
-    qp_problem.init(H_qp_qpoases, g_qp_qpoases, C_qp_qpoases, lb_qp_qpoases, ub_qp_qpoases, lbC_qp_qpoases, NULL, nWSR);
+    _qp_solver->solve(_qp);
+    const Eigen::VectorXd& UOpt = _qp_solver->getSolution();
 
-    real_t UOpt[3 * _LegContactState.ContactTotalNum * MPC_Step];
-    qp_problem.getPrimalSolution(UOpt);
+    // forces of the first step are input 0 alone
 
     int select_count = 0;
     int num = 0;
@@ -462,7 +437,6 @@ void MPCController::calControlInput()
         select_count++;
     }
 
-    printf("1 num(%d) ",num);
 
     if (_LegContactState.LegState[1])
     {
@@ -475,7 +449,6 @@ void MPCController::calControlInput()
         select_count++;
     }
 
-    printf("2 num(%d) ",num);
 
     if (_LegContactState.LegState[2])
     {
@@ -488,7 +461,6 @@ void MPCController::calControlInput()
         select_count++;
     }
 
-    printf("3 num(%d) ",num);
 
     if (_LegContactState.LegState[3])
     {
@@ -499,9 +471,7 @@ void MPCController::calControlInput()
         _F[3](2) = UOpt[num+2];
 
         select_count++;
-    }     
-
-    printf("4 num(%d) \n",num);        
+    }
 }
 
 void MPCController::getControlInput(quadruped_robot::QuadrupedRobot &robot, std::array<Eigen::Vector3d, 4> &F_leg)
@@ -515,159 +485,100 @@ void MPCController::getControlInput(quadruped_robot::QuadrupedRobot &robot, std:
     }
 }
 
-void MPCController::cal_A_d()
+// exp(M) by scaling and squaring of its Taylor series
+template<int N>
+static Eigen::Matrix<double, N, N> expm(const Eigen::Matrix<double, N, N>& M)
 {
-    _A_d = _I15x15;
-    _A_d.block<3, 3>(0, 6) = _Rz * SamplingTime;
-    _A_d.block<3, 3>(3, 9) = _I3x3 * SamplingTime;
-    _A_d.block<3, 3>(3, 12) = _I3x3 * (-1 / 2 * SamplingTime * SamplingTime);
-    _A_d.block<3, 3>(9, 12) = _I3x3 * (-SamplingTime);
+    typedef Eigen::Matrix<double, N, N> MatrixN;
+
+    // scaled to a norm below 1/2, the series of order 12 is exact to double precision
+    double norm = M.cwiseAbs().rowwise().sum().maxCoeff();
+    int squarings = (norm > 0.5) ? (int)std::ceil(std::log2(norm / 0.5)) : 0;
+    MatrixN X = M / std::ldexp(1.0, squarings);
+
+    MatrixN E = MatrixN::Identity();
+    MatrixN term = MatrixN::Identity();
+    for (int k = 1; k <= 12; k++)
+    {
+        term = term * X / k;
+        E += term;
+    }
+
+    for (int k = 0; k < squarings; k++)
+        E = E * E;
+
+    return E;
 }
 
-void MPCController::cal_B_d_and_B_d_d()
+/* State x = [Theta, p, w, p_dot, g], input u = [F_1 .. F_n] of the stance legs
+ *
+ *   A_c = [0 0 Rz 0 0; 0 0 0 I 0; 0 0 0 0 0; 0 0 0 0 -I; 0 0 0 0 0],  B_c = [0; 0; I^-1 [r_i]; I/m; 0]
+ *
+ * With P = diag(Rz, I, I, I, I), A_c = P A_c(0) P^T, so exp(A_c T) = P exp(A_c(0) T) P^T and the integral
+ * of the hold is P Int exp(A_c(0) s) ds B_c (rows of Theta are zero in B_c). The exponential at zero yaw
+ * depends on the sampling time only and is taken once of [A_c(0) E; 0 0] T, E the acceleration rows.
+*/
+void MPCController::cal_ZOH()
 {
-    // Calculate _B_d and Calculate _B_d_d
+    Eigen::Matrix<double, 21, 21> M = Eigen::Matrix<double, 21, 21>::Zero();
+    M.block<3, 3>(0, 6).setIdentity();
+    M.block<3, 3>(3, 9).setIdentity();
+    M.block<3, 3>(9, 12) = -Eigen::Matrix3d::Identity();
+    M.block<6, 6>(6, 15).setIdentity();
 
-    int select_count = 0;
-    int num = 0;
+    const Eigen::Matrix<double, 21, 21> E = expm<21>(M * SamplingTime);
 
-    if (_LegContactState.LegState[0])
-    {
-        num = select_count * 3;
+    _A_d_0 = E.block<15, 15>(0, 0);
+    _B_d_0 = E.block<15, 6>(0, 15);
 
-        _B_d(0, num) = 1 / 2 * (_R1(0, 0) * SamplingTime * SamplingTime * _Rz(0, 0) + _R1(1, 0) * SamplingTime * SamplingTime * _Rz(0, 1) + _R1(2, 0) * SamplingTime * SamplingTime * _Rz(0, 2));
-        _B_d(1, num) = 1 / 2 * (_R1(0, 0) * SamplingTime * SamplingTime * _Rz(1, 0) + _R1(1, 0) * SamplingTime * SamplingTime * _Rz(1, 1) + _R1(2, 0) * SamplingTime * SamplingTime * _Rz(1, 2));
-        _B_d(2, num) = 1 / 2 * (_R1(0, 0) * SamplingTime * SamplingTime * _Rz(2, 0) + _R1(1, 0) * SamplingTime * SamplingTime * _Rz(2, 1) + _R1(2, 0) * SamplingTime * SamplingTime * _Rz(2, 2));
-        _B_d(0, num + 1) = 1 / 2 * (_R1(0, 1) * SamplingTime * SamplingTime * _Rz(0, 0) + _R1(1, 1) * SamplingTime * SamplingTime * _Rz(0, 1) + _R1(2, 1) * SamplingTime * SamplingTime * _Rz(0, 2));
-        _B_d(1, num + 1) = 1 / 2 * (_R1(0, 1) * SamplingTime * SamplingTime * _Rz(1, 0) + _R1(1, 1) * SamplingTime * SamplingTime * _Rz(1, 1) + _R1(2, 1) * SamplingTime * SamplingTime * _Rz(1, 2));
-        _B_d(2, num + 1) = 1 / 2 * (_R1(0, 1) * SamplingTime * SamplingTime * _Rz(2, 0) + _R1(1, 1) * SamplingTime * SamplingTime * _Rz(2, 1) + _R1(2, 1) * SamplingTime * SamplingTime * _Rz(2, 2));
-        _B_d(0, num + 2) = 1 / 2 * (_R1(0, 2) * SamplingTime * SamplingTime * _Rz(0, 0) + _R1(1, 2) * SamplingTime * SamplingTime * _Rz(0, 1) + _R1(2, 2) * SamplingTime * SamplingTime * _Rz(0, 2));
-        _B_d(1, num + 2) = 1 / 2 * (_R1(0, 2) * SamplingTime * SamplingTime * _Rz(1, 0) + _R1(1, 2) * SamplingTime * SamplingTime * _Rz(1, 1) + _R1(2, 2) * SamplingTime * SamplingTime * _Rz(1, 2));
-        _B_d(2, num + 2) = 1 / 2 * (_R1(0, 2) * SamplingTime * SamplingTime * _Rz(2, 0) + _R1(1, 2) * SamplingTime * SamplingTime * _Rz(2, 1) + _R1(2, 2) * SamplingTime * SamplingTime * _Rz(2, 2));
-
-        _B_d.block<3, 3>(3, num) = _I3x3 * (SamplingTime * SamplingTime / (2 * _m_body));
-        _B_d.block<3, 3>(6, num) = _R1 * SamplingTime;
-        _B_d.block<3, 3>(9, num) = _I3x3 * (SamplingTime / _m_body);
-
-        _B_d_d(0, num) = 1 / 2 * (_R1_d(0, 0) * SamplingTime * SamplingTime * _Rz_d(0, 0) + _R1_d(1, 0) * SamplingTime * SamplingTime * _Rz_d(0, 1) + _R1_d(2, 0) * SamplingTime * SamplingTime * _Rz_d(0, 2));
-        _B_d_d(1, num) = 1 / 2 * (_R1_d(0, 0) * SamplingTime * SamplingTime * _Rz_d(1, 0) + _R1_d(1, 0) * SamplingTime * SamplingTime * _Rz_d(1, 1) + _R1_d(2, 0) * SamplingTime * SamplingTime * _Rz_d(1, 2));
-        _B_d_d(2, num) = 1 / 2 * (_R1_d(0, 0) * SamplingTime * SamplingTime * _Rz_d(2, 0) + _R1_d(1, 0) * SamplingTime * SamplingTime * _Rz_d(2, 1) + _R1_d(2, 0) * SamplingTime * SamplingTime * _Rz_d(2, 2));
-        _B_d_d(0, num + 1) = 1 / 2 * (_R1_d(0, 1) * SamplingTime * SamplingTime * _Rz_d(0, 0) + _R1_d(1, 1) * SamplingTime * SamplingTime * _Rz_d(0, 1) + _R1_d(2, 1) * SamplingTime * SamplingTime * _Rz_d(0, 2));
-        _B_d_d(1, num + 1) = 1 / 2 * (_R1_d(0, 1) * SamplingTime * SamplingTime * _Rz_d(1, 0) + _R1_d(1, 1) * SamplingTime * SamplingTime * _Rz_d(1, 1) + _R1_d(2, 1) * SamplingTime * SamplingTime * _Rz_d(1, 2));
-        _B_d_d(2, num + 1) = 1 / 2 * (_R1_d(0, 1) * SamplingTime * SamplingTime * _Rz_d(2, 0) + _R1_d(1, 1) * SamplingTime * SamplingTime * _Rz_d(2, 1) + _R1_d(2, 1) * SamplingTime * SamplingTime * _Rz_d(2, 2));
-        _B_d_d(0, num + 2) = 1 / 2 * (_R1_d(0, 2) * SamplingTime * SamplingTime * _Rz_d(0, 0) + _R1_d(1, 2) * SamplingTime * SamplingTime * _Rz_d(0, 1) + _R1_d(2, 2) * SamplingTime * SamplingTime * _Rz_d(0, 2));
-        _B_d_d(1, num + 2) = 1 / 2 * (_R1_d(0, 2) * SamplingTime * SamplingTime * _Rz_d(1, 0) + _R1_d(1, 2) * SamplingTime * SamplingTime * _Rz_d(1, 1) + _R1_d(2, 2) * SamplingTime * SamplingTime * _Rz_d(1, 2));
-        _B_d_d(2, num + 2) = 1 / 2 * (_R1_d(0, 2) * SamplingTime * SamplingTime * _Rz_d(2, 0) + _R1_d(1, 2) * SamplingTime * SamplingTime * _Rz_d(2, 1) + _R1_d(2, 2) * SamplingTime * SamplingTime * _Rz_d(2, 2));
-
-        _B_d_d.block<3, 3>(3, num) = _I3x3 * (SamplingTime * SamplingTime / (2 * _m_body));
-        _B_d_d.block<3, 3>(6, num) = _R1 * SamplingTime;
-        _B_d_d.block<3, 3>(9, num) = _I3x3 * (SamplingTime / _m_body);
-
-        select_count++;
+    // blocks the yaw acts on, zero blocks stay zero
+    for (int i = 0; i < 5; i++)
+    {
+        _A_d_0_row[i] = !_A_d_0.block<3, 3>(0, 3 * i).isZero(0.0);
+        _A_d_0_col[i] = !_A_d_0.block<3, 3>(3 * i, 0).isZero(0.0);
+        _B_d_0_w[i] = !_B_d_0.block<3, 3>(3 * i, 0).isZero(0.0);
     }
+}
 
-    if (_LegContactState.LegState[1])
-    {
-        num = select_count * 3;
+// A_d = P A_d_0 P^T, rotating the nonzero 3x3 blocks of the first block row and column
+void MPCController::cal_A_d()
+{
+    const Eigen::Matrix3d Rz = _Rz;
 
-        _B_d(0, num) = 1 / 2 * (_R2(0, 0) * SamplingTime * SamplingTime * _Rz(0, 0) + _R2(1, 0) * SamplingTime * SamplingTime * _Rz(0, 1) + _R2(2, 0) * SamplingTime * SamplingTime * _Rz(0, 2));
-        _B_d(1, num) = 1 / 2 * (_R2(0, 0) * SamplingTime * SamplingTime * _Rz(1, 0) + _R2(1, 0) * SamplingTime * SamplingTime * _Rz(1, 1) + _R2(2, 0) * SamplingTime * SamplingTime * _Rz(1, 2));
-        _B_d(2, num) = 1 / 2 * (_R2(0, 0) * SamplingTime * SamplingTime * _Rz(2, 0) + _R2(1, 0) * SamplingTime * SamplingTime * _Rz(2, 1) + _R2(2, 0) * SamplingTime * SamplingTime * _Rz(2, 2));
-        _B_d(0, num + 1) = 1 / 2 * (_R2(0, 1) * SamplingTime * SamplingTime * _Rz(0, 0) + _R2(1, 1) * SamplingTime * SamplingTime * _Rz(0, 1) + _R2(2, 1) * SamplingTime * SamplingTime * _Rz(0, 2));
-        _B_d(1, num + 1) = 1 / 2 * (_R2(0, 1) * SamplingTime * SamplingTime * _Rz(1, 0) + _R2(1, 1) * SamplingTime * SamplingTime * _Rz(1, 1) + _R2(2, 1) * SamplingTime * SamplingTime * _Rz(1, 2));
-        _B_d(2, num + 1) = 1 / 2 * (_R2(0, 1) * SamplingTime * SamplingTime * _Rz(2, 0) + _R2(1, 1) * SamplingTime * SamplingTime * _Rz(2, 1) + _R2(2, 1) * SamplingTime * SamplingTime * _Rz(2, 2));
-        _B_d(0, num + 2) = 1 / 2 * (_R2(0, 2) * SamplingTime * SamplingTime * _Rz(0, 0) + _R2(1, 2) * SamplingTime * SamplingTime * _Rz(0, 1) + _R2(2, 2) * SamplingTime * SamplingTime * _Rz(0, 2));
-        _B_d(1, num + 2) = 1 / 2 * (_R2(0, 2) * SamplingTime * SamplingTime * _Rz(1, 0) + _R2(1, 2) * SamplingTime * SamplingTime * _Rz(1, 1) + _R2(2, 2) * SamplingTime * SamplingTime * _Rz(1, 2));
-        _B_d(2, num + 2) = 1 / 2 * (_R2(0, 2) * SamplingTime * SamplingTime * _Rz(2, 0) + _R2(1, 2) * SamplingTime * SamplingTime * _Rz(2, 1) + _R2(2, 2) * SamplingTime * SamplingTime * _Rz(2, 2));
-
-        _B_d.block<3, 3>(3, num) = _I3x3 * (SamplingTime * SamplingTime / (2 * _m_body));
-        _B_d.block<3, 3>(6, num) = _R2 * SamplingTime;
-        _B_d.block<3, 3>(9, num) = _I3x3 * (SamplingTime / _m_body);
-
-        _B_d_d(0, num) = 1 / 2 * (_R2_d(0, 0) * SamplingTime * SamplingTime * _Rz_d(0, 0) + _R2_d(1, 0) * SamplingTime * SamplingTime * _Rz_d(0, 1) + _R2_d(2, 0) * SamplingTime * SamplingTime * _Rz_d(0, 2));
-        _B_d_d(1, num) = 1 / 2 * (_R2_d(0, 0) * SamplingTime * SamplingTime * _Rz_d(1, 0) + _R2_d(1, 0) * SamplingTime * SamplingTime * _Rz_d(1, 1) + _R2_d(2, 0) * SamplingTime * SamplingTime * _Rz_d(1, 2));
-        _B_d_d(2, num) = 1 / 2 * (_R2_d(0, 0) * SamplingTime * SamplingTime * _Rz_d(2, 0) + _R2_d(1, 0) * SamplingTime * SamplingTime * _Rz_d(2, 1) + _R2_d(2, 0) * SamplingTime * SamplingTime * _Rz_d(2, 2));
-        _B_d_d(0, num + 1) = 1 / 2 * (_R2_d(0, 1) * SamplingTime * SamplingTime * _Rz_d(0, 0) + _R2_d(1, 1) * SamplingTime * SamplingTime * _Rz_d(0, 1) + _R2_d(2, 1) * SamplingTime * SamplingTime * _Rz_d(0, 2));
-        _B_d_d(1, num + 1) = 1 / 2 * (_R2_d(0, 1) * SamplingTime * SamplingTime * _Rz_d(1, 0) + _R2_d(1, 1) * SamplingTime * SamplingTime * _Rz_d(1, 1) + _R2_d(2, 1) * SamplingTime * SamplingTime * _Rz_d(1, 2));
-        _B_d_d(2, num + 1) = 1 / 2 * (_R2_d(0, 1) * SamplingTime * SamplingTime * _Rz_d(2, 0) + _R2_d(1, 1) * SamplingTime * SamplingTime * _Rz_d(2, 1) + _R2_d(2, 1) * SamplingTime * SamplingTime * _Rz_d(2, 2));
-        _B_d_d(0, num + 2) = 1 / 2 * (_R2_d(0, 2) * SamplingTime * SamplingTime * _Rz_d(0, 0) + _R2_d(1, 2) * SamplingTime * SamplingTime * _Rz_d(0, 1) + _R2_d(2, 2) * SamplingTime * SamplingTime * _Rz_d(0, 2));
-        _B_d_d(1, num + 2) = 1 / 2 * (_R2_d(0, 2) * SamplingTime * SamplingTime * _Rz_d(1, 0) + _R2_d(1, 2) * SamplingTime * SamplingTime * _Rz_d(1, 1) + _R2_d(2, 2) * SamplingTime * SamplingTime * _Rz_d(1, 2));
-        _B_d_d(2, num + 2) = 1 / 2 * (_R2_d(0, 2) * SamplingTime * SamplingTime * _Rz_d(2, 0) + _R2_d(1, 2) * SamplingTime * SamplingTime * _Rz_d(2, 1) + _R2_d(2, 2) * SamplingTime * SamplingTime * _Rz_d(2, 2));
-
-        _B_d_d.block<3, 3>(3, num) = _I3x3 * (SamplingTime * SamplingTime / (2 * _m_body));
-        _B_d_d.block<3, 3>(6, num) = _R2 * SamplingTime;
-        _B_d_d.block<3, 3>(9, num) = _I3x3 * (SamplingTime / _m_body);
+    _A_d = _A_d_0;
 
-        select_count++;
-    }
+    for (int j = 0; j < 5; j++)
+        if (_A_d_0_row[j])
+            _A_d.block<3, 3>(0, 3 * j).noalias() = Rz * _A_d_0.block<3, 3>(0, 3 * j);
 
-    if (_LegContactState.LegState[2])
-    {
-        num = select_count * 3;
+    for (int i = 0; i < 5; i++)
+        if (_A_d_0_col[i])
+            _A_d.block<3, 3>(3 * i, 0) = _A_d.block<3, 3>(3 * i, 0) * Rz.transpose();
+}
 
-        _B_d(0, num) = 1 / 2 * (_R3(0, 0) * SamplingTime * SamplingTime * _Rz(0, 0) + _R3(1, 0) * SamplingTime * SamplingTime * _Rz(0, 1) + _R3(2, 0) * SamplingTime * SamplingTime * _Rz(0, 2));
-        _B_d(1, num) = 1 / 2 * (_R3(0, 0) * SamplingTime * SamplingTime * _Rz(1, 0) + _R3(1, 0) * SamplingTime * SamplingTime * _Rz(1, 1) + _R3(2, 0) * SamplingTime * SamplingTime * _Rz(1, 2));
-        _B_d(2, num) = 1 / 2 * (_R3(0, 0) * SamplingTime * SamplingTime * _Rz(2, 0) + _R3(1, 0) * SamplingTime * SamplingTime * _Rz(2, 1) + _R3(2, 0) * SamplingTime * SamplingTime * _Rz(2, 2));
-        _B_d(0, num+1) = 1 / 2 * (_R3(0, 1) * SamplingTime * SamplingTime * _Rz(0, 0) + _R3(1, 1) * SamplingTime * SamplingTime * _Rz(0, 1) + _R3(2, 1) * SamplingTime * SamplingTime * _Rz(0, 2));
-        _B_d(1, num+1) = 1 / 2 * (_R3(0, 1) * SamplingTime * SamplingTime * _Rz(1, 0) + _R3(1, 1) * SamplingTime * SamplingTime * _Rz(1, 1) + _R3(2, 1) * SamplingTime * SamplingTime * _Rz(1, 2));
-        _B_d(2, num+1) = 1 / 2 * (_R3(0, 1) * SamplingTime * SamplingTime * _Rz(2, 0) + _R3(1, 1) * SamplingTime * SamplingTime * _Rz(2, 1) + _R3(2, 1) * SamplingTime * SamplingTime * _Rz(2, 2));
-        _B_d(0, num+2) = 1 / 2 * (_R3(0, 2) * SamplingTime * SamplingTime * _Rz(0, 0) + _R3(1, 2) * SamplingTime * SamplingTime * _Rz(0, 1) + _R3(2, 2) * SamplingTime * SamplingTime * _Rz(0, 2));
-        _B_d(1, num+2) = 1 / 2 * (_R3(0, 2) * SamplingTime * SamplingTime * _Rz(1, 0) + _R3(1, 2) * SamplingTime * SamplingTime * _Rz(1, 1) + _R3(2, 2) * SamplingTime * SamplingTime * _Rz(1, 2));
-        _B_d(2, num+2) = 1 / 2 * (_R3(0, 2) * SamplingTime * SamplingTime * _Rz(2, 0) + _R3(1, 2) * SamplingTime * SamplingTime * _Rz(2, 1) + _R3(2, 2) * SamplingTime * SamplingTime * _Rz(2, 2));
-
-        _B_d.block<3, 3>(3, num) = _I3x3 * (SamplingTime * SamplingTime / (2 * _m_body));
-        _B_d.block<3, 3>(6, num) = _R3 * SamplingTime;
-        _B_d.block<3, 3>(9, num) = _I3x3 * (SamplingTime / _m_body);
-
-        _B_d_d(0, num) = 1 / 2 * (_R3_d(0, 0) * SamplingTime * SamplingTime * _Rz_d(0, 0) + _R3_d(1, 0) * SamplingTime * SamplingTime * _Rz_d(0, 1) + _R3_d(2, 0) * SamplingTime * SamplingTime * _Rz_d(0, 2));
-        _B_d_d(1, num) = 1 / 2 * (_R3_d(0, 0) * SamplingTime * SamplingTime * _Rz_d(1, 0) + _R3_d(1, 0) * SamplingTime * SamplingTime * _Rz_d(1, 1) + _R3_d(2, 0) * SamplingTime * SamplingTime * _Rz_d(1, 2));
-        _B_d_d(2, num) = 1 / 2 * (_R3_d(0, 0) * SamplingTime * SamplingTime * _Rz_d(2, 0) + _R3_d(1, 0) * SamplingTime * SamplingTime * _Rz_d(2, 1) + _R3_d(2, 0) * SamplingTime * SamplingTime * _Rz_d(2, 2));
-        _B_d_d(0, num+1) = 1 / 2 * (_R3_d(0, 1) * SamplingTime * SamplingTime * _Rz_d(0, 0) + _R3_d(1, 1) * SamplingTime * SamplingTime * _Rz_d(0, 1) + _R3_d(2, 1) * SamplingTime * SamplingTime * _Rz_d(0, 2));
-        _B_d_d(1, num+1) = 1 / 2 * (_R3_d(0, 1) * SamplingTime * SamplingTime * _Rz_d(1, 0) + _R3_d(1, 1) * SamplingTime * SamplingTime * _Rz_d(1, 1) + _R3_d(2, 1) * SamplingTime * SamplingTime * _Rz_d(1, 2));
-        _B_d_d(2, num+1) = 1 / 2 * (_R3_d(0, 1) * SamplingTime * SamplingTime * _Rz_d(2, 0) + _R3_d(1, 1) * SamplingTime * SamplingTime * _Rz_d(2, 1) + _R3_d(2, 1) * SamplingTime * SamplingTime * _Rz_d(2, 2));
-        _B_d_d(0, num+2) = 1 / 2 * (_R3_d(0, 2) * SamplingTime * SamplingTime * _Rz_d(0, 0) + _R3_d(1, 2) * SamplingTime * SamplingTime * _Rz_d(0, 1) + _R3_d(2, 2) * SamplingTime * SamplingTime * _Rz_d(0, 2));
-        _B_d_d(1, num+2) = 1 / 2 * (_R3_d(0, 2) * SamplingTime * SamplingTime * _Rz_d(1, 0) + _R3_d(1, 2) * SamplingTime * SamplingTime * _Rz_d(1, 1) + _R3_d(2, 2) * SamplingTime * SamplingTime * _Rz_d(1, 2));
-        _B_d_d(2, num+2) = 1 / 2 * (_R3_d(0, 2) * SamplingTime * SamplingTime * _Rz_d(2, 0) + _R3_d(1, 2) * SamplingTime * SamplingTime * _Rz_d(2, 1) + _R3_d(2, 2) * SamplingTime * SamplingTime * _Rz_d(2, 2));
-
-        _B_d_d.block<3, 3>(3, num) = _I3x3 * (SamplingTime * SamplingTime / (2 * _m_body));
-        _B_d_d.block<3, 3>(6, num) = _R3 * SamplingTime;
-        _B_d_d.block<3, 3>(9, num) = _I3x3 * (SamplingTime / _m_body);
+// one 15x3 block per stance leg, B_d = P B_d_0 [I^-1 [r_i]; I/m] in 3x3 blocks
+void MPCController::cal_B_d(const Eigen::Matrix3d& Rz, const std::array<Eigen::Matrix3d, 4>& R_leg, Eigen::MatrixXd& B_d) const
+{
+    // P B_d_0 once, the force to linear acceleration part is the same for all legs
+    Eigen::Matrix<double, 15, 6> B_0 = _B_d_0;
+    B_0.topRows<3>() = Rz * _B_d_0.topRows<3>();
+    const Eigen::Matrix<double, 15, 3> B_force = B_0.rightCols<3>() * (1.0 / _m_body);
 
-        select_count++;
-    }
+    int num = 0;
 
-    if (_LegContactState.LegState[3])
+    for (int i = 0; i < 4; i++)
     {
-        num = select_count * 3;
+        if (!_LegContactState.LegState[i])
+            continue;
 
-        _B_d(0, num) = 1 / 2 * (_R4(0, 0) * SamplingTime * SamplingTime * _Rz(0, 0) + _R4(1, 0) * SamplingTime * SamplingTime * _Rz(0, 1) + _R4(2, 0) * SamplingTime * SamplingTime * _Rz(0, 2));
-        _B_d(1, num) = 1 / 2 * (_R4(0, 0) * SamplingTime * SamplingTime * _Rz(1, 0) + _R4(1, 0) * SamplingTime * SamplingTime * _Rz(1, 1) + _R4(2, 0) * SamplingTime * SamplingTime * _Rz(1, 2));
-        _B_d(2, num) = 1 / 2 * (_R4(0, 0) * SamplingTime * SamplingTime * _Rz(2, 0) + _R4(1, 0) * SamplingTime * SamplingTime * _Rz(2, 1) + _R4(2, 0) * SamplingTime * SamplingTime * _Rz(2, 2));
-        _B_d(0, num + 1) = 1 / 2 * (_R4(0, 1) * SamplingTime * SamplingTime * _Rz(0, 0) + _R4(1, 1) * SamplingTime * SamplingTime * _Rz(0, 1) + _R4(2, 1) * SamplingTime * SamplingTime * _Rz(0, 2));
-        _B_d(1, num + 1) = 1 / 2 * (_R4(0, 1) * SamplingTime * SamplingTime * _Rz(1, 0) + _R4(1, 1) * SamplingTime * SamplingTime * _Rz(1, 1) + _R4(2, 1) * SamplingTime * SamplingTime * _Rz(1, 2));
-        _B_d(2, num + 1) = 1 / 2 * (_R4(0, 1) * SamplingTime * SamplingTime * _Rz(2, 0) + _R4(1, 1) * SamplingTime * SamplingTime * _Rz(2, 1) + _R4(2, 1) * SamplingTime * SamplingTime * _Rz(2, 2));
-        _B_d(0, num + 2) = 1 / 2 * (_R4(0, 2) * SamplingTime * SamplingTime * _Rz(0, 0) + _R4(1, 2) * SamplingTime * SamplingTime * _Rz(0, 1) + _R4(2, 2) * SamplingTime * SamplingTime * _Rz(0, 2));
-        _B_d(1, num + 2) = 1 / 2 * (_R4(0, 2) * SamplingTime * SamplingTime * _Rz(1, 0) + _R4(1, 2) * SamplingTime * SamplingTime * _Rz(1, 1) + _R4(2, 2) * SamplingTime * SamplingTime * _Rz(1, 2));
-        _B_d(2, num + 2) = 1 / 2 * (_R4(0, 2) * SamplingTime * SamplingTime * _Rz(2, 0) + _R4(1, 2) * SamplingTime * SamplingTime * _Rz(2, 1) + _R4(2, 2) * SamplingTime * SamplingTime * _Rz(2, 2));
-
-        _B_d.block<3, 3>(3, num) = _I3x3 * (SamplingTime * SamplingTime / (2 * _m_body));
-        _B_d.block<3, 3>(6, num) = _R4 * SamplingTime;
-        _B_d.block<3, 3>(9, num) = _I3x3 * (SamplingTime / _m_body);
-
-        _B_d_d(0, num) = 1 / 2 * (_R4_d(0, 0) * SamplingTime * SamplingTime * _Rz_d(0, 0) + _R4_d(1, 0) * SamplingTime * SamplingTime * _Rz_d(0, 1) + _R4_d(2, 0) * SamplingTime * SamplingTime * _Rz_d(0, 2));
-        _B_d_d(1, num) = 1 / 2 * (_R4_d(0, 0) * SamplingTime * SamplingTime * _Rz_d(1, 0) + _R4_d(1, 0) * SamplingTime * SamplingTime * _Rz_d(1, 1) + _R4_d(2, 0) * SamplingTime * SamplingTime * _Rz_d(1, 2));
-        _B_d_d(2, num) = 1 / 2 * (_R4_d(0, 0) * SamplingTime * SamplingTime * _Rz_d(2, 0) + _R4_d(1, 0) * SamplingTime * SamplingTime * _Rz_d(2, 1) + _R4_d(2, 0) * SamplingTime * SamplingTime * _Rz_d(2, 2));
-        _B_d_d(0, num + 1) = 1 / 2 * (_R4_d(0, 1) * SamplingTime * SamplingTime * _Rz_d(0, 0) + _R4_d(1, 1) * SamplingTime * SamplingTime * _Rz_d(0, 1) + _R4_d(2, 1) * SamplingTime * SamplingTime * _Rz_d(0, 2));
-        _B_d_d(1, num + 1) = 1 / 2 * (_R4_d(0, 1) * SamplingTime * SamplingTime * _Rz_d(1, 0) + _R4_d(1, 1) * SamplingTime * SamplingTime * _Rz_d(1, 1) + _R4_d(2, 1) * SamplingTime * SamplingTime * _Rz_d(1, 2));
-        _B_d_d(2, num + 1) = 1 / 2 * (_R4_d(0, 1) * SamplingTime * SamplingTime * _Rz_d(2, 0) + _R4_d(1, 1) * SamplingTime * SamplingTime * _Rz_d(2, 1) + _R4_d(2, 1) * SamplingTime * SamplingTime * _Rz_d(2, 2));
-        _B_d_d(0, num + 2) = 1 / 2 * (_R4_d(0, 2) * SamplingTime * SamplingTime * _Rz_d(0, 0) + _R4_d(1, 2) * SamplingTime * SamplingTime * _Rz_d(0, 1) + _R4_d(2, 2) * SamplingTime * SamplingTime * _Rz_d(0, 2));
-        _B_d_d(1, num + 2) = 1 / 2 * (_R4_d(0, 2) * SamplingTime * SamplingTime * _Rz_d(1, 0) + _R4_d(1, 2) * SamplingTime * SamplingTime * _Rz_d(1, 1) + _R4_d(2, 2) * SamplingTime * SamplingTime * _Rz_d(1, 2));
-        _B_d_d(2, num + 2) = 1 / 2 * (_R4_d(0, 2) * SamplingTime * SamplingTime * _Rz_d(2, 0) + _R4_d(1, 2) * SamplingTime * SamplingTime * _Rz_d(2, 1) + _R4_d(2, 2) * SamplingTime * SamplingTime * _Rz_d(2, 2));
-
-        _B_d_d.block<3, 3>(3, num) = _I3x3 * (SamplingTime * SamplingTime / (2 * _m_body));
-        _B_d_d.block<3, 3>(6, num) = _R4 * SamplingTime;
-        _B_d_d.block<3, 3>(9, num) = _I3x3 * (SamplingTime / _m_body);
+        for (int j = 0; j < 5; j++)
+        {
+            if (_B_d_0_w[j])
+                B_d.block<3, 3>(3 * j, num).noalias() = B_0.block<3, 3>(3 * j, 0) * R_leg[i] + B_force.block<3, 3>(3 * j, 0);
+            else
+                B_d.block<3, 3>(3 * j, num) = B_force.block<3, 3>(3 * j, 0);
+        }
 
-        select_count++;
+        num += 3;
     }
 }
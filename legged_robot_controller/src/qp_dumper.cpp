@@ -0,0 +1,186 @@
+/*
+  Author: Modulabs
+  File Name: qp_dumper.cpp
+*/
+
+#include "legged_robot_controller/qp_dumper.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <sys/stat.h>
+
+
+static void copy(const double* v, int size, std::vector<double>& buffer)
+{
+  if (v)
+    buffer.assign(v, v + size);
+  else
+    buffer.clear();
+}
+
+// rows x cols, row-major, or the default value if v is empty
+static bool writeMatrix(const std::string& file_name, const double* v, int rows, int cols, double value = 0.0)
+{
+  std::FILE* file = std::fopen(file_name.c_str(), "w");
+  if (!file)
+    return false;
+
+  for (int i=0; i<rows; i++)
+  {
+    for (int j=0; j<cols; j++)
+      std::fprintf(file, "%.17e ", v ? v[i*cols + j] : value);
+    std::fprintf(file, "\n");
+  }
+
+  return std::fclose(file) == 0;
+}
+
+static bool makeDirectory(const std::string& directory)
+{
+  return mkdir(directory.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+
+QPDumper::QPDumper()
+  : _sample_interval(QP_DUMP_INTERVAL), _samples(0), _queue(QP_DUMP_QUEUE),
+    _head(0), _tail(0), _running(false), _written(0), _dropped(0)
+{
+}
+
+QPDumper::~QPDumper()
+{
+  close();
+}
+
+bool QPDumper::open(const std::string& directory, int sample_interval)
+{
+  close();
+
+  if (directory.empty() || !makeDirectory(directory))
+    return false;
+
+  _directory = directory;
+  _sample_interval = std::max(sample_interval, 1);
+  _samples = 0;
+  _head = 0;
+  _tail = 0;
+  _written = 0;
+  _dropped = 0;
+
+  _running = true;
+  _writer = std::thread(&QPDumper::run, this);
+  return true;
+}
+
+void QPDumper::close()
+{
+  if (!_running)
+    return;
+
+  _running = false;
+  _writer.join();
+}
+
+void QPDumper::sample(const qp_solver::Problem& qp)
+{
+  // no legs in contact give an empty problem, it is not an OQP problem
+  if (!_running || qp.n <= 0 || _samples++ % _sample_interval != 0)
+    return;
+
+  long head = _head.load(std::memory_order_relaxed);
+  if (head - _tail.load(std::memory_order_acquire) >= (long)_queue.size())
+  {
+    _dropped++;
+    return;
+  }
+
+  Slot& slot = _queue[head % _queue.size()];
+  int n_C = qp.numConstraints();
+
+  slot.n = qp.n;
+  slot.n_blocks = qp.n_blocks;
+  slot.block_rows = qp.block_rows;
+  slot.block_cols = qp.block_cols;
+  copy(qp.H, qp.n*qp.n, slot.H);
+  copy(qp.g, qp.n, slot.g);
+  copy(qp.lb, qp.n, slot.lb);
+  copy(qp.ub, qp.n, slot.ub);
+  copy(qp.C_blocks, n_C*qp.block_cols, slot.C_blocks);
+  copy(qp.lbC, n_C, slot.lbC);
+  copy(qp.ubC, n_C, slot.ubC);
+
+  _head.store(head + 1, std::memory_order_release);
+}
+
+void QPDumper::run()
+{
+  long index = 0;
+
+  // the queue is emptied after close() as well
+  for (;;)
+  {
+    bool running = _running;
+    long tail = _tail.load(std::memory_order_relaxed);
+
+    if (tail == _head.load(std::memory_order_acquire))
+    {
+      if (!running)
+        break;
+      std::this_thread::sleep_for(std::chrono::milliseconds(QP_DUMP_IDLE_MS));
+      continue;
+    }
+
+    if (write(_queue[tail % _queue.size()], index++))
+      _written++;
+    else
+      _dropped++;
+
+    _tail.store(tail + 1, std::memory_order_release);
+  }
+}
+
+bool QPDumper::write(const Slot& slot, long index) const
+{
+  char name[16];
+  std::snprintf(name, sizeof(name), "%06ld", index);
+  std::string path = _directory + "/" + name + "/";
+  if (!makeDirectory(path))
+    return false;
+
+  int n = slot.n;
+  int n_C = slot.n_blocks*slot.block_rows;
+
+  std::FILE* dims = std::fopen((path + "dims.oqp").c_str(), "w");
+  if (!dims)
+    return false;
+  std::fprintf(dims, "1\n%d\n%d\n0\n", n, n_C);
+  if (std::fclose(dims) != 0)
+    return false;
+
+  const double* lb = slot.lb.empty() ? NULL : slot.lb.data();
+  const double* ub = slot.ub.empty() ? NULL : slot.ub.data();
+  bool ok = writeMatrix(path + "H.oqp", slot.H.data(), n, n) &&
+            writeMatrix(path + "g.oqp", slot.g.data(), 1, n) &&
+            writeMatrix(path + "lb.oqp", lb, 1, n, -QP_DUMP_INFTY) &&
+            writeMatrix(path + "ub.oqp", ub, 1, n, QP_DUMP_INFTY);
+
+  if (n_C > 0 && ok)
+  {
+    // block diagonal C dense
+    std::vector<double> A(n_C*n, 0.0);
+    for (int b=0; b<slot.n_blocks; b++)
+      for (int i=0; i<slot.block_rows; i++)
+        for (int j=0; j<slot.block_cols; j++)
+          A[(b*slot.block_rows + i)*n + b*slot.block_cols + j] = slot.C_blocks[(b*slot.block_rows + i)*slot.block_cols + j];
+
+    const double* lbC = slot.lbC.empty() ? NULL : slot.lbC.data();
+    const double* ubC = slot.ubC.empty() ? NULL : slot.ubC.data();
+    ok = writeMatrix(path + "A.oqp", A.data(), n_C, n) &&
+         writeMatrix(path + "lbA.oqp", lbC, 1, n_C, -QP_DUMP_INFTY) &&
+         writeMatrix(path + "ubA.oqp", ubC, 1, n_C, QP_DUMP_INFTY);
+  }
+
+  return ok;
+}
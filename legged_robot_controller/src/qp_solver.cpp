@@ -0,0 +1,696 @@
+/*
+  Author: Modulabs
+  File Name: qp_solver.cpp
+*/
+
+#include "legged_robot_controller/qp_solver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace qp_solver
+{
+
+typedef Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> > BlockMap;
+
+static double elapsed(const std::chrono::steady_clock::time_point& t_start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+}
+
+// problem data in the precision of the solver, copied only if it differs
+#ifdef __USE_SINGLE_PRECISION__
+static float* toReal(const double* v, int n, std::vector<float>& buffer)
+{
+  if (!v)
+    return NULL;
+  buffer.assign(v, v + n);
+  return buffer.data();
+}
+#else
+static double* toReal(const double* v, int n, std::vector<double>& buffer)
+{
+  return const_cast<double*>(v);
+}
+#endif
+
+// fields of qpOASES::Options in a profile
+struct BoolOption { const char* name; qpOASES::BooleanType qpOASES::Options::* field; };
+struct IntOption { const char* name; int qpOASES::Options::* field; };
+struct RealOption { const char* name; qpOASES::real_t qpOASES::Options::* field; };
+
+static const BoolOption bool_options[] = {
+  {"enableRamping", &qpOASES::Options::enableRamping},
+  {"enableFarBounds", &qpOASES::Options::enableFarBounds},
+  {"enableFlippingBounds", &qpOASES::Options::enableFlippingBounds},
+  {"enableRegularisation", &qpOASES::Options::enableRegularisation},
+  {"enableFullLITests", &qpOASES::Options::enableFullLITests},
+  {"enableNZCTests", &qpOASES::Options::enableNZCTests},
+  {"enableEqualities", &qpOASES::Options::enableEqualities}
+};
+
+static const IntOption int_options[] = {
+  {"enableDriftCorrection", &qpOASES::Options::enableDriftCorrection},
+  {"enableCholeskyRefactorisation", &qpOASES::Options::enableCholeskyRefactorisation},
+  {"numRegularisationSteps", &qpOASES::Options::numRegularisationSteps},
+  {"numRefinementSteps", &qpOASES::Options::numRefinementSteps}
+};
+
+static const RealOption real_options[] = {
+  {"terminationTolerance", &qpOASES::Options::terminationTolerance},
+  {"boundTolerance", &qpOASES::Options::boundTolerance},
+  {"boundRelaxation", &qpOASES::Options::boundRelaxation},
+  {"epsNum", &qpOASES::Options::epsNum},
+  {"epsDen", &qpOASES::Options::epsDen},
+  {"maxPrimalJump", &qpOASES::Options::maxPrimalJump},
+  {"maxDualJump", &qpOASES::Options::maxDualJump},
+  {"initialRamping", &qpOASES::Options::initialRamping},
+  {"finalRamping", &qpOASES::Options::finalRamping},
+  {"initialFarBounds", &qpOASES::Options::initialFarBounds},
+  {"growFarBounds", &qpOASES::Options::growFarBounds},
+  {"epsFlipping", &qpOASES::Options::epsFlipping},
+  {"epsRegularisation", &qpOASES::Options::epsRegularisation},
+  {"epsIterRef", &qpOASES::Options::epsIterRef},
+  {"epsLITests", &qpOASES::Options::epsLITests},
+  {"epsNZCTests", &qpOASES::Options::epsNZCTests}
+};
+
+#define N_OPTIONS(table) (sizeof(table) / sizeof(table[0]))
+
+static bool setOption(qpOASES::Options& options, const std::string& name, std::istringstream& value)
+{
+  if (name == "preset")
+  {
+    std::string preset;
+    value >> preset;
+    if (preset == "default")
+      options.setToDefault();
+    else if (preset == "reliable")
+      options.setToReliable();
+    else if (preset == "MPC")
+      options.setToMPC();
+    else if (preset == "fast")
+      options.setToFast();
+    else
+      return false;
+    return true;
+  }
+
+  if (name == "initialStatusBounds")
+  {
+    int status;
+    value >> status;
+    if (status < qpOASES::ST_LOWER || status > qpOASES::ST_UPPER)
+      return false;
+    options.initialStatusBounds = (qpOASES::SubjectToStatus)status;
+    return !value.fail();
+  }
+
+  for (size_t i=0; i<N_OPTIONS(bool_options); i++)
+  {
+    if (name == bool_options[i].name)
+    {
+      int enable;
+      value >> enable;
+      options.*bool_options[i].field = enable ? qpOASES::BT_TRUE : qpOASES::BT_FALSE;
+      return !value.fail();
+    }
+  }
+  for (size_t i=0; i<N_OPTIONS(int_options); i++)
+  {
+    if (name == int_options[i].name)
+    {
+      value >> options.*int_options[i].field;
+      return !value.fail();
+    }
+  }
+  for (size_t i=0; i<N_OPTIONS(real_options); i++)
+  {
+    if (name == real_options[i].name)
+    {
+      double real;
+      value >> real;
+      options.*real_options[i].field = real;
+      return !value.fail();
+    }
+  }
+
+  return false;
+}
+
+bool loadOptions(const std::string& file_name, qpOASES::Options& options)
+{
+  std::ifstream file(file_name.c_str());
+  if (!file.is_open())
+    return false;
+
+  // a bad line leaves the options as they were
+  qpOASES::Options profile = options;
+
+  std::string line;
+  while (std::getline(file, line))
+  {
+    line = line.substr(0, line.find('#'));
+    if (line.find_first_not_of(" \t\r") == std::string::npos)
+      continue;
+
+    std::istringstream values(line);
+    std::string name;
+    values >> name;
+    if (!setOption(profile, name, values))
+      return false;
+  }
+
+  options = profile;
+  options.ensureConsistency();
+  return true;
+}
+
+bool saveOptions(const std::string& file_name, const qpOASES::Options& options, const std::string& comment)
+{
+  std::ofstream file(file_name.c_str());
+  if (!file.is_open())
+    return false;
+
+  file << "# qpOASES options (qp_solver.h)" << std::endl;
+  if (!comment.empty())
+    file << "# " << comment << std::endl;
+
+  file.precision(17);
+  for (size_t i=0; i<N_OPTIONS(bool_options); i++)
+    file << bool_options[i].name << " " << (options.*bool_options[i].field == qpOASES::BT_TRUE ? 1 : 0) << std::endl;
+  for (size_t i=0; i<N_OPTIONS(int_options); i++)
+    file << int_options[i].name << " " << options.*int_options[i].field << std::endl;
+  for (size_t i=0; i<N_OPTIONS(real_options); i++)
+    file << real_options[i].name << " " << (double)(options.*real_options[i].field) << std::endl;
+  file << "initialStatusBounds " << (int)options.initialStatusBounds << std::endl;
+
+  return file.good();
+}
+
+Solver* createSolver(backends::Backend backend, bool equilibrate)
+{
+  Solver* solver;
+  switch (backend)
+  {
+    case backends::QPOASES:     solver = new QPOASESSolver(); break;
+    case backends::ADMM:        solver = new ADMMSolver(); break;
+    case backends::ADMM_SINGLE: solver = new ADMMSolverSingle(); break;
+    default:                    return NULL;
+  }
+
+  return equilibrate ? new EquilibratedSolver(solver) : solver;
+}
+
+
+QPOASESSolver::QPOASESSolver()
+  : _check_kkt(false), _n_C(-1)
+{
+#ifdef __USE_SINGLE_PRECISION__
+  // default options cycle on the MPC QP in float, without ramping and with regularisation it is solved
+  _options.setToMPC();
+#endif
+}
+
+bool QPOASESSolver::loadOptions(const std::string& file_name)
+{
+  if (!qp_solver::loadOptions(file_name, _options))
+    return false;
+  reset();
+  return true;
+}
+
+bool QPOASESSolver::solve(const Problem& qp)
+{
+  USING_NAMESPACE_QPOASES
+
+  std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+
+  int n = qp.n;
+  int n_C = qp.numConstraints();
+
+  // working set is guessed from the nonzero multipliers of the last solution
+  bool warm = (_n_C == n_C && _x_real.size() == n);
+  if (!warm)
+  {
+    _x_real.resize(n);
+    _y.resize(n + n_C);
+  }
+
+  real_t* H_real = toReal(qp.H, n*n, _H);
+  const real_t* g = toReal(qp.g, n, _g);
+  const real_t* lb = toReal(qp.lb, n, _lb);
+  const real_t* ub = toReal(qp.ub, n, _ub);
+  real_t* C_blocks = toReal(qp.C_blocks, n_C*qp.block_cols, _C_blocks);
+  const real_t* lbC = toReal(qp.lbC, n_C, _lbC);
+  const real_t* ubC = toReal(qp.ubC, n_C, _ubC);
+
+  SymDenseMat H(n, n, n, H_real);
+  BlockDiagMatrix C(qp.n_blocks, qp.block_rows, qp.block_cols, C_blocks);
+
+  returnValue status = RET_INIT_FAILED;
+  int nWSR = 0;
+  double t_check = 0.0;
+
+  // a failed warm start is repeated cold
+  for (int cold = (warm ? 0 : 1); cold <= 1 && status != SUCCESSFUL_RETURN; cold++)
+  {
+    const real_t* y_guess = cold ? NULL : _y.data();
+    nWSR = QPOASES_MAX_NWSR;
+
+    if (n_C > 0)
+    {
+      QProblem qp_problem(n, n_C, HST_UNKNOWN, &_workspace);
+      qp_problem.setOptions(_options);
+      status = qp_problem.init(&H, g, &C, lb, ub, lbC, ubC, nWSR, NULL, NULL, y_guess);
+      qp_problem.getPrimalSolution(_x_real.data());
+      qp_problem.getDualSolution(_y.data());
+      if (_check_kkt)
+        t_check += checkKkt(&qp_problem);
+    }
+    else
+    {
+      QProblemB qp_problem(n, HST_UNKNOWN, &_workspace);
+      qp_problem.setOptions(_options);
+      status = qp_problem.init(&H, g, lb, ub, nWSR, NULL, NULL, y_guess);
+      qp_problem.getPrimalSolution(_x_real.data());
+      qp_problem.getDualSolution(_y.data());
+      if (_check_kkt)
+        t_check += checkKkt(&qp_problem);
+    }
+
+    _statistics.warm_started = !cold;
+    _statistics.factorizations++;
+  }
+
+  _n_C = (status == SUCCESSFUL_RETURN) ? n_C : -1;
+  _x = _x_real.cast<double>();
+
+  _statistics.solved = (status == SUCCESSFUL_RETURN);
+  _statistics.iterations = nWSR;
+  _statistics.solve_time = elapsed(t_start) - t_check;
+
+  return _statistics.solved;
+}
+
+template <typename QProblemType>
+double QPOASESSolver::checkKkt(QProblemType* qp_problem)
+{
+  std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+
+  qpOASES::SolutionAnalysis analysis;
+  _statistics.kkt_violation = analysis.getKktViolation(qp_problem);
+
+  return elapsed(t_start);
+}
+
+
+template <typename Scalar>
+ADMMSolverT<Scalar>::ADMMSolverT()
+  : _rho(ADMM_RHO), _sigma(ADMM_SIGMA), _alpha(ADMM_ALPHA),
+    _eps_abs(ADMM_EPS_ABS), _eps_rel(ADMM_EPS_REL), _max_iter(ADMM_MAX_ITER),
+    _warm(false), _factorized(false), _n(0), _m(0), _n_blocks(0), _block_rows(0), _block_cols(0)
+{
+}
+
+template <>
+backends::Backend ADMMSolverT<double>::getBackend() const { return backends::ADMM; }
+
+template <>
+backends::Backend ADMMSolverT<float>::getBackend() const { return backends::ADMM_SINGLE; }
+
+template <typename Scalar>
+void ADMMSolverT<Scalar>::multiplyA(const VectorS& x, VectorS& z) const
+{
+  int br = _block_rows, bc = _block_cols;
+
+  z.head(_n) = x;
+  for (int b = 0; b < _n_blocks; b++)
+    z.segment(_n + b*br, br).noalias() = _C.middleRows(b*br, br) * x.segment(b*bc, bc);
+}
+
+template <typename Scalar>
+void ADMMSolverT<Scalar>::multiplyAt(const VectorS& z, VectorS& x) const
+{
+  int br = _block_rows, bc = _block_cols;
+
+  x = z.head(_n);
+  for (int b = 0; b < _n_blocks; b++)
+    x.segment(b*bc, bc).noalias() += _C.middleRows(b*br, br).transpose() * z.segment(_n + b*br, br);
+}
+
+template <typename Scalar>
+void ADMMSolverT<Scalar>::setProblem(const Problem& qp)
+{
+  int n_C = qp.numConstraints();
+  const Scalar inf = 1e20;
+
+  _H = Eigen::Map<const Eigen::MatrixXd>(qp.H, _n, _n).cast<Scalar>();
+  _g = Eigen::Map<const Eigen::VectorXd>(qp.g, _n).cast<Scalar>();
+  if (n_C > 0)
+    _C = BlockMap(qp.C_blocks, n_C, qp.block_cols).cast<Scalar>();
+  else
+    _C.resize(0, qp.block_cols);
+
+  _n_blocks = qp.n_blocks;
+  _block_rows = qp.block_rows;
+  _block_cols = qp.block_cols;
+
+  for (int i = 0; i < _n; i++)
+  {
+    _l(i) = qp.lb ? qp.lb[i] : -inf;
+    _u(i) = qp.ub ? qp.ub[i] : inf;
+  }
+  for (int i = _n; i < _m; i++)
+  {
+    _l(i) = qp.lbC ? qp.lbC[i-_n] : -inf;
+    _u(i) = qp.ubC ? qp.ubC[i-_n] : inf;
+  }
+}
+
+template <typename Scalar>
+bool ADMMSolverT<Scalar>::needFactorization() const
+{
+  if (!_factorized)
+    return true;
+
+  if (_C_factorized.rows() != _C.rows() || _C_factorized.cols() != _C.cols())
+    return true;
+  if (_C.rows() > 0 && _C_factorized != _C)
+    return true;
+
+  return _H_factorized != _H;
+}
+
+template <typename Scalar>
+void ADMMSolverT<Scalar>::factorize()
+{
+  int br = _block_rows, bc = _block_cols;
+
+  // K = H + sigma*I + rho*(I + C'C), C'C is block diagonal as C
+  _K = _H;
+  _K.diagonal().array() += _sigma + _rho;
+  for (int b = 0; b < _n_blocks; b++)
+    _K.block(b*bc, b*bc, bc, bc).noalias() += _rho * _C.middleRows(b*br, br).transpose() * _C.middleRows(b*br, br);
+
+  _llt.compute(_K);
+
+  _H_factorized = _H;
+  _C_factorized = _C;
+
+  _factorized = (_llt.info() == Eigen::Success);
+  _statistics.factorizations++;
+}
+
+template <typename Scalar>
+bool ADMMSolverT<Scalar>::solve(const Problem& qp)
+{
+  std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+
+  int n = qp.n;
+  int m = n + qp.numConstraints();
+
+  // iterates of the last problem are kept while the contact set stays
+  bool warm = _warm && n == _n && m == _m;
+  if (!warm)
+  {
+    _n = n;
+    _m = m;
+    _x_iter.setZero(n);
+    _z.setZero(m);
+    _y.setZero(m);
+    _l.resize(m);
+    _u.resize(m);
+    _x_tilde.resize(n);
+    _rhs.resize(n);
+    _Aty.resize(n);
+    _Hx.resize(n);
+    _z_tilde.resize(m);
+    _res.resize(m);
+    _Ax.resize(m);
+    _factorized = false;
+  }
+
+  setProblem(qp);
+
+  if (needFactorization())
+    factorize();
+
+  _statistics.warm_started = warm;
+  _statistics.solved = false;
+  _statistics.iterations = 0;
+
+  if (!_factorized)
+  {
+    _warm = false;
+    _statistics.solve_time = elapsed(t_start);
+    return false;
+  }
+
+  int k;
+  for (k = 1; k <= _max_iter; k++)
+  {
+    // x~ = K^-1 (sigma*x - g + A'(rho*z - y))
+    _res = _rho*_z - _y;
+    multiplyAt(_res, _rhs);
+    _rhs += _sigma*_x_iter - _g;
+
+    _x_tilde = _rhs;
+    _llt.solveInPlace(_x_tilde);
+
+    // relaxed update of x, projection of z, dual ascent of y
+    multiplyA(_x_tilde, _z_tilde);
+    _x_iter = _alpha*_x_tilde + (1 - _alpha)*_x_iter;
+    _z_tilde = _alpha*_z_tilde + (1 - _alpha)*_z;
+    _res = _z_tilde + _y / _rho;
+    _z = _res.cwiseMax(_l).cwiseMin(_u);
+    _y += _rho*(_z_tilde - _z);
+
+    if (k % ADMM_CHECK_INTERVAL == 0 || k == _max_iter)
+    {
+      multiplyA(_x_iter, _Ax);
+      multiplyAt(_y, _Aty);
+      _Hx.noalias() = _H * _x_iter;
+
+      Scalar r_prim = (_Ax - _z).template lpNorm<Eigen::Infinity>();
+      Scalar r_dual = (_Hx + _g + _Aty).template lpNorm<Eigen::Infinity>();
+      Scalar scale_prim = std::max(_Ax.template lpNorm<Eigen::Infinity>(), _z.template lpNorm<Eigen::Infinity>());
+      Scalar scale_dual = std::max(std::max(_Hx.template lpNorm<Eigen::Infinity>(), _Aty.template lpNorm<Eigen::Infinity>()),
+                                   _g.template lpNorm<Eigen::Infinity>());
+
+      if (!std::isfinite(r_prim) || !std::isfinite(r_dual))
+        break;
+
+      if (r_prim <= _eps_abs + _eps_rel*scale_prim && r_dual <= _eps_abs + _eps_rel*scale_dual)
+      {
+        _statistics.solved = true;
+        break;
+      }
+
+      // balance the relative residuals by rho, a new rho needs a new factorization
+      if (k % ADMM_RHO_INTERVAL == 0)
+      {
+        Scalar rho_new = _rho * std::sqrt((r_prim / (scale_prim + Scalar(1e-30))) / (r_dual / (scale_dual + Scalar(1e-30)) + Scalar(1e-30)));
+        rho_new = std::min(std::max(rho_new, Scalar(ADMM_RHO_MIN)), Scalar(ADMM_RHO_MAX));
+        if (rho_new > Scalar(ADMM_RHO_ADAPT) * _rho || rho_new * Scalar(ADMM_RHO_ADAPT) < _rho)
+        {
+          _rho = rho_new;
+          factorize();
+        }
+      }
+    }
+  }
+
+  // diverged iterates are no warm start
+  _warm = _x_iter.allFinite();
+  _x = _x_iter.template cast<double>();
+
+  _statistics.iterations = std::min(k, _max_iter);
+  _statistics.solve_time = elapsed(t_start);
+
+  return _statistics.solved;
+}
+
+template class ADMMSolverT<double>;
+template class ADMMSolverT<float>;
+
+
+
+// scale factor 1/sqrt(norm) of a row or column, zero ones stay
+static double ruizFactor(double norm)
+{
+  if (norm <= 0.0)
+    return 1.0;
+  return std::min(std::max(1.0 / std::sqrt(norm), EQUILIBRATION_MIN), EQUILIBRATION_MAX);
+}
+
+static double clampScale(double d)
+{
+  return std::min(std::max(d, EQUILIBRATION_MIN), EQUILIBRATION_MAX);
+}
+
+void Equilibration::clear()
+{
+  for (size_t i=0; i<_cache.size(); i++)
+    _cache[i].valid = false;
+  _current = NULL;
+}
+
+void Equilibration::compute(const Problem& qp, Scaling& s)
+{
+  int n = qp.n, n_C = qp.numConstraints();
+  int br = qp.block_rows, bc = qp.block_cols;
+
+  s.n = n;
+  s.n_blocks = qp.n_blocks;
+  s.block_rows = br;
+  s.block_cols = bc;
+  s.D.setOnes(n);
+  s.E.setOnes(n_C);
+
+  // scaled copies of H and C, once per contact set
+  Eigen::MatrixXd H = Eigen::Map<const Eigen::MatrixXd>(qp.H, n, n);
+  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> C;
+  if (n_C > 0)
+    C = BlockMap(qp.C_blocks, n_C, bc);
+  Eigen::VectorXd delta(n), eps(n_C);
+
+  // KKT matrix [H C'; C 0] to unit infinity norm of its rows and columns
+  for (int k=0; k<EQUILIBRATION_ITER; k++)
+  {
+    for (int j=0; j<n; j++)
+    {
+      double norm = H.col(j).cwiseAbs().maxCoeff();
+      if (n_C > 0)
+        norm = std::max(norm, C.block((j/bc)*br, j%bc, br, 1).cwiseAbs().maxCoeff());
+      delta(j) = ruizFactor(norm);
+    }
+    for (int i=0; i<n_C; i++)
+      eps(i) = ruizFactor(C.row(i).cwiseAbs().maxCoeff());
+
+    H = delta.asDiagonal() * H * delta.asDiagonal();
+    for (int b=0; b<qp.n_blocks; b++)
+      C.middleRows(b*br, br) = eps.segment(b*br, br).asDiagonal() * C.middleRows(b*br, br) * delta.segment(b*bc, bc).asDiagonal();
+
+    for (int j=0; j<n; j++)
+      s.D(j) = clampScale(s.D(j) * delta(j));
+    for (int i=0; i<n_C; i++)
+      s.E(i) = clampScale(s.E(i) * eps(i));
+  }
+
+  // cost to unit mean column norm of H, or gradient norm if that is larger
+  double mean_norm = 0.0;
+  for (int j=0; j<n; j++)
+    mean_norm += H.col(j).cwiseAbs().maxCoeff() / n;
+  double g_norm = (s.D.cwiseProduct(Eigen::Map<const Eigen::VectorXd>(qp.g, n))).cwiseAbs().maxCoeff();
+  double cost_norm = std::max(mean_norm, g_norm);
+  s.c = (cost_norm > 0.0) ? clampScale(1.0 / cost_norm) : 1.0;
+
+  s.valid = true;
+  _computations++;
+}
+
+void Equilibration::scale(const Problem& qp, Problem& scaled)
+{
+  int n = qp.n, n_C = qp.numConstraints();
+  int br = qp.block_rows, bc = qp.block_cols;
+
+  if (n <= 0)
+  {
+    scaled = qp;
+    _current = NULL;
+    return;
+  }
+
+  int slot = (qp.contact_set >= 0 && qp.contact_set < EQUILIBRATION_CACHE) ? qp.contact_set : EQUILIBRATION_CACHE;
+  Scaling& s = _cache[slot];
+  if (!s.valid || s.n != n || s.n_blocks != qp.n_blocks || s.block_rows != br || s.block_cols != bc)
+    compute(qp, s);
+  _current = &s;
+
+  const Eigen::VectorXd& D = s.D;
+  const Eigen::VectorXd& E = s.E;
+
+  // buffers only grow
+  if (_H.size() < (size_t)(n*n))
+    _H.resize(n*n);
+  if (_g.size() < (size_t)n)
+  {
+    _g.resize(n);
+    _lb.resize(n);
+    _ub.resize(n);
+  }
+  if (_C_blocks.size() < (size_t)(n_C*bc))
+    _C_blocks.resize(n_C*bc);
+  if (_lbC.size() < (size_t)n_C)
+  {
+    _lbC.resize(n_C);
+    _ubC.resize(n_C);
+  }
+
+  // D H D is symmetric, the same for row- and column-major H
+  for (int i=0; i<n; i++)
+    for (int j=0; j<n; j++)
+      _H[i*n + j] = s.c * D(i) * qp.H[i*n + j] * D(j);
+
+  for (int i=0; i<n; i++)
+  {
+    _g[i] = s.c * D(i) * qp.g[i];
+    if (qp.lb)
+      _lb[i] = (std::abs(qp.lb[i]) >= EQUILIBRATION_INFTY) ? qp.lb[i] : qp.lb[i] / D(i);
+    if (qp.ub)
+      _ub[i] = (std::abs(qp.ub[i]) >= EQUILIBRATION_INFTY) ? qp.ub[i] : qp.ub[i] / D(i);
+  }
+
+  for (int b=0; b<qp.n_blocks; b++)
+    for (int r=0; r<br; r++)
+      for (int k=0; k<bc; k++)
+        _C_blocks[(b*br + r)*bc + k] = E(b*br + r) * qp.C_blocks[(b*br + r)*bc + k] * D(b*bc + k);
+
+  for (int i=0; i<n_C; i++)
+  {
+    if (qp.lbC)
+      _lbC[i] = (std::abs(qp.lbC[i]) >= EQUILIBRATION_INFTY) ? qp.lbC[i] : E(i) * qp.lbC[i];
+    if (qp.ubC)
+      _ubC[i] = (std::abs(qp.ubC[i]) >= EQUILIBRATION_INFTY) ? qp.ubC[i] : E(i) * qp.ubC[i];
+  }
+
+  scaled = qp;
+  scaled.H = _H.data();
+  scaled.g = _g.data();
+  scaled.lb = qp.lb ? _lb.data() : NULL;
+  scaled.ub = qp.ub ? _ub.data() : NULL;
+  scaled.C_blocks = (n_C > 0) ? _C_blocks.data() : NULL;
+  scaled.lbC = qp.lbC ? _lbC.data() : NULL;
+  scaled.ubC = qp.ubC ? _ubC.data() : NULL;
+}
+
+void Equilibration::unscale(const Eigen::VectorXd& x_scaled, Eigen::VectorXd& x) const
+{
+  if (!_current || _current->D.size() != x_scaled.size())
+  {
+    x = x_scaled;
+    return;
+  }
+  x = _current->D.cwiseProduct(x_scaled);
+}
+
+
+bool EquilibratedSolver::solve(const Problem& qp)
+{
+  std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+
+  _equilibration.scale(qp, _scaled);
+  bool solved = _solver->solve(_scaled);
+  _equilibration.unscale(_solver->getSolution(), _x);
+
+  _statistics = _solver->getStatistics();
+  _statistics.solve_time = elapsed(t_start);
+
+  return solved;
+}
+
+}
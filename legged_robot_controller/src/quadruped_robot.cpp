@@ -25,6 +25,12 @@ QuadrupedRobot::QuadrupedRobot()
     _kdl_trq_coriolis_leg[i].resize(3);
     _kdl_trq_grav_leg[i].resize(3);
   }
+
+  _contact_states_d.fill(1);
+}
+
+QuadrupedRobot::~QuadrupedRobot()
+{
 }
 
 controllers::Controller QuadrupedRobot::getController(size_t i)
@@ -74,6 +80,8 @@ int QuadrupedRobot::init()
       _kdl_idyn_solver[i].reset(new KDL::ChainDynParam(_kdl_chain[i],_kdl_gravity));
     }
   }
+
+  return 0;
 }
 
 void QuadrupedRobot::updateSensorData(const std::array<Eigen::Vector3d, 4>& q_leg, const std::array<Eigen::Vector3d, 4>& qdot_leg,
@@ -141,10 +149,10 @@ void QuadrupedRobot::calKinematicsDynamics()
   _pose_com._pos = _pose_body * _p_body2com;
   _pose_com._rot_quat = _pose_body._rot_quat;
 
-  _pose_vel_com_d._linear = _pose_vel_body_d._linear + skew(_pose_vel_body_d._linear) * _pose_body_d._rot_quat.toRotationMatrix() * _p_body2com;
+  _pose_vel_com_d._linear = _pose_vel_body_d._linear + so3::hatMul(_pose_vel_body_d._linear, _pose_body_d._rot_quat * _p_body2com);
   _pose_vel_com_d._angular = _pose_vel_body_d._angular;
 
-  _pose_vel_com._linear = _pose_vel_body._linear + skew(_pose_vel_body._linear) * _pose_body._rot_quat.toRotationMatrix() * _p_body2com;
+  _pose_vel_com._linear = _pose_vel_body._linear + so3::hatMul(_pose_vel_body._linear, _pose_body._rot_quat * _p_body2com);
   _pose_vel_com._angular = _pose_vel_body._angular;
 }
 }
@@ -0,0 +1,210 @@
+/*
+  Author: Modulabs
+  File Name: test_behavior_tree.cpp
+*/
+
+/* Loading of behavior trees with their errors, ticking of the motion planner tree in config/,
+ * and propagation of failure and running through sequences, selectors and inverters.
+*/
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "legged_robot_controller/behavior_tree.h"
+
+using namespace behavior_tree;
+
+
+// leaves returning a settable status and counting their ticks
+struct Leaves
+{
+  Status _status[4];
+  int _n_tick[4];
+
+  Leaves()
+  {
+    for (int i=0; i<4; i++)
+    {
+      _status[i] = Success;
+      _n_tick[i] = 0;
+    }
+  }
+
+  void registerTo(BehaviorTree& tree)
+  {
+    const char* names[4] = {"a", "b", "c", "d"};
+    for (int i=0; i<4; i++)
+      tree.registerLeaf(names[i], [this, i]() { _n_tick[i]++; return _status[i]; });
+  }
+
+  void resetTicks()
+  {
+    for (int i=0; i<4; i++)
+      _n_tick[i] = 0;
+  }
+};
+
+
+TEST(BehaviorTree, LoadErrors)
+{
+  Leaves leaves;
+  BehaviorTree tree;
+  leaves.registerTo(tree);
+
+  const char* trees[][2] = {
+    {"", "empty tree"},
+    {"# comment only\n", "empty tree"},
+    {"selector\n   action a\n", "wrong indentation"},
+    {"selector\n    action a\n", "wrong indentation"},
+    {"action a\naction b\n", "wrong indentation"},
+    {"parallel\n  action a\n", "unknown node type parallel"},
+    {"sequence\n  action e\n", "unknown leaf e"},
+    {"inverter\n  action a\n  action b\n", "too many children"},
+    {"sequence\n  condition a\n    action b\n", "too many children"},
+    {"sequence\n  selector\n  action a\n", "composite node without children"},
+  };
+
+  for (size_t k=0; k<sizeof(trees) / sizeof(trees[0]); k++)
+  {
+    EXPECT_FALSE(tree.loadString(trees[k][0])) << trees[k][0];
+    EXPECT_FALSE(tree.isLoaded()) << trees[k][0];
+    EXPECT_NE(tree.getError().find(trees[k][1]), std::string::npos) << tree.getError();
+    EXPECT_EQ(tree.tick(), Failure);
+  }
+
+  // too deep
+  std::string deep;
+  for (int d=0; d<=BT_MAX_DEPTH; d++)
+    deep += std::string(2*d, ' ') + "sequence\n";
+  EXPECT_FALSE(tree.loadString(deep));
+  EXPECT_NE(tree.getError().find("tree is too large"), std::string::npos) << tree.getError();
+
+  EXPECT_FALSE(tree.loadFile("/nonexistent.tree"));
+  EXPECT_NE(tree.getError().find("cannot open"), std::string::npos) << tree.getError();
+
+  // a valid tree clears the error, comments and blank lines are skipped
+  EXPECT_TRUE(tree.loadString("# root\nsequence  # trailing comment\n\n  action a\n  action b\n")) << tree.getError();
+  EXPECT_TRUE(tree.isLoaded());
+  EXPECT_TRUE(tree.getError().empty());
+  EXPECT_EQ(tree.size(), 3u);
+}
+
+TEST(BehaviorTree, Propagation)
+{
+  Leaves leaves;
+  BehaviorTree tree;
+  leaves.registerTo(tree);
+
+  // sequence stops at the first child that does not succeed
+  ASSERT_TRUE(tree.loadString("sequence\n  action a\n  action b\n  action c\n")) << tree.getError();
+  EXPECT_EQ(tree.tick(), Success);
+  EXPECT_EQ(leaves._n_tick[2], 1);
+
+  leaves.resetTicks();
+  leaves._status[1] = Failure;
+  EXPECT_EQ(tree.tick(), Failure);
+  EXPECT_EQ(leaves._n_tick[0], 1);
+  EXPECT_EQ(leaves._n_tick[1], 1);
+  EXPECT_EQ(leaves._n_tick[2], 0);
+
+  leaves.resetTicks();
+  leaves._status[1] = Running;
+  EXPECT_EQ(tree.tick(), Running);
+  EXPECT_EQ(leaves._n_tick[2], 0);
+
+  // selector stops at the first child that does not fail
+  ASSERT_TRUE(tree.loadString("selector\n  action a\n  action b\n  action c\n")) << tree.getError();
+  leaves.resetTicks();
+  leaves._status[0] = Failure;
+  leaves._status[1] = Running;
+  EXPECT_EQ(tree.tick(), Running);
+  EXPECT_EQ(leaves._n_tick[2], 0);
+
+  leaves.resetTicks();
+  leaves._status[1] = Failure;
+  leaves._status[2] = Failure;
+  EXPECT_EQ(tree.tick(), Failure);
+  EXPECT_EQ(leaves._n_tick[0] + leaves._n_tick[1] + leaves._n_tick[2], 3);
+
+  leaves._status[2] = Success;
+  EXPECT_EQ(tree.tick(), Success);
+
+  // inverter swaps success and failure, running passes through
+  ASSERT_TRUE(tree.loadString("inverter\n  condition d\n")) << tree.getError();
+  leaves._status[3] = Success;
+  EXPECT_EQ(tree.tick(), Failure);
+  leaves._status[3] = Failure;
+  EXPECT_EQ(tree.tick(), Success);
+  leaves._status[3] = Running;
+  EXPECT_EQ(tree.tick(), Running);
+
+  // running of a nested action reaches the root through all composites
+  ASSERT_TRUE(tree.loadString("selector\n  sequence\n    inverter\n      condition d\n    action a\n  action b\n")) << tree.getError();
+  leaves.resetTicks();
+  leaves._status[3] = Failure;
+  leaves._status[0] = Running;
+  EXPECT_EQ(tree.tick(), Running);
+  EXPECT_EQ(leaves._n_tick[1], 0);
+
+  // a leaf registered again is replaced, also in a loaded tree
+  tree.registerLeaf("a", []() { return Failure; });
+  leaves._status[1] = Success;
+  EXPECT_EQ(tree.tick(), Success);
+  EXPECT_EQ(leaves._n_tick[1], 1);
+}
+
+TEST(BehaviorTree, MotionPlannerTree)
+{
+  bool is_falling = false, is_standing = false, is_moving = false, is_gait_start = false;
+  int n_falling = 0, n_start_standing = 0, n_standing = 0, n_start_moving = 0, n_moving = 0;
+
+  BehaviorTree tree;
+  tree.registerLeaf("is_falling", [&]() { return is_falling ? Success : Failure; });
+  tree.registerLeaf("is_standing", [&]() { return is_standing ? Success : Failure; });
+  tree.registerLeaf("is_moving", [&]() { return is_moving ? Success : Failure; });
+  tree.registerLeaf("is_gait_start", [&]() { return is_gait_start ? Success : Failure; });
+  tree.registerLeaf("update_falling", [&]() { n_falling++; return Success; });
+  tree.registerLeaf("start_standing", [&]() { n_start_standing++; return Success; });
+  tree.registerLeaf("update_standing", [&]() { n_standing++; return Success; });
+  tree.registerLeaf("start_moving", [&]() { n_start_moving++; return Success; });
+  tree.registerLeaf("update_moving", [&]() { n_moving++; return Success; });
+
+  ASSERT_TRUE(tree.loadFile(LEGGED_ROBOT_CONTROLLER_CONFIG "/motion_planner.tree")) << tree.getError();
+
+  // no state matches
+  EXPECT_EQ(tree.tick(), Failure);
+
+  is_falling = true;
+  EXPECT_EQ(tree.tick(), Success);
+  EXPECT_EQ(n_falling, 1);
+
+  // standing starts once, then updates
+  is_falling = false;
+  is_standing = true;
+  is_gait_start = true;
+  EXPECT_EQ(tree.tick(), Success);
+  is_gait_start = false;
+  EXPECT_EQ(tree.tick(), Success);
+  EXPECT_EQ(n_start_standing, 1);
+  EXPECT_EQ(n_standing, 1);
+
+  // moving starts and updates on the first tick, only updates afterwards
+  is_standing = false;
+  is_moving = true;
+  is_gait_start = true;
+  EXPECT_EQ(tree.tick(), Success);
+  is_gait_start = false;
+  EXPECT_EQ(tree.tick(), Success);
+  EXPECT_EQ(n_start_moving, 1);
+  EXPECT_EQ(n_moving, 2);
+
+  EXPECT_EQ(n_falling, 1);
+  EXPECT_EQ(n_start_standing + n_standing, 2);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,154 @@
+/*
+  Author: Modulabs
+  File Name: test_gait_scheduler.cpp
+*/
+
+/* Gait tables built by GaitScheduler::init, the per tick update against the contact mask,
+ * and the contact lookahead of the MPC against the mask at the predicted times.
+*/
+
+#include <gtest/gtest.h>
+
+#include "legged_robot_controller/gait_scheduler.h"
+
+#define DT 0.001
+#define N_TICKS 5000
+#define N_STRIDES 8
+#define T_START 0.37
+#define EPS 1e-12
+
+using namespace quadruped_robot;
+
+
+TEST(GaitScheduler, Tables)
+{
+  GaitScheduler scheduler;
+  scheduler.init();
+
+  for (int p=0; p<GAIT_PATTERN_NUM; p++)
+  {
+    gait_patterns::GaitPattern pattern = static_cast<gait_patterns::GaitPattern>(p);
+    const GaitTable& g = scheduler.getGaitTable(pattern);
+
+    EXPECT_NEAR(g._T_stance + g._T_swing, g._T_stride, EPS) << "pattern " << p;
+    EXPECT_NEAR(g._T_stance, g._duty * g._T_stride, EPS) << "pattern " << p;
+    EXPECT_NEAR(g._inv_T_stride * g._T_stride, 1.0, EPS) << "pattern " << p;
+    EXPECT_NEAR(g._inv_duty * g._duty, 1.0, EPS) << "pattern " << p;
+
+    // standing patterns never swing
+    if (gait_patterns::isMoving(pattern))
+      EXPECT_NEAR(g._inv_swing * (1.0 - g._duty), 1.0, EPS) << "pattern " << p;
+    else
+      EXPECT_EQ(g._T_swing, 0.0) << "pattern " << p;
+  }
+
+  // trot: diagonal pairs share their phase
+  const GaitTable& trot = scheduler.getGaitTable(gait_patterns::Trotting);
+  EXPECT_EQ(trot._offset[0], trot._offset[3]);
+  EXPECT_EQ(trot._offset[1], trot._offset[2]);
+  EXPECT_NEAR(std::fabs(trot._offset[0] - trot._offset[1]), 0.5, EPS);
+}
+
+TEST(GaitScheduler, UpdateMatchesMask)
+{
+  GaitScheduler scheduler;
+  scheduler.init();
+  QuadrupedRobot robot;
+
+  for (int p=gait_patterns::Standing; p<GAIT_PATTERN_NUM; p++)
+  {
+    gait_patterns::GaitPattern pattern = static_cast<gait_patterns::GaitPattern>(p);
+    const GaitTable& g = scheduler.getGaitTable(pattern);
+    scheduler.start(pattern, T_START);
+
+    // whole strides, so that every leg gets its duty factor of contact
+    int n_ticks = static_cast<int>(std::lround(N_STRIDES * g._T_stride / DT));
+    std::array<int, 4> n_contact = {0, 0, 0, 0};
+    for (int k=0; k<n_ticks; k++)
+    {
+      double t = T_START + k * DT;
+      scheduler.update(t, robot);
+      int mask = scheduler.getContactMask(t);
+
+      for (int i=0; i<4; i++)
+      {
+        ASSERT_EQ(robot._contact_states_d[i], (mask >> i) & 1) << "pattern " << p << " tick " << k << " leg " << i;
+        EXPECT_GE(scheduler._phase[i], 0.0);
+        EXPECT_LT(scheduler._phase[i], 1.0);
+        EXPECT_NEAR(robot._t_leg[i], scheduler._phase[i] * g._T_stride, EPS);
+
+        // stance runs 0 -> 1 while swing is held at 0, and the other way round
+        if (robot._contact_states_d[i])
+        {
+          EXPECT_NEAR(robot._S_stance[i], scheduler._phase[i] / g._duty, EPS);
+          EXPECT_EQ(robot._S_swing[i], 0.0);
+        }
+        else
+        {
+          EXPECT_EQ(robot._S_stance[i], 1.0);
+          EXPECT_NEAR(robot._S_swing[i], (scheduler._phase[i] - g._duty) / (1.0 - g._duty), EPS);
+        }
+        n_contact[i] += robot._contact_states_d[i];
+      }
+    }
+
+    // up to one tick of rounding per stride
+    for (int i=0; i<4; i++)
+      EXPECT_NEAR(n_contact[i], g._duty * n_ticks, N_STRIDES + 1) << "pattern " << p << " leg " << i;
+  }
+
+  // phases start at the offsets
+  scheduler.start(gait_patterns::Walking, T_START);
+  scheduler.update(T_START, robot);
+  const GaitTable& walk = scheduler.getGaitTable(gait_patterns::Walking);
+  for (int i=0; i<4; i++)
+    EXPECT_NEAR(scheduler._phase[i], walk._offset[i] - std::floor(walk._offset[i]), EPS);
+}
+
+TEST(GaitScheduler, Lookahead)
+{
+  const int n_step = 10;
+  const double dt = 0.03;
+
+  GaitScheduler scheduler;
+  scheduler.init();
+
+  for (int p=gait_patterns::Standing; p<GAIT_PATTERN_NUM; p++)
+  {
+    scheduler.start(static_cast<gait_patterns::GaitPattern>(p), T_START);
+
+    std::array<int, 4> contacts[n_step];
+    for (int k=0; k<N_TICKS; k+=7)
+    {
+      double t = T_START + k * DT;
+      scheduler.getContactLookahead(t, dt, n_step, contacts);
+
+      for (int j=0; j<n_step; j++)
+      {
+        // away from the phase switches the accumulated time steps give the same contacts
+        int mask = scheduler.getContactMask(t + j * dt);
+        int mask_early = scheduler.getContactMask(t + j * dt - EPS);
+        int mask_late = scheduler.getContactMask(t + j * dt + EPS);
+        if (mask_early != mask_late)
+          continue;
+
+        for (int i=0; i<4; i++)
+          EXPECT_EQ(contacts[j][i], (mask >> i) & 1) << "pattern " << p << " tick " << k << " step " << j << " leg " << i;
+      }
+    }
+  }
+
+  // standing keeps every leg on the ground over the whole horizon
+  scheduler.start(gait_patterns::Standing, T_START);
+  std::array<int, 4> contacts[n_step];
+  scheduler.getContactLookahead(T_START + 1.234, dt, n_step, contacts);
+  for (int j=0; j<n_step; j++)
+    for (int i=0; i<4; i++)
+      EXPECT_EQ(contacts[j][i], 1);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,49 @@
+/*
+  Author: Modulabs
+  File Name: test_mpc_discretisation.cpp
+*/
+
+/* cal_A_d and cal_B_d of MPCController against the RK4 reference of mpc_discretisation.h,
+ * on a fixed seed. mpc_discretisation_check prints the errors over more cases and the time.
+*/
+
+#include <cstdlib>
+
+#include <gtest/gtest.h>
+
+#include "mpc_discretisation.h"
+
+#define N_CASES 300
+#define SEED 1
+
+
+TEST(MPCDiscretisation, MatchesReference)
+{
+  std::srand(SEED);
+
+  MPCController mpc;
+  mpc.init();
+  Model model;
+  Eigen::MatrixXd A_ref, B_ref;
+
+  for (int k=0; k<N_CASES; k++)
+  {
+    randomModel(model);
+    reference(model, A_ref, B_ref);
+
+    setModel(mpc, model);
+    mpc.cal_A_d();
+    mpc.cal_B_d(model.Rz, model.R_leg, mpc._B_d);
+    mpc.cal_B_d(mpc._Rz_d, mpc._R_leg_d, mpc._B_d_d);
+
+    EXPECT_LT(relativeError(mpc._A_d, A_ref), DISCRETISATION_ERROR_MAX) << "case " << k;
+    EXPECT_LT(relativeError(mpc._B_d, B_ref), DISCRETISATION_ERROR_MAX) << "case " << k;
+    EXPECT_LT(relativeError(mpc._B_d_d, B_ref), DISCRETISATION_ERROR_MAX) << "case " << k;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,151 @@
+/*
+  Author: Modulabs
+  File Name: test_so3.cpp
+*/
+
+/* exp/log round trips of the SO(3) kernels of legged_robot_math, for rotation matrices and quaternions,
+ * at angles around the Taylor series threshold near 0 and around the symmetric part path near pi.
+*/
+
+#include <cmath>
+#include <cstdlib>
+
+#include <gtest/gtest.h>
+
+#include "legged_robot_math/so3.h"
+
+#define N_AXES 200
+#define SEED 1
+
+using Eigen::Vector3d;
+using Eigen::Matrix3d;
+using Eigen::Quaterniond;
+
+
+inline Vector3d randomAxis()
+{
+  Vector3d a;
+  do
+  {
+    a = Vector3d::Random();
+  } while (a.norm() < 0.1);
+
+  return a.normalized();
+}
+
+// angles near 0 and the Taylor series threshold, and near pi and the switch to the symmetric part (cos = -0.9)
+const double angles[] = {
+  0.0, 1e-12, 1e-8, 1e-5, 1e-3, 0.5 * std::sqrt(SO3_TAYLOR_THRESHOLD), std::sqrt(SO3_TAYLOR_THRESHOLD) * (1 - 1e-9),
+  std::sqrt(SO3_TAYLOR_THRESHOLD) * (1 + 1e-9), 0.1, 1.0, 2.0,
+  std::acos(-0.9) - 1e-9, std::acos(-0.9) + 1e-9, 3.0, M_PI - 1e-3, M_PI - 1e-6, M_PI - 1e-9
+};
+const int n_angles = sizeof(angles) / sizeof(double);
+
+// error of the recovered rotation vector, relative to the angle also near 0
+inline double tolerance(double t)
+{
+  return 1e-13 * t;
+}
+
+
+TEST(SO3, ExpMatchesAngleAxis)
+{
+  std::srand(SEED);
+
+  for (int k=0; k<N_AXES; k++)
+  {
+    Vector3d a = randomAxis();
+    for (int j=0; j<n_angles; j++)
+    {
+      Matrix3d R = so3::exp(angles[j] * a);
+      Matrix3d R_ref = Eigen::AngleAxisd(angles[j], a).toRotationMatrix();
+      EXPECT_LT((R - R_ref).cwiseAbs().maxCoeff(), 1e-15 * 4) << "angle " << angles[j];
+
+      Quaterniond q = so3::expQ(angles[j] * a);
+      EXPECT_NEAR(q.norm(), 1.0, 1e-15 * 4) << "angle " << angles[j];
+      EXPECT_LT((q.toRotationMatrix() - R_ref).cwiseAbs().maxCoeff(), 1e-15 * 4) << "angle " << angles[j];
+    }
+  }
+}
+
+TEST(SO3, LogExpRoundTrip)
+{
+  std::srand(SEED);
+
+  for (int k=0; k<N_AXES; k++)
+  {
+    Vector3d a = randomAxis();
+    for (int j=0; j<n_angles; j++)
+    {
+      Vector3d w = angles[j] * a;
+
+      Vector3d w_R = so3::log(so3::exp(w));
+      EXPECT_LE((w_R - w).norm(), tolerance(angles[j])) << "angle " << angles[j] << " axis " << a.transpose();
+
+      Vector3d w_q = so3::log(so3::expQ(w));
+      EXPECT_LE((w_q - w).norm(), tolerance(angles[j])) << "angle " << angles[j] << " axis " << a.transpose();
+
+      // -q is the same rotation
+      Quaterniond q = so3::expQ(w);
+      Quaterniond q_neg(-q.w(), -q.x(), -q.y(), -q.z());
+      EXPECT_LE((so3::log(q_neg) - w).norm(), tolerance(angles[j])) << "angle " << angles[j];
+    }
+  }
+}
+
+TEST(SO3, ExpLogRoundTripAtPi)
+{
+  std::srand(SEED);
+
+  // log of a half turn is either of the two opposite vectors, both map back to the same rotation
+  for (int k=0; k<N_AXES; k++)
+  {
+    Vector3d a = randomAxis();
+    Matrix3d R = Eigen::AngleAxisd(M_PI, a).toRotationMatrix();
+
+    Vector3d w = so3::log(R);
+    EXPECT_NEAR(w.norm(), M_PI, 1e-12) << "axis " << a.transpose();
+    EXPECT_NEAR(std::fabs(w.normalized().dot(a)), 1.0, 1e-12) << "axis " << a.transpose();
+    EXPECT_LT((so3::exp(w) - R).cwiseAbs().maxCoeff(), 1e-12) << "axis " << a.transpose();
+
+    Quaterniond q(Eigen::AngleAxisd(M_PI, a));
+    w = so3::log(q);
+    EXPECT_NEAR(w.norm(), M_PI, 1e-12) << "axis " << a.transpose();
+    EXPECT_LT((so3::exp(w) - R).cwiseAbs().maxCoeff(), 1e-12) << "axis " << a.transpose();
+  }
+
+  // angles past pi wrap to the opposite axis
+  Vector3d a = randomAxis();
+  double t = M_PI + 0.1;
+  EXPECT_LT((so3::log(so3::exp(t * a)) + (2*M_PI - t) * a).norm(), 1e-12);
+  EXPECT_LT((so3::log(so3::expQ(t * a)) + (2*M_PI - t) * a).norm(), 1e-12);
+}
+
+TEST(SO3, JacobianLog)
+{
+  std::srand(SEED);
+  const double dt = 1e-6;
+
+  // e_dot = J(e) w for R_e = exp(w dt) R_e, by central differences
+  for (int k=0; k<N_AXES; k++)
+  {
+    Vector3d a = randomAxis(), w = Vector3d::Random();
+    for (int j=0; j<n_angles; j++)
+    {
+      if (angles[j] > 3.0)
+        continue;   // log is not smooth at pi
+
+      Vector3d e = angles[j] * a;
+      Matrix3d R_e = so3::exp(e);
+      Vector3d e_dot = (so3::log(so3::exp(w * dt) * R_e) - so3::log(so3::exp(-w * dt) * R_e)) / (2 * dt);
+
+      EXPECT_LT((so3::jacobianLog(e) * w - e_dot).norm(), 1e-7) << "angle " << angles[j];
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,203 @@
+/*
+  Author: Modulabs
+  File Name: test_trajectory_table.cpp
+*/
+
+/* Cubic Hermite interpolation of TrajectoryTable against the sampled trajectories,
+ * and the footstep re-targeting of MainController's swing legs.
+*/
+
+#include <array>
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "legged_robot_math/bezier.h"
+#include "legged_robot_math/trajectory_table.h"
+
+#define N_EVAL 1000
+#define RESOLUTION 50
+#define EPS 1e-12
+
+using Eigen::Vector3d;
+typedef trajectory::TrajectoryTable<3> Table;
+
+
+// smooth but not polynomial, so that the interpolation error is visible
+struct Wave
+{
+  void getPoint(double s, Vector3d& p, Vector3d& p_dot, Vector3d& p_ddot) const
+  {
+    const double w = 3.0;
+    p = Vector3d(std::sin(w*s), std::cos(w*s), std::exp(s));
+    p_dot = Vector3d(w*std::cos(w*s), -w*std::sin(w*s), std::exp(s));
+    p_ddot = Vector3d(-w*w*std::sin(w*s), -w*w*std::cos(w*s), std::exp(s));
+  }
+};
+
+// swing curve of MainController
+inline trajectory::Bezier<3, 4> swingCurve()
+{
+  std::array<Vector3d, 4> pnts;
+  pnts[0] = Vector3d(-0.3, 0, -0.5);
+  pnts[1] = Vector3d(-0.3, 0, -0.3);
+  pnts[2] = Vector3d(0.3, 0, -0.3);
+  pnts[3] = Vector3d(0.3, 0, -0.5);
+
+  trajectory::Bezier<3, 4> curve;
+  curve.setPoints(pnts);
+  return curve;
+}
+
+// largest error of position, velocity and acceleration over the phase
+template<class Trajectory>
+void interpolationError(const Trajectory& traj, const Table& table, std::array<double, 3>& err)
+{
+  err.fill(0);
+  for (int k=0; k<=N_EVAL; k++)
+  {
+    double s = double(k) / N_EVAL;
+    Vector3d p, p_dot, p_ddot, q, q_dot, q_ddot;
+    traj.getPoint(s, p, p_dot, p_ddot);
+    table.getPoint(s, q, q_dot, q_ddot);
+
+    err[0] = std::max(err[0], (p - q).cwiseAbs().maxCoeff());
+    err[1] = std::max(err[1], (p_dot - q_dot).cwiseAbs().maxCoeff());
+    err[2] = std::max(err[2], (p_ddot - q_ddot).cwiseAbs().maxCoeff());
+  }
+}
+
+
+TEST(TrajectoryTable, HermiteError)
+{
+  // cubic swing curve is reproduced exactly
+  trajectory::Bezier<3, 4> swing = swingCurve();
+  Table table;
+  table.build(swing, RESOLUTION);
+  EXPECT_EQ(table.getResolution(), RESOLUTION);
+
+  std::array<double, 3> err;
+  interpolationError(swing, table, err);
+  EXPECT_LT(err[0], EPS);
+  EXPECT_LT(err[1], 1e-10);
+  EXPECT_LT(err[2], 1e-8);
+
+  // otherwise position converges with h^4, velocity with h^3 and acceleration with h^2
+  Wave wave;
+  std::array<double, 3> err_coarse, err_fine;
+  table.build(wave, RESOLUTION);
+  interpolationError(wave, table, err_coarse);
+  table.build(wave, 2*RESOLUTION - 1);
+  interpolationError(wave, table, err_fine);
+
+  EXPECT_LT(err_coarse[0], 1e-6);
+  EXPECT_GT(err_coarse[0] / err_fine[0], 12.0);
+  EXPECT_GT(err_coarse[1] / err_fine[1], 6.0);
+  EXPECT_GT(err_coarse[2] / err_fine[2], 3.0);
+
+  // phase is clamped to [0, 1]
+  Vector3d p, p_dot, p_ddot, q, q_dot, q_ddot;
+  table.getPoint(-0.5, p, p_dot, p_ddot);
+  table.getPoint(0.0, q, q_dot, q_ddot);
+  EXPECT_LT((p - q).norm(), EPS);
+  table.getPoint(1.5, p, p_dot, p_ddot);
+  EXPECT_LT((p - table.getEndPoint()).norm(), EPS);
+}
+
+TEST(TrajectoryTable, Retarget)
+{
+  trajectory::Bezier<3, 4> swing = swingCurve();
+  Table table;
+  table.build(swing, RESOLUTION);
+  Table::Correction correction;
+
+  Vector3d p, p_dot, p_ddot, q, q_dot, q_ddot;
+
+  // no correction until re-targeted
+  table.getPoint(0.3, correction, p, p_dot, p_ddot);
+  table.getPoint(0.3, q, q_dot, q_ddot);
+  EXPECT_LT((p - q).norm(), EPS);
+
+  // new footstep mid-swing: continuous at the phase of re-targeting, ends on the target at rest
+  const double s_retarget[2] = {0.4, 0.7};
+  const Vector3d targets[2] = {Vector3d(0.38, 0.02, -0.5), Vector3d(0.25, -0.03, -0.48)};
+  Vector3d end_dot, end_ddot;
+  table.getPoint(1.0, q, end_dot, end_ddot);
+
+  for (int k=0; k<2; k++)
+  {
+    double s = s_retarget[k];
+    table.getPoint(s, correction, q, q_dot, q_ddot);
+    table.retarget(s, targets[k], correction);
+    table.getPoint(s, correction, p, p_dot, p_ddot);
+
+    EXPECT_LT((p - q).norm(), EPS) << "retarget " << k;
+    EXPECT_LT((p_dot - q_dot).norm(), 1e-10) << "retarget " << k;
+    EXPECT_LT((p_ddot - q_ddot).norm(), 1e-8) << "retarget " << k;
+
+    table.getPoint(1.0, correction, p, p_dot, p_ddot);
+    EXPECT_LT((p - targets[k]).norm(), EPS) << "retarget " << k;
+    EXPECT_LT((p_dot - end_dot).norm(), 1e-10) << "retarget " << k;
+    EXPECT_LT((p_ddot - end_ddot).norm(), 1e-8) << "retarget " << k;
+
+    // the swing before the first re-targeting is not changed
+    if (k == 0)
+    {
+      table.getPoint(0.5 * s, correction, p, p_dot, p_ddot);
+      table.getPoint(0.5 * s, q, q_dot, q_ddot);
+      EXPECT_LT((p - q).norm(), EPS);
+    }
+  }
+
+  // corrected trajectory stays smooth: no jump between neighbouring evaluations
+  Vector3d p_prev;
+  table.getPoint(0.0, correction, p_prev, p_dot, p_ddot);
+  double max_step = 0;
+  for (int k=1; k<=N_EVAL; k++)
+  {
+    table.getPoint(double(k) / N_EVAL, correction, p, p_dot, p_ddot);
+    max_step = std::max(max_step, (p - p_prev).norm());
+    p_prev = p;
+  }
+  EXPECT_LT(max_step, 5.0 / N_EVAL);
+
+  // nothing is left to move at the end of the swing
+  Table::Correction end_correction = correction;
+  table.retarget(1.0, Vector3d::Zero(), end_correction);
+  EXPECT_EQ(end_correction._s0, correction._s0);
+  EXPECT_TRUE(end_correction._q.isApprox(correction._q));
+
+  correction.reset();
+  EXPECT_FALSE(correction._active);
+}
+
+// per tick re-targeting to the same footstep, as MainController does for a swing leg
+TEST(TrajectoryTable, RetargetEveryTick)
+{
+  trajectory::Bezier<3, 4> swing = swingCurve();
+  Table table;
+  table.build(swing, RESOLUTION);
+  Table::Correction correction;
+
+  const Vector3d target = table.getEndPoint() + Vector3d(0.05, 0, 0);
+  Vector3d p, p_dot, p_ddot, q, q_dot, q_ddot;
+  double max_jump = 0;
+
+  for (int k=0; k<=N_EVAL; k++)
+  {
+    double s = double(k) / N_EVAL;
+    table.getPoint(s, correction, q, q_dot, q_ddot);
+    table.retarget(s, target, correction);
+    table.getPoint(s, correction, p, p_dot, p_ddot);
+    max_jump = std::max(max_jump, (p - q).norm());
+  }
+
+  EXPECT_LT(max_jump, EPS);
+  EXPECT_LT((p - target).norm(), EPS);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
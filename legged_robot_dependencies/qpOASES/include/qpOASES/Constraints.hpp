@@ -84,6 +84,13 @@ class Constraints : public SubjectTo
 		returnValue init(	int _n = 0					/**< Number of constraints. */
 							);
 
+		/** Initialises object with given number of constraints, taking all arrays from a workspace.
+		 *	\return SUCCESSFUL_RETURN \n
+		 			RET_INVALID_ARGUMENTS */
+		returnValue init(	int _n,						/**< Number of constraints. */
+							Workspace* const _workspace	/**< Workspace for the arrays (0 for heap). */
+							);
+
 
 		/** Initially adds number of a new (i.e. not yet in the list) constraint to
 		 *  a given index set.
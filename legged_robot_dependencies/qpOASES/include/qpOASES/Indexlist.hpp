@@ -37,7 +37,14 @@
 #define QPOASES_INDEXLIST_HPP
 
 
-#include <qpOASES/Utils.hpp>
+#include <qpOASES/Workspace.hpp>
+
+
+/** Index lists of up to this physical length (at most 64) keep a bit mask of their
+ *  numbers, 0 disables the masks. */
+#ifndef INDEXLIST_MASK_LENGTH
+	#define INDEXLIST_MASK_LENGTH 64
+#endif
 
 
 BEGIN_NAMESPACE_QPOASES
@@ -48,6 +55,13 @@ BEGIN_NAMESPACE_QPOASES
  *
  *	This class manages index lists of active/inactive bounds/constraints.
  *
+ *	The numbers are kept in the order they were added (which is the order of the
+ *	columns in the factorisations of QProblem), iSort sorts them. Lists of up to
+ *	INDEXLIST_MASK_LENGTH numbers in 0..INDEXLIST_MASK_LENGTH-1 additionally keep a
+ *	bit mask of their numbers, so membership tests and searches are one popcount
+ *	instead of a bisection over iSort. Adding a number outside this range (or twice)
+ *	falls back to bisection until the next init().
+ *
  *	\author Hans Joachim Ferreau
  *	\version 3.1
  *	\date 2007-2015
@@ -62,6 +76,7 @@ class Indexlist
 	friend class SparseMatrix;
 	friend class SparseMatrixRow;
 	friend class SymSparseMat;
+	friend class BlockDiagMatrix;
 
 	/*
 	 *	PUBLIC MEMBER FUNCTIONS
@@ -92,6 +107,13 @@ class Indexlist
 		returnValue init(	int n = 0	/**< Physical length of index list. */
 							);
 
+		/** Initialises index list of desired physical length, taking its arrays from a workspace.
+		 *	\return SUCCESSFUL_RETURN \n
+		 			RET_INVALID_ARGUMENTS */
+		returnValue init(	int n,						/**< Physical length of index list. */
+							Workspace* const _workspace	/**< Workspace for the arrays (0 for heap). */
+							);
+
 
 		/** Creates an array of all numbers within the index set in correct order.
 		 *	\return SUCCESSFUL_RETURN \n
@@ -185,6 +207,11 @@ class Indexlist
 		int	last;			/**< Physical index of last element. */
 		int	lastusedindex;	/**< Physical index of last entry in index list. */
 		int	physicallength;	/**< Physical length of index list. */
+
+		unsigned long long mask;	/**< Bit i is set iff number i is in the list (if useMask). */
+		BooleanType useMask;		/**< Indicates if mask holds all numbers of the list. */
+
+		Workspace* workspace;	/**< Workspace the arrays are taken from (0 for heap). */
 };
 
 END_NAMESPACE_QPOASES
@@ -77,6 +77,15 @@ inline int Indexlist::getLastNumber( ) const
  */
 inline BooleanType Indexlist::isMember( int _number ) const
 {
+	if ( useMask == BT_TRUE )
+	{
+		/* 64 bits of mask, INDEXLIST_MASK_LENGTH of the library may differ */
+		if ( ( _number >= 0 ) && ( _number < 64 ) && ( ( ( mask >> _number ) & 1ULL ) != 0 ) )
+			return BT_TRUE;
+		else
+			return BT_FALSE;
+	}
+
 	if ( getIndex( _number ) >= 0 )
 		return BT_TRUE;
 	else
@@ -52,6 +52,8 @@
 	#define SYR2 ssyr2_
 	/** Macro for calling level 3 BLAS operation in single precision. */
 	#define POTRF spotrf_
+	/** Macro for calling triangular solve in single precision. */
+	#define TRTRS strtrs_
 
 #else
 
@@ -63,6 +65,8 @@
 	#define SYR2 dsyr2_
 	/** Macro for calling level 3 BLAS operation in double precision. */
 	#define POTRF dpotrf_
+	/** Macro for calling triangular solve in double precision. */
+	#define TRTRS dtrtrs_
 
 #endif /* __USE_SINGLE_PRECISION__ */
 
@@ -70,32 +74,39 @@
 extern "C"
 {
 	/** Performs one of the matrix-matrix operation in double precision. */
-	void dgemm_ ( const char*, const char*, const unsigned long*, const unsigned long*, const unsigned long*,
-			const double*, const double*, const unsigned long*, const double*, const unsigned long*,
-			const double*, double*, const unsigned long* );
+	void dgemm_ ( const char*, const char*, const la_uint_t*, const la_uint_t*, const la_uint_t*,
+			const double*, const double*, const la_uint_t*, const double*, const la_uint_t*,
+			const double*, double*, const la_uint_t* );
 	/** Performs one of the matrix-matrix operation in single precision. */
-	void sgemm_ ( const char*, const char*, const unsigned long*, const unsigned long*, const unsigned long*,
-			const float*, const float*, const unsigned long*, const float*, const unsigned long*,
-			const float*, float*, const unsigned long* );
+	void sgemm_ ( const char*, const char*, const la_uint_t*, const la_uint_t*, const la_uint_t*,
+			const float*, const float*, const la_uint_t*, const float*, const la_uint_t*,
+			const float*, float*, const la_uint_t* );
 
 	/** Performs a symmetric rank 1 operation in double precision. */
-	void dsyr_ ( const char *, const unsigned long *, const double *, const double *,
-				 const unsigned long *, double *, const unsigned long *);
+	void dsyr_ ( const char *, const la_uint_t *, const double *, const double *,
+				 const la_uint_t *, double *, const la_uint_t *);
 	/** Performs a symmetric rank 1 operation in single precision. */
-	void ssyr_ ( const char *, const unsigned long *, const float *, const float *,
-				 const unsigned long *, float *, const unsigned long *);
+	void ssyr_ ( const char *, const la_uint_t *, const float *, const float *,
+				 const la_uint_t *, float *, const la_uint_t *);
 
 	/** Performs a symmetric rank 2 operation in double precision. */
-	void dsyr2_ ( const char *, const unsigned long *, const double *, const double *,
-				  const unsigned long *, const double *, const unsigned long *, double *, const unsigned long *);
+	void dsyr2_ ( const char *, const la_uint_t *, const double *, const double *,
+				  const la_uint_t *, const double *, const la_uint_t *, double *, const la_uint_t *);
 	/** Performs a symmetric rank 2 operation in single precision. */
-	void ssyr2_ ( const char *, const unsigned long *, const float *, const float *,
-				  const unsigned long *, const float *, const unsigned long *, float *, const unsigned long *);
+	void ssyr2_ ( const char *, const la_uint_t *, const float *, const float *,
+				  const la_uint_t *, const float *, const la_uint_t *, float *, const la_uint_t *);
 
 	/** Calculates the Cholesky factorization of a real symmetric positive definite matrix in double precision. */
-	void dpotrf_ ( const char *, const unsigned long *, double *, const unsigned long *, long * );
+	void dpotrf_ ( const char *, const la_uint_t *, double *, const la_uint_t *, la_int_t * );
 	/** Calculates the Cholesky factorization of a real symmetric positive definite matrix in single precision. */
-	void spotrf_ ( const char *, const unsigned long *, float *, const unsigned long *, long * );
+	void spotrf_ ( const char *, const la_uint_t *, float *, const la_uint_t *, la_int_t * );
+
+	/** Solves a triangular system with multiple right-hand sides in double precision. */
+	void dtrtrs_ ( const char *, const char *, const char *, const la_uint_t *, const la_uint_t *,
+				   const double *, const la_uint_t *, double *, const la_uint_t *, la_int_t * );
+	/** Solves a triangular system with multiple right-hand sides in single precision. */
+	void strtrs_ ( const char *, const char *, const char *, const la_uint_t *, const la_uint_t *,
+				   const float *, const la_uint_t *, float *, const la_uint_t *, la_int_t * );
 }
 
 
@@ -110,6 +121,29 @@ BEGIN_NAMESPACE_QPOASES
 typedef int sparse_int_t;
 
 
+/** Determines the envelope of the upper triangle of the leading n x n block of a
+ *  (column-major, leading dimension lda), i.e. the row of the first nonzero entry
+ *  of each column.
+ *	\return Flops of the envelope factorisation relative to the dense one (<= 1). */
+real_t getEnvelope(	int n,					/**< Dimension of the block. */
+					const real_t* const a,	/**< Matrix (only upper triangle is used). */
+					int lda,				/**< Leading dimension of a. */
+					int* first				/**< Output: first nonzero row of each column. */
+					);
+
+/** Computes the upper Cholesky factor R'*R = A of the leading n x n block of a
+ *  in place, like POTRF, but skips the entries outside the envelope of A (which
+ *  are zero in R as well). The sums are taken in the same order as in the POTRF
+ *  of LAPACKReplacement up to 32 columns, so both give identical factors there.
+ *	\return 0 on success, or the (1-based) column of the first non-positive pivot,
+ *			whose value is tunneled to a[0] as done by POTRF. */
+la_int_t POTRFenvelope(	int n,					/**< Dimension of the block. */
+						real_t* a,				/**< Matrix, overwritten by its factor. */
+						int lda,				/**< Leading dimension of a. */
+						const int* const first	/**< First nonzero row of each column, see getEnvelope(). */
+						);
+
+
 /**
  *	\brief Abstract base class for interfacing tailored matrix-vector operations.
  *
@@ -814,6 +848,163 @@ class SparseMatrixRow : public virtual Matrix
 };
 
 
+/**
+ *	\brief Interfaces matrix-vector operations tailored to block diagonal matrices.
+ *
+ *	Block diagonal matrix with nBlocks dense blocks of equal size, e.g. the
+ *	friction pyramids of the stance legs (one 4x3 block per leg and stage).
+ *	The blocks are stored one after another in row major format, which is the
+ *	layout of the (nBlocks*blockRows) x blockCols matrix stacking them. Only
+ *	the blocks are stored and touched, so memory and products grow linearly
+ *	with the number of blocks.
+ *
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ */
+class BlockDiagMatrix : public virtual Matrix
+{
+	public:
+		/** Default constructor. */
+		BlockDiagMatrix( );
+
+		/** Constructor with arguments, the blocks are not copied. */
+		BlockDiagMatrix(	int nb,				/**< Number of blocks. */
+							int br,				/**< Number of rows of each block. */
+							int bc,				/**< Number of columns of each block. */
+							real_t *v			/**< Blocks, stacked and row major (nb*br*bc). */
+							);
+
+		/** Constructor from dense matrix, copies the diagonal blocks (other entries are ignored). */
+		BlockDiagMatrix(	int nb,					/**< Number of blocks. */
+							int br,					/**< Number of rows of each block. */
+							int bc,					/**< Number of columns of each block. */
+							int ld,					/**< Leading dimension. */
+							const real_t * const v	/**< Row major stored matrix elements. */
+							);
+
+		/** Destructor. */
+		virtual ~BlockDiagMatrix( );
+
+		/** Frees all internal memory. */
+		virtual void free( );
+
+		/** Returns a deep-copy of the Matrix object.
+		 *	\return Deep-copy of Matrix object */
+		virtual Matrix *duplicate( ) const;
+
+		/** Returns i-th diagonal entry.
+		 *	\return i-th diagonal entry */
+		virtual real_t diag(	int i			/**< Index. */
+								) const;
+
+		/** Checks whether matrix is square and diagonal.
+		 *	\return BT_TRUE  iff matrix is square and diagonal; \n
+		 *	        BT_FALSE otherwise. */
+		virtual BooleanType isDiag( ) const;
+
+        /** Get the N-norm of the matrix
+         *  \return N-norm of the matrix
+         */
+        virtual real_t getNorm(	int type = 2	/**< Norm type, 1: one-norm, 2: Euclidean norm. */
+								) const;
+
+        /** Get the N-norm of a row
+         *  \return N-norm of row \a rNum
+         */
+        virtual real_t getRowNorm(	int rNum,		/**< Row number. */
+									int type = 2	/**< Norm type, 1: one-norm, 2: Euclidean norm. */
+									) const;
+
+		/** Retrieve indexed entries of matrix row multiplied by alpha. */
+		virtual returnValue getRow(	int rNum,						/**< Row number. */
+									const Indexlist* const icols,	/**< Index list specifying columns. */
+									real_t alpha,					/**< Scalar factor. */
+									real_t *row						/**< Output row vector. */
+									) const;
+
+		/** Retrieve indexed entries of matrix column multiplied by alpha. */
+		virtual returnValue getCol(	int cNum,						/**< Column number. */
+									const Indexlist* const irows,	/**< Index list specifying rows. */
+									real_t alpha,					/**< Scalar factor. */
+									real_t *col						/**< Output column vector. */
+									) const;
+
+		/** Evaluate Y=alpha*A*X + beta*Y. */
+		virtual returnValue times(	int xN,					/**< Number of vectors to multiply. */
+									real_t alpha,			/**< Scalar factor for matrix vector product. */
+									const real_t *x,		/**< Input vector to be multiplied. */
+									int xLD,				/**< Leading dimension of input x. */
+									real_t beta,			/**< Scalar factor for y. */
+									real_t *y,				/**< Output vector of results. */
+									int yLD					/**< Leading dimension of output y. */
+									) const;
+
+		/** Evaluate Y=alpha*A'*X + beta*Y. */
+		virtual returnValue transTimes(	int xN,				/**< Number of vectors to multiply. */
+										real_t alpha,		/**< Scalar factor for matrix vector product. */
+										const real_t *x,	/**< Input vector to be multiplied. */
+										int xLD,			/**< Leading dimension of input x. */
+										real_t beta,		/**< Scalar factor for y. */
+										real_t *y,			/**< Output vector of results. */
+										int yLD				/**< Leading dimension of output y. */
+										) const;
+
+		/** Evaluate matrix vector product with submatrix given by Indexlist. */
+		virtual returnValue times(	const Indexlist* const irows,	/**< Index list specifying rows. */
+									const Indexlist* const icols,	/**< Index list specifying columns. */
+									int xN,							/**< Number of vectors to multiply. */
+									real_t alpha,					/**< Scalar factor for matrix vector product. */
+									const real_t *x,				/**< Input vector to be multiplied. */
+									int xLD,						/**< Leading dimension of input x. */
+									real_t beta,					/**< Scalar factor for y. */
+									real_t *y,						/**< Output vector of results. */
+									int yLD,						/**< Leading dimension of output y. */
+									BooleanType yCompr = BT_TRUE	/**< Compressed storage for y. */
+									) const;
+
+		/** Evaluate matrix transpose vector product. */
+		virtual returnValue transTimes(	const Indexlist* const irows,	/**< Index list specifying rows. */
+										const Indexlist* const icols,	/**< Index list specifying columns. */
+										int xN,							/**< Number of vectors to multiply. */
+										real_t alpha,					/**< Scalar factor for matrix vector product. */
+										const real_t *x,				/**< Input vector to be multiplied. */
+										int xLD,						/**< Leading dimension of input x. */
+										real_t beta,					/**< Scalar factor for y. */
+										real_t *y,						/**< Output vector of results. */
+										int yLD							/**< Leading dimension of output y. */
+										) const;
+
+		/** Adds given offset to diagonal of matrix.
+		 *	\return SUCCESSFUL_RETURN \n
+		 			RET_NO_DIAGONAL_AVAILABLE */
+		virtual returnValue addToDiag(	real_t alpha		/**< Diagonal offset. */
+										);
+
+		/** Allocates and creates dense matrix array in row major format.
+		 *
+		 *  Note: Calling function has to free allocated memory!
+		 *
+		 *  \return Pointer to matrix array.
+		 */
+		virtual real_t* full() const;
+
+		/** Prints matrix to screen.
+		 *	\return SUCCESSFUL_RETURN */
+		virtual returnValue print( 	const char* name = 0	/** Name of matrix. */
+									) const;
+
+
+	protected:
+		int nBlocks;		/**< Number of blocks. */
+		int blockRows;		/**< Number of rows of each block. */
+		int blockCols;		/**< Number of columns of each block. */
+		int nRows;			/**< Number of rows (nBlocks*blockRows). */
+		int nCols;			/**< Number of columns (nBlocks*blockCols). */
+		real_t *val;		/**< Blocks, stacked and row major (nBlocks*blockRows*blockCols). */
+};
+
+
 /**
  *	\brief Interfaces matrix-vector operations tailored to symmetric sparse matrices.
  *
@@ -456,8 +456,10 @@ class MessageHandling
 #define THROWINFO(retval) ( getGlobalMessageHandler( )->throwInfo((retval),0,__FUNCTION__,__FILE__,__LINE__,VS_VISIBLE) )
 
 
-/** Returns a pointer to global message handler.
- *  \return Pointer to global message handler.
+/** Returns a pointer to global message handler. If QPOASES_THREAD_LOCAL is
+ *  supported, each thread has its own handler (print levels, output file and
+ *  error count set on one thread do not affect QPs solved on another one).
+ *  \return Pointer to global message handler of the calling thread.
  */
 MessageHandling* getGlobalMessageHandler( );
 
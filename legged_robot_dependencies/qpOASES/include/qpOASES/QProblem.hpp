@@ -73,10 +73,12 @@ class QProblem : public QProblemB
 		 *  information. If the Hessian is the zero (i.e. HST_ZERO) or the
 		 *  identity matrix (i.e. HST_IDENTITY), respectively, no memory
 		 *  is allocated for it and a NULL pointer can be passed for it
-		 *  to the init() functions. */
+		 *  to the init() functions. If a workspace is given, all internal
+		 *  arrays are taken from it (see Workspace). */
 		QProblem(	int _nV,	  							/**< Number of variables. */
 					int _nC,		  						/**< Number of constraints. */
-					HessianType _hessianType = HST_UNKNOWN	/**< Type of Hessian matrix. */
+					HessianType _hessianType = HST_UNKNOWN,	/**< Type of Hessian matrix. */
+					Workspace* const _workspace = 0			/**< Workspace for internal arrays (0 for heap). */
 					);
 
 		/** Copy constructor (deep copy). */
@@ -375,6 +377,12 @@ class QProblem : public QProblemB
 		 *	\return Number of constraints. */
 		inline int getNC( ) const;
 
+		/** Returns the size of a workspace holding all internal arrays of a problem of given dimensions.
+		 *	\return Size in bytes. */
+		static size_t getWorkspaceSize(	int _nV,	/**< Number of variables. */
+										int _nC		/**< Number of constraints. */
+										);
+
 		/** Returns the number of (implicitly defined) equality constraints.
 		 *	\return Number of (implicitly defined) equality constraints. */
 		inline int getNEC( ) const;
@@ -76,9 +76,11 @@ class QProblemB
 		 *  information. If the Hessian is the zero (i.e. HST_ZERO) or the
 		 *  identity matrix (i.e. HST_IDENTITY), respectively, no memory
 		 *  is allocated for it and a NULL pointer can be passed for it
-		 *  to the init() functions. */
+		 *  to the init() functions. If a workspace is given, all internal
+		 *  arrays are taken from it (see Workspace). */
 		QProblemB(	int _nV,								/**< Number of variables. */
-					HessianType _hessianType = HST_UNKNOWN	/**< Type of Hessian matrix. */
+					HessianType _hessianType = HST_UNKNOWN,	/**< Type of Hessian matrix. */
+					Workspace* const _workspace = 0			/**< Workspace for internal arrays (0 for heap). */
 					);
 
 		/** Copy constructor (deep copy). */
@@ -323,6 +325,11 @@ class QProblemB
 		 *	\return Number of variables. */
 		inline int getNV( ) const;
 
+		/** Returns the size of a workspace holding all internal arrays of a problem of given dimension.
+		 *	\return Size in bytes. */
+		static size_t getWorkspaceSize(	int _nV		/**< Number of variables. */
+										);
+
 		/** Returns the number of free variables.
 		 *	\return Number of free variables. */
 		inline int getNFR( ) const;
@@ -430,6 +437,15 @@ class QProblemB
 		 *	\return SUCCESSFUL_RETURN. */
 		inline returnValue resetCounter( );
 
+		/** Returns the time spent in the phases of the active set method since
+		 *  construction or the last reset (only measured if __PROFILING__ is defined).
+		 *	\return Profiling statistics. */
+		inline ProfilingStatistics getProfilingStatistics( ) const;
+
+		/** Resets the profiling statistics (to zero).
+		 *	\return SUCCESSFUL_RETURN. */
+		inline returnValue resetProfilingStatistics( );
+
 
 		/** Prints concise list of properties of the current QP.
 		 *	\return  SUCCESSFUL_RETURN \n */
@@ -482,6 +498,14 @@ class QProblemB
 		 *			RET_INDEXLIST_CORRUPTED */
 		returnValue computeCholesky( );
 
+		/** Computes the upper Cholesky factor of the leading nR x nR block of R
+		 *  in place. Blocks whose envelope saves at least half of the flops
+		 *  (e.g. banded Hessians of long horizons) are factorised by POTRFenvelope(),
+		 *  all others by POTRF.
+		 *	\return 0 on success, >0 if the block is not positive definite (see POTRF) */
+		la_int_t factoriseR(	int nR		/**< Dimension of the block. */
+								);
+
 
 		/** Computes initial Cholesky decomposition of the (simply projected) Hessian 
 		 *  making use of the function computeCholesky().
@@ -995,6 +1019,7 @@ class QProblemB
 		unsigned int count;			/**< Counts the number of hotstart function calls. */
 
 		real_t *delta_xFR_TMP;		/**< Temporary for determineStepDirection */
+		int *envelopeFirst;			/**< First nonzero row of each column of R, for factoriseR */
 
 		real_t ramp0;				/**< Start value for Ramping Strategy. */
 		real_t ramp1;				/**< Final value for Ramping Strategy. */
@@ -1004,7 +1029,11 @@ class QProblemB
 		
 		Flipper flipper;			/**< Struct for making a temporary copy of the matrix factorisations. */
 
+		Workspace* workspace;		/**< Workspace the internal arrays are taken from (0 for heap). */
+
 		TabularOutput tabularOutput;	/**< Struct storing information for tabular output (printLevel == PL_TABULAR). */
+
+		ProfilingStatistics profile;	/**< Time spent in the phases of the active set method (__PROFILING__). */
 };
 
 
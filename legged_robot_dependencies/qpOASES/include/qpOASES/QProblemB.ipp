@@ -229,6 +229,30 @@ inline returnValue QProblemB::resetCounter( )
 }
 
 
+/*
+ *	g e t P r o f i l i n g S t a t i s t i c s
+ */
+inline ProfilingStatistics QProblemB::getProfilingStatistics( ) const
+{
+	return profile;
+}
+
+
+/*
+ *	r e s e t P r o f i l i n g S t a t i s t i c s
+ */
+inline returnValue QProblemB::resetProfilingStatistics( )
+{
+	profile.setup = profile.homotopy = profile.factorisation = profile.stepDirection = 0.0;
+	profile.performStep = profile.addConstraint = profile.removeConstraint = 0.0;
+
+	profile.nSetup = profile.nHomotopy = profile.nFactorisation = profile.nStepDirection = 0;
+	profile.nPerformStep = profile.nAddConstraint = profile.nRemoveConstraint = 0;
+
+	return SUCCESSFUL_RETURN;
+}
+
+
 /*****************************************************************************
  *  P R O T E C T E D                                                        *
  *****************************************************************************/
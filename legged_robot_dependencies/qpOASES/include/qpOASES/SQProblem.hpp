@@ -72,10 +72,12 @@ class SQProblem : public QProblem
 		 *  information. If the Hessian is the zero (i.e. HST_ZERO) or the
 		 *  identity matrix (i.e. HST_IDENTITY), respectively, no memory
 		 *  is allocated for it and a NULL pointer can be passed for it
-		 *  to the init() functions. */
+		 *  to the init() functions. If a workspace is given, all internal
+		 *  arrays are taken from it (see Workspace). */
 		SQProblem(	int _nV,	  							/**< Number of variables. */
 					int _nC,  								/**< Number of constraints. */
-					HessianType _hessianType = HST_UNKNOWN	/**< Type of Hessian matrix. */
+					HessianType _hessianType = HST_UNKNOWN,	/**< Type of Hessian matrix. */
+					Workspace* const _workspace = 0			/**< Workspace for internal arrays (0 for heap). */
 					);
 
 		/** Copy constructor (deep copy). */
@@ -84,6 +84,13 @@ class SubjectTo
 		returnValue init(	int _n = 0					/**< Number of constraints or bounds. */
 							);
 
+		/** Initialises object with given number of constraints or bounds, taking its arrays from a workspace.
+		 *	\return SUCCESSFUL_RETURN \n
+		 			RET_INVALID_ARGUMENTS */
+		returnValue init(	int _n,						/**< Number of constraints or bounds. */
+							Workspace* const _workspace	/**< Workspace for the arrays (0 for heap). */
+							);
+
 
 		/** Returns number of constraints/bounds with given SubjectTo type.
 		 *	\return Number of constraints/bounds with given type. */
@@ -214,6 +221,8 @@ class SubjectTo
 
 		BooleanType noLower;	 	/**< This flag indicates if there is no lower bound on any variable. */
 		BooleanType noUpper;	 	/**< This flag indicates if there is no upper bound on any variable. */
+
+		Workspace* workspace;		/**< Workspace the arrays are taken from (0 for heap). */
 };
 
 
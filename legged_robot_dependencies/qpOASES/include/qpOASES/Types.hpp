@@ -70,6 +70,14 @@
 /* Uncomment the following line to activate the use of single precision arithmetic. */
 /* #define __USE_SINGLE_PRECISION__ */
 
+/* Uncomment the following line to pass 64 bit integers to BLAS/LAPACK,
+ * as needed by an external ILP64 library. */
+/* #define __USE_ILP64__ */
+
+/* Uncomment the following line to measure the time spent in the phases of
+ * the active set method (see ProfilingStatistics). */
+/* #define __PROFILING__ */
+
 
 
 /* Work-around for Borland BCC 5.5 compiler. */
@@ -87,6 +95,20 @@
 #endif
 
 
+/* C++11 threads and thread local storage are available. */
+#if ( __cplusplus >= 201103L ) || ( defined(_MSC_VER) && ( _MSC_VER >= 1900 ) )
+  #define __USE_THREADS__
+#endif
+
+/** Storage class of the message handler: one handler per thread if the compiler
+ *  supports thread local storage, so that QPs can be solved on several threads. */
+#ifdef __USE_THREADS__
+  #define QPOASES_THREAD_LOCAL thread_local
+#else
+  #define QPOASES_THREAD_LOCAL
+#endif
+
+
 #ifdef __DSPACE__
 
 	#define __NO_SNPRINTF__
@@ -120,6 +142,17 @@
 #endif
 
 
+/** Integer types of BLAS/LAPACK arguments, must match the linked library
+ *  (32 bit for the replacement routines and common LP64 builds). */
+#ifdef __USE_ILP64__
+typedef long la_int_t;
+typedef unsigned long la_uint_t;
+#else
+typedef int la_int_t;
+typedef unsigned int la_uint_t;
+#endif /* __USE_ILP64__ */
+
+
 /** Macro for accessing the Cholesky factor R. */
 #define RR( I,J )  R[(I)+nV*(J)]
 
@@ -244,6 +277,38 @@ struct TabularOutput {
 };
 
 
+/**
+ *	\brief Time spent in the phases of the active set method.
+ *
+ *	Accumulated over all calls of init( ) and hotstart( ) of a (S)QProblem(B)
+ *	object, in seconds. Only measured if __PROFILING__ is defined, zero otherwise.
+ *	The times are double in every build, see getClockTime( ).
+ *	Factorisations, step directions, steps and working set changes are part of
+ *	the setup and homotopy times.
+ *
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ */
+struct ProfilingStatistics {
+	double setup;				/**< Setting up the auxiliary QP in init( ). */
+	double homotopy;			/**< Homotopy in hotstart( ), including the one performed by init( ). */
+	double factorisation;		/**< Setting up TQ and Cholesky factorisations from scratch. */
+	double stepDirection;		/**< Determination of the step direction. */
+	double performStep;			/**< Ratio tests and step along the homotopy path. */
+	double addConstraint;		/**< Adding a bound or constraint to the working set in the homotopy. */
+	double removeConstraint;	/**< Removing a bound or constraint from the working set in the homotopy. */
+
+	int nSetup;					/**< Number of auxiliary QP setups. */
+	int nHomotopy;				/**< Number of homotopies. */
+	int nFactorisation;			/**< Number of factorisations from scratch. */
+	int nStepDirection;			/**< Number of step directions. */
+	int nPerformStep;			/**< Number of steps. */
+	int nAddConstraint;			/**< Number of bounds and constraints added. */
+	int nRemoveConstraint;		/**< Number of bounds and constraints removed. */
+};
+
+
 
 /**
  *	\brief Struct containing the variable header for mat file.
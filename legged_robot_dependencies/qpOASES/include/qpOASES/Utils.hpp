@@ -185,11 +185,62 @@ returnValue writeIntoMatFile(	FILE* const matFile,		/**< Pointer to Matlab binar
 								);
 
 
-/** Returns the current system time.
- * \return current system time */
+/** Returns the current system time (monotonic clock on Linux, performance counter on Windows).
+ *  The clocks count from boot, so the time is double in every build.
+ * \return current system time in seconds */
+double getClockTime( );
+
+
+/** Returns the time since the first call in the process. Counting from there keeps
+ *  short intervals resolved in single precision builds.
+ * \return time since the first call in seconds */
 real_t getCPUtime( );
 
 
+#ifdef __PROFILING__
+
+/**
+ *	\brief Adds the time spent in a scope to a phase of a ProfilingStatistics.
+ *
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ */
+class ProfilingTimer
+{
+	public:
+		/** Constructor, starts the timer. */
+		ProfilingTimer(	double& _time,	/**< Time of the phase. */
+						int& _count		/**< Number of times the phase was entered. */
+						) : time( _time ), count( _count ), starttime( getClockTime( ) ) { }
+
+		/** Destructor, adds the elapsed time to the phase. */
+		~ProfilingTimer( ) { time += getClockTime( ) - starttime; ++count; }
+
+	protected:
+		double& time;			/**< Time of the phase. */
+		int& count;				/**< Number of times the phase was entered. */
+		double starttime;		/**< Time when the timer was started. */
+};
+
+/** Adds the time spent in the rest of the enclosing scope to a phase of the profile member. */
+#define PROFILE_SCOPE( time,count ) ProfilingTimer profilingTimer( profile.time,profile.count )
+
+/** Starts measuring a phase that does not end with a scope. */
+#define PROFILE_TIC( tic ) double tic = getClockTime( )
+
+/** Adds the time since PROFILE_TIC to a phase of the profile member. */
+#define PROFILE_TOC( tic,time,count ) { profile.time += getClockTime( ) - tic; ++profile.count; }
+
+#else
+
+#define PROFILE_SCOPE( time,count )
+#define PROFILE_TIC( tic )
+#define PROFILE_TOC( tic,time,count )
+
+#endif /* __PROFILING__ */
+
+
 /** Returns the N-norm of a vector.
  * \return >= 0.0: successful */
 real_t getNorm(	const real_t* const v,	/**< Vector. */
@@ -0,0 +1,182 @@
+/*
+ *	This file is part of qpOASES.
+ *
+ *	qpOASES -- An Implementation of the Online Active Set Strategy.
+ *	Copyright (C) 2007-2015 by Hans Joachim Ferreau, Andreas Potschka,
+ *	Christian Kirches et al. All rights reserved.
+ *
+ *	qpOASES is free software; you can redistribute it and/or
+ *	modify it under the terms of the GNU Lesser General Public
+ *	License as published by the Free Software Foundation; either
+ *	version 2.1 of the License, or (at your option) any later version.
+ *
+ *	qpOASES is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	See the GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with qpOASES; if not, write to the Free Software
+ *	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/**
+ *	\file include/qpOASES/Workspace.hpp
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ *
+ *	Declaration of the Workspace class, a preallocated memory block
+ *	from which a QProblem carves its internal arrays.
+ */
+
+
+#ifndef QPOASES_WORKSPACE_HPP
+#define QPOASES_WORKSPACE_HPP
+
+
+#include <stddef.h>
+
+#include <qpOASES/Utils.hpp>
+
+
+/** Alignment of the block and of each array carved from it (cache line). */
+#define QPOASES_WORKSPACE_ALIGN 64
+
+
+BEGIN_NAMESPACE_QPOASES
+
+
+/**
+ *	\brief Preallocated memory block for the internal arrays of a QProblem.
+ *
+ *	A QProblem(B) constructed with a workspace takes all of its internal arrays
+ *	(QP vectors, factorisations, bounds, constraints and their index lists) from
+ *	one cache aligned block instead of allocating each of them on the heap.
+ *	The block is kept when the problem is destroyed, so constructing the next
+ *	problem of the same (or smaller) dimensions does not touch the heap.
+ *
+ *	Only one problem may use a workspace at a time, constructing a new one
+ *	invalidates the arrays of the previous one. Copies of a problem allocate
+ *	on the heap as usual.
+ *
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ */
+class Workspace
+{
+	/*
+	 *	PUBLIC MEMBER FUNCTIONS
+	 */
+	public:
+		/** Default constructor, the block is allocated on first use. */
+		Workspace( );
+
+		/** Constructor which preallocates a block of given size. */
+		Workspace(	size_t _size		/**< Size of block in bytes. */
+					);
+
+		/** Destructor. */
+		~Workspace( );
+
+
+		/** Makes sure the block holds at least the given number of bytes,
+		 *  reallocates it otherwise (all arrays carved before are lost).
+		 *	\return SUCCESSFUL_RETURN \n
+		 			RET_INVALID_ARGUMENTS */
+		returnValue reserve(	size_t _size	/**< Size of block in bytes. */
+								);
+
+		/** Releases all arrays carved from the block, the block itself is kept.
+		 *	\return SUCCESSFUL_RETURN */
+		returnValue reset( );
+
+
+		/** Carves an array of n elements from the block.
+		 *	\return Pointer to the array, 0 if the block is exhausted. */
+		template <typename T>
+		inline T* allocate(	int n		/**< Number of elements. */
+							);
+
+		/** Checks if an array was carved from the block.
+		 *	\return BT_TRUE iff p points into the block. */
+		inline BooleanType contains(	const void* p	/**< Pointer to an array. */
+										) const;
+
+
+		/** Returns size of the block.
+		 *	\return Size of block in bytes. */
+		inline size_t getSize( ) const;
+
+		/** Returns number of bytes carved from the block since the last reset.
+		 *	\return Number of bytes in use. */
+		inline size_t getUsed( ) const;
+
+
+		/** Returns number of bytes an array of n elements takes in the block.
+		 *	\return Size in bytes, including alignment. */
+		template <typename T>
+		static inline size_t getArraySize(	int n	/**< Number of elements. */
+											);
+
+
+	/*
+	 *	PRIVATE MEMBER FUNCTIONS
+	 */
+	private:
+		/** Copy constructor, not available. */
+		Workspace(	const Workspace& rhs	/**< Rhs object. */
+					);
+
+		/** Assignment operator, not available. */
+		Workspace& operator=(	const Workspace& rhs	/**< Rhs object. */
+								);
+
+
+	/*
+	 *	PROTECTED MEMBER VARIABLES
+	 */
+	protected:
+		char* memory;					/**< Memory as returned by malloc. */
+		char* block;					/**< Aligned start of the block within memory. */
+		size_t size;					/**< Size of block in bytes. */
+		size_t used;					/**< Number of bytes carved since the last reset. */
+};
+
+
+/** Allocates an array of n elements from the workspace, or on the heap
+ *  if there is no workspace or it is exhausted.
+ *	\return Pointer to the array. */
+template <typename T>
+inline T* allocate(	Workspace* const workspace,	/**< Workspace, may be 0. */
+					int n						/**< Number of elements. */
+					);
+
+/** Frees an array obtained by allocate() and sets the pointer to 0.
+ *  Arrays carved from the workspace are left to it. */
+template <typename T>
+inline void deallocate(	const Workspace* const workspace,	/**< Workspace, may be 0. */
+						T*& p								/**< Array to be freed. */
+						);
+
+/** Reserves size bytes in the workspace (if any), to be used in constructor initialiser lists.
+ *	\return The given workspace. */
+inline Workspace* reserveWorkspace(	Workspace* const workspace,	/**< Workspace, may be 0. */
+									size_t _size				/**< Size of block in bytes. */
+									);
+
+
+END_NAMESPACE_QPOASES
+
+
+#include <qpOASES/Workspace.ipp>
+
+#endif	/* QPOASES_WORKSPACE_HPP */
+
+
+/*
+ *	end of file
+ */
@@ -0,0 +1,152 @@
+/*
+ *	This file is part of qpOASES.
+ *
+ *	qpOASES -- An Implementation of the Online Active Set Strategy.
+ *	Copyright (C) 2007-2015 by Hans Joachim Ferreau, Andreas Potschka,
+ *	Christian Kirches et al. All rights reserved.
+ *
+ *	qpOASES is free software; you can redistribute it and/or
+ *	modify it under the terms of the GNU Lesser General Public
+ *	License as published by the Free Software Foundation; either
+ *	version 2.1 of the License, or (at your option) any later version.
+ *
+ *	qpOASES is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	See the GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with qpOASES; if not, write to the Free Software
+ *	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/**
+ *	\file include/qpOASES/Workspace.ipp
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ *
+ *	Implementation of inlined member functions of the Workspace class.
+ */
+
+
+BEGIN_NAMESPACE_QPOASES
+
+
+/*****************************************************************************
+ *  P U B L I C                                                              *
+ *****************************************************************************/
+
+
+/*
+ *	a l l o c a t e
+ */
+template <typename T>
+inline T* Workspace::allocate( int n )
+{
+	size_t arraySize = getArraySize<T>( n );
+
+	if ( used + arraySize > size )
+		return 0;
+
+	T* p = (T*)( block + used );
+	used += arraySize;
+
+	return p;
+}
+
+
+/*
+ *	c o n t a i n s
+ */
+inline BooleanType Workspace::contains( const void* p ) const
+{
+	if ( ( block != 0 ) && ( (const char*)p >= block ) && ( (const char*)p < block + size ) )
+		return BT_TRUE;
+	else
+		return BT_FALSE;
+}
+
+
+/*
+ *	g e t S i z e
+ */
+inline size_t Workspace::getSize( ) const
+{
+	return size;
+}
+
+
+/*
+ *	g e t U s e d
+ */
+inline size_t Workspace::getUsed( ) const
+{
+	return used;
+}
+
+
+/*
+ *	g e t A r r a y S i z e
+ */
+template <typename T>
+inline size_t Workspace::getArraySize( int n )
+{
+	/* at least one element, so that every array has its own address within the block */
+	size_t bytes = ( n > 0 ) ? (size_t)n * sizeof(T) : sizeof(T);
+
+	return ( bytes + QPOASES_WORKSPACE_ALIGN-1 ) / QPOASES_WORKSPACE_ALIGN * QPOASES_WORKSPACE_ALIGN;
+}
+
+
+/*
+ *	a l l o c a t e
+ */
+template <typename T>
+inline T* allocate( Workspace* const workspace, int n )
+{
+	T* p = 0;
+
+	if ( workspace != 0 )
+		p = workspace->allocate<T>( n );
+
+	if ( p == 0 )
+		p = new T[n];
+
+	return p;
+}
+
+
+/*
+ *	d e a l l o c a t e
+ */
+template <typename T>
+inline void deallocate( const Workspace* const workspace, T*& p )
+{
+	if ( ( workspace == 0 ) || ( workspace->contains( p ) == BT_FALSE ) )
+		delete[] p;
+
+	p = 0;
+}
+
+
+/*
+ *	r e s e r v e W o r k s p a c e
+ */
+inline Workspace* reserveWorkspace( Workspace* const workspace, size_t _size )
+{
+	if ( workspace != 0 )
+		workspace->reserve( _size );
+
+	return workspace;
+}
+
+
+END_NAMESPACE_QPOASES
+
+
+/*
+ *	end of file
+ */
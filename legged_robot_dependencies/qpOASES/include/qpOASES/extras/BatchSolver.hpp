@@ -0,0 +1,200 @@
+/*
+ *	This file is part of qpOASES.
+ *
+ *	qpOASES -- An Implementation of the Online Active Set Strategy.
+ *	Copyright (C) 2007-2015 by Hans Joachim Ferreau, Andreas Potschka,
+ *	Christian Kirches et al. All rights reserved.
+ *
+ *	qpOASES is free software; you can redistribute it and/or
+ *	modify it under the terms of the GNU Lesser General Public
+ *	License as published by the Free Software Foundation; either
+ *	version 2.1 of the License, or (at your option) any later version.
+ *
+ *	qpOASES is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	See the GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with qpOASES; if not, write to the Free Software
+ *	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/**
+ *	\file include/qpOASES/extras/BatchSolver.hpp
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ *
+ *	Declaration of the BatchSolver class designed to solve many
+ *	independent QPs on a pool of threads.
+ */
+
+
+#ifndef QPOASES_BATCHSOLVER_HPP
+#define QPOASES_BATCHSOLVER_HPP
+
+
+#include <qpOASES/QProblem.hpp>
+
+
+BEGIN_NAMESPACE_QPOASES
+
+
+/**
+ *	\brief One QP of a batch.
+ *
+ *	Dense QP data as passed to QProblem::init( ), matrices stored row wise.
+ *	Problems without constraints (nC = 0) are solved as QProblemB, A, lbA and
+ *	ubA are then ignored.
+ */
+struct BatchProblem
+{
+	int nV;						/**< Number of variables. */
+	int nC;						/**< Number of constraints. */
+
+	const real_t* H;			/**< Hessian matrix, 0 for an LP. */
+	const real_t* g;			/**< Gradient vector. */
+	const real_t* A;			/**< Constraint matrix. */
+	const real_t* lb;			/**< Lower bounds, 0 if unbounded. */
+	const real_t* ub;			/**< Upper bounds, 0 if unbounded. */
+	const real_t* lbA;			/**< Lower constraints' bounds, 0 if unbounded. */
+	const real_t* ubA;			/**< Upper constraints' bounds, 0 if unbounded. */
+
+	int nWSR;					/**< Maximum number of working set recalculations, 5*(nV+nC) if not positive. */
+
+	real_t* xOpt;				/**< Output: primal solution (nV), may be 0. */
+	real_t* yOpt;				/**< Output: dual solution (nV+nC), may be 0. */
+};
+
+
+/**
+ *	\brief Solver statistics of one QP of a batch.
+ */
+struct BatchStatistics
+{
+	returnValue status;			/**< Return value of init( ). */
+	int nWSR;					/**< Number of working set recalculations performed. */
+	real_t cpuTime;				/**< Time for setting up and solving the QP (seconds). */
+	int thread;					/**< Index of the thread that solved the QP. */
+};
+
+
+class BatchThreadPool;
+
+
+/**
+ *	\brief Solves batches of independent QPs on a pool of threads.
+ *
+ *	Intended for sweeps over many small QPs (gain tuning, Monte-Carlo studies,
+ *	recorded controller states). The problems of a batch are split evenly
+ *	among the threads, a thread that runs out of problems steals from the back
+ *	of the others' queues. The calling thread works as well. Each thread keeps
+ *	a Workspace, so the solvers do not touch the heap once it has grown to
+ *	the largest problem. The threads are kept between batches.
+ *
+ *	Without C++11 threads (see __USE_THREADS__), batches are solved
+ *	on the calling thread.
+ *
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ */
+class BatchSolver
+{
+	/*
+	 *	PUBLIC MEMBER FUNCTIONS
+	 */
+	public:
+		/** Default constructor, one thread per hardware thread. */
+		BatchSolver( );
+
+		/** Constructor with given number of threads. */
+		BatchSolver(	int _nThreads	/**< Number of threads including the calling one, one per hardware thread if not positive. */
+						);
+
+		/** Destructor. */
+		~BatchSolver( );
+
+
+		/** Sets the options used for all QPs of a batch.
+		 *	\return SUCCESSFUL_RETURN */
+		returnValue setOptions(	const Options& _options	/**< New options. */
+								);
+
+		/** Returns the options used for all QPs of a batch.
+		 *	\return Options. */
+		inline Options getOptions( ) const;
+
+		/** Returns the number of threads solving a batch.
+		 *	\return Number of threads, including the calling one. */
+		inline int getNThreads( ) const;
+
+
+		/** Solves a batch of QPs and waits until all of them are solved.
+		 *	\return SUCCESSFUL_RETURN \n
+		 			RET_INVALID_ARGUMENTS \n
+					return value of the first QP (by index) that could not be solved */
+		returnValue solve(	const BatchProblem* const problems,		/**< Array of QPs. */
+							int nProblems,							/**< Number of QPs. */
+							BatchStatistics* const statistics = 0	/**< Output: statistics for each QP, may be 0. */
+							);
+
+
+	/*
+	 *	PRIVATE MEMBER FUNCTIONS
+	 */
+	private:
+		/** Copy constructor, not available. */
+		BatchSolver(	const BatchSolver& rhs	/**< Rhs object. */
+						);
+
+		/** Assignment operator, not available. */
+		BatchSolver& operator=(	const BatchSolver& rhs	/**< Rhs object. */
+								);
+
+
+	/*
+	 *	PROTECTED MEMBER FUNCTIONS
+	 */
+	protected:
+		/** Sets up the thread pool.
+		 *	\return SUCCESSFUL_RETURN */
+		returnValue init(	int _nThreads	/**< Number of threads, one per hardware thread if not positive. */
+							);
+
+
+	/*
+	 *	PROTECTED MEMBER VARIABLES
+	 */
+	protected:
+		int nThreads;					/**< Number of threads including the calling one. */
+		Options options;				/**< Options of all QPs. */
+
+		Workspace workspace;			/**< Workspace of the calling thread. */
+		BatchThreadPool* pool;			/**< Worker threads, 0 if there are none. */
+};
+
+
+/** Solves one QP of a batch with the given workspace.
+ *	\return Return value of init( ). */
+returnValue solveBatchProblem(	const BatchProblem& problem,		/**< QP to be solved. */
+								const Options& options,				/**< Options. */
+								Workspace* const workspace,			/**< Workspace of the calling thread, may be 0. */
+								int thread,							/**< Index of the calling thread. */
+								BatchStatistics* const statistics	/**< Output: statistics, may be 0. */
+								);
+
+
+END_NAMESPACE_QPOASES
+
+#include <qpOASES/extras/BatchSolver.ipp>
+
+#endif	/* QPOASES_BATCHSOLVER_HPP */
+
+
+/*
+ *	end of file
+ */
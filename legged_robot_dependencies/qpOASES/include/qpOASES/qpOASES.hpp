@@ -34,6 +34,7 @@
 
 #include <MessageHandling.cpp>
 #include <Utils.cpp>
+#include <Workspace.cpp>
 #include <Indexlist.cpp>
 #include <SubjectTo.cpp>
 #include <Bounds.cpp>
@@ -50,6 +51,7 @@
 #ifndef __C_WRAPPER__
 #include <OQPinterface.cpp>
 #include <SolutionAnalysis.cpp>
+#include <BatchSolver.cpp>
 #endif
 
 #else /* default compilation mode */
@@ -59,5 +61,6 @@
 #include <qpOASES/SQProblem.hpp>
 #include <qpOASES/extras/OQPinterface.hpp>
 #include <qpOASES/extras/SolutionAnalysis.hpp>
+#include <qpOASES/extras/BatchSolver.hpp>
 
 #endif
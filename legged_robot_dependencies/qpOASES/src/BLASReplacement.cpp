@@ -34,112 +34,310 @@
 
 #include <qpOASES/Utils.hpp>
 
+#if defined(__USE_AVX2__) && defined(__AVX2__) && defined(__FMA__)
+	#include <immintrin.h>
+	#define __GEMM_AVX2__
+#endif
 
-extern "C" void dgemm_ ( const char *TRANSA, const char *TRANSB,
-		const unsigned long *M, const unsigned long *N, const unsigned long *K,
-		const double *ALPHA, const double *A, const unsigned long *LDA, const double *B, const unsigned long *LDB,
-		const double *BETA, double *C, const unsigned long *LDC)
+
+/*
+ *	Both dgemm_ and sgemm_ compute C = ALPHA * op(A) * B + BETA * C for column major
+ *	matrices, where op(A) is A or A^T (TRANSB is not supported, as before).
+ *
+ *	The depth of the product is split into blocks of GEMM_KC, such that the
+ *	touched parts of A and B stay in cache. Within a block, C is updated tile by tile
+ *	(GEMM_MR x GEMM_NR for op(A) = A, GEMM_MR_T x 1 for op(A) = A^T) with
+ *	the sums kept in registers. If compiled with __USE_AVX2__ and AVX2/FMA are enabled,
+ *	the double precision tiles are computed by AVX2/FMA kernels, otherwise by the
+ *	portable kernels below. The AVX2/FMA kernels sum up in a different order, so
+ *	their results differ from the portable ones in the last digits.
+ */
+
+#define GEMM_KC		256		/**< Depth of a block. */
+#define GEMM_MR		8		/**< Rows of a tile of C, op(A) = A. */
+#define GEMM_NR		4		/**< Columns of a tile of C, op(A) = A. */
+#define GEMM_MR_T	4		/**< Rows of a tile of C, op(A) = A^T. */
+
+
+namespace
 {
-	unsigned int i, j, k;
-
-	if ( REFER_NAMESPACE_QPOASES isZero(*BETA) == REFER_NAMESPACE_QPOASES BT_TRUE )
-		for (k = 0; k < *N; k++)
-			for (j = 0; j < *M; j++)
-				C[j+(*LDC)*k] = 0.0;
-	else if ( REFER_NAMESPACE_QPOASES isEqual(*BETA,-1.0) == REFER_NAMESPACE_QPOASES BT_TRUE )
-		for (k = 0; k < *N; k++)
-			for (j = 0; j < *M; j++)
-				C[j+(*LDC)*k] = -C[j+(*LDC)*k];
-	else if ( REFER_NAMESPACE_QPOASES isEqual(*BETA,1.0) == REFER_NAMESPACE_QPOASES BT_FALSE )
-		for (k = 0; k < *N; k++)
-			for (j = 0; j < *M; j++)
-				C[j+(*LDC)*k] *= *BETA;
-
-	if (TRANSA[0] == 'N')
-		if ( REFER_NAMESPACE_QPOASES isEqual(*ALPHA,1.0) == REFER_NAMESPACE_QPOASES BT_TRUE )
-			for (k = 0; k < *N; k++)
-				for (j = 0; j < *M; j++)
-					for (i = 0; i < *K; i++)
-						C[j+(*LDC)*k] += A[j+(*LDA)*i] * B[i+(*LDB)*k];
-		else if ( REFER_NAMESPACE_QPOASES isEqual(*ALPHA,-1.0) == REFER_NAMESPACE_QPOASES BT_TRUE )
-			for (k = 0; k < *N; k++)
-				for (j = 0; j < *M; j++)
-					for (i = 0; i < *K; i++)
-						C[j+(*LDC)*k] -= A[j+(*LDA)*i] * B[i+(*LDB)*k];
+
+/*
+ *	Portable kernels.
+ *	Each element of C is summed up in the same order as by the plain triple loop,
+ *	so results do not change from the previous implementation.
+ */
+
+/** C(0:m,k) += alpha * A(0:m,0:kc) * B(0:kc,k) for k < nr, m = MR or mr if MR is 0. */
+template <typename T, int MR>
+void kernelNN_tile(	unsigned long mr, unsigned long nr, unsigned long kc, T alpha,
+					const T *A, unsigned long LDA, const T *B, unsigned long LDB, T *C, unsigned long LDC )
+{
+	const unsigned long m = ( MR > 0 ) ? MR : mr;
+	unsigned long i, j, k;
+	T acc[GEMM_MR];
+
+	for (k = 0; k < nr; k++)
+	{
+		const T *b = B+LDB*k;
+		T *c = C+LDC*k;
+
+		/* sums of a tile are kept in registers */
+		for (j = 0; j < m; j++)
+			acc[j] = c[j];
+
+		if ( REFER_NAMESPACE_QPOASES isEqual(alpha,1.0) == REFER_NAMESPACE_QPOASES BT_TRUE )
+			for (i = 0; i < kc; i++)
+				for (j = 0; j < m; j++)
+					acc[j] += A[j+LDA*i] * b[i];
+		else if ( REFER_NAMESPACE_QPOASES isEqual(alpha,-1.0) == REFER_NAMESPACE_QPOASES BT_TRUE )
+			for (i = 0; i < kc; i++)
+				for (j = 0; j < m; j++)
+					acc[j] -= A[j+LDA*i] * b[i];
 		else
-			for (k = 0; k < *N; k++)
-				for (j = 0; j < *M; j++)
-					for (i = 0; i < *K; i++)
-						C[j+(*LDC)*k] += *ALPHA * A[j+(*LDA)*i] * B[i+(*LDB)*k];
+			for (i = 0; i < kc; i++)
+				for (j = 0; j < m; j++)
+					acc[j] += alpha * A[j+LDA*i] * b[i];
+
+		for (j = 0; j < m; j++)
+			c[j] = acc[j];
+	}
+}
+
+/** C(0:mr,0:nr) += alpha * A(0:mr,0:kc) * B(0:kc,0:nr), mr <= GEMM_MR, nr <= GEMM_NR. */
+template <typename T>
+void kernelNN(	unsigned long mr, unsigned long nr, unsigned long kc, T alpha,
+				const T *A, unsigned long LDA, const T *B, unsigned long LDB, T *C, unsigned long LDC )
+{
+	if (mr == GEMM_MR)
+		kernelNN_tile<T,GEMM_MR>(mr, nr, kc, alpha, A, LDA, B, LDB, C, LDC);
 	else
-		if ( REFER_NAMESPACE_QPOASES isEqual(*ALPHA,1.0) == REFER_NAMESPACE_QPOASES BT_TRUE )
-			for (k = 0; k < *N; k++)
-				for (j = 0; j < *M; j++)
-					for (i = 0; i < *K; i++)
-						C[j+(*LDC)*k] += A[i+(*LDA)*j] * B[i+(*LDB)*k];
-		else if ( REFER_NAMESPACE_QPOASES isEqual(*ALPHA,-1.0) == REFER_NAMESPACE_QPOASES BT_TRUE )
-			for (k = 0; k < *N; k++)
-				for (j = 0; j < *M; j++)
-					for (i = 0; i < *K; i++)
-						C[j+(*LDC)*k] -= A[i+(*LDA)*j] * B[i+(*LDB)*k];
-		else
-			for (k = 0; k < *N; k++)
-				for (j = 0; j < *M; j++)
-					for (i = 0; i < *K; i++)
-						C[j+(*LDC)*k] += *ALPHA * A[i+(*LDA)*j] * B[i+(*LDB)*k];
+		kernelNN_tile<T,0>(mr, nr, kc, alpha, A, LDA, B, LDB, C, LDC);
 }
 
-extern "C" void sgemm_ ( const char *TRANSA, const char *TRANSB,
-		const unsigned long *M, const unsigned long *N, const unsigned long *K,
-		const float *ALPHA, const float *A, const unsigned long *LDA, const float *B, const unsigned long *LDB,
-		const float *BETA, float *C, const unsigned long *LDC)
+/** C(0:mr,0) += alpha * A(0:kc,0:mr)^T * B(0:kc,0), mr <= GEMM_MR_T. */
+template <typename T>
+void kernelTN(	unsigned long mr, unsigned long kc, T alpha,
+				const T *A, unsigned long LDA, const T *B, T *C )
 {
-	unsigned int i, j, k;
-
-	if ( REFER_NAMESPACE_QPOASES isZero(*BETA) == REFER_NAMESPACE_QPOASES BT_TRUE )
-		for (k = 0; k < *N; k++)
-			for (j = 0; j < *M; j++)
-				C[j+(*LDC)*k] = 0.0;
-	else if ( REFER_NAMESPACE_QPOASES isEqual(*BETA,-1.0) == REFER_NAMESPACE_QPOASES BT_TRUE )
-		for (k = 0; k < *N; k++)
-			for (j = 0; j < *M; j++)
-				C[j+(*LDC)*k] = -C[j+(*LDC)*k];
-	else if ( REFER_NAMESPACE_QPOASES isEqual(*BETA,1.0) == REFER_NAMESPACE_QPOASES BT_FALSE )
-		for (k = 0; k < *N; k++)
-			for (j = 0; j < *M; j++)
-				C[j+(*LDC)*k] *= *BETA;
-
-	if (TRANSA[0] == 'N')
-		if ( REFER_NAMESPACE_QPOASES isEqual(*ALPHA,1.0) == REFER_NAMESPACE_QPOASES BT_TRUE )
-			for (k = 0; k < *N; k++)
-				for (j = 0; j < *M; j++)
-					for (i = 0; i < *K; i++)
-						C[j+(*LDC)*k] += A[j+(*LDA)*i] * B[i+(*LDB)*k];
-		else if ( REFER_NAMESPACE_QPOASES isEqual(*ALPHA,-1.0) == REFER_NAMESPACE_QPOASES BT_TRUE )
-			for (k = 0; k < *N; k++)
-				for (j = 0; j < *M; j++)
-					for (i = 0; i < *K; i++)
-						C[j+(*LDC)*k] -= A[j+(*LDA)*i] * B[i+(*LDB)*k];
+	unsigned long i, j;
+
+	for (j = 0; j < mr; j++)
+	{
+		const T *a = A + LDA*j;
+		T acc = C[j];
+
+		if ( REFER_NAMESPACE_QPOASES isEqual(alpha,1.0) == REFER_NAMESPACE_QPOASES BT_TRUE )
+			for (i = 0; i < kc; i++)
+				acc += a[i] * B[i];
+		else if ( REFER_NAMESPACE_QPOASES isEqual(alpha,-1.0) == REFER_NAMESPACE_QPOASES BT_TRUE )
+			for (i = 0; i < kc; i++)
+				acc -= a[i] * B[i];
 		else
-			for (k = 0; k < *N; k++)
-				for (j = 0; j < *M; j++)
-					for (i = 0; i < *K; i++)
-						C[j+(*LDC)*k] += *ALPHA * A[j+(*LDA)*i] * B[i+(*LDB)*k];
+			for (i = 0; i < kc; i++)
+				acc += alpha * a[i] * B[i];
+
+		C[j] = acc;
+	}
+}
+
+
+#ifdef __GEMM_AVX2__
+
+/*
+ *	AVX2/FMA kernels for full tiles, double precision.
+ */
+
+/** C(0:8,0:4) += alpha * A(0:8,0:kc) * B(0:kc,0:4). */
+inline void kernelNN_8x4(	unsigned long kc, double alpha,
+							const double *A, unsigned long LDA, const double *B, unsigned long LDB, double *C, unsigned long LDC )
+{
+	__m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd(), c02 = _mm256_setzero_pd(), c03 = _mm256_setzero_pd();
+	__m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd(), c12 = _mm256_setzero_pd(), c13 = _mm256_setzero_pd();
+
+	const double *b0 = B, *b1 = B+LDB, *b2 = B+2*LDB, *b3 = B+3*LDB;
+
+	for (unsigned long i = 0; i < kc; i++)
+	{
+		__m256d a0 = _mm256_loadu_pd(A+LDA*i);
+		__m256d a1 = _mm256_loadu_pd(A+LDA*i+4);
+		__m256d b;
+
+		b = _mm256_broadcast_sd(b0+i); c00 = _mm256_fmadd_pd(a0, b, c00); c10 = _mm256_fmadd_pd(a1, b, c10);
+		b = _mm256_broadcast_sd(b1+i); c01 = _mm256_fmadd_pd(a0, b, c01); c11 = _mm256_fmadd_pd(a1, b, c11);
+		b = _mm256_broadcast_sd(b2+i); c02 = _mm256_fmadd_pd(a0, b, c02); c12 = _mm256_fmadd_pd(a1, b, c12);
+		b = _mm256_broadcast_sd(b3+i); c03 = _mm256_fmadd_pd(a0, b, c03); c13 = _mm256_fmadd_pd(a1, b, c13);
+	}
+
+	__m256d al = _mm256_set1_pd(alpha);
+	double *c;
+	c = C;       _mm256_storeu_pd(c, _mm256_fmadd_pd(al, c00, _mm256_loadu_pd(c))); _mm256_storeu_pd(c+4, _mm256_fmadd_pd(al, c10, _mm256_loadu_pd(c+4)));
+	c = C+LDC;   _mm256_storeu_pd(c, _mm256_fmadd_pd(al, c01, _mm256_loadu_pd(c))); _mm256_storeu_pd(c+4, _mm256_fmadd_pd(al, c11, _mm256_loadu_pd(c+4)));
+	c = C+2*LDC; _mm256_storeu_pd(c, _mm256_fmadd_pd(al, c02, _mm256_loadu_pd(c))); _mm256_storeu_pd(c+4, _mm256_fmadd_pd(al, c12, _mm256_loadu_pd(c+4)));
+	c = C+3*LDC; _mm256_storeu_pd(c, _mm256_fmadd_pd(al, c03, _mm256_loadu_pd(c))); _mm256_storeu_pd(c+4, _mm256_fmadd_pd(al, c13, _mm256_loadu_pd(c+4)));
+}
+
+/** C(0:8,0) += alpha * A(0:8,0:kc) * B(0:kc,0), matrix vector product. */
+inline void kernelNN_8x1(	unsigned long kc, double alpha,
+							const double *A, unsigned long LDA, const double *B, double *C )
+{
+	__m256d c0 = _mm256_setzero_pd(), c1 = _mm256_setzero_pd();
+	__m256d d0 = _mm256_setzero_pd(), d1 = _mm256_setzero_pd();
+	unsigned long i;
+
+	/* two sets of sums to hide latency of FMA */
+	for (i = 0; i+2 <= kc; i += 2)
+	{
+		__m256d b = _mm256_broadcast_sd(B+i);
+		c0 = _mm256_fmadd_pd(_mm256_loadu_pd(A+LDA*i),   b, c0);
+		c1 = _mm256_fmadd_pd(_mm256_loadu_pd(A+LDA*i+4), b, c1);
+		b = _mm256_broadcast_sd(B+i+1);
+		d0 = _mm256_fmadd_pd(_mm256_loadu_pd(A+LDA*(i+1)),   b, d0);
+		d1 = _mm256_fmadd_pd(_mm256_loadu_pd(A+LDA*(i+1)+4), b, d1);
+	}
+	if (i < kc)
+	{
+		__m256d b = _mm256_broadcast_sd(B+i);
+		c0 = _mm256_fmadd_pd(_mm256_loadu_pd(A+LDA*i),   b, c0);
+		c1 = _mm256_fmadd_pd(_mm256_loadu_pd(A+LDA*i+4), b, c1);
+	}
+
+	__m256d al = _mm256_set1_pd(alpha);
+	_mm256_storeu_pd(C,   _mm256_fmadd_pd(al, _mm256_add_pd(c0, d0), _mm256_loadu_pd(C)));
+	_mm256_storeu_pd(C+4, _mm256_fmadd_pd(al, _mm256_add_pd(c1, d1), _mm256_loadu_pd(C+4)));
+}
+
+/** C(0:4,0) += alpha * A(0:kc,0:4)^T * B(0:kc,0). */
+inline void kernelTN_4x1(	unsigned long kc, double alpha,
+							const double *A, unsigned long LDA, const double *B, double *C )
+{
+	const double *a0 = A, *a1 = A+LDA, *a2 = A+2*LDA, *a3 = A+3*LDA;
+	__m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+	unsigned long i;
+
+	for (i = 0; i+4 <= kc; i += 4)
+	{
+		__m256d b = _mm256_loadu_pd(B+i);
+		s0 = _mm256_fmadd_pd(_mm256_loadu_pd(a0+i), b, s0);
+		s1 = _mm256_fmadd_pd(_mm256_loadu_pd(a1+i), b, s1);
+		s2 = _mm256_fmadd_pd(_mm256_loadu_pd(a2+i), b, s2);
+		s3 = _mm256_fmadd_pd(_mm256_loadu_pd(a3+i), b, s3);
+	}
+
+	/* horizontal sums, sum = [sum(s0), sum(s1), sum(s2), sum(s3)] */
+	__m256d t0 = _mm256_hadd_pd(s0, s1);
+	__m256d t1 = _mm256_hadd_pd(s2, s3);
+	__m256d sum = _mm256_add_pd(_mm256_permute2f128_pd(t0, t1, 0x20), _mm256_permute2f128_pd(t0, t1, 0x31));
+
+	if (i < kc)
+	{
+		double r[4] = { 0.0, 0.0, 0.0, 0.0 };
+		for (; i < kc; i++)
+		{
+			r[0] += a0[i] * B[i];
+			r[1] += a1[i] * B[i];
+			r[2] += a2[i] * B[i];
+			r[3] += a3[i] * B[i];
+		}
+		sum = _mm256_add_pd(sum, _mm256_loadu_pd(r));
+	}
+
+	_mm256_storeu_pd(C, _mm256_fmadd_pd(_mm256_set1_pd(alpha), sum, _mm256_loadu_pd(C)));
+}
+
+/* full tiles of double precision go to the AVX2/FMA kernels */
+inline void kernelNN(	unsigned long mr, unsigned long nr, unsigned long kc, double alpha,
+						const double *A, unsigned long LDA, const double *B, unsigned long LDB, double *C, unsigned long LDC )
+{
+	if (mr == GEMM_MR && nr == GEMM_NR)
+		kernelNN_8x4(kc, alpha, A, LDA, B, LDB, C, LDC);
+	else if (mr == GEMM_MR)
+		for (unsigned long k = 0; k < nr; k++)
+			kernelNN_8x1(kc, alpha, A, LDA, B+LDB*k, C+LDC*k);
+	else
+		kernelNN<double>(mr, nr, kc, alpha, A, LDA, B, LDB, C, LDC);
+}
+
+inline void kernelTN(	unsigned long mr, unsigned long kc, double alpha,
+						const double *A, unsigned long LDA, const double *B, double *C )
+{
+	if (mr == GEMM_MR_T)
+		kernelTN_4x1(kc, alpha, A, LDA, B, C);
 	else
-		if ( REFER_NAMESPACE_QPOASES isEqual(*ALPHA,1.0) == REFER_NAMESPACE_QPOASES BT_TRUE )
-			for (k = 0; k < *N; k++)
-				for (j = 0; j < *M; j++)
-					for (i = 0; i < *K; i++)
-						C[j+(*LDC)*k] += A[i+(*LDA)*j] * B[i+(*LDB)*k];
-		else if ( REFER_NAMESPACE_QPOASES isEqual(*ALPHA,-1.0) == REFER_NAMESPACE_QPOASES BT_TRUE )
-			for (k = 0; k < *N; k++)
-				for (j = 0; j < *M; j++)
-					for (i = 0; i < *K; i++)
-						C[j+(*LDC)*k] -= A[i+(*LDA)*j] * B[i+(*LDB)*k];
+		kernelTN<double>(mr, kc, alpha, A, LDA, B, C);
+}
+
+#endif /* __GEMM_AVX2__ */
+
+
+/** C = alpha * op(A) * B + beta * C. */
+template <typename T>
+void gemm(	const char *TRANSA, unsigned long M, unsigned long N, unsigned long K,
+			T alpha, const T *A, unsigned long LDA, const T *B, unsigned long LDB,
+			T beta, T *C, unsigned long LDC )
+{
+	unsigned long i0, j, k, kc;
+
+	if ( REFER_NAMESPACE_QPOASES isZero(beta) == REFER_NAMESPACE_QPOASES BT_TRUE )
+		for (k = 0; k < N; k++)
+			for (j = 0; j < M; j++)
+				C[j+LDC*k] = 0.0;
+	else if ( REFER_NAMESPACE_QPOASES isEqual(beta,-1.0) == REFER_NAMESPACE_QPOASES BT_TRUE )
+		for (k = 0; k < N; k++)
+			for (j = 0; j < M; j++)
+				C[j+LDC*k] = -C[j+LDC*k];
+	else if ( REFER_NAMESPACE_QPOASES isEqual(beta,1.0) == REFER_NAMESPACE_QPOASES BT_FALSE )
+		for (k = 0; k < N; k++)
+			for (j = 0; j < M; j++)
+				C[j+LDC*k] *= beta;
+
+	for (i0 = 0; i0 < K; i0 += GEMM_KC)
+	{
+		kc = ( K-i0 < GEMM_KC ) ? K-i0 : GEMM_KC;
+
+		if (TRANSA[0] == 'N')
+		{
+			/* A(:,i0:i0+kc) * B(i0:i0+kc,:) */
+			for (k = 0; k < N; k += GEMM_NR)
+			{
+				unsigned long nr = ( N-k < GEMM_NR ) ? N-k : GEMM_NR;
+				for (j = 0; j < M; j += GEMM_MR)
+				{
+					unsigned long mr = ( M-j < GEMM_MR ) ? M-j : GEMM_MR;
+					kernelNN(mr, nr, kc, alpha, A+j+LDA*i0, LDA, B+i0+LDB*k, LDB, C+j+LDC*k, LDC);
+				}
+			}
+		}
 		else
-			for (k = 0; k < *N; k++)
-				for (j = 0; j < *M; j++)
-					for (i = 0; i < *K; i++)
-						C[j+(*LDC)*k] += *ALPHA * A[i+(*LDA)*j] * B[i+(*LDB)*k];
+		{
+			/* A(i0:i0+kc,:)^T * B(i0:i0+kc,:) */
+			for (k = 0; k < N; k++)
+			{
+				for (j = 0; j < M; j += GEMM_MR_T)
+				{
+					unsigned long mr = ( M-j < GEMM_MR_T ) ? M-j : GEMM_MR_T;
+					kernelTN(mr, kc, alpha, A+i0+LDA*j, LDA, B+i0+LDB*k, C+j+LDC*k);
+				}
+			}
+		}
+	}
 }
 
+} /* namespace */
+
+
+extern "C" void dgemm_ ( const char *TRANSA, const char *TRANSB,
+		const la_uint_t *M, const la_uint_t *N, const la_uint_t *K,
+		const double *ALPHA, const double *A, const la_uint_t *LDA, const double *B, const la_uint_t *LDB,
+		const double *BETA, double *C, const la_uint_t *LDC)
+{
+	gemm<double>(TRANSA, *M, *N, *K, *ALPHA, A, *LDA, B, *LDB, *BETA, C, *LDC);
+}
+
+extern "C" void sgemm_ ( const char *TRANSA, const char *TRANSB,
+		const la_uint_t *M, const la_uint_t *N, const la_uint_t *K,
+		const float *ALPHA, const float *A, const la_uint_t *LDA, const float *B, const la_uint_t *LDB,
+		const float *BETA, float *C, const la_uint_t *LDC)
+{
+	gemm<float>(TRANSA, *M, *N, *K, *ALPHA, A, *LDA, B, *LDB, *BETA, C, *LDC);
+}
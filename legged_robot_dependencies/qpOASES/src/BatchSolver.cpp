@@ -0,0 +1,496 @@
+/*
+ *	This file is part of qpOASES.
+ *
+ *	qpOASES -- An Implementation of the Online Active Set Strategy.
+ *	Copyright (C) 2007-2015 by Hans Joachim Ferreau, Andreas Potschka,
+ *	Christian Kirches et al. All rights reserved.
+ *
+ *	qpOASES is free software; you can redistribute it and/or
+ *	modify it under the terms of the GNU Lesser General Public
+ *	License as published by the Free Software Foundation; either
+ *	version 2.1 of the License, or (at your option) any later version.
+ *
+ *	qpOASES is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	See the GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with qpOASES; if not, write to the Free Software
+ *	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/**
+ *	\file src/BatchSolver.cpp
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ *
+ *	Implementation of the BatchSolver class designed to solve many
+ *	independent QPs on a pool of threads.
+ */
+
+
+#include <qpOASES/extras/BatchSolver.hpp>
+
+#ifdef __USE_THREADS__
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
+
+
+BEGIN_NAMESPACE_QPOASES
+
+
+#ifdef __USE_THREADS__
+
+/**
+ *	\brief Worker threads of a BatchSolver.
+ *
+ *	Every thread (including the calling one, index 0) owns a queue of problem
+ *	indices, it pops from the front of its own queue and steals from the back
+ *	of the others once its queue is empty. A batch is done when all queues
+ *	are empty and all threads have finished their last problem.
+ *
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ */
+class BatchThreadPool
+{
+	/*
+	 *	PUBLIC MEMBER FUNCTIONS
+	 */
+	public:
+		/** Constructor, starts nThreads-1 worker threads. */
+		BatchThreadPool(	int _nThreads	/**< Number of threads including the calling one. */
+							);
+
+		/** Destructor, stops and joins the worker threads. */
+		~BatchThreadPool( );
+
+		/** Solves a batch, the calling thread works as thread 0. */
+		void run(	const BatchProblem* const _problems,	/**< Array of QPs. */
+					int nProblems,							/**< Number of QPs. */
+					const Options& _options,				/**< Options. */
+					Workspace* const _workspace,			/**< Workspace of the calling thread. */
+					BatchStatistics* const _statistics		/**< Output: statistics for each QP. */
+					);
+
+
+	/*
+	 *	PROTECTED MEMBER FUNCTIONS
+	 */
+	protected:
+		/** Main loop of a worker thread. */
+		void work(	int thread	/**< Index of the thread. */
+					);
+
+		/** Solves problems until all queues are empty. */
+		void drain(	int thread,					/**< Index of the thread. */
+					Workspace* const _workspace	/**< Workspace of the thread. */
+					);
+
+		/** Takes the next problem from the front of the own queue.
+		 *	\return BT_TRUE iff a problem was taken. */
+		BooleanType pop(	int thread,		/**< Index of the thread. */
+							int& problem	/**< Output: index of the problem. */
+							);
+
+		/** Takes a problem from the back of another thread's queue.
+		 *	\return BT_TRUE iff a problem was taken. */
+		BooleanType steal(	int thread,		/**< Index of the thread. */
+							int& problem	/**< Output: index of the problem. */
+							);
+
+
+	/*
+	 *	PROTECTED MEMBER VARIABLES
+	 */
+	protected:
+		/** Problem queue of one thread. */
+		struct Queue
+		{
+			std::mutex mutex;
+			std::deque<int> problems;
+		};
+
+		int nThreads;									/**< Number of threads including the calling one. */
+		std::vector<Queue*> queues;						/**< Queue of each thread. */
+		std::vector<Workspace*> workspaces;				/**< Workspace of each worker thread (0 for the calling one). */
+		std::vector<std::thread> threads;				/**< Worker threads. */
+
+		std::mutex mutex;								/**< Guards the batch counter, nBusy and stop. */
+		std::condition_variable wakeUp;					/**< Signals a new batch or stop to the workers. */
+		std::condition_variable done;					/**< Signals the last worker finishing a batch. */
+		unsigned long batch;							/**< Number of batches started. */
+		int nBusy;										/**< Number of workers still on the current batch. */
+		bool stop;										/**< Workers have to terminate. */
+
+		const BatchProblem* problems;					/**< QPs of the current batch. */
+		const Options* options;							/**< Options of the current batch. */
+		BatchStatistics* statistics;					/**< Statistics of the current batch. */
+};
+
+
+/*
+ *	B a t c h T h r e a d P o o l
+ */
+BatchThreadPool::BatchThreadPool( int _nThreads )
+{
+	int i;
+
+	nThreads = _nThreads;
+	batch = 0;
+	nBusy = 0;
+	stop = false;
+
+	problems = 0;
+	options = 0;
+	statistics = 0;
+
+	for( i=0; i<nThreads; ++i )
+	{
+		queues.push_back( new Queue );
+		workspaces.push_back( ( i > 0 ) ? new Workspace : 0 );
+	}
+
+	for( i=1; i<nThreads; ++i )
+		threads.push_back( std::thread( &BatchThreadPool::work,this,i ) );
+}
+
+
+/*
+ *	~ B a t c h T h r e a d P o o l
+ */
+BatchThreadPool::~BatchThreadPool( )
+{
+	size_t i;
+
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+		stop = true;
+	}
+	wakeUp.notify_all( );
+
+	for( i=0; i<threads.size( ); ++i )
+		threads[i].join( );
+
+	for( i=0; i<queues.size( ); ++i )
+	{
+		delete workspaces[i];
+		delete queues[i];
+	}
+}
+
+
+/*
+ *	r u n
+ */
+void BatchThreadPool::run(	const BatchProblem* const _problems, int nProblems, const Options& _options,
+							Workspace* const _workspace, BatchStatistics* const _statistics
+							)
+{
+	int i;
+
+	{
+		std::unique_lock<std::mutex> lock( mutex );
+
+		problems = _problems;
+		options = &_options;
+		statistics = _statistics;
+
+		/* contiguous chunks, so that stealing takes from the far end */
+		for( i=0; i<nProblems; ++i )
+			queues[ (size_t)( (long)i * nThreads / nProblems ) ]->problems.push_back( i );
+
+		nBusy = nThreads-1;
+		++batch;
+	}
+	wakeUp.notify_all( );
+
+	drain( 0,_workspace );
+
+	std::unique_lock<std::mutex> lock( mutex );
+	while ( nBusy > 0 )
+		done.wait( lock );
+}
+
+
+/*
+ *	w o r k
+ */
+void BatchThreadPool::work( int thread )
+{
+	unsigned long lastBatch = 0;
+
+	std::unique_lock<std::mutex> lock( mutex );
+
+	while ( true )
+	{
+		while ( ( stop == false ) && ( batch == lastBatch ) )
+			wakeUp.wait( lock );
+
+		if ( stop == true )
+			return;
+
+		lastBatch = batch;
+
+		lock.unlock( );
+		drain( thread,workspaces[(size_t)thread] );
+		lock.lock( );
+
+		if ( --nBusy == 0 )
+			done.notify_one( );
+	}
+}
+
+
+/*
+ *	d r a i n
+ */
+void BatchThreadPool::drain( int thread, Workspace* const _workspace )
+{
+	int problem;
+
+	while ( ( pop( thread,problem ) == BT_TRUE ) || ( steal( thread,problem ) == BT_TRUE ) )
+		solveBatchProblem( problems[problem],*options,_workspace,thread,&(statistics[problem]) );
+}
+
+
+/*
+ *	p o p
+ */
+BooleanType BatchThreadPool::pop( int thread, int& problem )
+{
+	Queue* queue = queues[(size_t)thread];
+	std::lock_guard<std::mutex> lock( queue->mutex );
+
+	if ( queue->problems.empty( ) )
+		return BT_FALSE;
+
+	problem = queue->problems.front( );
+	queue->problems.pop_front( );
+
+	return BT_TRUE;
+}
+
+
+/*
+ *	s t e a l
+ */
+BooleanType BatchThreadPool::steal( int thread, int& problem )
+{
+	int i;
+
+	for( i=1; i<nThreads; ++i )
+	{
+		Queue* queue = queues[ (size_t)( (thread+i) % nThreads ) ];
+		std::lock_guard<std::mutex> lock( queue->mutex );
+
+		if ( queue->problems.empty( ) == false )
+		{
+			problem = queue->problems.back( );
+			queue->problems.pop_back( );
+			return BT_TRUE;
+		}
+	}
+
+	return BT_FALSE;
+}
+
+#else
+
+/** Placeholder, batches are solved on the calling thread. */
+class BatchThreadPool
+{
+};
+
+#endif /* __USE_THREADS__ */
+
+
+
+/*****************************************************************************
+ *  P U B L I C                                                              *
+ *****************************************************************************/
+
+
+/*
+ *	B a t c h S o l v e r
+ */
+BatchSolver::BatchSolver( )
+{
+	pool = 0;
+	init( 0 );
+}
+
+
+/*
+ *	B a t c h S o l v e r
+ */
+BatchSolver::BatchSolver( int _nThreads )
+{
+	pool = 0;
+	init( _nThreads );
+}
+
+
+/*
+ *	~ B a t c h S o l v e r
+ */
+BatchSolver::~BatchSolver( )
+{
+	delete pool;
+}
+
+
+/*
+ *	s e t O p t i o n s
+ */
+returnValue BatchSolver::setOptions( const Options& _options )
+{
+	options = _options;
+	options.ensureConsistency( );
+
+	return SUCCESSFUL_RETURN;
+}
+
+
+/*
+ *	s o l v e
+ */
+returnValue BatchSolver::solve(	const BatchProblem* const problems, int nProblems,
+								BatchStatistics* const statistics
+								)
+{
+	int i;
+
+	if ( ( nProblems < 0 ) || ( ( problems == 0 ) && ( nProblems > 0 ) ) )
+		return THROWERROR( RET_INVALID_ARGUMENTS );
+
+	if ( nProblems == 0 )
+		return SUCCESSFUL_RETURN;
+
+	/* statistics are needed for the return value */
+	BatchStatistics* stats = statistics;
+	if ( stats == 0 )
+		stats = new BatchStatistics[nProblems];
+
+	#ifdef __USE_THREADS__
+	if ( pool != 0 )
+		pool->run( problems,nProblems,options,&workspace,stats );
+	else
+	#endif
+		for( i=0; i<nProblems; ++i )
+			solveBatchProblem( problems[i],options,&workspace,0,&(stats[i]) );
+
+	returnValue returnvalue = SUCCESSFUL_RETURN;
+	for( i=0; i<nProblems; ++i )
+		if ( stats[i].status != SUCCESSFUL_RETURN )
+		{
+			returnvalue = stats[i].status;
+			break;
+		}
+
+	if ( statistics == 0 )
+		delete[] stats;
+
+	return returnvalue;
+}
+
+
+
+/*****************************************************************************
+ *  P R O T E C T E D                                                        *
+ *****************************************************************************/
+
+
+/*
+ *	i n i t
+ */
+returnValue BatchSolver::init( int _nThreads )
+{
+	#ifdef __USE_THREADS__
+	if ( _nThreads <= 0 )
+		_nThreads = (int)std::thread::hardware_concurrency( );
+	if ( _nThreads <= 0 )
+		_nThreads = 1;
+
+	nThreads = _nThreads;
+
+	if ( nThreads > 1 )
+		pool = new BatchThreadPool( nThreads );
+	#else
+	nThreads = 1;
+	#endif /* __USE_THREADS__ */
+
+	return SUCCESSFUL_RETURN;
+}
+
+
+
+/*****************************************************************************
+ *  G L O B A L  F U N C T I O N S                                           *
+ *****************************************************************************/
+
+
+/*
+ *	s o l v e B a t c h P r o b l e m
+ */
+returnValue solveBatchProblem(	const BatchProblem& problem, const Options& options,
+								Workspace* const workspace, int thread, BatchStatistics* const statistics
+								)
+{
+	int nWSR = ( problem.nWSR > 0 ) ? problem.nWSR : 5*( problem.nV + problem.nC );
+	returnValue returnvalue;
+
+	double tic = getClockTime( );
+
+	if ( problem.nC > 0 )
+	{
+		QProblem qp( problem.nV,problem.nC,HST_UNKNOWN,workspace );
+		qp.setOptions( options );
+
+		returnvalue = qp.init( problem.H,problem.g,problem.A,problem.lb,problem.ub,problem.lbA,problem.ubA, nWSR );
+
+		if ( problem.xOpt != 0 )
+			qp.getPrimalSolution( problem.xOpt );
+		if ( problem.yOpt != 0 )
+			qp.getDualSolution( problem.yOpt );
+	}
+	else
+	{
+		QProblemB qp( problem.nV,HST_UNKNOWN,workspace );
+		qp.setOptions( options );
+
+		returnvalue = qp.init( problem.H,problem.g,problem.lb,problem.ub, nWSR );
+
+		if ( problem.xOpt != 0 )
+			qp.getPrimalSolution( problem.xOpt );
+		if ( problem.yOpt != 0 )
+			qp.getDualSolution( problem.yOpt );
+	}
+
+	if ( statistics != 0 )
+	{
+		statistics->status = returnvalue;
+		statistics->nWSR = nWSR;
+		statistics->cpuTime = (real_t)( getClockTime( ) - tic );
+		statistics->thread = thread;
+	}
+
+	return returnvalue;
+}
+
+
+END_NAMESPACE_QPOASES
+
+
+/*
+ *	end of file
+ */
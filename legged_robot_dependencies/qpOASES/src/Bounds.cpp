@@ -117,6 +117,25 @@ returnValue Bounds::init(	int _n
 }
 
 
+/*
+ *	i n i t
+ */
+returnValue Bounds::init(	int _n,
+							Workspace* const _workspace
+							)
+{
+	if ( _n < 0 )
+		return THROWERROR( RET_INVALID_ARGUMENTS );
+
+	clear( );
+
+	freee.init( _n,_workspace );
+	fixed.init( _n,_workspace );
+
+	return SubjectTo::init( _n,_workspace );
+}
+
+
 
 /*
  *	s e t u p B o u n d
@@ -116,6 +116,25 @@ returnValue Constraints::init(	int _n
 }
 
 
+/*
+ *	i n i t
+ */
+returnValue Constraints::init(	int _n,
+								Workspace* const _workspace
+								)
+{
+	if ( _n < 0 )
+		return THROWERROR( RET_INVALID_ARGUMENTS );
+
+	clear( );
+
+	active.init( _n,_workspace );
+	inactive.init( _n,_workspace );
+
+	return SubjectTo::init( _n,_workspace );
+}
+
+
 
 /*
  *	s e t u p C o n s t r a i n t
@@ -39,6 +39,26 @@
 BEGIN_NAMESPACE_QPOASES
 
 
+/** Number of set bits of m. */
+static inline int countBits( unsigned long long m )
+{
+	#if defined(__GNUC__)
+	return __builtin_popcountll( m );
+	#else
+	int count = 0;
+	for ( ; m != 0; m &= m-1 )
+		++count;
+	return count;
+	#endif
+}
+
+/** Mask of the numbers 0..i, i.e. bits 0..i. */
+static inline unsigned long long maskUpTo( int i )
+{
+	return ( i >= 63 ) ? ~0ULL : ( ( 1ULL << (i+1) ) - 1 );
+}
+
+
 /*****************************************************************************
  *  P U B L I C                                                              *
  *****************************************************************************/
@@ -51,6 +71,7 @@ Indexlist::Indexlist( )
 {
 	number = 0;
 	iSort  = 0;
+	workspace = 0;
 
 	init( );
 }
@@ -63,6 +84,7 @@ Indexlist::Indexlist( int n )
 {
 	number = 0;
 	iSort  = 0;
+	workspace = 0;
 
 	init( n );
 }
@@ -111,21 +133,49 @@ returnValue Indexlist::init(	int n
 	if ( n < 0 )
 		return THROWERROR( RET_INVALID_ARGUMENTS );
 
+	/* arrays taken from the workspace are reused */
+	if ( ( n > 0 ) && ( n == physicallength ) && ( workspace != 0 ) && ( workspace->contains( number ) == BT_TRUE ) )
+	{
+		length = 0;
+		mask = 0;
+		useMask = ( n <= INDEXLIST_MASK_LENGTH ) ? BT_TRUE : BT_FALSE;
+		return SUCCESSFUL_RETURN;
+	}
+
 	clear( );
 
 	length = 0;
 	physicallength = n;
+	mask = 0;
+	useMask = ( n <= INDEXLIST_MASK_LENGTH ) ? BT_TRUE : BT_FALSE;
 
 	if ( n > 0 )
 	{
-		number = new int[n];
-		iSort  = new int[n];
+		number = allocate<int>( workspace,n );
+		iSort  = allocate<int>( workspace,n );
 	}
 
 	return SUCCESSFUL_RETURN;
 }
 
 
+/*
+ *	i n i t
+ */
+returnValue Indexlist::init(	int n,
+								Workspace* const _workspace
+								)
+{
+	if ( n < 0 )
+		return THROWERROR( RET_INVALID_ARGUMENTS );
+
+	clear( );
+	workspace = _workspace;
+
+	return init( n );
+}
+
+
 /*
  *	g e t N u m b e r A r r a y
  */
@@ -156,7 +206,12 @@ returnValue Indexlist::getISortArray( int** const iSortArray ) const
  */
 int Indexlist::getIndex( int givennumber ) const
 {
+	if ( useMask == BT_TRUE )
+		return ( isMember( givennumber ) == BT_TRUE ) ? iSort[findInsert( givennumber )] : -1;
+
 	int index = findInsert(givennumber);
+	if ( index < 0 )
+		return -1;
 	return number[iSort[index]] == givennumber ? iSort[index] : -1;
 }
 
@@ -169,6 +224,11 @@ returnValue Indexlist::addNumber( int addnumber )
 	if ( length >= physicallength )
 		return THROWERROR( RET_INDEXLIST_EXCEEDS_MAX_LENGTH );
 
+	/* numbers outside of the mask or added twice, bisection from now on */
+	if ( ( useMask == BT_TRUE ) &&
+		 ( ( addnumber < 0 ) || ( addnumber >= INDEXLIST_MASK_LENGTH ) || ( isMember( addnumber ) == BT_TRUE ) ) )
+		useMask = BT_FALSE;
+
 	int i, j;
 	number[length] = addnumber;
 	j = findInsert(addnumber);
@@ -177,6 +237,9 @@ returnValue Indexlist::addNumber( int addnumber )
 	iSort[j+1] = length;
 	++length;
 
+	if ( useMask == BT_TRUE )
+		mask |= 1ULL << addnumber;
+
 	return SUCCESSFUL_RETURN;
 }
 
@@ -187,7 +250,13 @@ returnValue Indexlist::addNumber( int addnumber )
 returnValue Indexlist::removeNumber( int removenumber )
 {
 	int i;
+
+	if ( ( useMask == BT_TRUE ) && ( isMember( removenumber ) == BT_FALSE ) )
+		return SUCCESSFUL_RETURN;
+
 	int idx = findInsert( removenumber );
+	if ( idx < 0 )
+		return SUCCESSFUL_RETURN;
 	int iSidx = iSort[idx];
 
 	/* nothing to be done if number is not contained in index set */
@@ -207,6 +276,9 @@ returnValue Indexlist::removeNumber( int removenumber )
 
 	--length;
 
+	if ( useMask == BT_TRUE )
+		mask &= ~( 1ULL << removenumber );
+
 	return SUCCESSFUL_RETURN;
 }
 
@@ -220,7 +292,8 @@ returnValue Indexlist::swapNumbers( int number1, int number2 )
 	int index2 = findInsert( number2 );
 
 	/* consistency check */
-	if ( ( number[iSort[index1]] != number1 ) || ( number[iSort[index2]] != number2 ) )
+	if ( ( index1 < 0 ) || ( index2 < 0 ) ||
+		 ( number[iSort[index1]] != number1 ) || ( number[iSort[index2]] != number2 ) )
 		return THROWERROR( RET_INDEXLIST_CORRUPTED );
 
 	int tmp;
@@ -248,16 +321,10 @@ returnValue Indexlist::swapNumbers( int number1, int number2 )
 returnValue Indexlist::clear( )
 {
 	if ( iSort != 0 )
-	{
-		delete[] iSort;
-		iSort = 0;
-	}
+		deallocate( workspace,iSort );
 
 	if ( number != 0 )
-	{
-		delete[] number;
-		number = 0;
-	}
+		deallocate( workspace,number );
 
 	return SUCCESSFUL_RETURN;
 }
@@ -271,8 +338,13 @@ returnValue Indexlist::copy(	const Indexlist& rhs
 {
 	int i;
 
+	/* copies live on the heap */
+	workspace = 0;
+
 	length = rhs.length;
 	physicallength = rhs.physicallength;
+	mask = rhs.mask;
+	useMask = rhs.useMask;
 
 	if ( rhs.number != 0 )
 	{
@@ -294,6 +366,10 @@ returnValue Indexlist::copy(	const Indexlist& rhs
 
 int Indexlist::findInsert(int i) const
 {
+	/* count of numbers <= i */
+	if ( useMask == BT_TRUE )
+		return ( i < 0 ) ? -1 : countBits( mask & maskUpTo( i ) ) - 1;
+
 	/* quick check if index can be appended */
 	if (length == 0 || i < number[iSort[0]]) return -1;
 	if (i >= number[iSort[length-1]]) return length-1;
@@ -33,88 +33,253 @@
 
 
 #include <qpOASES/Utils.hpp>
+#include <qpOASES/Matrices.hpp>
 
 
-extern "C" void dpotrf_(	const char *uplo, const unsigned long *_n, double *a,
-							const unsigned long *_lda, long *info
-							)
+/*
+ *	dpotrf_/spotrf_ compute the upper Cholesky factor R'*R = A in place,
+ *	dtrtrs_/strtrs_ solve R*X = B or R'*X = B for an upper triangular R with
+ *	nonzero diagonal. Only UPLO = 'U' and DIAG = 'N' are supported, other values
+ *	are rejected with INFO = -1 and -3 as LAPACK does for invalid arguments.
+ *
+ *	Matrices of up to LAPACK_NB columns are handled by plain loops. Larger ones are
+ *	split into blocks of LAPACK_NB columns (right-looking): the block row of a
+ *	diagonal block is factorised by the plain loops and the trailing matrix is
+ *	updated by GEMM. Triangular solves substitute block by block and update the
+ *	rest of the right-hand side by GEMM. The inner kernels are therefore those of
+ *	BLASReplacement, i.e. register tiles or AVX2/FMA if compiled with __USE_AVX2__.
+ *	Up to LAPACK_NB columns the results are identical to the previous unblocked
+ *	routines, above they differ in the last digits as the sums are taken in a
+ *	different order.
+ */
+
+#define LAPACK_NB	32		/**< Columns of a block. */
+
+
+namespace
+{
+
+/** C = alpha * op(A) * B + beta * C by dgemm_/sgemm_. */
+inline void gemm(	const char *TRANSA, long M, long N, long K,
+					double alpha, const double *A, long LDA, const double *B, long LDB,
+					double beta, double *C, long LDC )
+{
+	la_uint_t _M = (la_uint_t)M, _N = (la_uint_t)N, _K = (la_uint_t)K;
+	la_uint_t _LDA = (la_uint_t)LDA, _LDB = (la_uint_t)LDB, _LDC = (la_uint_t)LDC;
+	dgemm_(TRANSA, "NOTRANS", &_M, &_N, &_K, &alpha, A, &_LDA, B, &_LDB, &beta, C, &_LDC);
+}
+
+inline void gemm(	const char *TRANSA, long M, long N, long K,
+					float alpha, const float *A, long LDA, const float *B, long LDB,
+					float beta, float *C, long LDC )
 {
-	double sum;
+	la_uint_t _M = (la_uint_t)M, _N = (la_uint_t)N, _K = (la_uint_t)K;
+	la_uint_t _LDA = (la_uint_t)LDA, _LDB = (la_uint_t)LDB, _LDC = (la_uint_t)LDC;
+	sgemm_(TRANSA, "NOTRANS", &_M, &_N, &_K, &alpha, A, &_LDA, B, &_LDB, &beta, C, &_LDC);
+}
+
+
+/** Factorises rows i0:i0+nb of A(0:n,0:n), whose previous rows are factorised and
+ *  already subtracted from the rows below. On a non-positive pivot, its value is
+ *  tunneled to a[0] and the (1-based) column is returned. */
+template <typename T>
+long potrfBlockRow( long i0, long nb, long n, T *a, long lda )
+{
+	T sum;
 	long i, j, k;
-	long n = (long)(*_n);
-	long lda = (long)(*_lda);
 
-	for( i=0; i<n; ++i )
+	for( i=i0; i<i0+nb; ++i )
 	{
 		/* j == i */
 		sum = a[i + lda*i];
 
-		for( k=(i-1); k>=0; --k )
+		for( k=(i-1); k>=i0; --k )
 			sum -= a[k+lda*i] * a[k+lda*i];
 
 		if ( sum > 0.0 )
-			a[i+lda*i] = REFER_NAMESPACE_QPOASES getSqrt( sum );
+			a[i+lda*i] = (T)(REFER_NAMESPACE_QPOASES getSqrt( sum ));
 		else
 		{
 			a[0] = sum; /* tunnel negative diagonal element to caller */
-			if (info != 0)
-				*info = (long)i+1;
-			return;
+			return i+1;
 		}
 
 		for( j=(i+1); j<n; ++j )
 		{
 			sum = a[j*lda + i];
 
-			for( k=(i-1); k>=0; --k )
+			for( k=(i-1); k>=i0; --k )
 				sum -= a[k+lda*i] * a[k+lda*j];
 
 			a[i+lda*j] = sum / a[i+lda*i];
 		}
 	}
-	if (info != 0)
-		*info = 0;
-}
 
+	return 0;
+}
 
-extern "C" void spotrf_(	const char *uplo, const unsigned long *_n, float *a,
-							const unsigned long *_lda, long *info
-							)
+/** R'*R = A(0:n,0:n), upper triangle, see dpotrf_. */
+template <typename T>
+long potrf( long n, T *a, long lda )
 {
-	float sum;
-	long i, j, k;
-	long n = (long)(*_n);
-	long lda = (long)(*_lda);
+	long i0, j, nb, info;
 
-	for( i=0; i<n; ++i )
+	for( i0=0; i0<n; i0+=LAPACK_NB )
 	{
-		/* j == i */
-		sum = a[i + lda*i];
+		nb = ( n-i0 < LAPACK_NB ) ? n-i0 : LAPACK_NB;
 
-		for( k=(i-1); k>=0; --k )
-			sum -= a[k+lda*i] * a[k+lda*i];
+		info = potrfBlockRow( i0,nb,n,a,lda );
+		if ( info != 0 )
+			return info;
 
-		if ( sum > 0.0 )
-			a[i+lda*i] = (float)(REFER_NAMESPACE_QPOASES getSqrt( sum ));
+		/* A(i1:j+1,j) -= R(i0:i1,i1:j+1)' * R(i0:i1,j), upper triangle of the trailing matrix */
+		long i1 = i0+nb;
+		for( j=i1; j<n; ++j )
+			gemm( "TRANS", j-i1+1, 1, nb, (T)-1.0, a+i0+lda*i1, lda, a+i0+lda*j, lda, (T)1.0, a+i1+lda*j, lda );
+	}
+
+	return 0;
+}
+
+/** Substitution on the diagonal block i0:i0+nb, R*X = B or R'*X = B. */
+template <typename T>
+void trtrsBlock( bool transposed, long i0, long nb, long nrhs, const T *a, long lda, T *b, long ldb )
+{
+	T sum;
+	long i, j, c;
+
+	for( c=0; c<nrhs; ++c )
+	{
+		T *x = b + ldb*c;
+
+		if ( transposed == false )
+		{
+			for( i=(i0+nb-1); i>=i0; --i )
+			{
+				sum = x[i];
+				for( j=(i+1); j<i0+nb; ++j )
+					sum -= a[i+lda*j] * x[j];
+				x[i] = sum / a[i+lda*i];
+			}
+		}
 		else
 		{
-			a[0] = sum; /* tunnel negative diagonal element to caller */
-			if (info != 0)
-				*info = (long)i+1;
-			return;
+			for( i=i0; i<i0+nb; ++i )
+			{
+				sum = x[i];
+				for( j=i0; j<i; ++j )
+					sum -= a[j+lda*i] * x[j];
+				x[i] = sum / a[i+lda*i];
+			}
 		}
+	}
+}
 
-		for( j=(i+1); j<n; ++j )
+/** R*X = B or R'*X = B, B is overwritten by X, see dtrtrs_. */
+template <typename T>
+long trtrs( bool transposed, long n, long nrhs, const T *a, long lda, T *b, long ldb )
+{
+	long i, i0, nb;
+
+	/* singular R, nothing is solved */
+	for( i=0; i<n; ++i )
+		if ( REFER_NAMESPACE_QPOASES isZero( (REFER_NAMESPACE_QPOASES real_t)a[i+lda*i] ) == REFER_NAMESPACE_QPOASES BT_TRUE )
+			return i+1;
+
+	if ( transposed == false )
+	{
+		/* from the last block up, X(0:i0) -= R(0:i0,i0:i0+nb) * X(i0:i0+nb) */
+		for( i0=((n-1)/LAPACK_NB)*LAPACK_NB; i0>=0; i0-=LAPACK_NB )
 		{
-			sum = a[j*lda + i];
+			nb = ( n-i0 < LAPACK_NB ) ? n-i0 : LAPACK_NB;
 
-			for( k=(i-1); k>=0; --k )
-				sum -= a[k+lda*i] * a[k+lda*j];
+			trtrsBlock( transposed,i0,nb,nrhs,a,lda,b,ldb );
+			if ( i0 > 0 )
+				gemm( "NOTRANS", i0, nrhs, nb, (T)-1.0, a+lda*i0, lda, b+i0, ldb, (T)1.0, b, ldb );
+		}
+	}
+	else
+	{
+		/* from the first block down, X(i0:i0+nb) -= R(0:i0,i0:i0+nb)' * X(0:i0) */
+		for( i0=0; i0<n; i0+=LAPACK_NB )
+		{
+			nb = ( n-i0 < LAPACK_NB ) ? n-i0 : LAPACK_NB;
 
-			a[i+lda*j] = sum / a[i+lda*i];
+			if ( i0 > 0 )
+				gemm( "TRANS", nb, nrhs, i0, (T)-1.0, a+lda*i0, lda, b, ldb, (T)1.0, b+i0, ldb );
+			trtrsBlock( transposed,i0,nb,nrhs,a,lda,b,ldb );
 		}
 	}
+
+	return 0;
+}
+
+/** Checks the options of dtrtrs_/strtrs_, returns LAPACK's INFO of the first unsupported one:
+ *  -1 for UPLO other than 'U', -2 for TRANS other than 'N', 'T' or 'C', -3 for DIAG other than 'N'. */
+long trtrsOptions( const char *uplo, const char *trans, const char *diag )
+{
+	if ( uplo[0] != 'U' && uplo[0] != 'u' )
+		return -1;
+
+	if ( trans[0] != 'N' && trans[0] != 'n' && trans[0] != 'T' && trans[0] != 't' && trans[0] != 'C' && trans[0] != 'c' )
+		return -2;
+
+	if ( diag[0] != 'N' && diag[0] != 'n' )
+		return -3;
+
+	return 0;
+}
+
+} /* namespace */
+
+
+extern "C" void dpotrf_(	const char *uplo, const la_uint_t *_n, double *a,
+							const la_uint_t *_lda, la_int_t *info
+							)
+{
+	long i = potrf<double>( (long)(*_n),a,(long)(*_lda) );
+
 	if (info != 0)
-		*info = 0;
+		*info = (la_int_t)i;
 }
 
+
+extern "C" void spotrf_(	const char *uplo, const la_uint_t *_n, float *a,
+							const la_uint_t *_lda, la_int_t *info
+							)
+{
+	long i = potrf<float>( (long)(*_n),a,(long)(*_lda) );
+
+	if (info != 0)
+		*info = (la_int_t)i;
+}
+
+
+extern "C" void dtrtrs_(	const char *uplo, const char *trans, const char *diag,
+							const la_uint_t *_n, const la_uint_t *_nrhs, const double *a,
+							const la_uint_t *_lda, double *b, const la_uint_t *_ldb, la_int_t *info
+							)
+{
+	long i = trtrsOptions( uplo,trans,diag );
+
+	if ( i == 0 )
+		i = trtrs<double>( trans[0] != 'N' && trans[0] != 'n',(long)(*_n),(long)(*_nrhs),a,(long)(*_lda),b,(long)(*_ldb) );
+
+	if (info != 0)
+		*info = (la_int_t)i;
+}
+
+
+extern "C" void strtrs_(	const char *uplo, const char *trans, const char *diag,
+							const la_uint_t *_n, const la_uint_t *_nrhs, const float *a,
+							const la_uint_t *_lda, float *b, const la_uint_t *_ldb, la_int_t *info
+							)
+{
+	long i = trtrsOptions( uplo,trans,diag );
+
+	if ( i == 0 )
+		i = trtrs<float>( trans[0] != 'N' && trans[0] != 'n',(long)(*_n),(long)(*_nrhs),a,(long)(*_lda),b,(long)(*_ldb) );
+
+	if (info != 0)
+		*info = (la_int_t)i;
+}
@@ -162,12 +162,12 @@ returnValue DenseMatrix::getCol(int cNum, const Indexlist* const irows, real_t a
 
 returnValue DenseMatrix::times(	int xN, real_t alpha, const real_t *x, int xLD, real_t beta, real_t *y, int yLD) const
 {
-	unsigned long _xN     = (unsigned long)xN;
-	unsigned long _nRows  = (unsigned long)nRows;
-	unsigned long _nCols  = (unsigned long)nCols;
-	unsigned long _leaDim = (unsigned long)getMax(1,nCols);
-	unsigned long _xLD    = (unsigned long)getMax(1,xLD);
-	unsigned long _yLD    = (unsigned long)getMax(1,yLD);
+	la_uint_t _xN     = (la_uint_t)xN;
+	la_uint_t _nRows  = (la_uint_t)nRows;
+	la_uint_t _nCols  = (la_uint_t)nCols;
+	la_uint_t _leaDim = (la_uint_t)getMax(1,nCols);
+	la_uint_t _xLD    = (la_uint_t)getMax(1,xLD);
+	la_uint_t _yLD    = (la_uint_t)getMax(1,yLD);
 
 	/* Call BLAS. Mind row major format! */
 	GEMM("TRANS", "NOTRANS", &_nRows, &_xN, &_nCols, &alpha, val, &_leaDim, x, &_xLD, &beta, y, &_yLD);
@@ -176,12 +176,12 @@ returnValue DenseMatrix::times(	int xN, real_t alpha, const real_t *x, int xLD,
 
 returnValue DenseMatrix::transTimes( int xN, real_t alpha, const real_t *x, int xLD, real_t beta, real_t *y, int yLD) const
 {
-	unsigned long _xN     = (unsigned long)xN;
-	unsigned long _nRows  = (unsigned long)nRows;
-	unsigned long _nCols  = (unsigned long)nCols;
-	unsigned long _leaDim = (unsigned long)getMax(1,nCols);
-	unsigned long _xLD    = (unsigned long)getMax(1,xLD);
-	unsigned long _yLD    = (unsigned long)getMax(1,yLD);
+	la_uint_t _xN     = (la_uint_t)xN;
+	la_uint_t _nRows  = (la_uint_t)nRows;
+	la_uint_t _nCols  = (la_uint_t)nCols;
+	la_uint_t _leaDim = (la_uint_t)getMax(1,nCols);
+	la_uint_t _xLD    = (la_uint_t)getMax(1,xLD);
+	la_uint_t _yLD    = (la_uint_t)getMax(1,yLD);
 
 	/* Call BLAS. Mind row major format! */
 	GEMM("NOTRANS", "NOTRANS", &_nCols, &_xN, &_nRows, &alpha, val, &_leaDim, x, &_xLD, &beta, y, &_yLD);
@@ -1886,6 +1886,349 @@ returnValue SparseMatrixRow::print( const char* name ) const
 
 
 
+BlockDiagMatrix::BlockDiagMatrix() : nBlocks(0), blockRows(0), blockCols(0), nRows(0), nCols(0), val(0) {}
+
+
+BlockDiagMatrix::BlockDiagMatrix(int nb, int br, int bc, real_t *v)
+	: nBlocks(nb), blockRows(br), blockCols(bc), nRows(nb*br), nCols(nb*bc), val(v) { doNotFreeMemory(); }
+
+
+BlockDiagMatrix::BlockDiagMatrix(int nb, int br, int bc, int ld, const real_t * const v)
+	: nBlocks(nb), blockRows(br), blockCols(bc), nRows(nb*br), nCols(nb*bc)
+{
+	int i, j;
+
+	val = new real_t[nRows*blockCols];
+
+	for (j = 0; j < nRows; j++)
+		for (i = 0; i < blockCols; i++)
+			val[j*blockCols+i] = v[j*ld + (j/blockRows)*blockCols + i];
+
+	doFreeMemory( );
+}
+
+
+BlockDiagMatrix::~BlockDiagMatrix()
+{
+	if ( needToFreeMemory() == BT_TRUE )
+		free( );
+}
+
+
+void BlockDiagMatrix::free( )
+{
+	if (val != 0) delete[] val;
+	val = 0;
+
+	doNotFreeMemory( );
+}
+
+
+Matrix *BlockDiagMatrix::duplicate() const
+{
+	BlockDiagMatrix *dupl = new BlockDiagMatrix;
+
+	dupl->nBlocks = nBlocks;
+	dupl->blockRows = blockRows;
+	dupl->blockCols = blockCols;
+	dupl->nRows = nRows;
+	dupl->nCols = nCols;
+	dupl->val = new real_t[nRows*blockCols];
+	memcpy( dupl->val,val, ((unsigned int)(nRows*blockCols))*sizeof(real_t) );
+
+	dupl->doFreeMemory( );
+
+	return dupl;
+}
+
+
+real_t BlockDiagMatrix::diag(int i) const
+{
+	int b = i / blockRows;
+
+	return ( i / blockCols == b ) ? val[i*blockCols + i - b*blockCols] : 0.0;
+}
+
+
+BooleanType BlockDiagMatrix::isDiag() const
+{
+	int i, j;
+
+	if ( blockRows != blockCols )
+		return BT_FALSE;
+
+	for (j = 0; j < nRows; j++)
+		for (i = 0; i < blockCols; i++)
+			if ( ( i != j%blockRows ) && ( getAbs( val[j*blockCols+i] ) > EPS ) )
+				return BT_FALSE;
+
+	return BT_TRUE;
+}
+
+
+real_t BlockDiagMatrix::getNorm(	int type
+									) const
+{
+	return REFER_NAMESPACE_QPOASES getNorm( val,nRows*blockCols,type );
+}
+
+
+real_t BlockDiagMatrix::getRowNorm( int rNum, int type ) const
+{
+	return REFER_NAMESPACE_QPOASES getNorm( &(val[rNum*blockCols]),blockCols,type );
+}
+
+
+returnValue BlockDiagMatrix::getRow(int rNum, const Indexlist* const icols, real_t alpha, real_t *row) const
+{
+	int i, col;
+	int first = ( rNum / blockRows ) * blockCols;
+	const real_t* valRow = &(val[rNum*blockCols]);
+
+	if (icols != 0)
+	{
+		for (i = 0; i < icols->length; i++)
+		{
+			col = icols->number[i] - first;
+			row[i] = ( ( col >= 0 ) && ( col < blockCols ) ) ? alpha * valRow[col] : 0.0;
+		}
+	}
+	else
+	{
+		for (i = 0; i < nCols; i++)
+			row[i] = 0.0;
+
+		for (i = 0; i < blockCols; i++)
+			row[first+i] = alpha * valRow[i];
+	}
+
+	return SUCCESSFUL_RETURN;
+}
+
+
+returnValue BlockDiagMatrix::getCol(int cNum, const Indexlist* const irows, real_t alpha, real_t *col) const
+{
+	int i, row;
+	int b = cNum / blockCols;
+	int c = cNum - b*blockCols;
+
+	if (irows != 0)
+	{
+		for (i = 0; i < irows->length; i++)
+		{
+			row = irows->number[i];
+			col[i] = ( row / blockRows == b ) ? alpha * val[row*blockCols+c] : 0.0;
+		}
+	}
+	else
+	{
+		for (i = 0; i < nRows; i++)
+			col[i] = ( i / blockRows == b ) ? alpha * val[i*blockCols+c] : 0.0;
+	}
+
+	return SUCCESSFUL_RETURN;
+}
+
+
+returnValue BlockDiagMatrix::times(int xN, real_t alpha, const real_t *x, int xLD,
+		real_t beta, real_t *y, int yLD) const
+{
+	int i, j, k, first;
+
+	if ( isZero(beta) == BT_TRUE )
+		for (k = 0; k < xN; k++)
+			for (j = 0; j < nRows; j++)
+				y[j+k*yLD] = 0.0;
+	else if ( isEqual(beta,-1.0) == BT_TRUE )
+		for (k = 0; k < xN; k++)
+			for (j = 0; j < nRows; j++)
+				y[j+k*yLD] = -y[j+k*yLD];
+	else if ( isEqual(beta,1.0) == BT_FALSE )
+		for (k = 0; k < xN; k++)
+			for (j = 0; j < nRows; j++)
+				y[j+k*yLD] *= beta;
+
+	for (k = 0; k < xN; k++)
+		for (j = 0; j < nRows; j++)
+		{
+			first = ( j / blockRows ) * blockCols;
+			for (i = 0; i < blockCols; i++)
+				y[j+k*yLD] += alpha * val[j*blockCols+i] * x[first+i+k*xLD];
+		}
+
+	return SUCCESSFUL_RETURN;
+}
+
+
+returnValue BlockDiagMatrix::transTimes(int xN, real_t alpha, const real_t *x, int xLD,
+		real_t beta, real_t *y, int yLD) const
+{
+	int i, j, k, first;
+
+	if ( isZero(beta) == BT_TRUE )
+		for (k = 0; k < xN; k++)
+			for (j = 0; j < nCols; j++)
+				y[j+k*yLD] = 0.0;
+	else if ( isEqual(beta,-1.0) == BT_TRUE )
+		for (k = 0; k < xN; k++)
+			for (j = 0; j < nCols; j++)
+				y[j+k*yLD] = -y[j+k*yLD];
+	else if ( isEqual(beta,1.0) == BT_FALSE )
+		for (k = 0; k < xN; k++)
+			for (j = 0; j < nCols; j++)
+				y[j+k*yLD] *= beta;
+
+	for (k = 0; k < xN; k++)
+		for (j = 0; j < nRows; j++)
+		{
+			first = ( j / blockRows ) * blockCols;
+			for (i = 0; i < blockCols; i++)
+				y[first+i+k*yLD] += alpha * val[j*blockCols+i] * x[j+k*xLD];
+		}
+
+	return SUCCESSFUL_RETURN;
+}
+
+
+returnValue BlockDiagMatrix::times(const Indexlist* const irows, const Indexlist* const icols,
+		int xN, real_t alpha, const real_t *x, int xLD, real_t beta, real_t *y, int yLD,
+		BooleanType yCompr) const
+{
+	int i, j, k, c, pos, row, col, iy, first;
+
+	if ( isZero(beta) == BT_TRUE )
+		for (k = 0; k < xN; k++)
+			for (j = 0; j < irows->length; j++)
+			{
+				iy = ( yCompr == BT_TRUE ) ? j : irows->number[j];
+				y[iy+k*yLD] = 0.0;
+			}
+	else if ( isEqual(beta,1.0) == BT_FALSE )
+		for (k = 0; k < xN; k++)
+			for (j = 0; j < irows->length; j++)
+			{
+				iy = ( yCompr == BT_TRUE ) ? j : irows->number[j];
+				y[iy+k*yLD] *= beta;
+			}
+
+	/* rows in ascending order visit the blocks in ascending order,
+	 * so the columns of the current block are found by one pass over icols */
+	for (k = 0; k < xN; k++)
+	{
+		c = 0;
+		for (j = 0; j < irows->length; j++)
+		{
+			pos = irows->iSort[j];
+			row = irows->number[pos];
+			first = ( row / blockRows ) * blockCols;
+			iy = ( ( yCompr == BT_TRUE ) ? pos : row ) + k*yLD;
+
+			if (icols == 0)
+			{
+				for (i = 0; i < blockCols; i++)
+					y[iy] += alpha * val[row*blockCols+i] * x[first+i+k*xLD];
+			}
+			else
+			{
+				while ( ( c < icols->length ) && ( icols->number[icols->iSort[c]] < first ) )
+					c++;
+
+				for (i = c; i < icols->length; i++)
+				{
+					col = icols->iSort[i];
+					if ( icols->number[col] >= first+blockCols )
+						break;
+					y[iy] += alpha * val[row*blockCols+icols->number[col]-first] * x[col+k*xLD];
+				}
+			}
+		}
+	}
+
+	return SUCCESSFUL_RETURN;
+}
+
+
+returnValue BlockDiagMatrix::transTimes(const Indexlist* const irows, const Indexlist* const icols,
+		int xN, real_t alpha, const real_t *x, int xLD, real_t beta, real_t *y, int yLD) const
+{
+	int i, j, k, c, pos, row, col, first;
+
+	if ( isZero(beta) == BT_TRUE )
+		for (k = 0; k < xN; k++)
+			for (j = 0; j < icols->length; j++)
+				y[j+k*yLD] = 0.0;
+	else if ( isEqual(beta,1.0) == BT_FALSE )
+		for (k = 0; k < xN; k++)
+			for (j = 0; j < icols->length; j++)
+				y[j+k*yLD] *= beta;
+
+	for (k = 0; k < xN; k++)
+	{
+		c = 0;
+		for (j = 0; j < irows->length; j++)
+		{
+			pos = irows->iSort[j];
+			row = irows->number[pos];
+			first = ( row / blockRows ) * blockCols;
+
+			while ( ( c < icols->length ) && ( icols->number[icols->iSort[c]] < first ) )
+				c++;
+
+			for (i = c; i < icols->length; i++)
+			{
+				col = icols->iSort[i];
+				if ( icols->number[col] >= first+blockCols )
+					break;
+				y[col+k*yLD] += alpha * val[row*blockCols+icols->number[col]-first] * x[pos+k*xLD];
+			}
+		}
+	}
+
+	return SUCCESSFUL_RETURN;
+}
+
+
+returnValue BlockDiagMatrix::addToDiag(real_t alpha)
+{
+	int i;
+
+	if ( blockRows != blockCols )
+		return RET_NO_DIAGONAL_AVAILABLE;
+
+	for (i = 0; i < nRows; i++)
+		val[i*blockCols + i%blockRows] += alpha;
+
+	return SUCCESSFUL_RETURN;
+}
+
+
+real_t *BlockDiagMatrix::full() const
+{
+	int i, j;
+	real_t *v = new real_t[nRows*nCols];
+
+	for (i = 0; i < nCols*nRows; i++)
+		v[i] = 0.0;
+
+	for (j = 0; j < nRows; j++)
+		for (i = 0; i < blockCols; i++)
+			v[j*nCols + (j/blockRows)*blockCols + i] = val[j*blockCols+i];
+
+	return v;
+}
+
+
+returnValue BlockDiagMatrix::print( const char* name ) const
+{
+	real_t* tmp = this->full();
+	returnValue retVal = REFER_NAMESPACE_QPOASES print( tmp,nRows,nCols,name );
+	delete[] tmp;
+
+	return retVal;
+}
+
+
+
 Matrix *SymSparseMat::duplicate() const
 {
 	return duplicateSym();
@@ -1971,6 +2314,70 @@ returnValue SymSparseMat::bilinear(const Indexlist* const icols,
 }
 
 
+
+/*
+ *	g e t E n v e l o p e
+ */
+real_t getEnvelope( int n, const real_t* const a, int lda, int* first )
+{
+	int i, j;
+	real_t flops = 0.0, flopsDense = 0.0;
+
+	for (j = 0; j < n; j++)
+	{
+		/* exact test, entries below any tolerance still belong to the envelope */
+		for (i = 0; i < j; i++)
+			if ( ( a[i+lda*j] < 0.0 ) || ( a[i+lda*j] > 0.0 ) )
+				break;
+		first[j] = i;
+
+		flops += (real_t)(j-i+1) * (real_t)(j-i+1);
+		flopsDense += (real_t)(j+1) * (real_t)(j+1);
+	}
+
+	return ( flopsDense > 0.0 ) ? flops / flopsDense : 1.0;
+}
+
+
+/*
+ *	P O T R F e n v e l o p e
+ */
+la_int_t POTRFenvelope( int n, real_t* a, int lda, const int* const first )
+{
+	int i, j, k, kStart;
+	real_t sum;
+
+	for (j = 0; j < n; j++)
+	{
+		for (i = first[j]; i < j; i++)
+		{
+			kStart = getMax( first[i],first[j] );
+			sum = a[i+lda*j];
+
+			for (k = i-1; k >= kStart; k--)
+				sum -= a[k+lda*i] * a[k+lda*j];
+
+			a[i+lda*j] = sum / a[i+lda*i];
+		}
+
+		sum = a[j+lda*j];
+
+		for (k = j-1; k >= first[j]; k--)
+			sum -= a[k+lda*j] * a[k+lda*j];
+
+		if ( sum > 0.0 )
+			a[j+lda*j] = getSqrt( sum );
+		else
+		{
+			a[0] = sum; /* tunnel negative diagonal element to caller */
+			return (la_int_t)j+1;
+		}
+	}
+
+	return 0;
+}
+
+
 END_NAMESPACE_QPOASES
 
 
@@ -45,14 +45,14 @@
 
 BEGIN_NAMESPACE_QPOASES
 
-/** Default file to display messages. */
+/** Default file to display messages, shared by all threads (only to be changed before solving). */
 FILE* stdFile = stdout;
 
 
 
 #ifndef __XPCTARGET__
-/** Defines pairs of global return values and messages. */
-MessageHandling::ReturnValueList returnValueList[] =
+/** Defines pairs of global return values and messages (read only). */
+const MessageHandling::ReturnValueList returnValueList[] =
 {
 /* miscellaneous */
 { SUCCESSFUL_RETURN, "Successful return", VS_VISIBLE },
@@ -217,7 +217,7 @@ MessageHandling::ReturnValueList returnValueList[] =
 { TERMINAL_LIST_ELEMENT, "", VS_HIDDEN }
 };
 #else
-MessageHandling::ReturnValueList returnValueList[1]; /* Do not use messages for embedded platforms! */
+const MessageHandling::ReturnValueList returnValueList[1] = { }; /* Do not use messages for embedded platforms! */
 #endif
 
 
@@ -596,8 +596,9 @@ const char* MessageHandling::getErrorCodeMessage(	const returnValue _returnValue
  *****************************************************************************/
 
 
-/** Global message handler for all qpOASES modules.*/
-static MessageHandling globalMessageHandler( stdFile,VS_VISIBLE,VS_VISIBLE,VS_VISIBLE );
+/** Global message handler for all qpOASES modules, one per thread
+ *  (see QPOASES_THREAD_LOCAL) as it keeps print levels and error counts. */
+static QPOASES_THREAD_LOCAL MessageHandling globalMessageHandler( stdFile,VS_VISIBLE,VS_VISIBLE,VS_VISIBLE );
 
 
 /*
@@ -77,7 +77,8 @@ QProblem::QProblem( ) : QProblemB( )
 /*
  *	Q P r o b l e m
  */
-QProblem::QProblem( int _nV, int _nC, HessianType _hessianType ) : QProblemB( _nV,_hessianType )
+QProblem::QProblem( int _nV, int _nC, HessianType _hessianType, Workspace* const _workspace )
+			: QProblemB( _nV,_hessianType,reserveWorkspace( _workspace,getWorkspaceSize( _nV,_nC ) ) )
 {
 	int i;
 
@@ -99,10 +100,10 @@ QProblem::QProblem( int _nV, int _nC, HessianType _hessianType ) : QProblemB( _n
 		freeConstraintMatrix = BT_FALSE;
 		A = 0;
 
-		lbA = new real_t[_nC];
+		lbA = allocate<real_t>( workspace,_nC );
 		for( i=0; i<_nC; ++i ) lbA[i] = 0.0;
 
-		ubA = new real_t[_nC];
+		ubA = allocate<real_t>( workspace,_nC );
 		for( i=0; i<_nC; ++i ) ubA[i] = 0.0;
 	}
 	else
@@ -116,21 +117,21 @@ QProblem::QProblem( int _nV, int _nC, HessianType _hessianType ) : QProblemB( _n
 		ubA = 0;
 	}
 
-	constraints.init( _nC );
+	constraints.init( _nC,workspace );
 
-	delete[] y; /* y of no constraints version too short! */
-	y = new real_t[_nV+_nC];
+	deallocate( workspace,y ); /* y of no constraints version too short! */
+	y = allocate<real_t>( workspace,_nV+_nC );
 	for( i=0; i<_nV+_nC; ++i ) y[i] = 0.0;
 
 	sizeT = getMin( _nV,_nC );
-	T = new real_t[sizeT*sizeT];
-	Q = new real_t[_nV*_nV];
+	T = allocate<real_t>( workspace,sizeT*sizeT );
+	Q = allocate<real_t>( workspace,_nV*_nV );
 
 	if ( _nC > 0 )
 	{
-		Ax = new real_t[_nC];
-		Ax_l = new real_t[_nC];
-		Ax_u = new real_t[_nC];
+		Ax = allocate<real_t>( workspace,_nC );
+		Ax_l = allocate<real_t>( workspace,_nC );
+		Ax_u = allocate<real_t>( workspace,_nC );
 	}
 	else
 	{
@@ -141,15 +142,15 @@ QProblem::QProblem( int _nV, int _nC, HessianType _hessianType ) : QProblemB( _n
 
 	constraintProduct = 0;
 
-	tempA = new real_t[_nV];			/* nFR */
-	ZFR_delta_xFRz = new real_t[_nV];	/* nFR */
-	delta_xFRz = new real_t[_nV];		/* nZ */
+	tempA = allocate<real_t>( workspace,_nV );			/* nFR */
+	ZFR_delta_xFRz = allocate<real_t>( workspace,_nV );	/* nFR */
+	delta_xFRz = allocate<real_t>( workspace,_nV );		/* nZ */
 
 	if ( _nC > 0 )
 	{
-		tempB = new real_t[_nC];			/* nAC */
-		delta_xFRy = new real_t[_nC];		/* nAC */
-		delta_yAC_TMP = new real_t[_nC];   /* nAC */
+		tempB = allocate<real_t>( workspace,_nC );			/* nAC */
+		delta_xFRy = allocate<real_t>( workspace,_nC );		/* nAC */
+		delta_yAC_TMP = allocate<real_t>( workspace,_nC );	/* nAC */
 	}
 	else
 	{
@@ -199,6 +200,29 @@ QProblem& QProblem::operator=( const QProblem& rhs )
 }
 
 
+/*
+ *	g e t W o r k s p a c e S i z e
+ */
+size_t QProblem::getWorkspaceSize( int _nV, int _nC )
+{
+	/* arrays of QProblemB, y is allocated again with length nV+nC */
+	size_t wsSize = QProblemB::getWorkspaceSize( _nV ) + Workspace::getArraySize<real_t>( _nV+_nC );
+
+	/* Q, T, tempA, ZFR_delta_xFRz and delta_xFRz */
+	wsSize += Workspace::getArraySize<real_t>( _nV*_nV ) + Workspace::getArraySize<real_t>( getMin( _nV,_nC )*getMin( _nV,_nC ) );
+	wsSize += 3 * Workspace::getArraySize<real_t>( _nV );
+
+	/* lbA, ubA, Ax, Ax_l, Ax_u, tempB, delta_xFRy and delta_yAC_TMP */
+	wsSize += 8 * Workspace::getArraySize<real_t>( _nC );
+
+	/* constraints with index lists of active and inactive constraints */
+	wsSize += Workspace::getArraySize<SubjectToType>( _nC ) + Workspace::getArraySize<SubjectToStatus>( _nC );
+	wsSize += 4 * Workspace::getArraySize<int>( _nC );
+
+	return wsSize;
+}
+
+
 /*
  *	r e s e t
  */
@@ -444,6 +468,8 @@ returnValue QProblem::hotstart(	const real_t* const g_new,
 	if ( nV == 0 )
 		return THROWERROR( RET_QPOBJECT_NOT_SETUP );
 
+	PROFILE_SCOPE( homotopy,nHomotopy );
+
 	
 	/* Possibly update working sets according to guesses for working sets of bounds and constraints. */
 	if ( ( guessedBounds != 0 ) || ( guessedConstraints != 0 ) )
@@ -1057,82 +1083,43 @@ returnValue QProblem::clear( )
 	}
 
 	if ( lbA != 0 )
-	{
-		delete[] lbA;
-		lbA = 0;
-	}
+		deallocate( workspace,lbA );
 
 	if ( ubA != 0 )
-	{
-		delete[] ubA;
-		ubA = 0;
-	}
+		deallocate( workspace,ubA );
 
 	if ( T != 0 )
-	{
-		delete[] T;
-		T = 0;
-	}
+		deallocate( workspace,T );
 
 	if ( Q != 0 )
-	{
-		delete[] Q;
-		Q = 0;
-	}
+		deallocate( workspace,Q );
 
 	if ( Ax != 0 )
-	{
-		delete[] Ax;
-		Ax = 0;
-	}
+		deallocate( workspace,Ax );
 
 	if ( Ax_l != 0 )
-	{
-		delete[] Ax_l;
-		Ax_l = 0;
-	}
+		deallocate( workspace,Ax_l );
 
 	if ( Ax_u != 0 )
-	{
-		delete[] Ax_u;
-		Ax_u = 0;
-	}
+		deallocate( workspace,Ax_u );
 
 	if ( tempA != 0 )
-	{
-		delete[] tempA;
-		tempA = 0;
-	}
+		deallocate( workspace,tempA );
 
 	if ( ZFR_delta_xFRz != 0 )
-	{
-		delete[] ZFR_delta_xFRz;
-		ZFR_delta_xFRz = 0;
-	}
+		deallocate( workspace,ZFR_delta_xFRz );
 
 	if ( delta_xFRy != 0 )
-	{
-		delete[] delta_xFRy;
-		delta_xFRy = 0;
-	}
+		deallocate( workspace,delta_xFRy );
 
 	if ( delta_xFRz != 0 )
-	{
-		delete[] delta_xFRz;
-		delta_xFRz = 0;
-	}
+		deallocate( workspace,delta_xFRz );
 
 	if ( tempB != 0 )
-	{
-		delete[] tempB;
-		tempB = 0;
-	}
+		deallocate( workspace,tempB );
 
 	if ( delta_yAC_TMP != 0 )
-	{
-		delete[] delta_yAC_TMP;
-		delta_yAC_TMP = 0;
-	}
+		deallocate( workspace,delta_yAC_TMP );
 
 	return SUCCESSFUL_RETURN;
 }
@@ -1180,7 +1167,7 @@ returnValue QProblem::copy(	const QProblem& rhs
 
 	if ( rhs.y != 0 )
 	{
-		delete[] y; /* y of no constraints version too short! */
+		deallocate( workspace,y ); /* y of no constraints version too short! */
 		y = new real_t[_nV+_nC];
 		memcpy( y,rhs.y,(_nV+_nC)*sizeof(real_t) );
 	}
@@ -1278,6 +1265,8 @@ returnValue QProblem::solveInitialQP(	const real_t* const xOpt, const real_t* co
 	if ( cputime != 0 )
 		starttime = getCPUtime( );
 
+	PROFILE_TIC( setupStart );
+
 	status = QPS_NOTINITIALISED;
 
 
@@ -1405,6 +1394,8 @@ returnValue QProblem::solveInitialQP(	const real_t* const xOpt, const real_t* co
 	if ( cputime != 0 )
 		*cputime -= getCPUtime( ) - starttime;
 
+	PROFILE_TOC( setupStart,setup,nSetup );
+
 	/* Use hotstart method to find the solution of the original initial QP,... */
 	returnValue returnvalue = hotstart( g_original,lb_original,ub_original,lbA_original,ubA_original, nWSR,cputime );
 
@@ -1912,6 +1903,8 @@ returnValue QProblem::computeProjectedCholesky( )
 	if ( getNFX() + getNAC() == 0 )
 		return QProblemB::computeCholesky( );
 
+	PROFILE_SCOPE( factorisation,nFactorisation );
+
 	/* 1) Initialises R with all zeros. */
 	for( i=0; i<nV*nV; ++i )
 		R[i] = 0.0;
@@ -1970,10 +1963,7 @@ returnValue QProblem::computeProjectedCholesky( )
 	}
 
 	/* R'*R = Z'*H*Z */
-	long info = 0;
-	unsigned long _nZ = (unsigned long)nZ, _nV = (unsigned long)nV;
-
-	POTRF( "U", &_nZ, R, &_nV, &info );
+	la_int_t info = factoriseR( nZ );
 
 	/* <0 = invalid call, =0 ok, >0 not spd */
 	if (info > 0) {
@@ -2039,6 +2029,8 @@ returnValue QProblem::setupTQfactorisation( )
 	int nV  = getNV( );
 	int nFR = getNFR( );
 
+	PROFILE_SCOPE( factorisation,nFactorisation );
+
 	int* FR_idx;
 	bounds.getFree( )->getNumberArray( &FR_idx );
 
@@ -4507,6 +4499,8 @@ returnValue QProblem::determineStepDirection(	const real_t* const delta_g, const
 	int nFX = getNFX( );
 	int nAC = getNAC( );
 	int nZ  = getNZ( );
+
+	PROFILE_SCOPE( stepDirection,nStepDirection );
 	
 	int* FR_idx;
 	int* FX_idx;
@@ -4854,6 +4848,8 @@ returnValue QProblem::performStep(	const real_t* const delta_g,
 	int nAC = getNAC( );
 	int nIAC = getNIAC( );
 
+	PROFILE_SCOPE( performStep,nPerformStep );
+
 	int* FR_idx;
 	int* FX_idx;
 	int* AC_idx;
@@ -5159,6 +5155,8 @@ returnValue QProblem::changeActiveSet( int BC_idx, SubjectToStatus BC_status, Bo
 		case ST_INACTIVE:
 			if ( BC_isBound == BT_TRUE )
 			{
+				PROFILE_SCOPE( removeConstraint,nRemoveConstraint );
+
 				#ifndef __XPCTARGET__
 				snprintf( messageString,MAX_STRING_LENGTH,"bound no. %d.", BC_idx );
 				getGlobalMessageHandler( )->throwInfo( RET_REMOVE_FROM_ACTIVESET,messageString,__FUNCTION__,__FILE__,__LINE__,VS_VISIBLE );
@@ -5171,6 +5169,8 @@ returnValue QProblem::changeActiveSet( int BC_idx, SubjectToStatus BC_status, Bo
 			}
 			else
 			{
+				PROFILE_SCOPE( removeConstraint,nRemoveConstraint );
+
 				#ifndef __XPCTARGET__
 				snprintf( messageString,MAX_STRING_LENGTH,"constraint no. %d.", BC_idx );
 				getGlobalMessageHandler( )->throwInfo( RET_REMOVE_FROM_ACTIVESET,messageString,__FUNCTION__,__FILE__,__LINE__,VS_VISIBLE );
@@ -5189,6 +5189,8 @@ returnValue QProblem::changeActiveSet( int BC_idx, SubjectToStatus BC_status, Bo
 			returnValue returnvalue;
 			if ( BC_isBound == BT_TRUE )
 			{
+				PROFILE_SCOPE( addConstraint,nAddConstraint );
+
 				#ifndef __XPCTARGET__
 				if ( BC_status == ST_LOWER )
 					snprintf( messageString,MAX_STRING_LENGTH,"lower bound no. %d.", BC_idx );
@@ -5205,6 +5207,8 @@ returnValue QProblem::changeActiveSet( int BC_idx, SubjectToStatus BC_status, Bo
 			}
 			else
 			{
+				PROFILE_SCOPE( addConstraint,nAddConstraint );
+
 				#ifndef __XPCTARGET__
 				if ( BC_status == ST_LOWER )
 					snprintf( messageString,MAX_STRING_LENGTH,"lower constraint's bound no. %d.", BC_idx );
@@ -79,12 +79,16 @@ QProblemB::QProblemB( )
 	status = QPS_NOTINITIALISED;
 
 	count = 0;
+	resetProfilingStatistics( );
 
 	ramp0 = options.initialRamping;
 	ramp1 = options.finalRamping;
 	rampOffset = 0;
 
 	delta_xFR_TMP = 0;
+	envelopeFirst = 0;
+
+	workspace = 0;
 
 	setPrintLevel( options.printLevel );
 }
@@ -93,7 +97,7 @@ QProblemB::QProblemB( )
 /*
  *	Q P r o b l e m B
  */
-QProblemB::QProblemB( int _nV, HessianType _hessianType )
+QProblemB::QProblemB( int _nV, HessianType _hessianType, Workspace* const _workspace )
 {
 	int i;
 
@@ -111,28 +115,36 @@ QProblemB::QProblemB( int _nV, HessianType _hessianType )
 	/* reset global message handler */
 	getGlobalMessageHandler( )->reset( );
 
+	/* carve all arrays below from the workspace, if any */
+	workspace = _workspace;
+	if ( workspace != 0 )
+	{
+		workspace->reserve( getWorkspaceSize( _nV ) );
+		workspace->reset( );
+	}
+
 	freeHessian = BT_FALSE;
 	H = 0;
 
-	g = new real_t[_nV];
+	g = allocate<real_t>( workspace,_nV );
 	for( i=0; i<_nV; ++i ) g[i] = 0.0;
 
-	lb = new real_t[_nV];
+	lb = allocate<real_t>( workspace,_nV );
 	for( i=0; i<_nV; ++i ) lb[i] = 0.0;
 
-	ub = new real_t[_nV];
+	ub = allocate<real_t>( workspace,_nV );
 	for( i=0; i<_nV; ++i ) ub[i] = 0.0;
 
-	bounds.init( _nV );
+	bounds.init( _nV,workspace );
 
-	R = new real_t[_nV*_nV];
+	R = allocate<real_t>( workspace,_nV*_nV );
 	for( i=0; i<_nV*_nV; ++i ) R[i] = 0.0;
 	haveCholesky = BT_FALSE;
 
-	x = new real_t[_nV];
+	x = allocate<real_t>( workspace,_nV );
 	for( i=0; i<_nV; ++i ) x[i] = 0.0;
 
-	y = new real_t[_nV];
+	y = allocate<real_t>( workspace,_nV );
 	for( i=0; i<_nV; ++i ) y[i] = 0.0;
 
 	tau = 0.0;
@@ -146,12 +158,14 @@ QProblemB::QProblemB( int _nV, HessianType _hessianType )
 	status = QPS_NOTINITIALISED;
 
 	count = 0;
+	resetProfilingStatistics( );
 
 	ramp0 = options.initialRamping;
 	ramp1 = options.finalRamping;
 	rampOffset = 0;
 
-	delta_xFR_TMP = new real_t[_nV];
+	delta_xFR_TMP = allocate<real_t>( workspace,_nV );
+	envelopeFirst = allocate<int>( workspace,_nV );
 
 	setPrintLevel( options.printLevel );
 
@@ -166,6 +180,7 @@ QProblemB::QProblemB( const QProblemB& rhs )
 {
 	freeHessian = BT_FALSE;
 	H = 0;
+	workspace = 0;
 
 	copy( rhs );
 }
@@ -198,6 +213,25 @@ QProblemB& QProblemB::operator=( const QProblemB& rhs )
 }
 
 
+/*
+ *	g e t W o r k s p a c e S i z e
+ */
+size_t QProblemB::getWorkspaceSize( int _nV )
+{
+	/* g, lb, ub, x, y, delta_xFR_TMP and R */
+	size_t wsSize = 6 * Workspace::getArraySize<real_t>( _nV ) + Workspace::getArraySize<real_t>( _nV*_nV );
+
+	/* bounds with index lists of free and fixed variables */
+	wsSize += Workspace::getArraySize<SubjectToType>( _nV ) + Workspace::getArraySize<SubjectToStatus>( _nV );
+	wsSize += 4 * Workspace::getArraySize<int>( _nV );
+
+	/* envelopeFirst */
+	wsSize += Workspace::getArraySize<int>( _nV );
+
+	return wsSize;
+}
+
+
 /*
  *	r e s e t
  */
@@ -418,6 +452,8 @@ returnValue QProblemB::hotstart(	const real_t* const g_new,
 	if ( nV == 0 )
 		return THROWERROR( RET_QPOBJECT_NOT_SETUP );
 
+	PROFILE_SCOPE( homotopy,nHomotopy );
+
 
 	/* Possibly update working set according to guess for working set of bounds. */
 	if ( guessedBounds != 0 )
@@ -1024,46 +1060,28 @@ returnValue QProblemB::clear( )
 	}
 
 	if ( g != 0 )
-	{
-		delete[] g;
-		g = 0;
-	}
+		deallocate( workspace,g );
 
 	if ( lb != 0 )
-	{
-		delete[] lb;
-		lb = 0;
-	}
+		deallocate( workspace,lb );
 
 	if ( ub != 0 )
-	{
-		delete[] ub;
-		ub = 0;
-	}
+		deallocate( workspace,ub );
 
 	if ( R != 0 )
-	{
-		delete[] R;
-		R = 0;
-	}
+		deallocate( workspace,R );
 
 	if ( x != 0 )
-	{
-		delete[] x;
-		x = 0;
-	}
+		deallocate( workspace,x );
 
 	if ( y != 0 )
-	{
-		delete[] y;
-		y = 0;
-	}
+		deallocate( workspace,y );
 
 	if ( delta_xFR_TMP != 0 )
-	{
-		delete[] delta_xFR_TMP;
-		delta_xFR_TMP = 0;
-	}
+		deallocate( workspace,delta_xFR_TMP );
+
+	if ( envelopeFirst != 0 )
+		deallocate( workspace,envelopeFirst );
 
 	return SUCCESSFUL_RETURN;
 }
@@ -1077,6 +1095,9 @@ returnValue QProblemB::copy(	const QProblemB& rhs
 {
 	unsigned int _nV = (unsigned int)rhs.getNV( );
 
+	/* copies live on the heap */
+	workspace = 0;
+
 	bounds = rhs.bounds;
 
 	freeHessian = rhs.freeHessian;
@@ -1147,11 +1168,13 @@ returnValue QProblemB::copy(	const QProblemB& rhs
 	status = rhs.status;
 
 	count = rhs.count;
+	profile = rhs.profile;
 
 	ramp0 = rhs.ramp0;
 	ramp1 = rhs.ramp1;
 
 	delta_xFR_TMP = new real_t[_nV];	/* nFR */
+	envelopeFirst = new int[_nV];		/* nFR or nZ */
 
 	options = rhs.options;
 	setPrintLevel( options.printLevel );
@@ -1360,7 +1383,9 @@ returnValue QProblemB::computeCholesky( )
 	int i, j;
 	int nV  = getNV( );
 	int nFR = getNFR( );
-	
+
+	PROFILE_SCOPE( factorisation,nFactorisation );
+
 	/* 1) Initialises R with all zeros. */
 	for( i=0; i<nV*nV; ++i )
 		R[i] = 0.0;
@@ -1404,10 +1429,7 @@ returnValue QProblemB::computeCholesky( )
 					H->getCol (FR_idx[j], bounds.getFree (), 1.0, &(R[j*nV]) );
 
 				/* R'*R = H */
-				long info = 0;
-				unsigned long _nFR = (unsigned long)nFR, _nV = (unsigned long)nV;
-
-				POTRF( "U", &_nFR, R, &_nV, &info );
+				la_int_t info = factoriseR( nFR );
 
 				/* <0 = invalid call, =0 ok, >0 not spd */
 				if (info > 0) {
@@ -1465,6 +1487,27 @@ returnValue QProblemB::setupInitialCholesky( )
 }
 
 
+/*
+ *	f a c t o r i s e R
+ */
+la_int_t QProblemB::factoriseR( int nR )
+{
+	la_int_t info = 0;
+
+	if ( getEnvelope( nR,R,getNV( ),envelopeFirst ) <= 0.5 )
+	{
+		info = POTRFenvelope( nR,R,getNV( ),envelopeFirst );
+	}
+	else
+	{
+		la_uint_t _nR = (la_uint_t)nR, _nV = (la_uint_t)getNV( );
+		POTRF( "U", &_nR, R, &_nV, &info );
+	}
+
+	return info;
+}
+
+
 /*
  *	o b t a i n A u x i l i a r y W o r k i n g S e t
  */
@@ -1629,12 +1672,10 @@ returnValue QProblemB::backsolveR(	const real_t* const b, BooleanType transposed
 									real_t* const a
 									) const
 {
-	int i, j;
+	int i;
 	int nV = getNV( );
 	int nR = getNZ( );
 
-	real_t sum;
-
 	/* if backsolve is called while removing a bound, reduce nZ by one. */
 	if ( removingBound == BT_TRUE )
 		--nR;
@@ -1645,36 +1686,21 @@ returnValue QProblemB::backsolveR(	const real_t* const b, BooleanType transposed
 
 
 	/* Solve Ra = b, where R might be transposed. */
-	if ( transposed == BT_FALSE )
-	{
-		/* solve Ra = b */
-		for( i=(nR-1); i>=0; --i )
-		{
-			sum = b[i];
-			for( j=(i+1); j<nR; ++j )
-				sum -= RR(i,j) * a[j];
-
-			if ( getAbs( RR(i,i) ) >= ZERO*getAbs( sum ) )
-				a[i] = sum / RR(i,i);
-			else
-				return THROWERROR( RET_DIV_BY_ZERO );
-		}
-	}
-	else
-	{
-		/* solve R^T*a = b */
+	if ( a != b )
 		for( i=0; i<nR; ++i )
-		{
-			sum = b[i];
-			for( j=0; j<i; ++j )
-				sum -= RR(j,i) * a[j];
+			a[i] = b[i];
 
-			if ( getAbs( RR(i,i) ) >= ZERO*getAbs( sum ) )
-				a[i] = sum / RR(i,i);
-			else
-				return THROWERROR( RET_DIV_BY_ZERO );
-		}
-	}
+	la_uint_t _nR = (la_uint_t)nR, _nV = (la_uint_t)nV, _nRHS = 1;
+	la_int_t info = 0;
+	TRTRS( "U", ( transposed == BT_FALSE ) ? "N" : "T", "N", &_nR, &_nRHS, R, &_nV, a, &_nR, &info );
+
+	if ( info != 0 )
+		return THROWERROR( RET_DIV_BY_ZERO );
+
+	/* |RR(i,i)| >= ZERO*|sum| of each substitution step, fails on NaN as well */
+	for( i=0; i<nR; ++i )
+		if ( !( ZERO*getAbs( a[i] ) <= 1.0 ) )
+			return THROWERROR( RET_DIV_BY_ZERO );
 
 	return SUCCESSFUL_RETURN;
 }
@@ -2254,6 +2280,8 @@ returnValue QProblemB::solveInitialQP(	const real_t* const xOpt, const real_t* c
 	if ( cputime != 0 )
 		starttime = getCPUtime( );
 
+	PROFILE_TIC( setupStart );
+
 
 	status = QPS_NOTINITIALISED;
 
@@ -2356,6 +2384,8 @@ returnValue QProblemB::solveInitialQP(	const real_t* const xOpt, const real_t* c
 	if ( cputime != 0 )
 		*cputime -= getCPUtime( ) - starttime;
 
+	PROFILE_TOC( setupStart,setup,nSetup );
+
 	/* Use hotstart method to find the solution of the original initial QP,... */
 	returnValue returnvalue = hotstart( g_original,lb_original,ub_original, nWSR,cputime );
 
@@ -3031,6 +3061,8 @@ returnValue QProblemB::determineStepDirection(	const real_t* const delta_g, cons
 	int r;
 	int nFR = getNFR( );
 	int nFX = getNFX( );
+
+	PROFILE_SCOPE( stepDirection,nStepDirection );
 	
 	int* FR_idx;
 	int* FX_idx;
@@ -3201,6 +3233,8 @@ returnValue QProblemB::performStep(	const real_t* const delta_g,
 	int nFR = getNFR( );
 	int nFX = getNFX( );
 
+	PROFILE_SCOPE( performStep,nPerformStep );
+
 	int* FR_idx;
 	int* FX_idx;
 
@@ -3349,6 +3383,9 @@ returnValue QProblemB::changeActiveSet( int BC_idx, SubjectToStatus BC_status )
 
 		/* Remove one variable from active set. */
 		case ST_INACTIVE:
+		{
+			PROFILE_SCOPE( removeConstraint,nRemoveConstraint );
+
 			#ifndef __XPCTARGET__
 			snprintf( messageString,MAX_STRING_LENGTH,"bound no. %d.", BC_idx );
 			getGlobalMessageHandler( )->throwInfo( RET_REMOVE_FROM_ACTIVESET,messageString,__FUNCTION__,__FILE__,__LINE__,VS_VISIBLE );
@@ -3359,10 +3396,14 @@ returnValue QProblemB::changeActiveSet( int BC_idx, SubjectToStatus BC_status )
 
 			y[BC_idx] = 0.0;
 			break;
+		}
 
 
 		/* Add one variable to active set. */
 		default:
+		{
+			PROFILE_SCOPE( addConstraint,nAddConstraint );
+
 			#ifndef __XPCTARGET__
 			if ( BC_status == ST_LOWER )
 				snprintf( messageString,MAX_STRING_LENGTH,"lower bound no. %d.", BC_idx );
@@ -3374,6 +3415,7 @@ returnValue QProblemB::changeActiveSet( int BC_idx, SubjectToStatus BC_status )
 			if ( addBound( BC_idx,BC_status,BT_TRUE ) != SUCCESSFUL_RETURN )
 				return THROWERROR( RET_ADD_TO_ACTIVESET_FAILED );
 			break;
+		}
 	}
 
 	return SUCCESSFUL_RETURN;
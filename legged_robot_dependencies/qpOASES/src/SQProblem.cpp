@@ -56,7 +56,8 @@ SQProblem::SQProblem( ) : QProblem( )
 /*
  *	S Q P r o b l e m
  */
-SQProblem::SQProblem( int _nV, int _nC, HessianType _hessianType ) : QProblem( _nV,_nC,_hessianType )
+SQProblem::SQProblem( int _nV, int _nC, HessianType _hessianType, Workspace* const _workspace )
+			: QProblem( _nV,_nC,_hessianType,_workspace )
 {
 }
 
@@ -51,6 +51,7 @@ SubjectTo::SubjectTo( )
 {
 	type   = 0;
 	status = 0;
+	workspace = 0;
 
 	init( );
 }
@@ -63,6 +64,7 @@ SubjectTo::SubjectTo( int _n )
 {
 	type   = 0;
 	status = 0;
+	workspace = 0;
 
 	init( _n );
 }
@@ -112,7 +114,17 @@ returnValue SubjectTo::init(	int _n
 	if ( _n < 0 )
 		return THROWERROR( RET_INVALID_ARGUMENTS );
 
-	clear( );
+	/* arrays taken from the workspace are reused */
+	if ( ( workspace == 0 ) || ( workspace->contains( type ) == BT_FALSE ) || ( _n != n ) || ( _n == 0 ) )
+	{
+		clear( );
+
+		if ( _n > 0 )
+		{
+			type   = allocate<SubjectToType>( workspace,_n );
+			status = allocate<SubjectToStatus>( workspace,_n );
+		}
+	}
 
 	n = _n;
 	noLower = BT_TRUE;
@@ -120,9 +132,6 @@ returnValue SubjectTo::init(	int _n
 
 	if ( n > 0 )
 	{
-		type   = new SubjectToType[n];
-		status = new SubjectToStatus[n];
-
 		for( i=0; i<n; ++i )
 		{
 			type[i]   = ST_UNKNOWN;
@@ -135,6 +144,24 @@ returnValue SubjectTo::init(	int _n
 
 
 
+/*
+ *	i n i t
+ */
+returnValue SubjectTo::init(	int _n,
+								Workspace* const _workspace
+								)
+{
+	if ( _n < 0 )
+		return THROWERROR( RET_INVALID_ARGUMENTS );
+
+	clear( );
+	workspace = _workspace;
+
+	return init( _n );
+}
+
+
+
 /*****************************************************************************
  *  P R O T E C T E D                                                        *
  *****************************************************************************/
@@ -145,16 +172,10 @@ returnValue SubjectTo::init(	int _n
 returnValue SubjectTo::clear( )
 {
 	if ( type != 0 )
-	{
-		delete[] type;
-		type = 0;
-	}
+		deallocate( workspace,type );
 
 	if ( status != 0 )
-	{
-		delete[] status;
-		status = 0;
-	}
+		deallocate( workspace,status );
 
 	return SUCCESSFUL_RETURN;
 }
@@ -168,6 +189,9 @@ returnValue SubjectTo::copy(	const SubjectTo& rhs
 {
 	int i;
 
+	/* copies live on the heap */
+	workspace = 0;
+
 	n = rhs.n;
 	noLower = rhs.noLower;
 	noUpper = rhs.noUpper;
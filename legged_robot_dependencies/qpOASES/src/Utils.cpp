@@ -39,6 +39,7 @@
 #elif defined(LINUX) || defined(__LINUX__)
   #include <sys/stat.h>
   #include <sys/time.h>
+  #include <time.h>
 #endif
 
 #ifdef __MATLAB__
@@ -563,27 +564,45 @@ returnValue writeIntoMatFile(	FILE* const matFile,
 
 
 /*
- *	g e t C P U t i m e
+ *	g e t C l o c k T i m e
  */
-real_t getCPUtime( )
+double getClockTime( )
 {
-	real_t current_time = -1.0;
+	double current_time = -1.0;
 
 	#if defined(__WIN32__) || defined(WIN32)
 	LARGE_INTEGER counter, frequency;
 	QueryPerformanceFrequency(&frequency);
 	QueryPerformanceCounter(&counter);
-	current_time = ((real_t) counter.QuadPart) / ((real_t) frequency.QuadPart);
+	current_time = ((double) counter.QuadPart) / ((double) frequency.QuadPart);
 	#elif defined(LINUX) || defined(__LINUX__)
+	#ifdef CLOCK_MONOTONIC
+	/* monotonic with ns resolution, unaffected by changes of the system time */
+	struct timespec theclock;
+	clock_gettime( CLOCK_MONOTONIC,&theclock );
+	current_time = 1.0*theclock.tv_sec + 1.0e-9*theclock.tv_nsec;
+	#else
 	struct timeval theclock;
 	gettimeofday( &theclock,0 );
 	current_time = 1.0*theclock.tv_sec + 1.0e-6*theclock.tv_usec;
 	#endif
+	#endif
 
 	return current_time;
 }
 
 
+/*
+ *	g e t C P U t i m e
+ */
+real_t getCPUtime( )
+{
+	static const double origin = getClockTime( );
+
+	return (real_t)( getClockTime( ) - origin );
+}
+
+
 /*
  *	g e t N o r m
  */
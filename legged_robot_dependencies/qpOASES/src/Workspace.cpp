@@ -0,0 +1,132 @@
+/*
+ *	This file is part of qpOASES.
+ *
+ *	qpOASES -- An Implementation of the Online Active Set Strategy.
+ *	Copyright (C) 2007-2015 by Hans Joachim Ferreau, Andreas Potschka,
+ *	Christian Kirches et al. All rights reserved.
+ *
+ *	qpOASES is free software; you can redistribute it and/or
+ *	modify it under the terms of the GNU Lesser General Public
+ *	License as published by the Free Software Foundation; either
+ *	version 2.1 of the License, or (at your option) any later version.
+ *
+ *	qpOASES is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	See the GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with qpOASES; if not, write to the Free Software
+ *	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/**
+ *	\file src/Workspace.cpp
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ *
+ *	Implementation of the Workspace class, a preallocated memory block
+ *	from which a QProblem carves its internal arrays.
+ */
+
+
+#include <stdlib.h>
+
+#include <qpOASES/Workspace.hpp>
+
+
+BEGIN_NAMESPACE_QPOASES
+
+
+/*****************************************************************************
+ *  P U B L I C                                                              *
+ *****************************************************************************/
+
+
+/*
+ *	W o r k s p a c e
+ */
+Workspace::Workspace( )
+{
+	memory = 0;
+	block = 0;
+	size = 0;
+	used = 0;
+}
+
+
+/*
+ *	W o r k s p a c e
+ */
+Workspace::Workspace( size_t _size )
+{
+	memory = 0;
+	block = 0;
+	size = 0;
+	used = 0;
+
+	reserve( _size );
+}
+
+
+/*
+ *	~ W o r k s p a c e
+ */
+Workspace::~Workspace( )
+{
+	if ( memory != 0 )
+		free( memory );
+}
+
+
+/*
+ *	r e s e r v e
+ */
+returnValue Workspace::reserve( size_t _size )
+{
+	if ( _size <= size )
+		return SUCCESSFUL_RETURN;
+
+	if ( memory != 0 )
+		free( memory );
+
+	/* round up to whole cache lines, plus one for aligning the start */
+	_size = ( _size + QPOASES_WORKSPACE_ALIGN-1 ) / QPOASES_WORKSPACE_ALIGN * QPOASES_WORKSPACE_ALIGN;
+	memory = (char*)malloc( _size + QPOASES_WORKSPACE_ALIGN );
+
+	if ( memory == 0 )
+	{
+		block = 0;
+		size = 0;
+		used = 0;
+		return THROWERROR( RET_INVALID_ARGUMENTS );
+	}
+
+	block = memory + ( QPOASES_WORKSPACE_ALIGN - (size_t)memory % QPOASES_WORKSPACE_ALIGN ) % QPOASES_WORKSPACE_ALIGN;
+	size = _size;
+	used = 0;
+
+	return SUCCESSFUL_RETURN;
+}
+
+
+/*
+ *	r e s e t
+ */
+returnValue Workspace::reset( )
+{
+	used = 0;
+
+	return SUCCESSFUL_RETURN;
+}
+
+
+END_NAMESPACE_QPOASES
+
+
+/*
+ *	end of file
+ */
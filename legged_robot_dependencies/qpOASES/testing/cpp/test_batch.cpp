@@ -0,0 +1,233 @@
+/*
+ *	This file is part of qpOASES.
+ *
+ *	qpOASES -- An Implementation of the Online Active Set Strategy.
+ *	Copyright (C) 2007-2015 by Hans Joachim Ferreau, Andreas Potschka,
+ *	Christian Kirches et al. All rights reserved.
+ *
+ *	qpOASES is free software; you can redistribute it and/or
+ *	modify it under the terms of the GNU Lesser General Public
+ *	License as published by the Free Software Foundation; either
+ *	version 2.1 of the License, or (at your option) any later version.
+ *
+ *	qpOASES is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	See the GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with qpOASES; if not, write to the Free Software
+ *	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/**
+ *	\file testing/cpp/test_batch.cpp
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ *
+ *	Unit test for the BatchSolver class: a batch of balance QPs of differing
+ *	sizes has to give the same solutions and return values on any number of
+ *	threads as when solved one after another.
+ */
+
+
+
+#include <cstdlib>
+#include <vector>
+#include <qpOASES.hpp>
+#include <qpOASES/UnitTesting.hpp>
+
+
+USING_NAMESPACE_QPOASES
+
+
+/** Number of QPs in the batch. */
+const int nProblems = 2000;
+
+
+/** Data of the batch, one balance QP per recorded state. */
+struct BalanceBatch
+{
+	std::vector<BatchProblem> problems;
+	std::vector< std::vector<real_t> > data;
+	std::vector< std::vector<real_t> > solutions;
+};
+
+
+/** Balance QP with 2 to 4 legs in contact: force tracking cost, friction pyramids
+ *  (as constraints, or none for every fifth QP) and normal force bounds. */
+void setupBalanceQP( BalanceBatch& batch, int k )
+{
+	size_t nLegs = 2 + (size_t)( k%3 );
+	size_t nV = 3*nLegs;
+	size_t nC = ( k%5 == 4 ) ? 0 : 4*nLegs;
+	size_t i, j;
+
+	std::vector<real_t> H( nV*nV ), g( nV ), lb( nV ), ub( nV ), A( nC*nV, 0.0 ), lbA( nC ), ubA( nC );
+
+	for (i = 0; i < nV; i++)
+		for (j = 0; j < nV; j++)
+			H[i*nV+j] = ( i == j ) ? 2.0 + 0.1 * rand() / RAND_MAX : 0.2 / ( 1.0 + getAbs( (real_t)i - (real_t)j ) );
+
+	for (i = 0; i < nV; i++)
+	{
+		g[i] = ( i%3 == 2 ) ? -100.0 * rand() / RAND_MAX : 40.0 * ( 2.0 * rand() / RAND_MAX - 1.0 );
+		lb[i] = ( i%3 == 2 ) ? 10.0 : -1e3;
+		ub[i] = ( i%3 == 2 ) ? 150.0 : 1e3;
+	}
+
+	for (i = 0; i < nC; i++)
+	{
+		size_t f = 3 * (i/4);
+		A[i*nV + f + (i%4)/2] = ( i%2 == 0 ) ? 1.0 : -1.0;
+		A[i*nV + f + 2] = -0.6;
+		lbA[i] = -INFTY;
+		ubA[i] = 0.0;
+	}
+
+	batch.data.push_back( H );
+	batch.data.push_back( g );
+	batch.data.push_back( lb );
+	batch.data.push_back( ub );
+	batch.data.push_back( A );
+	batch.data.push_back( lbA );
+	batch.data.push_back( ubA );
+	batch.solutions.push_back( std::vector<real_t>( nV ) );
+	batch.solutions.push_back( std::vector<real_t>( nV+nC ) );
+
+	BatchProblem problem;
+	problem.nV = (int)nV;
+	problem.nC = (int)nC;
+	problem.nWSR = 0;
+	batch.problems.push_back( problem );
+}
+
+
+/** Sets the pointers of the problems, once all data is in place. */
+void setPointers( BalanceBatch& batch )
+{
+	for (size_t k = 0; k < batch.problems.size( ); k++)
+	{
+		BatchProblem& problem = batch.problems[k];
+		std::vector<real_t>* data = &(batch.data[7*k]);
+
+		problem.H = &(data[0][0]);
+		problem.g = &(data[1][0]);
+		problem.lb = &(data[2][0]);
+		problem.ub = &(data[3][0]);
+		problem.A = ( problem.nC > 0 ) ? &(data[4][0]) : 0;
+		problem.lbA = ( problem.nC > 0 ) ? &(data[5][0]) : 0;
+		problem.ubA = ( problem.nC > 0 ) ? &(data[6][0]) : 0;
+		problem.xOpt = &(batch.solutions[2*k][0]);
+		problem.yOpt = &(batch.solutions[2*k+1][0]);
+	}
+}
+
+
+/** Run tests on BatchSolver. */
+int main( )
+{
+	size_t i, k, t;
+	const int nThreads[] = { 1, 2, 4, 0 };
+
+	BalanceBatch batch;
+	for (k = 0; k < (size_t)nProblems; k++)
+		setupBalanceQP( batch, (int)k );
+	setPointers( batch );
+
+	Options options;
+	options.setToMPC( );
+	options.printLevel = PL_NONE;
+
+	/* reference: one QP after another, without workspace */
+	std::vector< std::vector<real_t> > reference( batch.solutions.size( ) );
+	std::vector<returnValue> referenceStatus( (size_t)nProblems );
+	real_t tic = getCPUtime( );
+	for (k = 0; k < (size_t)nProblems; k++)
+	{
+		referenceStatus[k] = solveBatchProblem( batch.problems[k],options,0,0,0 );
+		reference[2*k] = batch.solutions[2*k];
+		reference[2*k+1] = batch.solutions[2*k+1];
+	}
+	real_t tReference = getCPUtime( ) - tic;
+
+	fprintf( stdFile, "%d QPs one after another: %.3f ms\n", nProblems, 1e3*tReference );
+
+	real_t maxDeviation = 0.0;
+	int nStatusMismatches = 0, nBadThreads = 0;
+	std::vector<BatchStatistics> statistics( (size_t)nProblems );
+
+	for (t = 0; t < sizeof(nThreads) / sizeof(int); t++)
+	{
+		BatchSolver solver( nThreads[t] );
+		solver.setOptions( options );
+
+		/* twice, the second batch reuses threads and workspaces */
+		for (int run = 0; run < 2; run++)
+		{
+			for (k = 0; k < batch.solutions.size( ); k++)
+				for (i = 0; i < batch.solutions[k].size( ); i++)
+					batch.solutions[k][i] = -1.0;
+
+			tic = getCPUtime( );
+			returnValue returnvalue = solver.solve( &(batch.problems[0]),nProblems,&(statistics[0]) );
+			real_t tBatch = getCPUtime( ) - tic;
+
+			int nWSR = 0;
+			real_t cpuTime = 0.0;
+			std::vector<int> nPerThread( (size_t)solver.getNThreads( ),0 );
+
+			for (k = 0; k < (size_t)nProblems; k++)
+			{
+				for (i = 0; i < batch.solutions[2*k].size( ); i++)
+					maxDeviation = getMax( maxDeviation, getAbs( batch.solutions[2*k][i] - reference[2*k][i] ) );
+				for (i = 0; i < batch.solutions[2*k+1].size( ); i++)
+					maxDeviation = getMax( maxDeviation, getAbs( batch.solutions[2*k+1][i] - reference[2*k+1][i] ) );
+
+				if ( statistics[k].status != referenceStatus[k] )
+					nStatusMismatches++;
+
+				if ( ( statistics[k].thread < 0 ) || ( statistics[k].thread >= solver.getNThreads( ) ) )
+					nBadThreads++;
+				else
+					nPerThread[ (size_t)statistics[k].thread ]++;
+
+				nWSR += statistics[k].nWSR;
+				cpuTime += statistics[k].cpuTime;
+			}
+
+			if ( returnvalue != SUCCESSFUL_RETURN )
+				nStatusMismatches++;
+
+			fprintf( stdFile, "%d thread(s), batch %d: %.3f ms, %d iterations, avg. %.2f us per QP, QPs per thread:",
+					solver.getNThreads( ), run, 1e3*tBatch, nWSR, 1e6*cpuTime/nProblems );
+			for (i = 0; i < nPerThread.size( ); i++)
+				fprintf( stdFile, " %d", nPerThread[i] );
+			fprintf( stdFile, "\n" );
+		}
+	}
+
+	/* empty batch and invalid arguments */
+	BatchSolver solver( 2 );
+	if ( solver.solve( 0,0 ) != SUCCESSFUL_RETURN )
+		nStatusMismatches++;
+	if ( solver.solve( 0,1 ) != RET_INVALID_ARGUMENTS )
+		nStatusMismatches++;
+
+	fprintf( stdFile, "Max. deviation from sequential solution: %9.2e, return value mismatches: %d, bad thread indices: %d\n",
+			maxDeviation, nStatusMismatches, nBadThreads );
+
+	QPOASES_TEST_FOR_TRUE( nStatusMismatches == 0 );
+	QPOASES_TEST_FOR_TRUE( nBadThreads == 0 );
+	QPOASES_TEST_FOR_TOL( maxDeviation,1e-15 );
+
+	return TEST_PASSED;
+}
+
+
+/*
+ *	end of file
+ */
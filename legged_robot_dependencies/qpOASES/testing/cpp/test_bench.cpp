@@ -82,7 +82,9 @@ int main( int argc, char *argv[] )
 
 
 	int nWSR;
-	real_t maxCPUtime; /* seconds */
+	real_t maxNWSR, avgNWSR;
+	real_t maxCPUtime, avgCPUtime; /* seconds */
+	real_t sumCPUtime = 0.0;
 	real_t maxStationarity = 0.0, maxFeasibility = 0.0, maxComplementarity = 0.0;
 	real_t avgStationarity = 0.0, avgFeasibility = 0.0, avgComplementarity = 0.0;
 
@@ -218,8 +220,8 @@ int main( int argc, char *argv[] )
 	}
 
 	/* 3) Run benchmark. */
-	printf("%10s %9s %9s %9s %6s  %-12s\n", "problem", "stat",
-			"feas", "compl", "nWSR", "result");
+	printf("%10s %9s %9s %9s %6s %9s  %-12s\n", "problem", "stat",
+			"feas", "compl", "nWSR", "avg. [ms]", "result");
 	for (i = 0; i < nproblems; i++)
 	{
 		if (scannedDir)
@@ -244,9 +246,11 @@ int main( int argc, char *argv[] )
 		maxCPUtime = 300.0;
 		nWSR = 2500;
 
-		returnvalue = runOQPbenchmark(	OQPproblem, isSparse, options,
-										nWSR, maxCPUtime, maxStationarity, maxFeasibility, maxComplementarity 
+		returnvalue = runOQPbenchmark(	OQPproblem, isSparse, BT_TRUE, options,
+										nWSR, maxNWSR, avgNWSR, maxCPUtime, avgCPUtime,
+										maxStationarity, maxFeasibility, maxComplementarity 
 										);
+		nWSR = (int)maxNWSR;
 		if (returnvalue	== SUCCESSFUL_RETURN
 				&& maxStationarity < TOL
 				&& maxFeasibility < TOL
@@ -257,6 +261,7 @@ int main( int argc, char *argv[] )
 			avgStationarity    += maxStationarity;
 			avgFeasibility     += maxFeasibility;
 			avgComplementarity += maxComplementarity;
+			sumCPUtime         += avgCPUtime;
 
 			strncpy(resstr, "pass", MAX_STRING_LENGTH);
 		}
@@ -268,8 +273,8 @@ int main( int argc, char *argv[] )
 			nfail++;
 			snprintf (resstr, MAX_STRING_LENGTH, "fail (%d)", returnvalue);
 		}
-		fprintf(stdFile, "%9.2e %9.2e %9.2e %6d  %-12s\n", maxStationarity,
-				maxFeasibility, maxComplementarity, nWSR, resstr);
+		fprintf(stdFile, "%9.2e %9.2e %9.2e %6d %9.3f  %-12s\n", maxStationarity,
+				maxFeasibility, maxComplementarity, nWSR, 1e3*avgCPUtime, resstr);
 
 		if (scannedDir) free(namelist[i]);
 	}
@@ -287,6 +292,7 @@ int main( int argc, char *argv[] )
 	printf( "Pass:  %3d\n",npass );
 	printf( "Fail:  %3d\n",nfail );
 	printf( "Ratio: %5.1f%%\n", 100.0 * (real_t)npass / (real_t)(npass+nfail) );
+	printf( "Time:  %.3f ms (sum of avg. time per QP of passed problems)\n", 1e3*sumCPUtime );
 	printf( "\n" );
 
 	QPOASES_TEST_FOR_TRUE( npass >= expectedNumSolvedProblems );
@@ -0,0 +1,258 @@
+/*
+ *	This file is part of qpOASES.
+ *
+ *	qpOASES -- An Implementation of the Online Active Set Strategy.
+ *	Copyright (C) 2007-2015 by Hans Joachim Ferreau, Andreas Potschka,
+ *	Christian Kirches et al. All rights reserved.
+ *
+ *	qpOASES is free software; you can redistribute it and/or
+ *	modify it under the terms of the GNU Lesser General Public
+ *	License as published by the Free Software Foundation; either
+ *	version 2.1 of the License, or (at your option) any later version.
+ *
+ *	qpOASES is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	See the GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with qpOASES; if not, write to the Free Software
+ *	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/**
+ *	\file testing/cpp/test_blockdiag.cpp
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ *
+ *	Unit test for the BlockDiagMatrix class: all products have to match the
+ *	ones of a DenseMatrix holding the same entries, and friction cone QPs with
+ *	a block diagonal constraint matrix have to give the dense solutions.
+ */
+
+
+
+#include <cstdlib>
+#include <qpOASES.hpp>
+#include <qpOASES/UnitTesting.hpp>
+
+#include "test_forceqp.hpp"
+
+
+USING_NAMESPACE_QPOASES
+
+
+/** Maximum absolute difference of two vectors. */
+real_t maxDiff( const real_t* const a, const real_t* const b, int n )
+{
+	real_t d = 0.0;
+	for (int i = 0; i < n; i++)
+		d = getMax( d, getAbs( a[i] - b[i] ) );
+	return d;
+}
+
+
+/** Compare all matrix operations with the ones of a DenseMatrix. */
+int compareWithDense( )
+{
+	const int nb = 8, br = 4, bc = 3, M = nb*br, N = nb*bc, K = 2;
+	int i, j, k;
+	real_t err = 0.0, errIndexed = 0.0;
+
+	real_t* blocks = new real_t[M*bc];
+	for (i = 0; i < M*bc; i++)
+		blocks[i] = 2.0 * rand() / RAND_MAX - 1.0;
+
+	BlockDiagMatrix A( nb,br,bc, blocks );
+	real_t* Av = A.full( );
+	DenseMatrix D( M,N,N, Av );
+
+	/* the dense constructor has to recover the blocks */
+	BlockDiagMatrix B( nb,br,bc, N,Av );
+	real_t* Bv = B.full( );
+	err = getMax( err, maxDiff( Av,Bv,M*N ) );
+	delete[] Bv;
+
+	real_t* x = new real_t[K*M];
+	real_t* yA = new real_t[K*M];
+	real_t* yD = new real_t[K*M];
+	for (i = 0; i < K*M; i++)
+		x[i] = 2.0 * rand() / RAND_MAX - 1.0;
+
+	/* full products */
+	for (i = 0; i < K*M; i++) yA[i] = yD[i] = 1.0;
+	A.times( K, 0.5, x,N, -2.0, yA,M );
+	D.times( K, 0.5, x,N, -2.0, yD,M );
+	err = getMax( err, maxDiff( yA,yD,K*M ) );
+
+	for (i = 0; i < K*M; i++) yA[i] = yD[i] = 1.0;
+	A.transTimes( K, -1.0, x,M, 0.0, yA,N );
+	D.transTimes( K, -1.0, x,M, 0.0, yD,N );
+	err = getMax( err, maxDiff( yA,yD,K*N ) );
+
+	/* unordered index lists, as working sets are */
+	Indexlist rows( M ), cols( N );
+	for (i = 0; i < M; i += 3)
+		rows.addNumber( ( 7*i+5 ) % M );
+	for (i = 0; i < N; i += 2)
+		cols.addNumber( ( 5*i+1 ) % N );
+
+	real_t alphas[] = { 1.0, -1.0, 0.7 };
+	for (k = 0; k < 3; k++)
+	{
+		for (i = 0; i < K*M; i++) yA[i] = yD[i] = 1.0;
+		A.times( &rows,&cols, K, alphas[k], x,N, 0.5, yA,M );
+		D.times( &rows,&cols, K, alphas[k], x,N, 0.5, yD,M );
+		errIndexed = getMax( errIndexed, maxDiff( yA,yD,K*M ) );
+
+		for (i = 0; i < K*M; i++) yA[i] = yD[i] = 1.0;
+		A.times( &rows,0, K, alphas[k], x,N, 1.0, yA,M );
+		D.times( &rows,0, K, alphas[k], x,N, 1.0, yD,M );
+		errIndexed = getMax( errIndexed, maxDiff( yA,yD,K*M ) );
+
+		for (i = 0; i < K*M; i++) yA[i] = yD[i] = 1.0;
+		A.times( &rows,&cols, K, alphas[k], x,N, 0.0, yA,M, BT_FALSE );
+		D.times( &rows,&cols, K, alphas[k], x,N, 0.0, yD,M, BT_FALSE );
+		errIndexed = getMax( errIndexed, maxDiff( yA,yD,K*M ) );
+
+		for (i = 0; i < K*M; i++) yA[i] = yD[i] = 1.0;
+		A.transTimes( &rows,&cols, K, alphas[k], x,M, -1.0, yA,N );
+		D.transTimes( &rows,&cols, K, alphas[k], x,M, -1.0, yD,N );
+		errIndexed = getMax( errIndexed, maxDiff( yA,yD,K*N ) );
+
+		for (j = 0; j < M; j++)
+		{
+			A.getRow( j,&cols, alphas[k], yA );
+			D.getRow( j,&cols, alphas[k], yD );
+			errIndexed = getMax( errIndexed, maxDiff( yA,yD,cols.getLength( ) ) );
+
+			A.getRow( j,0, alphas[k], yA );
+			D.getRow( j,0, alphas[k], yD );
+			errIndexed = getMax( errIndexed, maxDiff( yA,yD,N ) );
+
+			errIndexed = getMax( errIndexed, getAbs( A.getRowNorm( j ) - D.getRowNorm( j ) ) );
+		}
+
+		for (j = 0; j < N; j++)
+		{
+			A.getCol( j,&rows, alphas[k], yA );
+			D.getCol( j,&rows, alphas[k], yD );
+			errIndexed = getMax( errIndexed, maxDiff( yA,yD,rows.getLength( ) ) );
+
+			errIndexed = getMax( errIndexed, getAbs( A.diag( j ) - D.diag( j ) ) );
+		}
+	}
+
+	err = getMax( err, getAbs( A.getNorm( ) - D.getNorm( ) ) );
+
+	fprintf( stdFile, "Block diagonal vs. dense: full products %9.2e, indexed products and rows/columns %9.2e\n", err, errIndexed );
+
+	delete[] yD;
+	delete[] yA;
+	delete[] x;
+	D.free( );	/* Av */
+	delete[] blocks;
+
+	QPOASES_TEST_FOR_TOL( err,1e-14 );
+	QPOASES_TEST_FOR_TOL( errIndexed,0.0 );
+
+	return TEST_PASSED;
+}
+
+
+/** Solve friction cone QPs of 4 legs over nStep steps with dense and block diagonal constraints. */
+int compareQPs( int nStep )
+{
+	const int nHotstarts = 20;
+	int k;
+
+	ForceQP qp;
+	setupForceQP( qp,nStep );
+	int nV = qp.nV, nC = qp.nC;
+
+	/* the pyramid rows of each leg form a 4x3 block */
+	SymDenseMat Hmat( nV,nV,nV, &qp.H[0] );
+	BlockDiagMatrix Ablock( nC/4,4,3, nV,&qp.A[0] );
+	DenseMatrix Adense( nC,nV,nV, &qp.A[0] );
+
+	Options options;
+	options.setToMPC( );
+	options.printLevel = PL_NONE;
+
+	QProblem qpDense( nV,nC );
+	QProblem qpBlock( nV,nC );
+	qpDense.setOptions( options );
+	qpBlock.setOptions( options );
+
+	const real_t *g = 0, *lb = &qp.lb[0], *ub = &qp.ub[0], *lbA = &qp.lbA[0], *ubA = &qp.ubA[0];
+	real_t* xDense = new real_t[nV+nC];
+	real_t* xBlock = new real_t[nV+nC];
+	real_t err = 0.0;
+	double tDense = 0.0, tBlock = 0.0, tic;
+	int nWSRdense, nWSRblock, nMismatches = 0;
+
+	for (k = 0; k <= nHotstarts; k++)
+	{
+		setupForceGradient( nV,-100.0 - 10.0*k,200.0,qp.g );
+		g = &qp.g[0];
+
+		nWSRdense = nWSRblock = 200;
+
+		tic = getClockTime( );
+		if ( k == 0 )
+			qpDense.init( &Hmat,g,&Adense,lb,ub,lbA,ubA, nWSRdense );
+		else
+			qpDense.hotstart( g,lb,ub,lbA,ubA, nWSRdense );
+		tDense += getClockTime( ) - tic;
+
+		tic = getClockTime( );
+		if ( k == 0 )
+			qpBlock.init( &Hmat,g,&Ablock,lb,ub,lbA,ubA, nWSRblock );
+		else
+			qpBlock.hotstart( g,lb,ub,lbA,ubA, nWSRblock );
+		tBlock += getClockTime( ) - tic;
+
+		if ( nWSRdense != nWSRblock )
+			nMismatches++;
+
+		qpDense.getPrimalSolution( xDense );
+		qpBlock.getPrimalSolution( xBlock );
+		err = getMax( err, maxDiff( xDense,xBlock,nV ) );
+
+		qpDense.getDualSolution( xDense );
+		qpBlock.getDualSolution( xBlock );
+		err = getMax( err, maxDiff( xDense,xBlock,nV+nC ) );
+	}
+
+	fprintf( stdFile, "%2d steps (nV = %3d, nC = %3d): dense %8.3f ms, block diagonal %8.3f ms, deviation %9.2e, iteration mismatches %d\n",
+			nStep, nV, nC, 1e3*tDense, 1e3*tBlock, err, nMismatches );
+
+	delete[] xBlock;
+	delete[] xDense;
+
+	QPOASES_TEST_FOR_TRUE( nMismatches == 0 );
+	QPOASES_TEST_FOR_TOL( err,1e-9 );
+
+	return TEST_PASSED;
+}
+
+
+/** Run tests on BlockDiagMatrix. */
+int main( )
+{
+	if ( compareWithDense( ) != TEST_PASSED )
+		return TEST_FAILED;
+
+	if ( ( compareQPs( 1 ) != TEST_PASSED ) || ( compareQPs( 3 ) != TEST_PASSED ) || ( compareQPs( 10 ) != TEST_PASSED ) )
+		return TEST_FAILED;
+
+	return TEST_PASSED;
+}
+
+
+/*
+ *	end of file
+ */
@@ -0,0 +1,334 @@
+/*
+ *	This file is part of qpOASES.
+ *
+ *	qpOASES -- An Implementation of the Online Active Set Strategy.
+ *	Copyright (C) 2007-2015 by Hans Joachim Ferreau, Andreas Potschka,
+ *	Christian Kirches et al. All rights reserved.
+ *
+ *	qpOASES is free software; you can redistribute it and/or
+ *	modify it under the terms of the GNU Lesser General Public
+ *	License as published by the Free Software Foundation; either
+ *	version 2.1 of the License, or (at your option) any later version.
+ *
+ *	qpOASES is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	See the GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with qpOASES; if not, write to the Free Software
+ *	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/**
+ *	\file testing/cpp/test_cholesky.cpp
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ *
+ *	Unit test for the blocked Cholesky factorisation and triangular solves of
+ *	LAPACKReplacement, compared against the unblocked loops. Also reports the
+ *	speed-up on the Hessian sizes of the MPC of legged_robot_controller.
+ */
+
+
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include <qpOASES.hpp>
+#include <qpOASES/UnitTesting.hpp>
+
+
+USING_NAMESPACE_QPOASES
+
+
+/** Unblocked upper Cholesky factorisation, the previous dpotrf_. */
+int potrfReference( int n, double *a, int lda )
+{
+	double sum;
+	int i, j, k;
+
+	for( i=0; i<n; ++i )
+	{
+		sum = a[i + lda*i];
+
+		for( k=(i-1); k>=0; --k )
+			sum -= a[k+lda*i] * a[k+lda*i];
+
+		if ( sum > 0.0 )
+			a[i+lda*i] = getSqrt( sum );
+		else
+		{
+			a[0] = sum;
+			return i+1;
+		}
+
+		for( j=(i+1); j<n; ++j )
+		{
+			sum = a[j*lda + i];
+
+			for( k=(i-1); k>=0; --k )
+				sum -= a[k+lda*i] * a[k+lda*j];
+
+			a[i+lda*j] = sum / a[i+lda*i];
+		}
+	}
+
+	return 0;
+}
+
+/** Substitution with an upper triangular R, the previous QProblemB::backsolveR. */
+void trtrsReference( bool transposed, int n, const double *a, int lda, double *x )
+{
+	double sum;
+	int i, j;
+
+	if ( transposed == false )
+	{
+		for( i=(n-1); i>=0; --i )
+		{
+			sum = x[i];
+			for( j=(i+1); j<n; ++j )
+				sum -= a[i+lda*j] * x[j];
+			x[i] = sum / a[i+lda*i];
+		}
+	}
+	else
+	{
+		for( i=0; i<n; ++i )
+		{
+			sum = x[i];
+			for( j=0; j<i; ++j )
+				sum -= a[j+lda*i] * x[j];
+			x[i] = sum / a[i+lda*i];
+		}
+	}
+}
+
+/** Uniform random numbers in [-1,1]. */
+void fillRandom( double *x, int n )
+{
+	for (int i = 0; i < n; i++)
+		x[i] = 2.0 * rand() / RAND_MAX - 1.0;
+}
+
+/** Random symmetric positive definite matrix, diagonally dominant. */
+void fillSpd( int n, double *a, int lda )
+{
+	for (int j = 0; j < n; j++)
+	{
+		for (int i = 0; i < j; i++)
+			a[i+lda*j] = a[j+lda*i] = 2.0 * rand() / RAND_MAX - 1.0;
+		a[j+lda*j] = n + 1.0;
+	}
+}
+
+
+/** Compare dpotrf_ against the reference on sizes around the block size. */
+int potrfAgainstReference()
+{
+	const int sizes[] = { 1, 2, 3, 5, 8, 16, 31, 32, 33, 36, 48, 63, 64, 65, 72, 100, 120, 160, 240 };
+	const int nSizes = sizeof(sizes) / sizeof(int);
+
+	double err = 0.0, errSmall = 0.0;
+	int nInfoMismatches = 0;
+	int nCases = 0;
+
+	for (int s = 0; s < nSizes; s++)
+		for (int c = 0; c < 3; c++)
+		{
+			/* c = 0: spd, c = 1: padded, c = 2: indefinite */
+			int n = sizes[s], lda = n + ( c == 1 ? 3 : 0 );
+			std::vector<double> A( (size_t)(lda*n) );
+
+			fillRandom( &A[0],lda*n );
+			fillSpd( n,&A[0],lda );
+			if ( c == 2 )
+				A[(size_t)((n/2)+lda*(n/2))] = -1.0;
+			std::vector<double> Rref( A );
+
+			la_uint_t _n = (la_uint_t)n, _lda = (la_uint_t)lda;
+			la_int_t info = 0;
+			dpotrf_( "U",&_n,&A[0],&_lda,&info );
+			int infoRef = potrfReference( n,&Rref[0],lda );
+
+			if ( (int)info != infoRef )
+				nInfoMismatches++;
+
+			/* factor (relative to its diagonal) or the tunneled pivot, lower triangle must not be touched */
+			double e = 0.0;
+			for (int j = 0; j < n; j++)
+				for (int i = 0; i < lda; i++)
+				{
+					size_t ij = (size_t)(i+lda*j);
+					if ( info == 0 && i <= j )
+						e = std::max( e, getAbs( A[ij] - Rref[ij] ) / getSqrt( n+1.0 ) );
+					else if ( i > j && getAbs( A[ij] - Rref[ij] ) > 0.0 )
+						e = 1.0;
+				}
+			if ( info != 0 )
+				e = std::max( e, getAbs( A[0] - Rref[0] ) / ( n+1.0 ) );
+
+			if ( n <= 32 )
+				errSmall = std::max( errSmall, e );
+			err = std::max( err, e );
+			nCases++;
+		}
+
+	fprintf(stdFile, "POTRF; Max. relative error in %d cases: %9.2e, up to 32 columns: %9.2e, info mismatches: %d\n",
+			nCases, err, errSmall, nInfoMismatches);
+
+	QPOASES_TEST_FOR_TRUE( nInfoMismatches == 0 );
+	QPOASES_TEST_FOR_TRUE( errSmall <= 0.0 );
+	QPOASES_TEST_FOR_TOL( err,1e-14 );
+
+	return TEST_PASSED;
+}
+
+
+/** Compare dtrtrs_ against the reference for R*X = B and R'*X = B. */
+int trtrsAgainstReference()
+{
+	const int sizes[] = { 1, 2, 3, 5, 8, 16, 31, 32, 33, 36, 48, 63, 64, 65, 72, 100, 120, 160, 240 };
+	const int nSizes = sizeof(sizes) / sizeof(int);
+	const int rhs[] = { 1, 3, 9 };
+	const int nRhs = sizeof(rhs) / sizeof(int);
+
+	double err = 0.0, errSmall = 0.0;
+	int nCases = 0;
+
+	for (int s = 0; s < nSizes; s++)
+		for (int r = 0; r < nRhs; r++)
+			for (int t = 0; t < 2; t++)
+			{
+				int n = sizes[s], nrhs = rhs[r];
+				int lda = n + nCases % 3, ldb = n + nCases % 2;
+				std::vector<double> A( (size_t)(lda*n) ), B( (size_t)(ldb*nrhs) );
+
+				fillSpd( n,&A[0],lda );
+				potrfReference( n,&A[0],lda );
+				fillRandom( &B[0],ldb*nrhs );
+				std::vector<double> X( B );
+
+				la_uint_t _n = (la_uint_t)n, _nrhs = (la_uint_t)nrhs, _lda = (la_uint_t)lda, _ldb = (la_uint_t)ldb;
+				la_int_t info = 0;
+				dtrtrs_( "U",( t == 0 ) ? "N" : "T","N",&_n,&_nrhs,&A[0],&_lda,&X[0],&_ldb,&info );
+				for (int c = 0; c < nrhs; c++)
+					trtrsReference( t == 1,n,&A[0],lda,&B[(size_t)(ldb*c)] );
+
+				/* padding of B must not be touched */
+				double e = ( info == 0 ) ? 0.0 : 1.0;
+				for (size_t i = 0; i < B.size( ); i++)
+					e = std::max( e, getAbs( X[i] - B[i] ) );
+
+				if ( n <= 32 )
+					errSmall = std::max( errSmall, e );
+				err = std::max( err, e );
+				nCases++;
+			}
+
+	/* zero on the diagonal */
+	double A[9] = { 1.0, 0.0, 0.0, 2.0, 0.0, 0.0, 3.0, 4.0, 5.0 };
+	double b[3] = { 1.0, 1.0, 1.0 };
+	la_uint_t _n = 3, _nrhs = 1;
+	la_int_t info = 0;
+	dtrtrs_( "U","N","N",&_n,&_nrhs,A,&_n,b,&_n,&info );
+
+	fprintf(stdFile, "TRTRS; Max. error in %d cases: %9.2e, up to 32 columns: %9.2e, info on singular R: %d\n",
+			nCases, err, errSmall, (int)info);
+
+	QPOASES_TEST_FOR_TRUE( info == 2 );
+	QPOASES_TEST_FOR_TRUE( errSmall <= 0.0 );
+	QPOASES_TEST_FOR_TOL( err,1e-14 );
+
+	return TEST_PASSED;
+}
+
+
+/** Time dpotrf_ and dtrtrs_ against the reference over the Hessian sizes of the MPC. */
+int choleskySpeed()
+{
+	/* 12 forces per step, horizon 1, 3, 6, 10, 13, 20 */
+	const int sizes[] = { 12, 36, 72, 120, 160, 240 };
+	const int nSizes = sizeof(sizes) / sizeof(int);
+
+	for (int s = 0; s < nSizes; s++)
+	{
+		int n = sizes[s];
+		int nRuns = std::max( 20, 20000000 / (n*n*n) );
+		std::vector<double> H( (size_t)(n*n) ), A( (size_t)(n*n) ), b( (size_t)n ), x( (size_t)n );
+
+		fillSpd( n,&H[0],n );
+		fillRandom( &b[0],n );
+
+		la_uint_t _n = (la_uint_t)n, _nrhs = 1;
+		la_int_t info = 0;
+
+		double tic = getClockTime();
+		for (int r = 0; r < nRuns; r++)
+		{
+			A = H;
+			dpotrf_( "U",&_n,&A[0],&_n,&info );
+		}
+		double tBlocked = getClockTime() - tic;
+
+		tic = getClockTime();
+		for (int r = 0; r < nRuns; r++)
+		{
+			A = H;
+			potrfReference( n,&A[0],n );
+		}
+		double tReference = getClockTime() - tic;
+
+		fprintf(stdFile, "POTRF   %3d: %9.3f us, reference %9.3f us, speed-up %5.2f\n",
+				n, 1e6*tBlocked/nRuns, 1e6*tReference/nRuns, tReference/tBlocked);
+
+		/* solves with the factor, 10 times as many runs */
+		for (int t = 0; t < 2; t++)
+		{
+			const char *trans = ( t == 0 ) ? "N" : "T";
+
+			tic = getClockTime();
+			for (int r = 0; r < 10*nRuns; r++)
+			{
+				x = b;
+				dtrtrs_( "U",trans,"N",&_n,&_nrhs,&A[0],&_n,&x[0],&_n,&info );
+			}
+			tBlocked = getClockTime() - tic;
+
+			tic = getClockTime();
+			for (int r = 0; r < 10*nRuns; r++)
+			{
+				x = b;
+				trtrsReference( t == 1,n,&A[0],n,&x[0] );
+			}
+			tReference = getClockTime() - tic;
+
+			fprintf(stdFile, "TRTRS %s %3d: %9.3f us, reference %9.3f us, speed-up %5.2f\n",
+					trans, n, 1e5*tBlocked/nRuns, 1e5*tReference/nRuns, tReference/tBlocked);
+		}
+	}
+
+	return TEST_PASSED;
+}
+
+
+/** Run tests on the Cholesky factorisation and triangular solves. */
+int main()
+{
+	int errorCount = TEST_PASSED;
+
+	errorCount += potrfAgainstReference();
+	errorCount += trtrsAgainstReference();
+	errorCount += choleskySpeed();
+
+	return errorCount;
+}
+
+
+/*
+ *	end of file
+ */
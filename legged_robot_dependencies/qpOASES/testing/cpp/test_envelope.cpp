@@ -0,0 +1,278 @@
+/*
+ *	This file is part of qpOASES.
+ *
+ *	qpOASES -- An Implementation of the Online Active Set Strategy.
+ *	Copyright (C) 2007-2015 by Hans Joachim Ferreau, Andreas Potschka,
+ *	Christian Kirches et al. All rights reserved.
+ *
+ *	qpOASES is free software; you can redistribute it and/or
+ *	modify it under the terms of the GNU Lesser General Public
+ *	License as published by the Free Software Foundation; either
+ *	version 2.1 of the License, or (at your option) any later version.
+ *
+ *	qpOASES is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	See the GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with qpOASES; if not, write to the Free Software
+ *	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/**
+ *	\file testing/cpp/test_envelope.cpp
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ *
+ *	Unit test and benchmark for the envelope Cholesky factorisation: it has to
+ *	give the same factors as POTRF, and long horizon force QPs with block banded
+ *	Hessians have to give the same solutions with dense and sparse Hessians.
+ *	Prints the timings over the horizon and the crossover of both.
+ */
+
+
+
+#include <cstdlib>
+#include <vector>
+#include <qpOASES.hpp>
+#include <qpOASES/UnitTesting.hpp>
+
+
+USING_NAMESPACE_QPOASES
+
+
+/** Number of legs, horizons and ticks per horizon. */
+const int nLegs = 4;
+const int horizons[] = { 1, 2, 4, 8, 16, 24, 32, 48 };
+const int nHorizons = sizeof(horizons) / sizeof(int);
+const int nTicks = 20;
+
+
+/** Hessian of the forces of nStep steps (row-major, dense): tracking cost with a
+ *  penalty on the change of the forces between steps, which couples neighbouring
+ *  steps only (block tridiagonal). */
+void setupHessian( int nStep, real_t alpha, std::vector<real_t>& H )
+{
+	size_t nU = 3*nLegs, nV = nU*(size_t)nStep;
+	size_t i, j;
+
+	H.assign( nV*nV, 0.0 );
+
+	for (i = 0; i < nV; i++)
+	{
+		/* legs of one step see each other through the body dynamics */
+		size_t s = i / nU;
+		for (j = s*nU; j < (s+1)*nU; j++)
+			H[i*nV+j] = ( i == j ) ? 2.0 + alpha : 0.1 * alpha / ( 1.0 + getAbs( (real_t)i - (real_t)j ) );
+
+		/* rate penalty */
+		if ( s > 0 )
+		{
+			H[i*nV+i] += 1.0;
+			H[i*nV+i-nU] = H[(i-nU)*nV+i] = -0.5;
+		}
+	}
+}
+
+
+/** Compare POTRFenvelope with POTRF on banded, dense and indefinite matrices. */
+int compareFactors( )
+{
+	const size_t n = 60;
+	size_t i, j;
+	int k;
+	real_t err = 0.0;
+	int nInfoMismatches = 0;
+
+	std::vector<real_t> A( n*n ), Rdense( n*n ), Renv( n*n );
+	std::vector<int> first( n );
+
+	for (k = 0; k < 4; k++)
+	{
+		int bandwidth = ( k == 0 ) ? 3 : ( ( k == 1 ) ? 10 : (int)n );
+
+		for (i = 0; i < n; i++)
+			for (j = 0; j < n; j++)
+				A[i+n*j] = ( getAbs( (real_t)i - (real_t)j ) <= bandwidth ) ? 0.5 * rand() / RAND_MAX : 0.0;
+		for (i = 0; i < n; i++)
+		{
+			for (j = 0; j < i; j++)
+				A[i+n*j] = A[j+n*i];
+			A[i+n*i] = ( k == 3 && i == n/2 ) ? -1.0 : 2.0*bandwidth;
+		}
+
+		Rdense = A;
+		Renv = A;
+
+		la_int_t infoDense = 0;
+		la_uint_t _n = (la_uint_t)n;
+		POTRF( "U", &_n, &Rdense[0], &_n, &infoDense );
+
+		real_t ratio = getEnvelope( (int)n,&Renv[0],(int)n,&first[0] );
+		la_int_t infoEnv = POTRFenvelope( (int)n,&Renv[0],(int)n,&first[0] );
+
+		if ( infoDense != infoEnv )
+			nInfoMismatches++;
+
+		if ( infoDense == 0 )
+			for (j = 0; j < n; j++)
+				for (i = 0; i <= j; i++)
+					err = getMax( err, getAbs( Rdense[i+n*j] - Renv[i+n*j] ) );
+		else
+			err = getMax( err, getAbs( Rdense[0] - Renv[0] ) );
+
+		fprintf( stdFile, "bandwidth %2d: envelope flops %5.1f%%, info %d/%d\n", bandwidth, 100.0*ratio, (int)infoDense, (int)infoEnv );
+	}
+
+	fprintf( stdFile, "Envelope vs. dense factors: %9.2e\n", err );
+
+	QPOASES_TEST_FOR_TRUE( nInfoMismatches == 0 );
+	QPOASES_TEST_FOR_TOL( err,1e-12 );
+
+	return TEST_PASSED;
+}
+
+
+/** Solve force QPs over a horizon of nStep steps with a dense and a sparse Hessian. */
+int compareQPs( int nStep, double& tDense, double& tSparse, double& tPotrf, double& tEnvelope )
+{
+	int nV = 3*nLegs*nStep;
+	size_t n = (size_t)nV;
+	size_t i, j, nnz;
+	int k;
+
+	std::vector<real_t> H, g( n ), lb( n ), ub( n ), xDense( n ), xSparse( n );
+
+	for (i = 0; i < n; i++)
+	{
+		lb[i] = ( i%3 == 2 ) ? 10.0 : -100.0;
+		ub[i] = ( i%3 == 2 ) ? 150.0 : 100.0;
+	}
+
+	/* CSC structure of the Hessian, set up once and reused for all ticks */
+	setupHessian( nStep,1.0,H );
+	std::vector<sparse_int_t> ir, jc( n+1 );
+	for (j = 0; j < n; j++)
+	{
+		jc[j] = (sparse_int_t)ir.size( );
+		for (i = 0; i < n; i++)
+			if ( ( H[i*n+j] < 0.0 ) || ( H[i*n+j] > 0.0 ) )
+				ir.push_back( (sparse_int_t)i );
+	}
+	jc[n] = (sparse_int_t)ir.size( );
+	std::vector<real_t> val( ir.size( ) );
+
+	SymSparseMat Hsparse( nV,nV,&ir[0],&jc[0],&val[0] );
+	Hsparse.createDiagInfo( );
+
+	Options options;
+	options.setToMPC( );
+	options.printLevel = PL_NONE;
+
+	real_t err = 0.0;
+	double tic;
+	int nMismatches = 0;
+	tDense = tSparse = tPotrf = tEnvelope = 0.0;
+
+	for (k = 0; k < nTicks; k++)
+	{
+		/* new values, same structure */
+		setupHessian( nStep,1.0 + 0.1*k,H );
+		for (j = 0, nnz = 0; j < n; j++)
+			for (i = (size_t)jc[j]; i < (size_t)jc[j+1]; i++)
+				val[nnz++] = H[(size_t)ir[i]*n+j];
+
+		for (i = 0; i < n; i++)
+			g[i] = ( i%3 == 2 ) ? -100.0 - 10.0*k : 100.0 * ( 2.0 * rand() / RAND_MAX - 1.0 );
+
+		/* one QP per tick, as done by the MPC */
+		int nWSRdense = 1000, nWSRsparse = 1000;
+
+		tic = getClockTime( );
+		SymDenseMat Hdense( nV,nV,nV,&H[0] );
+		QProblemB qpDense( nV );
+		qpDense.setOptions( options );
+		qpDense.init( &Hdense,&g[0],&lb[0],&ub[0], nWSRdense );
+		tDense += getClockTime( ) - tic;
+
+		tic = getClockTime( );
+		QProblemB qpSparse( nV );
+		qpSparse.setOptions( options );
+		qpSparse.init( &Hsparse,&g[0],&lb[0],&ub[0], nWSRsparse );
+		tSparse += getClockTime( ) - tic;
+
+		if ( nWSRdense != nWSRsparse )
+			nMismatches++;
+
+		qpDense.getPrimalSolution( &xDense[0] );
+		qpSparse.getPrimalSolution( &xSparse[0] );
+		for (i = 0; i < n; i++)
+			err = getMax( err, getAbs( xDense[i] - xSparse[i] ) );
+
+		/* factorisation of the full Hessian alone */
+		std::vector<real_t> R( H ), Renv( H );
+		std::vector<int> first( n );
+		la_int_t info = 0;
+		la_uint_t _nV = (la_uint_t)n;
+
+		tic = getClockTime( );
+		POTRF( "U", &_nV, &R[0], &_nV, &info );
+		tPotrf += getClockTime( ) - tic;
+
+		tic = getClockTime( );
+		getEnvelope( (int)nV,&Renv[0],(int)nV,&first[0] );
+		POTRFenvelope( (int)nV,&Renv[0],(int)nV,&first[0] );
+		tEnvelope += getClockTime( ) - tic;
+	}
+
+	fprintf( stdFile, "%2d steps (nV = %3d, nnz = %5d): dense %9.3f ms, sparse %9.3f ms, POTRF %9.3f ms, envelope %9.3f ms, deviation %9.2e\n",
+			nStep, nV, (int)ir.size( ), 1e3*tDense/nTicks, 1e3*tSparse/nTicks, 1e3*tPotrf/nTicks, 1e3*tEnvelope/nTicks, err );
+
+	QPOASES_TEST_FOR_TRUE( nMismatches == 0 );
+	QPOASES_TEST_FOR_TOL( err,1e-9 );
+
+	return TEST_PASSED;
+}
+
+
+/** Run tests and benchmark of the envelope factorisation. */
+int main( )
+{
+	if ( compareFactors( ) != TEST_PASSED )
+		return TEST_FAILED;
+
+	int crossoverQP = -1, crossoverFactor = -1;
+
+	for (int h = 0; h < nHorizons; h++)
+	{
+		double tDense, tSparse, tPotrf, tEnvelope;
+
+		if ( compareQPs( horizons[h],tDense,tSparse,tPotrf,tEnvelope ) != TEST_PASSED )
+			return TEST_FAILED;
+
+		/* shortest horizon from which on the sparse variant stays faster */
+		if ( tSparse >= tDense )
+			crossoverQP = -1;
+		else if ( crossoverQP < 0 )
+			crossoverQP = horizons[h];
+
+		if ( tEnvelope >= tPotrf )
+			crossoverFactor = -1;
+		else if ( crossoverFactor < 0 )
+			crossoverFactor = horizons[h];
+	}
+
+	fprintf( stdFile, "Sparse Hessian faster from %d steps on, envelope factorisation faster from %d steps on\n",
+			crossoverQP, crossoverFactor );
+
+	return TEST_PASSED;
+}
+
+
+/*
+ *	end of file
+ */
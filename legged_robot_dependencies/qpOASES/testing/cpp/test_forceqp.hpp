@@ -0,0 +1,115 @@
+/*
+ *	This file is part of qpOASES.
+ *
+ *	qpOASES -- An Implementation of the Online Active Set Strategy.
+ *	Copyright (C) 2007-2015 by Hans Joachim Ferreau, Andreas Potschka,
+ *	Christian Kirches et al. All rights reserved.
+ *
+ *	qpOASES is free software; you can redistribute it and/or
+ *	modify it under the terms of the GNU Lesser General Public
+ *	License as published by the Free Software Foundation; either
+ *	version 2.1 of the License, or (at your option) any later version.
+ *
+ *	qpOASES is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	See the GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with qpOASES; if not, write to the Free Software
+ *	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/**
+ *	\file testing/cpp/test_forceqp.hpp
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ *
+ *	Contact force QP of the legged robot MPC, shared by the unit tests:
+ *	4 legs over nStep steps, force tracking cost coupling all forces,
+ *	friction pyramids and bounds on the normal forces.
+ */
+
+
+#ifndef QPOASES_TEST_FORCEQP_HPP
+#define QPOASES_TEST_FORCEQP_HPP
+
+
+#include <cstdlib>
+#include <vector>
+#include <qpOASES.hpp>
+
+
+USING_NAMESPACE_QPOASES
+
+
+/** Force QP of 4 legs over nStep steps, forces (f_x,f_y,f_z) of one leg after the other. */
+struct ForceQP
+{
+	int nV;									/**< Number of variables, 12*nStep. */
+	int nC;									/**< Number of constraints, 16*nStep. */
+	std::vector<real_t> H, A, lb, ub, lbA, ubA;
+	std::vector<real_t> g;					/**< Gradient, see setupForceGradient( ). */
+};
+
+
+/** Friction coefficient of the pyramids. */
+const real_t forceQPmu = 0.6;
+
+
+/** Sets a gradient with entry fz for the normal forces and random entries
+ *  within [-fxy,fxy] for the tangential ones. */
+void setupForceGradient( int nV, real_t fz, real_t fxy, std::vector<real_t>& g )
+{
+	g.resize( (size_t)nV );
+	for (size_t i = 0; i < g.size( ); i++)
+		g[i] = ( i%3 == 2 ) ? fz : fxy * ( 2.0 * (real_t)rand( ) / (real_t)RAND_MAX - 1.0 );
+}
+
+
+/** Sets up Hessian, friction pyramids |f_x|, |f_y| <= mu f_z (row-major) and
+ *  bounds 0 <= f_z <= 150 of a force QP over nStep steps, and a gradient. */
+void setupForceQP( ForceQP& qp, int nStep )
+{
+	size_t nV = 12*(size_t)nStep, nC = 16*(size_t)nStep;
+	size_t i, j;
+
+	qp.nV = (int)nV;
+	qp.nC = (int)nC;
+
+	qp.H.resize( nV*nV );
+	for (i = 0; i < nV; i++)
+		for (j = 0; j < nV; j++)
+			qp.H[i*nV+j] = ( i == j ) ? 2.0 : 0.1 / ( 1.0 + getAbs( (real_t)i - (real_t)j ) );
+
+	qp.lb.resize( nV );
+	qp.ub.resize( nV );
+	for (i = 0; i < nV; i++)
+	{
+		qp.lb[i] = ( i%3 == 2 ) ? 0.0 : -INFTY;
+		qp.ub[i] = ( i%3 == 2 ) ? 150.0 : INFTY;
+	}
+
+	qp.A.assign( nC*nV, 0.0 );
+	qp.lbA.assign( nC, -INFTY );
+	qp.ubA.assign( nC, 0.0 );
+	for (i = 0; i < nC; i++)
+	{
+		size_t f = 3 * (i/4);
+		qp.A[i*nV + f + (i%4)/2] = ( i%2 == 0 ) ? 1.0 : -1.0;
+		qp.A[i*nV + f + 2] = -forceQPmu;
+	}
+
+	setupForceGradient( qp.nV,-60.0,20.0,qp.g );
+}
+
+
+#endif	/* QPOASES_TEST_FORCEQP_HPP */
+
+
+/*
+ *	end of file
+ */
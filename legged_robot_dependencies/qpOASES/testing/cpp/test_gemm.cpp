@@ -0,0 +1,215 @@
+/*
+ *	This file is part of qpOASES.
+ *
+ *	qpOASES -- An Implementation of the Online Active Set Strategy.
+ *	Copyright (C) 2007-2015 by Hans Joachim Ferreau, Andreas Potschka,
+ *	Christian Kirches et al. All rights reserved.
+ *
+ *	qpOASES is free software; you can redistribute it and/or
+ *	modify it under the terms of the GNU Lesser General Public
+ *	License as published by the Free Software Foundation; either
+ *	version 2.1 of the License, or (at your option) any later version.
+ *
+ *	qpOASES is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	See the GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with qpOASES; if not, write to the Free Software
+ *	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/**
+ *	\file testing/cpp/test_gemm.cpp
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ *
+ *	Unit test for the blocked GEMM of BLASReplacement, compared against
+ *	the plain triple loop. Also reports the speed-up on the matrix sizes
+ *	of the MPC of legged_robot_controller.
+ */
+
+
+
+#include <algorithm>
+#include <cstdlib>
+#include <qpOASES.hpp>
+#include <qpOASES/UnitTesting.hpp>
+
+
+USING_NAMESPACE_QPOASES
+
+
+/** Plain triple loop, C = alpha * op(A) * B + beta * C, column major. */
+void gemmReference(	char transA, la_uint_t M, la_uint_t N, la_uint_t K,
+					double alpha, const double *A, la_uint_t LDA, const double *B, la_uint_t LDB,
+					double beta, double *C, la_uint_t LDC )
+{
+	la_uint_t i, j, k;
+
+	for (k = 0; k < N; k++)
+		for (j = 0; j < M; j++)
+		{
+			double sum = 0.0;
+			for (i = 0; i < K; i++)
+				sum += ( transA == 'N' ? A[j+LDA*i] : A[i+LDA*j] ) * B[i+LDB*k];
+			C[j+LDC*k] = alpha*sum + beta*C[j+LDC*k];
+		}
+}
+
+/** Uniform random numbers in [-1,1]. */
+void fillRandom( double *x, la_uint_t n )
+{
+	for (la_uint_t i = 0; i < n; i++)
+		x[i] = 2.0 * rand() / RAND_MAX - 1.0;
+}
+
+/** Relative max. deviation of dgemm_ from the reference for one case. */
+double gemmError(	char transA, la_uint_t M, la_uint_t N, la_uint_t K, double alpha, double beta, la_uint_t pad )
+{
+	la_uint_t _M = M, _N = N, _K = K;
+	la_uint_t _LDA = ( transA == 'N' ? M : K ) + pad;
+	la_uint_t _LDB = K + pad;
+	la_uint_t _LDC = M + pad;
+	la_uint_t nColA = ( transA == 'N' ? K : M );
+
+	double *A = new double[_LDA*nColA + 1];
+	double *B = new double[_LDB*N + 1];
+	double *C = new double[_LDC*N + 1];
+	double *Cref = new double[_LDC*N + 1];
+
+	fillRandom(A, _LDA*nColA + 1);
+	fillRandom(B, _LDB*N + 1);
+	fillRandom(C, _LDC*N + 1);
+	for (la_uint_t i = 0; i < _LDC*N + 1; i++)
+		Cref[i] = C[i];
+
+	const char *trans = ( transA == 'N' ? "NOTRANS" : "TRANS" );
+	dgemm_(trans, "NOTRANS", &_M, &_N, &_K, &alpha, A, &_LDA, B, &_LDB, &beta, C, &_LDC);
+	gemmReference(transA, M, N, K, alpha, A, _LDA, B, _LDB, beta, Cref, _LDC);
+
+	/* padding of C must not be touched */
+	double err = 0.0;
+	for (la_uint_t k = 0; k < _N; k++)
+		for (la_uint_t j = 0; j < _LDC; j++)
+		{
+			double e = getAbs(C[j+_LDC*k] - Cref[j+_LDC*k]);
+			if ( j < _M )
+				e /= std::max( 1.0, (double)K );
+			else if ( e > 0.0 )
+				e = 1.0;
+			err = std::max( err, e );
+		}
+	if ( getAbs(C[_LDC*N] - Cref[_LDC*N]) > 0.0 )
+		err = 1.0;
+
+	delete[] Cref;
+	delete[] C;
+	delete[] B;
+	delete[] A;
+
+	return err;
+}
+
+
+/** Compare dgemm_ against the reference on sizes around the tile sizes. */
+int gemmAgainstReference()
+{
+	const la_uint_t sizes[] = { 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 36, 48, 120, 160, 300 };
+	const int nSizes = sizeof(sizes) / sizeof(la_uint_t);
+	const la_uint_t cols[] = { 1, 2, 3, 4, 5, 9 };
+	const int nCols = sizeof(cols) / sizeof(la_uint_t);
+	const double alphas[] = { 1.0, -1.0, 0.5 };
+	const double betas[] = { 0.0, 1.0, -1.0, 2.0 };
+
+	double err = 0.0;
+	int nCases = 0;
+
+	for (int t = 0; t < 2; t++)
+		for (int m = 0; m < nSizes; m++)
+			for (int k = 0; k < nSizes; k++)
+				for (int n = 0; n < nCols; n++)
+				{
+					/* vary scaling and padding over the cases */
+					double alpha = alphas[nCases % 3];
+					double beta = betas[nCases % 4];
+					la_uint_t pad = (la_uint_t)( nCases % 3 );
+
+					err = std::max( err, gemmError( t == 0 ? 'N' : 'T', sizes[m], cols[n], sizes[k], alpha, beta, pad ) );
+					nCases++;
+				}
+
+	fprintf(stdFile, "GEMM; Max. relative error in %d cases: %9.2e\n", nCases, err);
+
+	QPOASES_TEST_FOR_TOL( err,1e-14 )
+
+	return TEST_PASSED;
+}
+
+
+/** Time dgemm_ against the reference, matrix vector products of the condensed MPC. */
+int gemmSpeed()
+{
+	/* rows, columns of the constraint matrix (4 legs, horizon 3, 6, 10) and the Hessian */
+	const la_uint_t M[] = { 48, 96, 160, 36, 120 };
+	const la_uint_t K[] = { 36, 72, 120, 36, 120 };
+	const int nSizes = sizeof(M) / sizeof(la_uint_t);
+	const int nRuns = 20000;
+
+	for (int s = 0; s < nSizes; s++)
+		for (int t = 0; t < 2; t++)
+		{
+			char transA = ( t == 0 ? 'N' : 'T' );
+			la_uint_t _M = M[s], _N = 1, _K = K[s];
+			la_uint_t _LDA = ( transA == 'N' ? _M : _K ), _LDB = _K, _LDC = _M;
+			double alpha = 1.0, beta = 1.0;
+
+			double *A = new double[_M*_K];
+			double *B = new double[_K];
+			double *C = new double[_M];
+			fillRandom(A, _M*_K);
+			fillRandom(B, _K);
+			fillRandom(C, _M);
+
+			const char *trans = ( transA == 'N' ? "NOTRANS" : "TRANS" );
+			double tic = getClockTime();
+			for (int r = 0; r < nRuns; r++)
+				dgemm_(trans, "NOTRANS", &_M, &_N, &_K, &alpha, A, &_LDA, B, &_LDB, &beta, C, &_LDC);
+			double tBlocked = getClockTime() - tic;
+
+			tic = getClockTime();
+			for (int r = 0; r < nRuns; r++)
+				gemmReference(transA, _M, _N, _K, alpha, A, _LDA, B, _LDB, beta, C, _LDC);
+			double tReference = getClockTime() - tic;
+
+			fprintf(stdFile, "GEMM %c %3d x %3d: %7.3f us, reference %7.3f us, speed-up %5.2f\n",
+					transA, (int)M[s], (int)K[s], 1e6*tBlocked/nRuns, 1e6*tReference/nRuns, tReference/tBlocked);
+
+			delete[] C;
+			delete[] B;
+			delete[] A;
+		}
+
+	return TEST_PASSED;
+}
+
+
+/** Run tests on GEMM. */
+int main()
+{
+	int errorCount = TEST_PASSED;
+
+	errorCount += gemmAgainstReference();
+	errorCount += gemmSpeed();
+
+	return errorCount;
+}
+
+
+/*
+ *	end of file
+ */
@@ -0,0 +1,232 @@
+/*
+ *	This file is part of qpOASES.
+ *
+ *	qpOASES -- An Implementation of the Online Active Set Strategy.
+ *	Copyright (C) 2007-2015 by Hans Joachim Ferreau, Andreas Potschka,
+ *	Christian Kirches et al. All rights reserved.
+ *
+ *	qpOASES is free software; you can redistribute it and/or
+ *	modify it under the terms of the GNU Lesser General Public
+ *	License as published by the Free Software Foundation; either
+ *	version 2.1 of the License, or (at your option) any later version.
+ *
+ *	qpOASES is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	See the GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with qpOASES; if not, write to the Free Software
+ *	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/**
+ *	\file testing/cpp/test_indexmask.cpp
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ *
+ *	Unit test for the bit masks of Indexlist: random active set changes on lists
+ *	with a mask are compared against lists using bisection (physical length above
+ *	INDEXLIST_MASK_LENGTH). Also reports the cost of an active set change.
+ */
+
+
+
+#include <cstdlib>
+#include <vector>
+#include <qpOASES.hpp>
+#include <qpOASES/UnitTesting.hpp>
+
+
+USING_NAMESPACE_QPOASES
+
+
+/** Physical length of the lists using bisection. */
+const int nBisection = INDEXLIST_MASK_LENGTH + 1;
+
+
+/** Number of differences in numbers, order, sorting and lookups of two lists holding numbers 0..n-1. */
+int compareLists( const Indexlist& a, const Indexlist& b, int n )
+{
+	int i, *numberA, *numberB, *iSortA, *iSortB;
+	int nDiff = 0;
+
+	if ( a.getLength( ) != b.getLength( ) )
+		return 1;
+
+	a.getNumberArray( &numberA );
+	b.getNumberArray( &numberB );
+	a.getISortArray( &iSortA );
+	b.getISortArray( &iSortB );
+
+	for (i = 0; i < a.getLength( ); i++)
+		if ( ( numberA[i] != numberB[i] ) || ( iSortA[i] != iSortB[i] ) )
+			nDiff++;
+
+	for (i = -1; i <= n; i++)
+		if ( ( a.getIndex( i ) != b.getIndex( i ) ) || ( a.isMember( i ) != b.isMember( i ) ) )
+			nDiff++;
+
+	return nDiff;
+}
+
+
+/** Random adds, removes and swaps on lists with and without mask. */
+int maskAgainstBisection( )
+{
+	const int sizes[] = { 1, 7, 12, 24, 48, 64 };
+	const int nSizes = sizeof(sizes) / sizeof(int);
+	const int nOps = 20000;
+
+	int nDiff = 0;
+
+	for (int s = 0; s < nSizes; s++)
+	{
+		int n = sizes[s];
+		if ( n > INDEXLIST_MASK_LENGTH )
+			continue;
+
+		Indexlist withMask( n ), withBisection( nBisection );
+
+		for (int k = 0; k < nOps; k++)
+		{
+			int i = rand( ) % n;
+			int j = rand( ) % n;
+
+			if ( withBisection.isMember( i ) == BT_FALSE )
+			{
+				withMask.addNumber( i );
+				withBisection.addNumber( i );
+			}
+			else if ( ( rand( ) % 4 == 0 ) && ( i != j ) && ( withBisection.isMember( j ) == BT_TRUE ) )
+			{
+				withMask.swapNumbers( i,j );
+				withBisection.swapNumbers( i,j );
+			}
+			else
+			{
+				withMask.removeNumber( i );
+				withBisection.removeNumber( i );
+			}
+
+			nDiff += compareLists( withMask,withBisection,n );
+
+			/* copies keep the mask */
+			if ( k % 1000 == 0 )
+			{
+				Indexlist copy( withMask );
+				nDiff += compareLists( copy,withBisection,n );
+			}
+		}
+	}
+
+	/* number outside of the mask */
+	Indexlist withMask( 4 ), withBisection( nBisection );
+	int numbers[] = { 2, 100, 0 };
+	for (int k = 0; k < 3; k++)
+	{
+		withMask.addNumber( numbers[k] );
+		withBisection.addNumber( numbers[k] );
+	}
+	nDiff += compareLists( withMask,withBisection,101 );
+	withMask.removeNumber( 100 );
+	withBisection.removeNumber( 100 );
+	nDiff += compareLists( withMask,withBisection,101 );
+
+	fprintf( stdFile, "Mask vs. bisection: %d differences\n", nDiff );
+
+	QPOASES_TEST_FOR_TRUE( nDiff == 0 );
+
+	return TEST_PASSED;
+}
+
+
+/** Moves numbers between two lists like the free/fixed lists of Bounds,
+ *  looking up its index first as done by QProblem.
+ *	\return Sum of the indices (keeps the lookups from being optimised away). */
+long changeActiveSet( Indexlist& free, Indexlist& fixed, const std::vector<int>& sequence )
+{
+	long sum = 0;
+
+	for (unsigned int k = 0; k < sequence.size( ); k++)
+	{
+		int i = sequence[k];
+		int index = free.getIndex( i );
+		sum += index;
+
+		if ( index >= 0 )
+		{
+			free.removeNumber( i );
+			fixed.addNumber( i );
+		}
+		else
+		{
+			sum += fixed.getIndex( i );
+			fixed.removeNumber( i );
+			free.addNumber( i );
+		}
+	}
+
+	return sum;
+}
+
+/** Time of an active set change with and without mask. */
+int indexlistSpeed( )
+{
+	const int sizes[] = { 6, 12, 24, 48, 64 };
+	const int nSizes = sizeof(sizes) / sizeof(int);
+	const int nChanges = 200000;
+
+	for (int s = 0; s < nSizes; s++)
+	{
+		int n = sizes[s];
+		if ( n > INDEXLIST_MASK_LENGTH )
+			continue;
+
+		std::vector<int> sequence( nChanges );
+		for (size_t k = 0; k < sequence.size( ); k++)
+			sequence[k] = rand( ) % n;
+
+		real_t t[2];
+		long sum[2];
+
+		for (int m = 0; m < 2; m++)
+		{
+			int physicalLength = ( m == 0 ) ? n : nBisection;
+			Indexlist free( physicalLength ), fixed( physicalLength );
+			for (int i = 0; i < n; i++)
+				free.addNumber( i );
+
+			real_t tic = getCPUtime( );
+			sum[m] = changeActiveSet( free,fixed,sequence );
+			t[m] = getCPUtime( ) - tic;
+		}
+
+		fprintf( stdFile, "%2d numbers: %6.1f ns per change, bisection %6.1f ns, speed-up %5.2f%s\n",
+				 n, 1e9*t[0]/nChanges, 1e9*t[1]/nChanges, t[1]/t[0], ( sum[0] == sum[1] ) ? "" : " (differs)" );
+
+		QPOASES_TEST_FOR_TRUE( sum[0] == sum[1] );
+	}
+
+	return TEST_PASSED;
+}
+
+
+/** Run tests on the bit masks of Indexlist. */
+int main( )
+{
+	int errorCount = TEST_PASSED;
+
+	errorCount += maskAgainstBisection( );
+	errorCount += indexlistSpeed( );
+
+	return errorCount;
+}
+
+
+/*
+ *	end of file
+ */
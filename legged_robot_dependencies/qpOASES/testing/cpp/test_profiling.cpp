@@ -0,0 +1,154 @@
+/*
+ *	This file is part of qpOASES.
+ *
+ *	qpOASES -- An Implementation of the Online Active Set Strategy.
+ *	Copyright (C) 2007-2015 by Hans Joachim Ferreau, Andreas Potschka,
+ *	Christian Kirches et al. All rights reserved.
+ *
+ *	qpOASES is free software; you can redistribute it and/or
+ *	modify it under the terms of the GNU Lesser General Public
+ *	License as published by the Free Software Foundation; either
+ *	version 2.1 of the License, or (at your option) any later version.
+ *
+ *	qpOASES is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	See the GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with qpOASES; if not, write to the Free Software
+ *	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/**
+ *	\file testing/cpp/test_profiling.cpp
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ *
+ *	Unit test for getClockTime( ), getCPUtime( ) and the ProfilingStatistics:
+ *	the clocks must never go backwards and must resolve the microseconds of a
+ *	phase in both precisions, and the phases must add up to at most the time of
+ *	init( ) and hotstart( ). Without __PROFILING__ all statistics stay zero.
+ */
+
+
+
+#include <algorithm>
+#include <qpOASES.hpp>
+#include <qpOASES/UnitTesting.hpp>
+
+#include "test_forceqp.hpp"
+
+
+USING_NAMESPACE_QPOASES
+
+
+/** Number of hotstarts. */
+const int nHotstarts = 50;
+
+
+/** Run tests on the profiling statistics. */
+int main( )
+{
+	int i, k;
+
+	/* clocks: monotonic, getClockTime( ) in double at any uptime, getCPUtime( ) from its first call */
+	int nBackwards = 0;
+	double resolution = INFTY, resolutionCPU = INFTY;
+	double last = getClockTime( );
+	real_t lastCPU = getCPUtime( );
+	for (i = 0; i < 100000; i++)
+	{
+		double now = getClockTime( );
+		real_t nowCPU = getCPUtime( );
+		if ( ( now < last ) || ( nowCPU < lastCPU ) )
+			nBackwards++;
+		if ( now > last )
+			resolution = std::min( resolution, now - last );
+		if ( nowCPU > lastCPU )
+			resolutionCPU = std::min( resolutionCPU, (double)( nowCPU - lastCPU ) );
+		last = now;
+		lastCPU = nowCPU;
+	}
+
+	fprintf( stdFile, "Clocks went backwards %d times, smallest increment: %.3e s, of getCPUtime( ): %.3e s\n",
+			nBackwards, resolution, resolutionCPU );
+
+	/* force QP over 2 steps of 4 legs, as solved by the MPC */
+	ForceQP qp;
+	setupForceQP( qp,2 );
+
+	Options options;
+	options.setToMPC( );
+	options.printLevel = PL_NONE;
+
+	QProblem problem( qp.nV,qp.nC );
+	problem.setOptions( options );
+
+	double tTotal = 0.0;
+	int nWSR, nIter = 0;
+
+	for (k = 0; k <= nHotstarts; k++)
+	{
+		setupForceGradient( qp.nV,-60.0 - (real_t)k,40.0,qp.g );
+
+		nWSR = 100;
+		double tic = getClockTime( );
+		if ( k == 0 )
+			problem.init( &qp.H[0],&qp.g[0],&qp.A[0],&qp.lb[0],&qp.ub[0],&qp.lbA[0],&qp.ubA[0], nWSR );
+		else
+			problem.hotstart( &qp.g[0],&qp.lb[0],&qp.ub[0],&qp.lbA[0],&qp.ubA[0], nWSR );
+		tTotal += getClockTime( ) - tic;
+		nIter += nWSR;
+	}
+
+	ProfilingStatistics profile = problem.getProfilingStatistics( );
+
+	fprintf( stdFile, "%d iterations in %.3f ms\n", nIter, 1e3*tTotal );
+	fprintf( stdFile, "setup          %10.3f ms %6d\n", 1e3*profile.setup,            profile.nSetup );
+	fprintf( stdFile, "homotopy       %10.3f ms %6d\n", 1e3*profile.homotopy,         profile.nHomotopy );
+	fprintf( stdFile, "factorisation  %10.3f ms %6d\n", 1e3*profile.factorisation,    profile.nFactorisation );
+	fprintf( stdFile, "stepDirection  %10.3f ms %6d\n", 1e3*profile.stepDirection,    profile.nStepDirection );
+	fprintf( stdFile, "performStep    %10.3f ms %6d\n", 1e3*profile.performStep,      profile.nPerformStep );
+	fprintf( stdFile, "addConstraint  %10.3f ms %6d\n", 1e3*profile.addConstraint,    profile.nAddConstraint );
+	fprintf( stdFile, "removeConstr.  %10.3f ms %6d\n", 1e3*profile.removeConstraint, profile.nRemoveConstraint );
+
+	QPOASES_TEST_FOR_TRUE( nBackwards == 0 );
+	QPOASES_TEST_FOR_TRUE( resolution < 1e-6 );
+	QPOASES_TEST_FOR_TRUE( resolutionCPU < 1e-5 );
+
+	#ifdef __PROFILING__
+	QPOASES_TEST_FOR_TRUE( profile.nSetup == 1 );
+	QPOASES_TEST_FOR_TRUE( profile.nHomotopy == nHotstarts+1 );
+	/* every homotopy ends with a full step that does not change the working set */
+	QPOASES_TEST_FOR_TRUE( profile.nStepDirection == nIter + profile.nHomotopy );
+	QPOASES_TEST_FOR_TRUE( profile.nPerformStep == nIter + profile.nHomotopy );
+	QPOASES_TEST_FOR_TRUE( profile.nAddConstraint + profile.nRemoveConstraint == nIter );
+	QPOASES_TEST_FOR_TRUE( profile.nFactorisation >= 1 );
+	/* every phase entered took a measurable time */
+	QPOASES_TEST_FOR_TRUE( ( profile.setup > 0.0 ) && ( profile.homotopy > 0.0 ) && ( profile.factorisation > 0.0 ) );
+	QPOASES_TEST_FOR_TRUE( ( profile.stepDirection > 0.0 ) && ( profile.performStep > 0.0 ) );
+	QPOASES_TEST_FOR_TRUE( ( profile.nAddConstraint == 0 ) || ( profile.addConstraint > 0.0 ) );
+	QPOASES_TEST_FOR_TRUE( ( profile.nRemoveConstraint == 0 ) || ( profile.removeConstraint > 0.0 ) );
+	QPOASES_TEST_FOR_TRUE( profile.setup + profile.homotopy <= tTotal );
+	QPOASES_TEST_FOR_TRUE( profile.stepDirection + profile.performStep + profile.addConstraint + profile.removeConstraint <= profile.homotopy );
+	#else
+	QPOASES_TEST_FOR_TRUE( profile.nSetup + profile.nHomotopy + profile.nFactorisation + profile.nStepDirection
+							+ profile.nPerformStep + profile.nAddConstraint + profile.nRemoveConstraint == 0 );
+	QPOASES_TEST_FOR_TRUE( profile.setup + profile.homotopy + profile.factorisation + profile.stepDirection
+							+ profile.performStep + profile.addConstraint + profile.removeConstraint <= 0.0 );
+	#endif /* __PROFILING__ */
+
+	problem.resetProfilingStatistics( );
+	QPOASES_TEST_FOR_TRUE( problem.getProfilingStatistics( ).nHomotopy == 0 );
+
+	return TEST_PASSED;
+}
+
+
+/*
+ *	end of file
+ */
@@ -0,0 +1,266 @@
+/*
+ *	This file is part of qpOASES.
+ *
+ *	qpOASES -- An Implementation of the Online Active Set Strategy.
+ *	Copyright (C) 2007-2015 by Hans Joachim Ferreau, Andreas Potschka,
+ *	Christian Kirches et al. All rights reserved.
+ *
+ *	qpOASES is free software; you can redistribute it and/or
+ *	modify it under the terms of the GNU Lesser General Public
+ *	License as published by the Free Software Foundation; either
+ *	version 2.1 of the License, or (at your option) any later version.
+ *
+ *	qpOASES is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	See the GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with qpOASES; if not, write to the Free Software
+ *	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/**
+ *	\file testing/cpp/test_threads.cpp
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ *
+ *	Stress test solving QPs on several threads at once: every thread has to
+ *	reproduce the single threaded solutions exactly, and print levels set on
+ *	one thread must not leak into the message handler of another one.
+ *	Needs C++11 and -pthread.
+ */
+
+
+
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <qpOASES.hpp>
+#include <qpOASES/UnitTesting.hpp>
+
+#include "test_forceqp.hpp"
+
+
+USING_NAMESPACE_QPOASES
+
+
+/** Number of QP sequences, of hotstarts per sequence and of threads. */
+const int nSequences = 24;
+const int nHotstarts = 10;
+const int nThreads = 8;
+const int nRounds = 5;
+
+
+/** Force QP with a sequence of gradients, as solved by the MPC, and its single threaded solutions. */
+struct QPSequence : public ForceQP
+{
+	std::vector<real_t> gSeq;				/**< nHotstarts+1 gradients. */
+
+	std::vector<real_t> x, y;				/**< Single threaded solutions. */
+	std::vector<int> status;				/**< Single threaded return values. */
+};
+
+
+/** Sets up a sequence, the QPs of every fourth one are infeasible. */
+void setupSequence( QPSequence& qp, int nStep, int seq )
+{
+	setupForceQP( qp,nStep );
+
+	size_t nV = (size_t)qp.nV, nC = (size_t)qp.nC;
+	size_t i;
+
+	/* total normal force within limits */
+	qp.A.resize( (nC+1)*nV, 0.0 );
+	for (i = 2; i < nV; i += 3)
+		qp.A[nC*nV + i] = 1.0;
+	qp.lbA.push_back( ( seq%4 == 3 ) ? 600.0*nStep : 0.0 );
+	qp.ubA.push_back( 400.0*nStep );
+	qp.nC++;
+
+	std::vector<real_t> g;
+	qp.gSeq.clear( );
+	for (int k = 0; k <= nHotstarts; k++)
+	{
+		setupForceGradient( qp.nV,-60.0 - 10.0*k,20.0,g );
+		qp.gSeq.insert( qp.gSeq.end( ),g.begin( ),g.end( ) );
+	}
+}
+
+
+/** Solves a sequence, stores solutions and return values, and counts solves after
+ *  which the message handler does not match the print level.
+ *	\return Number of iterations. */
+int solveSequence(	const QPSequence& qp, PrintLevel printLevel, Workspace* workspace,
+					std::vector<real_t>& x, std::vector<real_t>& y, std::vector<int>& status,
+					int& nHandlerMismatches )
+{
+	size_t nV = (size_t)qp.nV, nC = (size_t)qp.nC;
+	size_t k;
+	int nWSR, nIter = 0;
+	VisibilityStatus errorVisibility = ( printLevel == PL_NONE ) ? VS_HIDDEN : VS_VISIBLE;
+
+	BooleanType isSolved = BT_FALSE;
+
+	x.assign( (nHotstarts+1)*nV, 0.0 );
+	y.assign( (nHotstarts+1)*(nV+nC), 0.0 );
+	status.assign( nHotstarts+1, SUCCESSFUL_RETURN );
+
+	QProblem problem( qp.nV,qp.nC,HST_UNKNOWN,workspace );
+
+	Options options;
+	options.setToMPC( );
+	options.printLevel = printLevel;
+	problem.setOptions( options );
+
+	for (k = 0; k <= nHotstarts; k++)
+	{
+		nWSR = 100;
+		if ( isSolved == BT_FALSE )
+			status[k] = problem.init( &qp.H[0],&qp.gSeq[k*nV],&qp.A[0],&qp.lb[0],&qp.ub[0],&qp.lbA[0],&qp.ubA[0], nWSR );
+		else
+			status[k] = problem.hotstart( &qp.gSeq[k*nV],&qp.lb[0],&qp.ub[0],&qp.lbA[0],&qp.ubA[0], nWSR );
+		nIter += nWSR;
+
+		if ( getGlobalMessageHandler( )->getErrorVisibilityStatus( ) != errorVisibility )
+			nHandlerMismatches++;
+
+		isSolved = ( status[k] == SUCCESSFUL_RETURN ) ? BT_TRUE : BT_FALSE;
+		if ( isSolved == BT_TRUE )
+		{
+			problem.getPrimalSolution( &x[k*nV] );
+			problem.getDualSolution( &y[k*(nV+nC)] );
+		}
+		else
+		{
+			/* start over with a cold start, as the controller does */
+			problem.reset( );
+		}
+	}
+
+	return nIter;
+}
+
+
+/** Result of one worker thread. */
+struct WorkerResult
+{
+	real_t maxDeviation;
+	int nStatusMismatches;
+	int nHandlerMismatches;
+	int nIter;
+	const MessageHandling* handler;
+};
+
+
+/** Solves all sequences nRounds times, starting at a different one per thread. */
+void worker( const std::vector<QPSequence>* qps, int id, WorkerResult* result )
+{
+	std::vector<real_t> x, y;
+	std::vector<int> status;
+	Workspace workspace;
+
+	/* even threads are silent, odd ones report errors */
+	PrintLevel printLevel = ( id%2 == 0 ) ? PL_NONE : PL_LOW;
+
+	result->maxDeviation = 0.0;
+	result->nStatusMismatches = 0;
+	result->nHandlerMismatches = 0;
+	result->nIter = 0;
+	result->handler = getGlobalMessageHandler( );
+
+	for (int r = 0; r < nRounds; r++)
+		for (int s = 0; s < nSequences; s++)
+		{
+			const QPSequence& qp = (*qps)[ (size_t)( ( s + 3*id ) % nSequences ) ];
+			result->nIter += solveSequence( qp,printLevel,&workspace, x,y,status, result->nHandlerMismatches );
+
+			for (size_t i = 0; i < x.size( ); i++)
+				result->maxDeviation = getMax( result->maxDeviation, getAbs( x[i] - qp.x[i] ) );
+			for (size_t i = 0; i < y.size( ); i++)
+				result->maxDeviation = getMax( result->maxDeviation, getAbs( y[i] - qp.y[i] ) );
+			for (size_t i = 0; i < status.size( ); i++)
+				if ( status[i] != qp.status[i] )
+					result->nStatusMismatches++;
+		}
+}
+
+
+/** Run the stress test. */
+int main( )
+{
+	size_t i, j;
+	int nFailed = 0, nHandlerMismatches = 0;
+
+	std::vector<QPSequence> qps( nSequences );
+	for (i = 0; i < qps.size( ); i++)
+	{
+		setupSequence( qps[i], 1 + (int)i%3, (int)i );
+		solveSequence( qps[i],PL_NONE,0, qps[i].x,qps[i].y,qps[i].status, nHandlerMismatches );
+
+		for (j = 0; j < qps[i].status.size( ); j++)
+			if ( qps[i].status[j] != SUCCESSFUL_RETURN )
+				nFailed++;
+	}
+
+	/* the main thread only shows errors, whatever the workers set (QProblem
+	 * destructors make all messages visible again) */
+	getGlobalMessageHandler( )->setErrorVisibilityStatus( VS_VISIBLE );
+	getGlobalMessageHandler( )->setWarningVisibilityStatus( VS_HIDDEN );
+	getGlobalMessageHandler( )->setInfoVisibilityStatus( VS_HIDDEN );
+
+	std::vector<WorkerResult> results( nThreads );
+	std::vector<std::thread> threads;
+
+	double tic = getClockTime( );
+	for (i = 0; i < results.size( ); i++)
+		threads.push_back( std::thread( worker, &qps, (int)i, &results[i] ) );
+	for (i = 0; i < threads.size( ); i++)
+		threads[i].join( );
+	double toc = getClockTime( ) - tic;
+
+	real_t maxDeviation = 0.0;
+	int nStatusMismatches = 0, nSharedHandlers = 0, nIter = 0;
+
+	for (i = 0; i < results.size( ); i++)
+	{
+		maxDeviation = getMax( maxDeviation, results[i].maxDeviation );
+		nStatusMismatches += results[i].nStatusMismatches;
+		nHandlerMismatches += results[i].nHandlerMismatches;
+		nIter += results[i].nIter;
+
+		if ( results[i].handler == getGlobalMessageHandler( ) )
+			nSharedHandlers++;
+		for (j = 0; j < i; j++)
+			if ( results[i].handler == results[j].handler )
+				nSharedHandlers++;
+	}
+
+	if ( getGlobalMessageHandler( )->getErrorVisibilityStatus( ) != VS_VISIBLE )
+		nHandlerMismatches++;
+	if ( getGlobalMessageHandler( )->getWarningVisibilityStatus( ) != VS_HIDDEN )
+		nHandlerMismatches++;
+	if ( getGlobalMessageHandler( )->getInfoVisibilityStatus( ) != VS_HIDDEN )
+		nHandlerMismatches++;
+
+	fprintf( stdFile, "%d threads x %d rounds x %d sequences (%d failing QPs per round), %d iterations in %.3f s\n",
+			nThreads, nRounds, nSequences, nFailed, nIter, toc );
+	fprintf( stdFile, "Max. deviation from single threaded solution: %9.2e\n", maxDeviation );
+	fprintf( stdFile, "Return value mismatches: %d, message handler mismatches: %d, shared message handlers: %d\n",
+			nStatusMismatches, nHandlerMismatches, nSharedHandlers );
+
+	QPOASES_TEST_FOR_TRUE( nStatusMismatches == 0 );
+	QPOASES_TEST_FOR_TRUE( nHandlerMismatches == 0 );
+	QPOASES_TEST_FOR_TRUE( nSharedHandlers == 0 );
+	QPOASES_TEST_FOR_TOL( maxDeviation,1e-15 );
+
+	return TEST_PASSED;
+}
+
+
+/*
+ *	end of file
+ */
@@ -0,0 +1,195 @@
+/*
+ *	This file is part of qpOASES.
+ *
+ *	qpOASES -- An Implementation of the Online Active Set Strategy.
+ *	Copyright (C) 2007-2015 by Hans Joachim Ferreau, Andreas Potschka,
+ *	Christian Kirches et al. All rights reserved.
+ *
+ *	qpOASES is free software; you can redistribute it and/or
+ *	modify it under the terms of the GNU Lesser General Public
+ *	License as published by the Free Software Foundation; either
+ *	version 2.1 of the License, or (at your option) any later version.
+ *
+ *	qpOASES is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *	See the GNU Lesser General Public License for more details.
+ *
+ *	You should have received a copy of the GNU Lesser General Public
+ *	License along with qpOASES; if not, write to the Free Software
+ *	Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+/**
+ *	\file testing/cpp/test_workspace.cpp
+ *	\author Modulabs
+ *	\version 3.1
+ *	\date 2019
+ *
+ *	Unit test for QProblems taking their internal arrays from a Workspace:
+ *	same solution as with heap arrays, no array allocations in the constructor
+ *	once the workspace is set up, and deep copies independent of the workspace.
+ */
+
+
+
+#include <new>
+#include <cstdlib>
+#include <qpOASES.hpp>
+#include <qpOASES/UnitTesting.hpp>
+
+#include "test_forceqp.hpp"
+
+
+/** Number of calls of operator new[]. */
+static int nArrayAllocations = 0;
+
+void* operator new[]( size_t size )
+{
+	nArrayAllocations++;
+
+	void* p = malloc( size > 0 ? size : 1 );
+	if ( p == 0 )
+		throw std::bad_alloc( );
+
+	return p;
+}
+
+void operator delete[]( void* p ) throw( )
+{
+	free( p );
+}
+
+
+USING_NAMESPACE_QPOASES
+
+
+/** Solves the same QP with and without workspace, and checks the allocations in the constructor. */
+int testSolution( )
+{
+	ForceQP fqp;
+	setupForceQP( fqp,3 );
+
+	int nV = fqp.nV, nC = fqp.nC;
+	int i, nWSR, nAlloc = 0;
+
+	const real_t *H = &fqp.H[0], *g = &fqp.g[0], *A = &fqp.A[0];
+	const real_t *lb = &fqp.lb[0], *ub = &fqp.ub[0], *lbA = &fqp.lbA[0], *ubA = &fqp.ubA[0];
+
+	real_t* xRef = new real_t[nV];
+	real_t* yRef = new real_t[nV+nC];
+	real_t* xOpt = new real_t[nV];
+	real_t* yOpt = new real_t[nV+nC];
+
+	Options options;
+	options.setToMPC( );
+	options.printLevel = PL_NONE;
+
+	QProblem reference( nV,nC );
+	reference.setOptions( options );
+	nWSR = 100;
+	QPOASES_TEST_FOR_TRUE( reference.init( H,g,A,lb,ub,lbA,ubA, nWSR ) == SUCCESSFUL_RETURN );
+	reference.getPrimalSolution( xRef );
+	reference.getDualSolution( yRef );
+
+	Workspace workspace;
+	real_t err = 0.0;
+
+	/* one problem per tick, as in a controller */
+	for (int tick = 0; tick < 3; tick++)
+	{
+		int nAllocBefore = nArrayAllocations;
+		QProblem qp( nV,nC,HST_UNKNOWN,&workspace );
+		if ( tick > 0 )
+			nAlloc += nArrayAllocations - nAllocBefore;
+
+		qp.setOptions( options );
+		nWSR = 100;
+		QPOASES_TEST_FOR_TRUE( qp.init( H,g,A,lb,ub,lbA,ubA, nWSR ) == SUCCESSFUL_RETURN );
+		qp.getPrimalSolution( xOpt );
+		qp.getDualSolution( yOpt );
+
+		for (i = 0; i < nV; i++)
+			err = getMax( err, getAbs( xOpt[i] - xRef[i] ) );
+		for (i = 0; i < nV+nC; i++)
+			err = getMax( err, getAbs( yOpt[i] - yRef[i] ) );
+	}
+
+	fprintf( stdFile, "Workspace of %d bytes, %d bytes used, %d array allocations in constructor\n",
+			(int)workspace.getSize( ), (int)workspace.getUsed( ), nAlloc );
+	fprintf( stdFile, "Max. deviation from heap version: %9.2e\n", err );
+
+	QPOASES_TEST_FOR_TRUE( workspace.getUsed( ) <= workspace.getSize( ) );
+	QPOASES_TEST_FOR_TRUE( nAlloc == 0 );
+	QPOASES_TEST_FOR_TOL( err,1e-15 );
+
+	delete[] yOpt; delete[] xOpt; delete[] yRef; delete[] xRef;
+
+	return TEST_PASSED;
+}
+
+
+/** Copies of a problem using a workspace have to survive the next problem carved from it. */
+int testCopy( )
+{
+	real_t H[2*2] = { 1.0, 0.0, 0.0, 0.5 };
+	real_t A[1*2] = { 1.0, 1.0 };
+	real_t g[2] = { 1.5, 1.0 };
+	real_t lb[2] = { 0.5, -2.0 };
+	real_t ub[2] = { 5.0, 2.0 };
+	real_t lbA[1] = { -1.0 };
+	real_t ubA[1] = { 2.0 };
+	real_t g_new[2] = { 1.0, 1.5 };
+
+	Options options;
+	options.printLevel = PL_NONE;
+
+	Workspace workspace;
+	QProblem* qp = new QProblem( 2,1,HST_UNKNOWN,&workspace );
+	qp->setOptions( options );
+	int nWSR = 10;
+	qp->init( H,g,A,lb,ub,lbA,ubA, nWSR );
+
+	QProblem copy( *qp );
+	delete qp;
+
+	/* overwrite the workspace */
+	QProblem other( 2,1,HST_UNKNOWN,&workspace );
+	other.setOptions( options );
+	nWSR = 10;
+	other.init( H,g_new,A,lb,ub,lbA,ubA, nWSR );
+
+	real_t xOpt[2], stat, feas, cmpl;
+	nWSR = 10;
+	QPOASES_TEST_FOR_TRUE( copy.hotstart( g_new,lb,ub,lbA,ubA, nWSR ) == SUCCESSFUL_RETURN );
+	copy.getPrimalSolution( xOpt );
+
+	SolutionAnalysis analyzer;
+	analyzer.getKktViolation( &copy, &stat,&feas,&cmpl );
+	fprintf( stdFile, "Copy: xOpt = [ %e, %e ], stat = %e, feas = %e, cmpl = %e\n", xOpt[0],xOpt[1],stat,feas,cmpl );
+
+	QPOASES_TEST_FOR_TOL( stat,1e-15 );
+	QPOASES_TEST_FOR_TOL( feas,1e-15 );
+	QPOASES_TEST_FOR_TOL( cmpl,1e-15 );
+
+	return TEST_PASSED;
+}
+
+
+/** Run tests on Workspace. */
+int main( )
+{
+	int errorCount = TEST_PASSED;
+
+	errorCount += testSolution( );
+	errorCount += testCopy( );
+
+	return errorCount;
+}
+
+
+/*
+ *	end of file
+ */
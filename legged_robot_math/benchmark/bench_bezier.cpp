@@ -0,0 +1,168 @@
+/*
+  Author: Modulabs
+  File Name: bench_bezier.cpp
+*/
+
+#include <cmath>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "legged_robot_math/bezier.h"
+#include "legged_robot_math/trajectory_table.h"
+
+using Eigen::Vector3d;
+
+// Bezier before templating, kept here as reference
+class DynamicBezier
+{
+public:
+  void setPoints(const std::vector<Vector2d>& pnts)
+  {
+    size_t n_size = pnts.size();
+    _n_order = n_size-1;
+    _pnts = pnts;
+    _b.resize(n_size);
+    for (size_t i=0; i<=_n_order; i++)
+      _b[i] = boost::math::binomial_coefficient<double>(_n_order, i);
+  }
+
+  const Vector2d& getPoint(double t)
+  {
+    _p.setZero();
+    for(size_t i=0; i<=_n_order; i++)
+      _p +=  _b[i] * pow(1-t, _n_order-i) * pow(t, i) * _pnts[i];
+
+    return _p;
+  }
+
+  size_t                  _n_order;
+  std::vector<Vector2d>   _pnts;
+  std::vector<double>     _b;
+  Vector2d                _p;
+};
+
+static const double swing_pnts[4][2] = {{-0.3, -0.5}, {-0.3, -0.3}, {0.3, -0.3}, {0.3, -0.5}};
+
+static void BM_DynamicBezier2d(benchmark::State& state)
+{
+  DynamicBezier bezier;
+  std::vector<Vector2d> pnts(4);
+  for (size_t i=0; i<4; i++)
+    pnts[i] = Vector2d(swing_pnts[i][0], swing_pnts[i][1]);
+  bezier.setPoints(pnts);
+
+  double t = 0;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(bezier.getPoint(t));
+    t = (t < 1.0) ? t + 1e-3 : 0.0;
+  }
+}
+BENCHMARK(BM_DynamicBezier2d);
+
+static void BM_Bezier3d(benchmark::State& state)
+{
+  trajectory::Bezier<3, 4> bezier;
+  std::array<Vector3d, 4> pnts;
+  for (size_t i=0; i<4; i++)
+    pnts[i] = Vector3d(swing_pnts[i][0], 0, swing_pnts[i][1]);
+  bezier.setPoints(pnts);
+
+  double t = 0;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(bezier.getPoint(t));
+    t = (t < 1.0) ? t + 1e-3 : 0.0;
+  }
+}
+BENCHMARK(BM_Bezier3d);
+
+static void BM_Bezier3dPosVelAcc(benchmark::State& state)
+{
+  trajectory::Bezier<3, 4> bezier;
+  std::array<Vector3d, 4> pnts;
+  for (size_t i=0; i<4; i++)
+    pnts[i] = Vector3d(swing_pnts[i][0], 0, swing_pnts[i][1]);
+  bezier.setPoints(pnts);
+
+  Vector3d p, p_dot, p_ddot;
+  double t = 0;
+  for (auto _ : state)
+  {
+    bezier.getPoint(t, p, p_dot, p_ddot);
+    benchmark::DoNotOptimize(p);
+    benchmark::DoNotOptimize(p_dot);
+    benchmark::DoNotOptimize(p_ddot);
+    t = (t < 1.0) ? t + 1e-3 : 0.0;
+  }
+}
+BENCHMARK(BM_Bezier3dPosVelAcc);
+
+// four swing legs
+static void BM_DynamicBezier2dFourLegs(benchmark::State& state)
+{
+  DynamicBezier bezier;
+  std::vector<Vector2d> pnts(4);
+  for (size_t i=0; i<4; i++)
+    pnts[i] = Vector2d(swing_pnts[i][0], swing_pnts[i][1]);
+  bezier.setPoints(pnts);
+
+  double t = 0;
+  for (auto _ : state)
+  {
+    for (size_t i=0; i<4; i++)
+      benchmark::DoNotOptimize(bezier.getPoint(t + 0.1*i));
+    t = (t < 0.6) ? t + 1e-3 : 0.0;
+  }
+}
+BENCHMARK(BM_DynamicBezier2dFourLegs);
+
+static void BM_Bezier3dBatchFourLegs(benchmark::State& state)
+{
+  trajectory::Bezier<3, 4> bezier;
+  std::array<Vector3d, 4> pnts;
+  for (size_t i=0; i<4; i++)
+    pnts[i] = Vector3d(swing_pnts[i][0], 0, swing_pnts[i][1]);
+  bezier.setPoints(pnts);
+
+  Eigen::Matrix<double, 1, 4> s;
+  Eigen::Matrix<double, 3, 4> p, p_dot, p_ddot;
+  double t = 0;
+  for (auto _ : state)
+  {
+    s << t, t + 0.1, t + 0.2, t + 0.3;
+    bezier.getPoints(s, p, p_dot, p_ddot);
+    benchmark::DoNotOptimize(p);
+    benchmark::DoNotOptimize(p_dot);
+    benchmark::DoNotOptimize(p_ddot);
+    t = (t < 0.6) ? t + 1e-3 : 0.0;
+  }
+}
+BENCHMARK(BM_Bezier3dBatchFourLegs);
+
+static void BM_TrajectoryTable3d(benchmark::State& state)
+{
+  trajectory::Bezier<3, 4> bezier;
+  std::array<Vector3d, 4> pnts;
+  for (size_t i=0; i<4; i++)
+    pnts[i] = Vector3d(swing_pnts[i][0], 0, swing_pnts[i][1]);
+  bezier.setPoints(pnts);
+
+  trajectory::TrajectoryTable<3> table;
+  table.build(bezier, state.range(0));
+
+  Vector3d p, p_dot, p_ddot;
+  double t = 0;
+  for (auto _ : state)
+  {
+    table.getPoint(t, p, p_dot, p_ddot);
+    benchmark::DoNotOptimize(p);
+    benchmark::DoNotOptimize(p_dot);
+    benchmark::DoNotOptimize(p_ddot);
+    t = (t < 1.0) ? t + 1e-3 : 0.0;
+  }
+}
+BENCHMARK(BM_TrajectoryTable3d)->Arg(16)->Arg(64)->Arg(256);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,57 @@
+/*
+  Author: Modulabs
+  File Name: bench_min_jerk.cpp
+*/
+
+#include <array>
+
+#include <benchmark/benchmark.h>
+
+#include "legged_robot_math/min_jerk.h"
+
+#define N_JOINT 12
+
+// one MinJerk per joint, as done before batching
+static void BM_MinJerkJoints(benchmark::State& state)
+{
+  std::array<trajectory::MinJerk, N_JOINT> traj;
+  for (int i=0; i<N_JOINT; i++)
+    traj[i].setTrajInput(0.0, 0.1*i, -0.2*i, 2.0);
+
+  double pos[N_JOINT], vel[N_JOINT], acc[N_JOINT];
+  double t = 0;
+  for (auto _ : state)
+  {
+    for (int i=0; i<N_JOINT; i++)
+      traj[i].getTrajOutput(t, pos[i], vel[i], acc[i]);
+    benchmark::DoNotOptimize(pos);
+    benchmark::DoNotOptimize(vel);
+    benchmark::DoNotOptimize(acc);
+    t = (t < 2.0) ? t + 1e-3 : 0.0;
+  }
+}
+BENCHMARK(BM_MinJerkJoints);
+
+template<int N>
+static void BM_MinJerkBatch(benchmark::State& state)
+{
+  typedef typename trajectory::MinJerkBatch<N>::VectorNd VectorNd;
+
+  trajectory::MinJerkBatch<N> traj;
+  traj.setTrajInput(0.0, VectorNd::LinSpaced(0.0, 1.0), VectorNd::LinSpaced(0.0, -2.0), 2.0);
+
+  VectorNd pos, vel, acc;
+  double t = 0;
+  for (auto _ : state)
+  {
+    traj.getTrajOutput(t, pos, vel, acc);
+    benchmark::DoNotOptimize(pos);
+    benchmark::DoNotOptimize(vel);
+    benchmark::DoNotOptimize(acc);
+    t = (t < 2.0) ? t + 1e-3 : 0.0;
+  }
+}
+BENCHMARK_TEMPLATE(BM_MinJerkBatch, 6);
+BENCHMARK_TEMPLATE(BM_MinJerkBatch, N_JOINT);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,134 @@
+/*
+  Author: Modulabs
+  File Name: bench_so3.cpp
+*/
+
+#include <benchmark/benchmark.h>
+
+#include "legged_robot_math/math_func.h"
+#include "legged_robot_math/so3.h"
+
+// logR() before so3::log(), kept here as reference
+static Vector3d logRAcos(const Matrix3d& R)
+{
+  double d = 0.5 * (R(0,0) + R(1,1) + R(2,2) - 1.0);
+  if (d > 1.0) { d = (double)1.0; }
+  if (d < -1.0) { d = (double)-1.0; }
+
+  double theta = acos(d);
+  if ( fabs(theta) < 1e-6 ) return Vector3d(0.0, 0.0, 0.0);
+
+  double cof = theta / (2.0 * sin(theta));
+
+  return Vector3d(cof * (R(2,1) - R(1,2)), cof * (R(0,2) - R(2,0)), cof * (R(1,0) - R(0,1)));
+}
+
+static const Quaterniond q_d(AngleAxisd(0.3, Vector3d(1, 2, 3).normalized()));
+static const Quaterniond q(AngleAxisd(0.1, Vector3d(-1, 0, 2).normalized()));
+
+// orientation error of BalanceController
+static void BM_LogErrorMatrix(benchmark::State& state)
+{
+  Quaterniond q_i = q;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(q_i);
+    const Matrix3d R_d = q_d.toRotationMatrix();
+    const Matrix3d R = q_i.toRotationMatrix();
+    benchmark::DoNotOptimize(logRAcos(R_d*R.transpose()));
+  }
+}
+BENCHMARK(BM_LogErrorMatrix);
+
+static void BM_LogErrorQuaternion(benchmark::State& state)
+{
+  Quaterniond q_i = q;
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(q_i);
+    benchmark::DoNotOptimize(so3::logError(q_d, q_i));
+  }
+}
+BENCHMARK(BM_LogErrorQuaternion);
+
+static void BM_LogAcos(benchmark::State& state)
+{
+  Matrix3d R = q_d.toRotationMatrix();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(R);
+    benchmark::DoNotOptimize(logRAcos(R));
+  }
+}
+BENCHMARK(BM_LogAcos);
+
+static void BM_Log(benchmark::State& state)
+{
+  Matrix3d R = q_d.toRotationMatrix();
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(R);
+    benchmark::DoNotOptimize(so3::log(R));
+  }
+}
+BENCHMARK(BM_Log);
+
+static void BM_LogSmallAngle(benchmark::State& state)
+{
+  Matrix3d R = so3::exp(Vector3d(1e-3, -2e-3, 5e-4));
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(R);
+    benchmark::DoNotOptimize(so3::log(R));
+  }
+}
+BENCHMARK(BM_LogSmallAngle);
+
+static void BM_ExpAngleAxis(benchmark::State& state)
+{
+  Vector3d w(0.1, 0.2, -0.3);
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(w);
+    benchmark::DoNotOptimize(AngleAxisd(w.norm(), w.normalized()).toRotationMatrix());
+  }
+}
+BENCHMARK(BM_ExpAngleAxis);
+
+static void BM_Exp(benchmark::State& state)
+{
+  Vector3d w(0.1, 0.2, -0.3);
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(w);
+    benchmark::DoNotOptimize(so3::exp(w));
+  }
+}
+BENCHMARK(BM_Exp);
+
+// I^-1 [p] of MPCController
+static void BM_InverseSkew(benchmark::State& state)
+{
+  Matrix3d I = Vector3d(0.9, 4.0, 4.5).asDiagonal();
+  Vector3d p(0.37, 0.21, -0.55);
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(p);
+    benchmark::DoNotOptimize(Matrix3d(I.inverse() * skew(p)));
+  }
+}
+BENCHMARK(BM_InverseSkew);
+
+static void BM_InverseMulHat(benchmark::State& state)
+{
+  Matrix3d I_inv = Vector3d(0.9, 4.0, 4.5).asDiagonal().inverse();
+  Vector3d p(0.37, 0.21, -0.55);
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(p);
+    benchmark::DoNotOptimize(so3::mulHat(I_inv, p));
+  }
+}
+BENCHMARK(BM_InverseMulHat);
+
+BENCHMARK_MAIN();
@@ -5,85 +5,131 @@
 
 #pragma once
 
+#include <array>
+
 #include <Eigen/Core>
 #include <boost/math/special_functions/binomial.hpp>
 
 using Eigen::Matrix;
 using Eigen::Vector2d;
 using std::array;
-using std::vector;
 
 namespace trajectory
 {
-#if 0
-template<size_t N_DIM, size_t N_PNT>
+/* Bezier curve
+ * N_DIM: dimension of point, N_PNT: number of control points (order + 1)
+ * Control points are converted to power basis once in setPoints(),
+ * so that position, velocity and acceleration are evaluated by Horner's rule without pow() and allocation.
+ * Derivatives are with respect to the curve parameter t in [0, 1].
+*/
+template<int N_DIM, int N_PNT>
 class Bezier
 {
 public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  typedef Matrix<double, N_DIM, 1> VectorNd;
+
   Bezier()
   {
-    _n_order = N_PNT-1;
-    for (size_t i=0; i<=N_PNT; i++)
-      _b[i] = boost::math::binomial_coefficient<double>(_n_order, i);
+    _c.setZero();
+    _c_dot.setZero();
+    _c_ddot.setZero();
   }
 
-  typedef Eigen::Matrix<double, N_DIM, 1> VectorNd;
-
-  void setPoints(const array<VectorNd, N_PNT>& pnts) {_pnts = pnts;}
-
-  const VectorNd& getPoint(double t)
+  void setPoints(const array<VectorNd, N_PNT>& pnts)
   {
-    _p.setZero();
-    for(size_t i=0; i<=N_PNT; i++)
-      _p +=  _b[i] * pow(1-t, _n_order) * pow(t, i) * _pnts[i];
+    const int n = N_PNT-1;
+
+    // power basis, c_k = C(n,k) sum_i (-1)^(k-i) C(k,i) p_i
+    for (int k=0; k<=n; k++)
+    {
+      _c.col(k).setZero();
+      for (int i=0; i<=k; i++)
+      {
+        double sign = ((k-i) % 2 == 0) ? 1.0 : -1.0;
+        _c.col(k) += sign * boost::math::binomial_coefficient<double>(k, i) * pnts[i];
+      }
+      _c.col(k) *= boost::math::binomial_coefficient<double>(n, k);
+    }
+
+    // derivative coefficients
+    _c_dot.setZero();
+    _c_ddot.setZero();
+    for (int k=0; k<n; k++)
+      _c_dot.col(k) = (k+1) * _c.col(k+1);
+    for (int k=0; k<n-1; k++)
+      _c_ddot.col(k) = (k+1) * _c_dot.col(k+1);
 
-    return _p;
+    _pnts = pnts;
   }
 
-private:
-  size_t                  _n_order;
-  array<VectorNd, N_PNT>  _pnts;
-  array<double,N_PNT>     _b;       // coefficient
-  VectorNd                _p;
-
-};
-
-#else
+  const array<VectorNd, N_PNT>& getPoints() const { return _pnts; }
 
-class Bezier
-{
+  VectorNd getPoint(double t) const
+  {
+    VectorNd p = _c.col(N_PNT-1);
+    for (int k=N_PNT-2; k>=0; k--)
+      p = p*t + _c.col(k);
 
+    return p;
+  }
 
-public:
-  Bezier()
+  void getPoint(double t, VectorNd& p, VectorNd& p_dot, VectorNd& p_ddot) const
   {
+    p = _c.col(N_PNT-1);
+    p_dot = _c_dot.col(N_PNT-1);
+    p_ddot = _c_ddot.col(N_PNT-1);
+    for (int k=N_PNT-2; k>=0; k--)
+    {
+      p = p*t + _c.col(k);
+      p_dot = p_dot*t + _c_dot.col(k);
+      p_ddot = p_ddot*t + _c_ddot.col(k);
+    }
   }
 
-  void setPoints(const vector<Vector2d>& pnts)
+  // batch evaluation, column j of p is the point at t(j), e.g. phase of each leg
+  template<int N_BATCH>
+  void getPoints(const Matrix<double, 1, N_BATCH>& t, Matrix<double, N_DIM, N_BATCH>& p) const
   {
-    size_t n_size = pnts.size();
-    _n_order = n_size-1;
-    _pnts = pnts;
-    _b.resize(n_size);
-    for (size_t i=0; i<=_n_order; i++)
-      _b[i] = boost::math::binomial_coefficient<double>(_n_order, i);
+    for (int j=0; j<N_BATCH; j++)
+    {
+      for (int d=0; d<N_DIM; d++)
+      {
+        double x = _c(d, N_PNT-1);
+        for (int k=N_PNT-2; k>=0; k--)
+          x = x*t(j) + _c(d, k);
+        p(d, j) = x;
+      }
+    }
   }
 
-  const Vector2d& getPoint(double t)
+  template<int N_BATCH>
+  void getPoints(const Matrix<double, 1, N_BATCH>& t, Matrix<double, N_DIM, N_BATCH>& p,
+                 Matrix<double, N_DIM, N_BATCH>& p_dot, Matrix<double, N_DIM, N_BATCH>& p_ddot) const
   {
-    _p.setZero();
-    for(size_t i=0; i<=_n_order; i++)
-      _p +=  _b[i] * pow(1-t, _n_order-i) * pow(t, i) * _pnts[i];
-
-    return _p;
+    for (int j=0; j<N_BATCH; j++)
+    {
+      for (int d=0; d<N_DIM; d++)
+      {
+        double x = _c(d, N_PNT-1), x_dot = _c_dot(d, N_PNT-1), x_ddot = _c_ddot(d, N_PNT-1);
+        for (int k=N_PNT-2; k>=0; k--)
+        {
+          x = x*t(j) + _c(d, k);
+          x_dot = x_dot*t(j) + _c_dot(d, k);
+          x_ddot = x_ddot*t(j) + _c_ddot(d, k);
+        }
+        p(d, j) = x;
+        p_dot(d, j) = x_dot;
+        p_ddot(d, j) = x_ddot;
+      }
+    }
   }
 
-public:
-  size_t                  _n_order;
-  vector<Vector2d>        _pnts;
-  vector<double>          _b;       // coefficient
-  Vector2d                _p;
-
+private:
+  array<VectorNd, N_PNT>       _pnts;
+  Matrix<double, N_DIM, N_PNT> _c;        // power basis coefficient
+  Matrix<double, N_DIM, N_PNT> _c_dot;    // of first derivative
+  Matrix<double, N_DIM, N_PNT> _c_ddot;   // of second derivative
 };
-#endif
 }
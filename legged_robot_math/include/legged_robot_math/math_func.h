@@ -8,6 +8,8 @@
 #include <Eigen/Core>
 #include <Eigen/Geometry>
 
+#include "legged_robot_math/so3.h"
+
 using Eigen::Vector3d;
 using Eigen::Matrix3d;
 using Eigen::Quaterniond;
@@ -20,6 +22,7 @@ using Eigen::AngleAxisd;
 #define MM2M (0.001)
 
 
+// same as so3::log() and so3::hat()
 Vector3d logR(const Matrix3d& R);
 
 Matrix3d skew(const Vector3d& v);
@@ -5,6 +5,10 @@
 
 #pragma once
 
+#include <algorithm>
+
+#include <Eigen/Core>
+
 
 namespace trajectory
 {
@@ -13,7 +17,7 @@ class MinJerk
 public:
     MinJerk();
 
-    double setTrajInput(double t, double start, double end, double duration);
+    void setTrajInput(double t, double start, double end, double duration);
 
     int getTrajOutput(double t, double& pos, double& vel, double& acc);
 
@@ -26,4 +30,82 @@ private:
     double _start_pos, _a3, _a4, _a5, _end_pos;
     double _duration, _t;
 };
-}
\ No newline at end of file
+
+/* Minimum jerk trajectory of N axes, e.g. 12 joints or 6 axes of body pose
+ * Coefficients are stored as structure of arrays and position, velocity and acceleration of all axes
+ * are evaluated in one loop without branch, which the compiler vectorizes.
+ * Each axis is start + (end - start) * (10 s^3 - 15 s^4 + 6 s^5), s = clamp((t - t_start) / duration, 0, 1)
+*/
+template<int N>
+class MinJerkBatch
+{
+public:
+    typedef Eigen::Matrix<double, N, 1> VectorNd;
+
+    MinJerkBatch()
+    {
+        _state = -1;
+        _t = 0.0;
+        _duration_max = 0.0;
+        for (int i=0; i<N; i++)
+        {
+            _start_pos[i] = 0.0;
+            _delta[i] = 0.0;
+            _inv_duration[i] = 1.0;
+        }
+    }
+
+    void setTrajInput(double t, const VectorNd& start, const VectorNd& end, double duration)
+    {
+        setTrajInput(t, start, end, VectorNd::Constant(duration));
+    }
+
+    void setTrajInput(double t, const VectorNd& start, const VectorNd& end, const VectorNd& duration)
+    {
+        _state = 0;
+        _t = t;
+        _duration_max = duration.maxCoeff();
+        for (int i=0; i<N; i++)
+        {
+            _start_pos[i] = start(i);
+            _delta[i] = end(i) - start(i);
+            _inv_duration[i] = 1.0 / duration(i);
+        }
+    }
+
+    int getTrajOutput(double t, VectorNd& pos, VectorNd& vel, VectorNd& acc)
+    {
+        double dt = t - _t;
+
+        double* p = pos.data();
+        double* v = vel.data();
+        double* a = acc.data();
+        for (int i=0; i<N; i++)
+        {
+            // velocity and acceleration vanish at both ends, so clamping covers before start and after finish
+            double s = std::min(std::max(dt * _inv_duration[i], 0.0), 1.0);
+            double s2 = s*s;
+            double s3 = s2*s;
+            double d_T = _delta[i] * _inv_duration[i];
+
+            p[i] = _start_pos[i] + _delta[i] * s3 * (10.0 + s*(-15.0 + 6.0*s));
+            v[i] = d_T * s2 * (30.0 + s*(-60.0 + 30.0*s));
+            a[i] = d_T * _inv_duration[i] * s * (60.0 + s*(-180.0 + 120.0*s));
+        }
+
+        if (dt < 0)
+            _state = -1;
+        else if (dt < _duration_max)
+            _state = 1;
+        else
+            _state = 2;
+
+        return _state;
+    }
+
+private:
+    int _state; // -1: before start, 0: set moving, 1: moving, 2: finish moving
+    double _start_pos[N], _delta[N], _inv_duration[N];
+    double _duration_max, _t;
+};
+}
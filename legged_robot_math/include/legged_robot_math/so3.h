@@ -0,0 +1,222 @@
+/*
+  Author: Modulabs
+  File Name: so3.h
+*/
+
+#pragma once
+
+#include <cmath>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+// below this squared angle, sin/cos terms are replaced by Taylor series
+#define SO3_TAYLOR_THRESHOLD (1e-4)
+
+/* SO(3) kernels
+ * Closed form exp/log of rotation matrix and quaternion, inlined for the control loop.
+ * Small angles take Taylor series paths, so there is no division by sin(theta) near zero,
+ * and log() handles theta near pi from the symmetric part of R.
+ * Rotation vectors are axis * angle (rad).
+*/
+namespace so3
+{
+  // skew symmetric matrix [v], [v] x = v.cross(x)
+  inline Eigen::Matrix3d hat(const Eigen::Vector3d& v)
+  {
+    Eigen::Matrix3d m;
+    m <<    0, -v(2),  v(1),
+         v(2),     0, -v(0),
+        -v(1),  v(0),     0;
+
+    return m;
+  }
+
+  // writes [v] into a 3x3 block, e.g. hat(p, A.block<3,3>(3,0))
+  template<class Derived>
+  inline void hat(const Eigen::Vector3d& v, const Eigen::MatrixBase<Derived>& block)
+  {
+    Eigen::MatrixBase<Derived>& m = const_cast<Eigen::MatrixBase<Derived>&>(block);
+    m(0,0) =     0; m(0,1) = -v(2); m(0,2) =  v(1);
+    m(1,0) =  v(2); m(1,1) =     0; m(1,2) = -v(0);
+    m(2,0) = -v(1); m(2,1) =  v(0); m(2,2) =     0;
+  }
+
+  // [v] x
+  inline Eigen::Vector3d hatMul(const Eigen::Vector3d& v, const Eigen::Vector3d& x)
+  {
+    return v.cross(x);
+  }
+
+  // M [v], row i is M.row(i) x v
+  inline Eigen::Matrix3d mulHat(const Eigen::Matrix3d& M, const Eigen::Vector3d& v)
+  {
+    Eigen::Matrix3d m;
+    for (int i=0; i<3; i++)
+    {
+      m(i,0) = M(i,1)*v(2) - M(i,2)*v(1);
+      m(i,1) = M(i,2)*v(0) - M(i,0)*v(2);
+      m(i,2) = M(i,0)*v(1) - M(i,1)*v(0);
+    }
+
+    return m;
+  }
+
+  // R = exp([w]) = I + A [w] + B [w]^2, A = sin(t)/t, B = (1 - cos(t))/t^2
+  inline Eigen::Matrix3d exp(const Eigen::Vector3d& w)
+  {
+    double t2 = w.squaredNorm();
+    double A, B;
+    if (t2 < SO3_TAYLOR_THRESHOLD)
+    {
+      A = 1.0 - t2/6.0*(1.0 - t2/20.0);
+      B = 0.5 - t2/24.0*(1.0 - t2/30.0);
+    }
+    else
+    {
+      double t = std::sqrt(t2);
+      A = std::sin(t) / t;
+      B = (1.0 - std::cos(t)) / t2;
+    }
+
+    // [w]^2 = w w^T - t^2 I
+    Eigen::Matrix3d R = B * w * w.transpose();
+    R.diagonal().array() += 1.0 - B*t2;
+    R(0,1) -= A*w(2); R(1,0) += A*w(2);
+    R(0,2) += A*w(1); R(2,0) -= A*w(1);
+    R(1,2) -= A*w(0); R(2,1) += A*w(0);
+
+    return R;
+  }
+
+  inline Eigen::Quaterniond expQ(const Eigen::Vector3d& w)
+  {
+    double t2 = w.squaredNorm();
+    double c, s;  // cos(t/2), sin(t/2)/t
+    if (t2 < SO3_TAYLOR_THRESHOLD)
+    {
+      c = 1.0 - t2/8.0*(1.0 - t2/48.0);
+      s = 0.5 - t2/48.0*(1.0 - t2/80.0);
+    }
+    else
+    {
+      double t = std::sqrt(t2);
+      c = std::cos(0.5*t);
+      s = std::sin(0.5*t) / t;
+    }
+
+    return Eigen::Quaterniond(c, s*w(0), s*w(1), s*w(2));
+  }
+
+  inline Eigen::Vector3d log(const Eigen::Matrix3d& R)
+  {
+    // 2 sin(t) axis
+    Eigen::Vector3d v(R(2,1) - R(1,2), R(0,2) - R(2,0), R(1,0) - R(0,1));
+    double c = 0.5 * (R.trace() - 1.0);
+    double s2 = 0.25 * v.squaredNorm();   // sin(t)^2
+
+    if (c > 0 && s2 < SO3_TAYLOR_THRESHOLD)
+    {
+      // t/(2 sin(t)) = 0.5 (1 + s^2/6 + 3 s^4/40 + ...)
+      return 0.5 * (1.0 + s2/6.0*(1.0 + 0.45*s2)) * v;
+    }
+
+    if (c > -0.9)
+      return (0.5 * std::acos(c) / std::sqrt(s2)) * v;
+
+    double t = std::atan2(std::sqrt(s2), c);
+
+    // near pi, axis from (R + R^T)/2 = c I + (1 - c) a a^T
+    int k;
+    R.diagonal().maxCoeff(&k);
+    Eigen::Vector3d a = 0.5 * (R.col(k) + R.row(k).transpose());
+    a(k) = R(k,k) - c;
+    a /= std::sqrt(a(k) * (1.0 - c));
+    if (a.dot(v) < 0)
+      a = -a;
+
+    return t * a;
+  }
+
+  inline Eigen::Vector3d log(const Eigen::Quaterniond& q)
+  {
+    // q and -q are the same rotation, take the one with angle in [0, pi]
+    double w = q.w();
+    Eigen::Vector3d v = q.vec();
+    if (w < 0)
+    {
+      w = -w;
+      v = -v;
+    }
+
+    double n2 = v.squaredNorm();   // sin(t/2)^2
+    if (n2 < SO3_TAYLOR_THRESHOLD)
+    {
+      // t/sin(t/2) = 2 (1 + n^2/6 + 3 n^4/40 + ...)
+      return 2.0 * (1.0 + n2/6.0*(1.0 + 0.45*n2)) * v;
+    }
+
+    double n = std::sqrt(n2);
+    return (2.0 * std::atan2(n, w) / n) * v;
+  }
+
+  // log(R_d R^T) without rotation matrices, orientation error in world frame
+  inline Eigen::Vector3d logError(const Eigen::Quaterniond& q_d, const Eigen::Quaterniond& q)
+  {
+    return log(q_d * q.conjugate());
+  }
+
+  /* Jacobian of log for world frame angular velocity
+   * e = log(R_e), R_e = exp(w dt) R_e  =>  e_dot = J(e) w
+   * J = I - [e]/2 + (1/t^2 - (1 + cos(t))/(2 t sin(t))) [e]^2
+  */
+  inline Eigen::Matrix3d jacobianLog(const Eigen::Vector3d& e)
+  {
+    double t2 = e.squaredNorm();
+    double D;
+    if (t2 < SO3_TAYLOR_THRESHOLD)
+    {
+      D = 1.0/12.0 + t2/720.0;
+    }
+    else
+    {
+      double t = std::sqrt(t2);
+      D = 1.0/t2 - (1.0 + std::cos(t)) / (2.0 * t * std::sin(t));
+    }
+
+    Eigen::Matrix3d J = D * e * e.transpose();
+    J.diagonal().array() += 1.0 - D*t2;
+    J(0,1) += 0.5*e(2); J(1,0) -= 0.5*e(2);
+    J(0,2) -= 0.5*e(1); J(2,0) += 0.5*e(1);
+    J(1,2) += 0.5*e(0); J(2,1) -= 0.5*e(0);
+
+    return J;
+  }
+}
+
+/* SE(3) kernels
+ * twist is (linear, angular), same order as Twist
+*/
+namespace se3
+{
+  // Ad_T = [R, [p] R; 0, R]
+  inline Eigen::Matrix<double, 6, 6> adjoint(const Eigen::Matrix3d& R, const Eigen::Vector3d& p)
+  {
+    Eigen::Matrix<double, 6, 6> Ad;
+    Ad.topLeftCorner<3,3>() = R;
+    Ad.topRightCorner<3,3>() = so3::hat(p) * R;
+    Ad.bottomLeftCorner<3,3>().setZero();
+    Ad.bottomRightCorner<3,3>() = R;
+
+    return Ad;
+  }
+
+  // twist seen from the other frame, Ad_T (v, w) without forming Ad_T
+  inline void adjointMul(const Eigen::Quaterniond& q, const Eigen::Vector3d& p,
+                         const Eigen::Vector3d& v, const Eigen::Vector3d& w,
+                         Eigen::Vector3d& v_out, Eigen::Vector3d& w_out)
+  {
+    w_out = q * w;
+    v_out = q * v + p.cross(w_out);
+  }
+}
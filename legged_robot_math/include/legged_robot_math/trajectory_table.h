@@ -0,0 +1,158 @@
+/*
+  Author: Modulabs
+  File Name: trajectory_table.h
+*/
+
+#pragma once
+
+#include <algorithm>
+
+#include <Eigen/Core>
+
+using Eigen::Matrix;
+using Eigen::Dynamic;
+
+namespace trajectory
+{
+/* Trajectory lookup table
+ * Samples position and first derivative of a trajectory over the phase s in [0, 1] once in build(),
+ * then serves position, velocity and acceleration by cubic Hermite interpolation between samples.
+ * Derivatives are with respect to s, divide by the phase duration (and its square) for time derivatives.
+ * Table is in phase, so it does not have to be rebuilt when only the timing of gait is changed.
+*/
+template<int N_DIM>
+class TrajectoryTable
+{
+public:
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  typedef Matrix<double, N_DIM, 1> VectorNd;
+
+  /* Correction
+   * quintic offset added from phase _s0 to the end, to move the end point of a trajectory (re-targeting)
+   * it keeps position, velocity and acceleration continuous at _s0 and ends with zero velocity and acceleration
+  */
+  struct Correction
+  {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    Correction() { reset(); }
+    void reset() { _active = false; _s0 = 0; _inv_len = 1; _q.setZero(); }
+
+    bool _active;
+    double _s0, _inv_len;
+    Matrix<double, N_DIM, 6> _q;  // coefficient of u^0 ... u^5, u = (s - _s0) / (1 - _s0)
+  };
+
+  TrajectoryTable() : _n_segment(0), _inv_ds(0) {}
+
+  // trajectory needs getPoint(s, p, p_dot, p_ddot), e.g. Bezier
+  template<class Trajectory>
+  void build(const Trajectory& traj, int n_sample)
+  {
+    n_sample = std::max(n_sample, 2);
+    _n_segment = n_sample - 1;
+    _inv_ds = _n_segment;
+
+    _p.resize(N_DIM, n_sample);
+    _p_dot.resize(N_DIM, n_sample);
+
+    VectorNd p, p_dot, p_ddot;
+    for (int i=0; i<n_sample; i++)
+    {
+      traj.getPoint(double(i) / _n_segment, p, p_dot, p_ddot);
+      _p.col(i) = p;
+      _p_dot.col(i) = p_dot;
+    }
+  }
+
+  int getResolution() const { return _n_segment + 1; }
+  VectorNd getEndPoint() const { return _p.col(_n_segment); }
+
+  void getPoint(double s, VectorNd& p, VectorNd& p_dot, VectorNd& p_ddot) const
+  {
+    s = std::min(std::max(s, 0.0), 1.0);
+
+    double x = s * _n_segment;
+    int i = std::min(int(x), _n_segment - 1);
+    double u = x - i, u2 = u*u, u3 = u2*u;
+    double ds = 1.0 / _inv_ds;
+
+    // tangents with respect to u
+    const VectorNd m0 = _p_dot.col(i) * ds;
+    const VectorNd m1 = _p_dot.col(i+1) * ds;
+    const VectorNd& p0 = _p.col(i);
+    const VectorNd& p1 = _p.col(i+1);
+
+    p = (2*u3 - 3*u2 + 1)*p0 + (u3 - 2*u2 + u)*m0 + (-2*u3 + 3*u2)*p1 + (u3 - u2)*m1;
+    p_dot = ((6*u2 - 6*u)*p0 + (3*u2 - 4*u + 1)*m0 + (-6*u2 + 6*u)*p1 + (3*u2 - 2*u)*m1) * _inv_ds;
+    p_ddot = ((12*u - 6)*p0 + (6*u - 4)*m0 + (-12*u + 6)*p1 + (6*u - 2)*m1) * (_inv_ds * _inv_ds);
+  }
+
+  void getPoint(double s, const Correction& correction, VectorNd& p, VectorNd& p_dot, VectorNd& p_ddot) const
+  {
+    getPoint(s, p, p_dot, p_ddot);
+
+    if (!correction._active)
+      return;
+
+    VectorNd c, c_dot, c_ddot;
+    getCorrection(s, correction, c, c_dot, c_ddot);
+    p += c;
+    p_dot += c_dot;
+    p_ddot += c_ddot;
+  }
+
+  // move end point to p_end from phase s, without rebuilding the table
+  void retarget(double s, const VectorNd& p_end, Correction& correction) const
+  {
+    s = std::min(std::max(s, 0.0), 1.0);
+    if (s >= 1.0)
+      return;
+
+    // current correction at s, to stay continuous
+    VectorNd c0 = VectorNd::Zero(), c0_dot = VectorNd::Zero(), c0_ddot = VectorNd::Zero();
+    if (correction._active)
+      getCorrection(s, correction, c0, c0_dot, c0_ddot);
+
+    double len = 1.0 - s;
+    const VectorNd v0 = c0_dot * len;           // with respect to u
+    const VectorNd a0 = c0_ddot * (len * len);
+    const VectorNd d = (p_end - getEndPoint()) - c0;
+
+    correction._active = true;
+    correction._s0 = s;
+    correction._inv_len = 1.0 / len;
+    correction._q.col(0) = c0;
+    correction._q.col(1) = v0;
+    correction._q.col(2) = 0.5 * a0;
+    correction._q.col(3) = 10*d - 6*v0 - 1.5*a0;
+    correction._q.col(4) = -15*d + 8*v0 + 1.5*a0;
+    correction._q.col(5) = 6*d - 3*v0 - 0.5*a0;
+  }
+
+private:
+  void getCorrection(double s, const Correction& correction, VectorNd& c, VectorNd& c_dot, VectorNd& c_ddot) const
+  {
+    double u = std::min(std::max((s - correction._s0) * correction._inv_len, 0.0), 1.0);
+    const Matrix<double, N_DIM, 6>& q = correction._q;
+
+    c = q.col(5);
+    c_dot = 5*q.col(5);
+    c_ddot = 20*q.col(5);
+    for (int k=4; k>=0; k--)
+    {
+      c = c*u + q.col(k);
+      if (k >= 1) c_dot = c_dot*u + k*q.col(k);
+      if (k >= 2) c_ddot = c_ddot*u + k*(k-1)*q.col(k);
+    }
+
+    c_dot *= correction._inv_len;
+    c_ddot *= correction._inv_len * correction._inv_len;
+  }
+
+  int _n_segment;
+  double _inv_ds;
+  Matrix<double, N_DIM, Dynamic> _p, _p_dot;
+};
+}
@@ -13,15 +13,17 @@ MinJerk::MinJerk()
     _t = 0.0;
 }
 
-double MinJerk::setTrajInput(double t, double start_pos, double end_pos, double duration)
+void MinJerk::setTrajInput(double t, double start_pos, double end_pos, double duration)
 {
+    double duration3 = duration*duration*duration;
+
     _state = 0;
     _t = t;
     _start_pos = start_pos;
     _duration = duration;
-    _a3 = (20.0*end_pos - 20.0*start_pos) / (2.0*duration*duration*duration);
-    _a4 = (30.0*start_pos - 30*end_pos) / (2.0*duration*duration*duration*duration);
-    _a5 = (12.0*end_pos - 12.0*start_pos) / (2.0*duration*duration*duration*duration*duration);
+    _a3 = (20.0*end_pos - 20.0*start_pos) / (2.0*duration3);
+    _a4 = (30.0*start_pos - 30*end_pos) / (2.0*duration3*duration);
+    _a5 = (12.0*end_pos - 12.0*start_pos) / (2.0*duration3*duration*duration);
     _end_pos = end_pos;
 }
 
@@ -39,9 +41,11 @@ int MinJerk::getTrajOutput(double t, double& pos, double& vel, double& acc)
     else if (dt <_duration)
     {
         _state = 1;
-        pos = getPos(dt);
-        vel = getVel(dt);
-        acc = getAcc(dt);
+        double dt2 = dt*dt;
+        double dt3 = dt2*dt;
+        pos = _start_pos + dt3*(_a3 + dt*(_a4 + dt*_a5));
+        vel = dt2*(3.0*_a3 + dt*(4.0*_a4 + dt*5.0*_a5));
+        acc = dt*(6.0*_a3 + dt*(12.0*_a4 + dt*20.0*_a5));
     }
     else
     {